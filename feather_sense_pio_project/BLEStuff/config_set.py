@@ -0,0 +1,103 @@
+# Set or reset a runtime config key over the Nordic UART service.
+#   python config_set.py ADDRESS imu_hz 5          # store an override, applied now
+#   python config_set.py ADDRESS spo2_window 100
+#   python config_set.py ADDRESS imu_hz --reset    # back to the built-in default
+#   python config_set.py --tcp 9000 imu_hz 5       # host build, HOST_BLE_OUT=tcp:9000
+# The device echoes the command with an ok byte; a value of the wrong type
+# or out of the key's range is refused and changes nothing.
+# Keys and ranges: include/config_store.h and src/config_store.cpp;
+# protocol: storage.cpp, "Incremental BLE upload".
+import asyncio
+import socket
+import struct
+import sys
+
+UART_RX = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"  # central writes
+UART_TX = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"  # device notifies
+USAGE = "usage: config_set.py (ADDRESS | --tcp PORT) KEY (VALUE | --reset)"
+
+NONE, I32, F32 = range(3)
+# name: (key id, type), in config_key_t order
+KEYS = {
+    "temp_hz": (0, F32), "spo2_hz": (1, F32), "spo2_2_hz": (2, F32),
+    "spo2_fusion_hz": (3, F32), "imu_hz": (4, F32), "mic_hz": (5, F32),
+    "battery_hz": (6, F32), "spo2_window": (7, I32), "spo2_dc_iir": (8, F32),
+    "spo2_smooth": (9, F32), "mic_min_hz": (10, F32), "mic_max_hz": (11, F32),
+    "mic_min_mag": (12, F32), "mic_max_mag": (13, F32), "temp_offset_c": (14, F32),
+    "flush_watermark": (15, I32),
+}
+
+
+def command(name, value):
+    key, kind = KEYS[name]
+    if value == "--reset":
+        return b"C" + struct.pack(">BBI", key, NONE, 0)
+    if kind == I32:
+        return b"C" + struct.pack(">BBi", key, kind, int(value))
+    return b"C" + struct.pack(">BBf", key, kind, float(value))
+
+
+def reply_in(buf, cmd):
+    """The device's echo of cmd in buf: True/False for its ok byte, None
+    while it hasn't arrived"""
+    at = buf.find(cmd)
+    if at < 0 or at + len(cmd) >= len(buf):
+        return None
+    return buf[at + len(cmd)] == 1
+
+
+async def run_ble(addr, cmd):
+    from bleak import BleakClient  # pip install bleak
+
+    buf = bytearray()
+    async with BleakClient(addr) as client:
+        await client.start_notify(UART_TX, lambda _, data: buf.extend(data))
+        await client.write_gatt_char(UART_RX, cmd, response=True)
+        for _ in range(50):
+            if reply_in(bytes(buf), cmd) is not None:
+                break
+            await asyncio.sleep(0.1)
+    return reply_in(bytes(buf), cmd)
+
+
+def run_tcp(port, cmd):
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind(("127.0.0.1", port))
+    srv.listen(1)
+    conn, _ = srv.accept()
+    conn.settimeout(5)
+    conn.sendall(cmd)
+    buf = b""
+    try:
+        while reply_in(buf, cmd) is None:
+            data = conn.recv(4096)
+            if not data:
+                break
+            buf += data
+    except socket.timeout:
+        pass
+    conn.close()
+    srv.close()
+    return reply_in(buf, cmd)
+
+
+def main(argv):
+    if len(argv) == 5 and argv[1] == "--tcp":
+        port, name, value = int(argv[2]), argv[3], argv[4]
+    elif len(argv) == 4 and not argv[1].startswith("--"):
+        port, name, value = None, argv[2], argv[3]
+    else:
+        print(USAGE, file=sys.stderr)
+        return 2
+    if name not in KEYS:
+        print("unknown key %s; keys: %s" % (name, " ".join(KEYS)), file=sys.stderr)
+        return 2
+    cmd = command(name, value)
+    ok = asyncio.run(run_ble(argv[1], cmd)) if port is None else run_tcp(port, cmd)
+    print("%s: %s" % (name, {True: "set", False: "refused", None: "no reply"}[ok]))
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,389 @@
+# Decode the flash log, from a BLE upload capture or a raw flash image.
+#   python log_decode.py upload.bin          # bleuart bytes: 'K' seq(4) off(2) batch ... (log_sync.py output)
+#   python log_decode.py --flash flash.bin   # QSPI image (e.g. HOST_FLASH_FILE)
+#   --skip-long                              # leave out long records (mic buffers...)
+#   --summaries                              # per-minute summaries instead ('M' frames / summary ring)
+# Prints one CSV line per record: ts_ms,sensor,codec,values. A batch that
+# fails its CRC is decoded up to the first record whose check byte fails.
+# Summaries print as minute,sensor,codec,count,stats,bins with stats as
+# vI=min/max/mean for each summarized value I.
+# Formats: storage.cpp (sectors, batches, upload frames) and record_codec.h (records).
+import struct
+import sys
+import zlib
+
+LOG_MAGIC = 0x534C4F47
+LOG_VERSION = 4
+LOG_HDR_COMMIT = 0xA55A
+LOG_BATCH_COMMIT = 0xA5
+LOG_SECTOR_BYTES = 4096
+LOG_REGION_BYTES = 512 * 1024
+SUM_MAGIC = 0x5353554D
+SUM_REGION_BASE = 528 * 1024
+SUM_REGION_BYTES = 512 * 1024  # STORAGE_SUMMARY_SECTORS
+SUM_ENTRY = struct.Struct(">BBBBIH")  # sensor codec mask bins minute count
+SECTOR_HDR = struct.Struct("<IIIIHHHH")  # magic seq base_ts erase_count version hdr_commit used seal_commit
+BATCH_HDR = 12  # len(2) commit flags base_ts(4) crc32(4), big endian
+
+RAW, U8_DELTA, I16BE_DELTA, F32BE_XOR, F32LE_XOR = range(5)
+LONG = 7
+CODEC_NAMES = {RAW: "raw", U8_DELTA: "u8", I16BE_DELTA: "i16be", F32BE_XOR: "f32be",
+               F32LE_XOR: "f32le", LONG: "long"}
+VALUE_BYTES = [1, 1, 2, 4, 4]
+MAX_VALUES = 8
+NO_WINDOW = 0xFF
+TELEMETRY_VERSION = 1  # telemetry.h; its frames share the UART
+CONFIG_KEYS = 16  # CONFIG_KEY_COUNT; config_set.py replies share the UART
+
+
+class Reader:
+    def __init__(self, data):
+        self.d = data
+        self.pos = 0
+        self.bit = 0
+
+    def byte(self):
+        if self.pos >= len(self.d):
+            raise ValueError("truncated record")
+        b = self.d[self.pos]
+        self.pos += 1
+        return b
+
+    def varint(self):
+        v = shift = 0
+        while True:
+            b = self.byte()
+            v |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return v
+            shift += 7
+            if shift >= 35:
+                raise ValueError("bad varint")
+
+    def bits(self, n):
+        v = 0
+        while n:
+            if self.pos >= len(self.d):
+                raise ValueError("truncated bits")
+            room = 8 - self.bit
+            take = min(n, room)
+            chunk = (self.d[self.pos] >> (room - take)) & ((1 << take) - 1)
+            v = (v << take) | chunk
+            self.bit += take
+            n -= take
+            if self.bit == 8:
+                self.bit = 0
+                self.pos += 1
+        return v
+
+    def end_bits(self):
+        if self.bit:
+            self.bit = 0
+            self.pos += 1
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def values_of(codec, raw):
+    if codec == I16BE_DELTA:
+        return list(struct.unpack(">%dh" % (len(raw) // 2), raw))
+    if codec == F32BE_XOR:
+        return [round(x, 4) for x in struct.unpack(">%df" % (len(raw) // 4), raw)]
+    if codec == F32LE_XOR:
+        return [round(x, 4) for x in struct.unpack("<%df" % (len(raw) // 4), raw)]
+    if codec == U8_DELTA:
+        return list(raw)
+    return [raw.hex()]
+
+
+def check(r, data, start):
+    """Per-record check byte: low byte of the CRC-32 of the record"""
+    if r.byte() != zlib.crc32(data[start:r.pos - 1]) & 0xFF:
+        raise ValueError("record check byte mismatch at %d" % start)
+
+
+def batch_ok(batch):
+    """CRC of a whole stored batch (header + body)"""
+    crc = zlib.crc32(batch[0:2] + batch[4:8] + batch[BATCH_HDR:])
+    return crc == struct.unpack_from(">I", batch, 8)[0]
+
+
+def decode_block(base_ts, data, parts=None):
+    """Yield (ts, sensor, codec, payload bytes) for one batch. Long record
+    parts are gathered per sensor in the parts dict, which carries over from
+    batch to batch; a record is yielded once its last part is in. Without a
+    dict long records are stepped over, bodies unread. Parts that don't
+    continue what was gathered (the rest was lost or evicted) are dropped."""
+    r = Reader(data)
+    last_ts = base_ts
+    slots = {}
+    while r.pos < len(data):
+        start = r.pos
+        tag = r.byte()
+        last_ts = (last_ts + unzigzag(r.varint())) & 0xFFFFFFFF
+        codec, idx = tag >> 5, tag & 0x1F
+        if codec == LONG:
+            total, off, n = r.varint(), r.varint(), r.varint()
+            check(r, data, start)
+            if n == 0 or off + n > total or r.pos + n > len(data):
+                raise ValueError("bad long record at %d" % start)
+            body = data[r.pos:r.pos + n]
+            r.pos += n
+            if parts is None:
+                continue
+            ts, got = parts.pop(idx, (last_ts, b""))
+            if off != len(got):
+                if off:
+                    continue
+                ts, got = last_ts, b""
+            got += body
+            if len(got) == total:
+                yield ts, idx, LONG, got
+            else:
+                parts[idx] = (ts, got)
+            continue
+        n_bytes = r.byte()
+        if codec > F32LE_XOR:
+            raise ValueError("bad codec %d" % codec)
+        if codec == RAW:
+            payload = bytes(r.byte() for _ in range(n_bytes))
+            check(r, data, start)
+            yield last_ts, idx, codec, payload
+            continue
+        vb = VALUE_BYTES[codec]
+        if n_bytes % vb or n_bytes // vb > MAX_VALUES:
+            raise ValueError("bad length %d for codec %d" % (n_bytes, codec))
+        prev, lead, trail = slots.get(idx, ([0] * MAX_VALUES, [NO_WINDOW] * MAX_VALUES, [0] * MAX_VALUES))
+        out = []
+        for i in range(n_bytes // vb):
+            if codec in (U8_DELTA, I16BE_DELTA):
+                v = (prev[i] + unzigzag(r.varint())) & 0xFFFFFFFF
+                v = v & 0xFF if codec == U8_DELTA else v & 0xFFFF
+                if codec == I16BE_DELTA and v & 0x8000:
+                    v -= 0x10000
+            elif r.bits(1) == 0:
+                v = prev[i]
+            elif r.bits(1) == 0:
+                if lead[i] == NO_WINDOW:
+                    raise ValueError("window reuse before one was set")
+                sig = 32 - lead[i] - trail[i]
+                v = prev[i] ^ (r.bits(sig) << trail[i])
+            else:
+                lz = r.bits(5)
+                sig = r.bits(5) + 1
+                if lz + sig > 32:
+                    raise ValueError("bad xor window")
+                tz = 32 - lz - sig
+                v = prev[i] ^ (r.bits(sig) << tz)
+                lead[i], trail[i] = lz, tz
+            prev[i] = v
+            out.append(v)
+        r.end_bits()
+        check(r, data, start)
+        slots[idx] = (prev, lead, trail)
+        if codec == I16BE_DELTA:
+            payload = b"".join(struct.pack(">h", v) for v in out)
+        elif codec == U8_DELTA:
+            payload = bytes(out)
+        elif codec == F32BE_XOR:
+            payload = b"".join(struct.pack(">I", v) for v in out)
+        else:
+            payload = b"".join(struct.pack("<I", v) for v in out)
+        yield last_ts, idx, codec, payload
+
+
+def summaries_in(body):
+    """Yield (minute, sensor, codec, count, {value: (min, max, mean)}, bins)
+    for the entries of one summary batch"""
+    pos = 0
+    while pos < len(body):
+        if pos + SUM_ENTRY.size > len(body):
+            raise ValueError("truncated summary at %d" % pos)
+        idx, codec, mask, nbins, minute, count = SUM_ENTRY.unpack_from(body, pos)
+        pos += SUM_ENTRY.size
+        stats = {}
+        if mask:
+            if codec == RAW or codec > F32LE_XOR:
+                raise ValueError("values for codec %d" % codec)
+            w = VALUE_BYTES[codec]
+            for i in range(MAX_VALUES):
+                if mask & (1 << i):
+                    if pos + 3 * w > len(body):
+                        raise ValueError("truncated summary at %d" % pos)
+                    stats[i] = tuple(values_of(codec, body[pos + k * w:pos + (k + 1) * w])[0] for k in range(3))
+                    pos += 3 * w
+        if pos + 2 * nbins > len(body):
+            raise ValueError("truncated summary at %d" % pos)
+        bins = list(struct.unpack_from(">%dH" % nbins, body, pos))
+        pos += 2 * nbins
+        yield minute, idx, codec, count, stats, bins
+
+
+def merge_summaries(entries):
+    """Merge entries of the same sensor and minute (a minute that spans two
+    log sectors has one from each); means are weighted by record count"""
+    out = {}
+    for minute, idx, codec, count, stats, bins in entries:
+        key = (minute, idx)
+        if key not in out:
+            out[key] = [codec, count, dict(stats), bins]
+            continue
+        cur = out[key]
+        total = cur[1] + count
+        for i, (lo, hi, mean) in stats.items():
+            if i in cur[2]:
+                clo, chi, cmean = cur[2][i]
+                mean = (cmean * cur[1] + mean * count) / total if total else mean
+                lo, hi = min(lo, clo), max(hi, chi)
+            cur[2][i] = (lo, hi, mean)
+        cur[1] = total
+        if len(cur[3]) == len(bins):
+            cur[3] = [a + b for a, b in zip(cur[3], bins)]
+    for (minute, idx), (codec, count, stats, bins) in sorted(out.items()):
+        yield minute, idx, codec, count, stats, bins
+
+
+def batches_in(stream):
+    """Split concatenated committed batches into (base_ts, body, crc_ok)"""
+    pos = 0
+    while pos + BATCH_HDR <= len(stream):
+        n, commit, _, base_ts = struct.unpack_from(">HBBI", stream, pos)
+        if commit != LOG_BATCH_COMMIT or n == 0 or pos + BATCH_HDR + n > len(stream):
+            raise ValueError("bad batch header at %d" % pos)
+        batch = stream[pos:pos + BATCH_HDR + n]
+        yield base_ts, batch[BATCH_HDR:], batch_ok(batch)
+        pos += BATCH_HDR + n
+
+
+def upload_frames(capture):
+    """Yield (end, 'K' or 'M', seq, off, batch) and (end, 'E', op, sent,
+    (cursor_seq, cursor_off)) frames from a bleuart capture; end is the
+    offset after the frame. Telemetry frames and other traffic on the UART
+    between frames are skipped; stops at a truncated frame."""
+    pos = 0
+    while pos < len(capture):
+        tag = capture[pos:pos + 1]
+        if tag in (b"K", b"M") and pos + 7 + BATCH_HDR <= len(capture):
+            seq, off, n, commit = struct.unpack_from(">IHHB", capture, pos + 1)
+            if commit == LOG_BATCH_COMMIT and 0 < n <= LOG_SECTOR_BYTES - SECTOR_HDR.size - BATCH_HDR:
+                if pos + 7 + BATCH_HDR + n > len(capture):
+                    return
+                pos += 7 + BATCH_HDR + n
+                yield pos, tag.decode(), seq, off, capture[pos - n - BATCH_HDR:pos]
+                continue
+        elif tag == b"E" and pos + 12 <= len(capture):
+            op, sent, cseq, coff = struct.unpack_from(">cIIH", capture, pos + 1)
+            if op in (b"N", b"R", b"T", b"S"):
+                pos += 12
+                yield pos, "E", op, sent, (cseq, coff)
+                continue
+        elif tag == b"T" and pos + 5 <= len(capture):
+            # Live telemetry between upload frames (telemetry.py decodes it)
+            kind, ver, n = struct.unpack_from(">cBH", capture, pos + 1)
+            if kind in (b"L", b"C") and ver == TELEMETRY_VERSION:
+                hdr = 9 if kind == b"L" else 5
+                if pos + hdr + n > len(capture):
+                    return
+                pos += hdr + n
+                continue
+        elif tag == b"C" and pos + 8 <= len(capture):
+            # Config command reply (config_set.py): key type value(4) ok
+            if capture[pos + 1] < CONFIG_KEYS and capture[pos + 2] <= 2 and capture[pos + 7] <= 1:
+                pos += 8
+                continue
+        elif tag in (b"K", b"M", b"E", b"T"):
+            return
+        pos += 1
+
+
+def upload_batches(capture, frame="K"):
+    """Uploaded batches ('K' log, 'M' summaries) in order, each once
+    (re-sends are dropped)"""
+    seen = {}
+    for _, kind, a, b, batch in upload_frames(capture):
+        if kind == frame:
+            seen[(a, b)] = batch
+    return b"".join(seen[k] for k in sorted(seen))
+
+
+def flash_batches(image, region=0, size=LOG_REGION_BYTES, want=LOG_MAGIC):
+    """Committed batches of every sector of the log (or, with the summary
+    region and SUM_MAGIC, the summary ring), oldest sequence first, as
+    (base_ts, body, crc_ok)"""
+    sectors = []
+    for i in range(max(0, min(len(image) - region, size)) // LOG_SECTOR_BYTES):
+        base = region + i * LOG_SECTOR_BYTES
+        magic, seq, _, _, version, hdr_commit, _, _ = SECTOR_HDR.unpack_from(image, base)
+        if magic == want and version == LOG_VERSION and hdr_commit == LOG_HDR_COMMIT:
+            sectors.append((seq, base))
+    for _, base in sorted(sectors):
+        off = SECTOR_HDR.size
+        while off + BATCH_HDR <= LOG_SECTOR_BYTES:
+            n, commit, _, base_ts = struct.unpack_from(">HBBI", image, base + off)
+            if commit != LOG_BATCH_COMMIT or n == 0 or off + BATCH_HDR + n > LOG_SECTOR_BYTES:
+                break
+            batch = image[base + off:base + off + BATCH_HDR + n]
+            yield base_ts, batch[BATCH_HDR:], batch_ok(batch)
+            off += BATCH_HDR + n
+
+
+def print_summaries(blocks):
+    print("minute,sensor,codec,count,stats,bins")
+    entries = []
+    bad = 0
+    for src_seq, body, ok in blocks:
+        if not ok:
+            bad += 1
+            print("warning: summary batch of sector %u fails its CRC" % src_seq, file=sys.stderr)
+            continue
+        try:
+            entries.extend(summaries_in(body))
+        except ValueError as e:
+            print("warning: summary batch of sector %u: %s" % (src_seq, e), file=sys.stderr)
+    for minute, idx, codec, count, stats, bins in merge_summaries(entries):
+        st = " ".join("v%d=%s/%s/%s" % (i, lo, hi, round(mean, 4)) for i, (lo, hi, mean) in sorted(stats.items()))
+        print("%u,%u,%s,%u,%s,%s" % (minute, idx, CODEC_NAMES.get(codec, codec), count, st,
+                                      " ".join(str(b) for b in bins)))
+    return 1 if bad else 0
+
+
+def main(argv):
+    parts = {}
+    if "--skip-long" in argv:
+        argv = [a for a in argv if a != "--skip-long"]
+        parts = None
+    summaries = "--summaries" in argv
+    argv = [a for a in argv if a != "--summaries"]
+    if len(argv) == 3 and argv[1] == "--flash":
+        image = open(argv[2], "rb").read()
+        if summaries:
+            blocks = flash_batches(image, SUM_REGION_BASE, SUM_REGION_BYTES, SUM_MAGIC)
+        else:
+            blocks = flash_batches(image)
+    elif len(argv) == 2:
+        blocks = batches_in(upload_batches(open(argv[1], "rb").read(), "M" if summaries else "K"))
+    else:
+        print("usage: log_decode.py [--flash] FILE [--skip-long] [--summaries]", file=sys.stderr)
+        return 2
+    if summaries:
+        return print_summaries(blocks)
+    print("ts_ms,sensor,codec,values")
+    bad = 0
+    for base_ts, body, ok in blocks:
+        try:
+            for ts, idx, codec, payload in decode_block(base_ts, body, parts):
+                vals = " ".join(str(v) for v in values_of(codec, payload))
+                print("%u,%u,%s,%s" % (ts, idx, CODEC_NAMES[codec], vals))
+        except ValueError as e:
+            # Keep the records before the damage; check bytes mark where it starts
+            print("warning: batch at ts %u: %s" % (base_ts, e), file=sys.stderr)
+        if not ok:
+            bad += 1
+            print("warning: batch at ts %u fails its CRC" % base_ts, file=sys.stderr)
+    return 1 if bad else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
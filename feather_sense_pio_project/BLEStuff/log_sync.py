@@ -0,0 +1,125 @@
+# Incremental log download over the Nordic UART service.
+#   python log_sync.py ADDRESS out.bin                  # everything not acked yet
+#   python log_sync.py ADDRESS out.bin --seq 10 20      # re-send sectors 10..20
+#   python log_sync.py ADDRESS out.bin --time T0 T1     # re-send batches with base_ts in [T0, T1] ms
+#   python log_sync.py ADDRESS out.bin --summaries      # the per-minute summaries (not acked)
+#   python log_sync.py --tcp 9000 out.bin ...           # host build, HOST_BLE_OUT=tcp:9000
+# Appends every received batch frame to out.bin (decode with log_decode.py)
+# and acks it, so the device only sends it again on an explicit --seq/--time.
+# Protocol: storage.cpp, "Incremental BLE upload".
+import asyncio
+import socket
+import struct
+import sys
+
+import log_decode
+
+UART_RX = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E"  # central writes
+UART_TX = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"  # device notifies
+USAGE = "usage: log_sync.py (ADDRESS | --tcp PORT) OUT [--seq FROM TO | --time FROM TO | --summaries]"
+
+
+class Sync:
+    """Splits device frames, stores batches and builds the acks to send"""
+
+    def __init__(self, out, op):
+        self.out = out
+        self.op = op
+        self.buf = b""
+        self.batches = 0
+        self.done = None
+
+    def feed(self, data):
+        self.buf += data
+        acks = b""
+        used = 0
+        for used, kind, a, b, c in log_decode.upload_frames(self.buf):
+            if kind == "K":
+                self.out.write(b"K" + struct.pack(">IH", a, b) + c)
+                self.out.flush()
+                acks += b"A" + struct.pack(">IH", a, b)
+                self.batches += 1
+            elif kind == "M":
+                self.out.write(b"M" + struct.pack(">IH", a, b) + c)
+                self.out.flush()
+                self.batches += 1
+            elif a == self.op:
+                self.done = (b, c)
+        self.buf = self.buf[used:]
+        return acks
+
+
+def request(argv):
+    if len(argv) == 0:
+        return b"N", b"N"
+    if argv == ["--summaries"]:
+        return b"S", b"S"
+    if len(argv) == 3 and argv[0] in ("--seq", "--time"):
+        op = b"R" if argv[0] == "--seq" else b"T"
+        return op, op + struct.pack(">II", int(argv[1]), int(argv[2]))
+    raise SystemExit(USAGE)
+
+
+def report(sync):
+    sent, (cseq, coff) = sync.done if sync.done else (0, (0, 0))
+    state = "done" if sync.done else "incomplete"
+    print("%s: %d batches, cursor seq %u off %u" % (state, sync.batches, cseq, coff))
+    return 0 if sync.done else 1
+
+
+async def run_ble(addr, sync, cmd):
+    from bleak import BleakClient  # pip install bleak
+
+    async with BleakClient(addr) as client:
+        async def on_notify(_, data):
+            acks = sync.feed(bytes(data))
+            if acks:
+                await client.write_gatt_char(UART_RX, acks, response=False)
+
+        await client.start_notify(UART_TX, on_notify)
+        # The device resumes on its own when we connect
+        if cmd != b"N":
+            await client.write_gatt_char(UART_RX, cmd, response=True)
+        while sync.done is None and client.is_connected:
+            await asyncio.sleep(0.2)
+
+
+def run_tcp(port, sync, cmd):
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind(("127.0.0.1", port))
+    srv.listen(1)
+    conn, _ = srv.accept()
+    if cmd != b"N":
+        conn.sendall(cmd)
+    while sync.done is None:
+        data = conn.recv(4096)
+        if not data:
+            break
+        acks = sync.feed(data)
+        if acks:
+            conn.sendall(acks)
+    conn.close()
+    srv.close()
+
+
+def main(argv):
+    if len(argv) >= 4 and argv[1] == "--tcp":
+        port, path, rest = int(argv[2]), argv[3], argv[4:]
+    elif len(argv) >= 3 and not argv[1].startswith("--"):
+        port, path, rest = None, argv[2], argv[3:]
+    else:
+        print(USAGE, file=sys.stderr)
+        return 2
+    op, cmd = request(rest)
+    with open(path, "ab") as out:
+        sync = Sync(out, op)
+        if port is None:
+            asyncio.run(run_ble(argv[1], sync, cmd))
+        else:
+            run_tcp(port, sync, cmd)
+    return report(sync)
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
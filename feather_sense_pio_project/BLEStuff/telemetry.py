@@ -0,0 +1,172 @@
+# Decode the binary live telemetry the device notifies on the Nordic UART.
+#   python telemetry.py ADDRESS             # live, over BLE
+#   python telemetry.py --tcp 9000          # live, host build with HOST_BLE_OUT=tcp:9000
+#   python telemetry.py --file capture.bin  # a saved bleuart capture (HOST_BLE_OUT=file)
+# Prints one CSV line per sample: ts_ms,sensor,name,values (RAW payloads
+# as hex). Other traffic on the UART (upload frames, text) is skipped.
+# Format: include/telemetry.h. website/telemetry.js is the same decoder.
+import asyncio
+import socket
+import struct
+import sys
+
+TELEMETRY_VERSION = 1
+RAW, U8, I16, F16 = range(4)
+TYPE_NAMES = {RAW: "raw", U8: "u8", I16: "i16", F16: "f16"}
+VALUE_FMT = {U8: ">B", I16: ">h", F16: ">e"}
+UART_TX = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"  # device notifies
+
+
+def varint(data, pos):
+    v = shift = 0
+    while True:
+        if pos >= len(data) or shift >= 35:
+            raise ValueError("bad varint")
+        b = data[pos]
+        pos += 1
+        v |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return v, pos
+        shift += 7
+
+
+def samples_in(base_ts, body):
+    """(ts, idx, type, values) of a 'T' 'L' frame body; RAW values are bytes"""
+    out = []
+    pos = 0
+    ts = base_ts
+    while pos < len(body):
+        tag = body[pos]
+        kind, idx = tag >> 5, tag & 0x1F
+        zz, pos = varint(body, pos + 1)
+        ts = (ts + ((zz >> 1) ^ -(zz & 1))) & 0xFFFFFFFF
+        if pos >= len(body) or kind not in TYPE_NAMES:
+            raise ValueError("bad sample")
+        n = body[pos]
+        pos += 1
+        if kind == RAW:
+            values = bytes(body[pos:pos + n])
+            pos += n
+        else:
+            fmt = struct.Struct(VALUE_FMT[kind])
+            values = [fmt.unpack_from(body, pos + i * fmt.size)[0] for i in range(n)] \
+                if pos + n * fmt.size <= len(body) else None
+            pos += n * fmt.size
+        if pos > len(body) or values is None:
+            raise ValueError("truncated sample")
+        out.append((ts, idx, kind, values))
+    return out
+
+
+def catalog_in(body):
+    """{idx: (type, name)} of a 'T' 'C' frame body"""
+    out = {}
+    pos = 0
+    while pos + 3 <= len(body):
+        idx, kind, n = body[pos], body[pos + 1], body[pos + 2]
+        if pos + 3 + n > len(body):
+            break
+        out[idx] = (kind, body[pos + 3:pos + 3 + n].decode("ascii", "replace"))
+        pos += 3 + n
+    return out
+
+
+class Decoder:
+    """Feed it notification bytes in order; returns the samples they
+    complete as (ts, idx, name, values). Names come from the catalog the
+    device sends on each connection."""
+
+    def __init__(self):
+        self.buf = b""
+        self.catalog = {}
+
+    def feed(self, data):
+        self.buf += data
+        out = []
+        pos = 0
+        while pos < len(self.buf):
+            if self.buf[pos:pos + 1] != b"T":
+                pos += 1
+                continue
+            if pos + 5 > len(self.buf):
+                break
+            kind, ver, n = struct.unpack_from(">cBH", self.buf, pos + 1)
+            hdr = {b"L": 9, b"C": 5}.get(kind)
+            if hdr is None or ver != TELEMETRY_VERSION:
+                pos += 1
+                continue
+            if pos + hdr + n > len(self.buf):
+                break
+            body = self.buf[pos + hdr:pos + hdr + n]
+            try:
+                if kind == b"C":
+                    self.catalog = catalog_in(body)
+                else:
+                    base_ts, = struct.unpack_from(">I", self.buf, pos + 5)
+                    for ts, idx, _, values in samples_in(base_ts, body):
+                        name = self.catalog.get(idx, (None, "sensor%d" % idx))[1]
+                        out.append((ts, idx, name, values))
+            except ValueError:
+                # Not a frame after all: a 'T' inside other traffic
+                pos += 1
+                continue
+            pos += hdr + n
+        self.buf = self.buf[pos:]
+        return out
+
+
+def print_samples(samples):
+    for ts, idx, name, values in samples:
+        if isinstance(values, bytes):
+            vals = values.hex()
+        else:
+            vals = " ".join(("%g" % v) if isinstance(v, float) else str(v) for v in values)
+        print("%u,%u,%s,%s" % (ts, idx, name, vals), flush=True)
+
+
+async def run_ble(addr, dec):
+    from bleak import BleakClient  # pip install bleak
+
+    async with BleakClient(addr) as client:
+        await client.start_notify(UART_TX, lambda _, data: print_samples(dec.feed(bytes(data))))
+        while client.is_connected:
+            await asyncio.sleep(0.5)
+
+
+def run_tcp(port, dec):
+    srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    srv.bind(("127.0.0.1", port))
+    srv.listen(1)
+    conn, _ = srv.accept()
+    while True:
+        data = conn.recv(4096)
+        if not data:
+            break
+        print_samples(dec.feed(data))
+    conn.close()
+    srv.close()
+
+
+def main(argv):
+    dec = Decoder()
+    if len(argv) == 3 and argv[1] == "--file":
+        print("ts_ms,sensor,name,values")
+        print_samples(dec.feed(open(argv[2], "rb").read()))
+    elif len(argv) == 3 and argv[1] == "--tcp":
+        print("ts_ms,sensor,name,values")
+        run_tcp(int(argv[2]), dec)
+    elif len(argv) == 2 and not argv[1].startswith("--"):
+        print("ts_ms,sensor,name,values")
+        asyncio.run(run_ble(argv[1], dec))
+    else:
+        print("usage: telemetry.py (ADDRESS | --tcp PORT | --file CAPTURE)", file=sys.stderr)
+        return 2
+    return 0
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main(sys.argv))
+    except KeyboardInterrupt:
+        sys.exit(0)
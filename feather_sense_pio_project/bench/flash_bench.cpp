@@ -0,0 +1,105 @@
+// bench/flash_bench.cpp
+// Flash write throughput: blocking flash_write() against page-aligned
+// flash_write_async() with the next block coded while the last one
+// programs, as the storage flush does. Host only, on the QSPI timing model
+// in lib/host_fakes (HOST_FLASH_PAGE_US / HOST_FLASH_ERASE_US, defaulting
+// here to the GD25Q16's typical 700 us / 45 ms).
+//   pio run -e native_bench && .pio/build/native_bench/program
+// Knobs: BENCH_KB written per run (256), BENCH_BLOCK bytes per write (2048),
+// BENCH_PREP_US extra per-block work on top of coding (0, 1000 and 4000).
+// Host tasks run truly in parallel, so the async figures are the best case
+// for overlap; on the nRF52840 the writer and the coder share one core.
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "storage.h"
+#include "record_codec.h"
+
+#define BENCH_BASE   (1024u * 1024u)   // past the log and its meta sectors
+#define MAX_BLOCK    4096u
+
+static uint8_t blocks[2][MAX_BLOCK];
+static record_codec_block_t coder;
+static uint32_t rec_ts = 0;
+
+// Fill a block with coded IMU-like records, plus prep_us of extra work
+static void prepare(uint8_t *out, size_t len, uint32_t prep_us) {
+  uint32_t t0 = micros();
+  record_codec_block_begin(&coder, rec_ts);
+  size_t n = 0;
+  while (n + RECORD_CODEC_MAX_BYTES(12) <= len) {
+    float v[3] = { (float)(rec_ts % 360), 1.5f, -0.25f * (float)(rec_ts % 7) };
+    rec_ts += 20;
+    n += record_codec_encode(&coder, RECORD_CODEC_F32LE_XOR, 4, rec_ts, (const uint8_t *)v,
+                             sizeof(v), out + n, len - n);
+  }
+  memset(out + n, 0xA5, len - n);
+  while (micros() - t0 < prep_us) {}
+}
+
+static void erase_area(uint32_t bytes) {
+  for (uint32_t a = 0; a < bytes; a += FLASH_SECTOR_SIZE) {
+    flash_erase_sector((BENCH_BASE + a) / FLASH_SECTOR_SIZE);
+  }
+}
+
+// Returns KB/s; *blocked_ms is how long the writing task sat in flash calls
+static float run(bool async, uint32_t total, uint32_t block, uint32_t prep_us, float *blocked_ms) {
+  uint32_t ticket[2] = { 0, 0 };
+  uint32_t blocked = 0;
+  erase_area(total);
+  uint32_t t0 = micros();
+  for (uint32_t off = 0, k = 0; off < total; off += block, k ^= 1) {
+    uint32_t b0 = micros();
+    if (async) flash_wait(ticket[k]);   // this buffer is still programming
+    blocked += micros() - b0;
+    prepare(blocks[k], block, prep_us);
+    b0 = micros();
+    if (async) ticket[k] = flash_write_async(BENCH_BASE + off, blocks[k], block, NULL, NULL);
+    else flash_write(BENCH_BASE + off, blocks[k], block);
+    blocked += micros() - b0;
+  }
+  uint32_t b0 = micros();
+  flash_sync();
+  blocked += micros() - b0;
+  uint32_t us = micros() - t0;
+  *blocked_ms = blocked / 1000.0f;
+  return (float)total * 1000000.0f / 1024.0f / (float)us;
+}
+
+void setup() {
+  Serial.begin(115200);
+  setenv("HOST_FLASH_PAGE_US", "700", 0);
+  setenv("HOST_FLASH_ERASE_US", "45000", 0);
+  if (!flash_init()) {
+    Serial.println("flash_init failed");
+    exit(1);
+  }
+
+  uint32_t total = (uint32_t)atol(getenv("BENCH_KB") ? getenv("BENCH_KB") : "256") * 1024u;
+  uint32_t block = (uint32_t)atol(getenv("BENCH_BLOCK") ? getenv("BENCH_BLOCK") : "2048");
+  if (block == 0 || block > MAX_BLOCK) block = 2048;
+  total -= total % block;
+  const char *prep_env = getenv("BENCH_PREP_US");
+  uint32_t preps[3] = { 0, 1000, 4000 };
+  int n_preps = 3;
+  if (prep_env) {
+    preps[0] = (uint32_t)atol(prep_env);
+    n_preps = 1;
+  }
+
+  Serial.printf("flash write bench: %u KB in %u-byte blocks\n", (unsigned)(total / 1024), (unsigned)block);
+  Serial.printf("prep_us  sync KB/s (blocked ms)  async KB/s (blocked ms)\n");
+  for (int i = 0; i < n_preps; ++i) {
+    float sync_blocked, async_blocked;
+    float sync_kbs = run(false, total, block, preps[i], &sync_blocked);
+    float async_kbs = run(true, total, block, preps[i], &async_blocked);
+    Serial.printf("%7u  %8.1f (%8.1f)      %8.1f (%8.1f)\n", (unsigned)preps[i],
+                  sync_kbs, sync_blocked, async_kbs, async_blocked);
+  }
+  // Tasks are still running; skip static destructors under their feet
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
@@ -0,0 +1,247 @@
+// bench/governor_bench.cpp
+// Adaptive rates replayed offline: rate_governor_step() with main.cpp's
+// rules (rate_rule_* in rate_governor.cpp) over a night of samples per
+// governed sensor, printed as one JSON object. Each trace is the signal at
+// the rule's max_hz; the replay samples it at whatever rate the governor has
+// chosen and, as the governor task does, scores every sample against the
+// previous one with the sensor's real metric and steps the rule once per
+// sample, but only moves the sensor's rate at each RATE_GOV_PERIOD_MS poll
+// (the next deadline re-timed from the last sample, as sensor_set_freq does).
+//   samples_saved  samples at max_hz minus the governed ones
+//   events         what the governor should react to: the synthetic
+//                  night's turns, warm-ups and desaturations, or for a
+//                  trace file the stretches that move by raise_above
+//                  within a second
+//   missed         events no governed sample saw: none of the samples
+//                  whose interval overlaps the event scored >= raise_above
+//   delay_s_mean   event start to the governed sample that saw it
+// temp and imu come from the host fakes' traces (lib/host_fakes/src/
+// host_trace.h, $HOST_TRACE_DIR) when present, played once; otherwise, and
+// always for SpO2 (its traces are raw PPG, not ESpO2), from a synthetic
+// night: still with noise, a few turns in bed, warm-ups and desaturations.
+//   pio run -e native_governor_bench && .pio/build/native_governor_bench/program > bench.json
+// Knobs: BENCH_HOURS synthetic night length (8), BENCH_SEED (1).
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <vector>
+#include "rate_governor.h"
+#include "imu.h"
+#include "host_trace.h"
+
+void quaternionToEuler(float qr, float qi, float qj, float qk, euler_t *ypr, bool degrees);
+
+typedef struct {
+  std::vector<std::vector<uint8_t> > rows;          // payloads at max_hz
+  std::vector<std::pair<size_t, size_t> > events;   // first, last row
+} trace_t;
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+static uint32_t rng = 1;
+static float noise(float amp) {
+  rng = rng * 1664525u + 1013904223u;
+  return amp * ((float)(rng >> 8) / 8388608.0f - 1.0f);
+}
+
+/* ---- Payloads as the adapters lay them out ---- */
+static std::vector<uint8_t> temp_payload(float c) {
+  int16_t t = (int16_t)roundf(c * 100.0f);
+  return { (uint8_t)(t >> 8), (uint8_t)t };
+}
+
+static std::vector<uint8_t> imu_payload(float yaw, float pitch, float roll) {
+  euler_t e;
+  e.yaw = yaw;
+  e.pitch = pitch;
+  e.roll = roll;
+  std::vector<uint8_t> p(sizeof(float) * 3);
+  memcpy(p.data(), &e, p.size());
+  return p;
+}
+
+static std::vector<uint8_t> spo2_payload(float spo2) {
+  std::vector<uint8_t> p(20, 0);
+  union { float f; uint8_t b[4]; } u;
+  u.f = spo2;
+  for (int i = 0; i < 4; ++i) p[12 + i] = u.b[3 - i];
+  return p;
+}
+
+/* ---- Traces ---- */
+static void mark(trace_t *t, size_t first, size_t last) {
+  t->events.push_back(std::make_pair(first, last));
+}
+
+// A trace file's events: rows that moved by raise_above within a second
+static void events_by_window(trace_t *t, const rate_rule_t *rule, rate_metric_cb metric) {
+  size_t w = (size_t)ceilf(rule->max_hz);
+  for (size_t i = w; i < t->rows.size(); ++i) {
+    if (metric(t->rows[i - w].data(), t->rows[i].data(), t->rows[i].size(), NULL) < rule->raise_above) continue;
+    if (!t->events.empty() && t->events.back().second + w >= i) t->events.back().second = i;
+    else mark(t, i - w + 1, i);
+  }
+}
+
+// Numeric rows of a host trace, once through (host_trace_next() loops)
+static bool trace_rows(const char *name, int cols, std::vector<std::vector<float> > *rows) {
+  host_trace_t t;
+  if (!host_trace_open(&t, name, cols)) return false;
+  char line[256];
+  while (fgets(line, sizeof(line), t.f)) {
+    char *p = line;
+    std::vector<float> v;
+    for (int c = 0; c < cols; ++c) {
+      char *end;
+      float f = strtof(p, &end);
+      if (end == p) break;
+      v.push_back(f);
+      p = end + strspn(end, ", \t");
+    }
+    if ((int)v.size() == cols) rows->push_back(v);
+  }
+  fclose(t.f);
+  return !rows->empty();
+}
+
+static const char *temp_trace(trace_t *out, uint32_t secs) {
+  std::vector<std::vector<float> > rows;
+  if (trace_rows("temp.csv", 1, &rows)) {
+    for (auto &r : rows) out->rows.push_back(temp_payload(r[0] / 256.0f - 192.0f));   // host_wire.cpp's calibration
+    events_by_window(out, &rate_rule_temp, rate_metric_temp);
+    return "temp.csv";
+  }
+  // 1 Hz: slow drift; every 75 minutes a 0.8 C warm-up over 40 s (covers
+  // on), held 6 minutes, then a drop back over 10 s (covers off)
+  for (uint32_t s = 0; s < secs; ++s) {
+    float c = 36.4f + 0.1f * sinf((float)s / 3600.0f) + noise(0.01f);
+    uint32_t in = s % 4500;
+    if (in >= 2000 && in < 2040) c += 0.8f * (float)(in - 2000) / 40.0f;
+    else if (in >= 2040 && in < 2400) c += 0.8f;
+    else if (in >= 2400 && in < 2410) c += 0.8f * (float)(2410 - in) / 10.0f;
+    if (in == 2000 || in == 2400) mark(out, s, s + (in == 2000 ? 39 : 9));
+    out->rows.push_back(temp_payload(c));
+  }
+  return "synthetic";
+}
+
+static const char *imu_trace(trace_t *out, uint32_t secs) {
+  std::vector<std::vector<float> > rows;
+  if (trace_rows("imu.csv", 4, &rows)) {
+    for (auto &r : rows) {
+      euler_t e;
+      quaternionToEuler(r[0], r[1], r[2], r[3], &e, true);
+      out->rows.push_back(imu_payload(e.yaw, e.pitch, e.roll));
+    }
+    events_by_window(out, &rate_rule_imu, rate_metric_imu);
+    return "imu.csv";
+  }
+  // 10 Hz: lying still, a 4 s turn in bed every 20 minutes, alternating sides
+  float yaw = 10.0f, pitch = 0.0f, roll = 0.0f;
+  for (uint32_t i = 0; i < secs * 10; ++i) {
+    uint32_t in = i % 12000;
+    if (in >= 6000 && in < 6040) roll += ((i / 12000) & 1 ? -90.0f : 90.0f) / 40.0f;
+    if (in == 6000) mark(out, i, i + 39);
+    out->rows.push_back(imu_payload(yaw + noise(0.2f), pitch + noise(0.2f), roll + noise(0.2f)));
+  }
+  return "synthetic";
+}
+
+static const char *spo2_trace(trace_t *out, uint32_t secs) {
+  // 1 Hz ESpO2: 97 % with noise, a 30 s fall to 89 % and recovery every 50 minutes
+  for (uint32_t s = 0; s < secs; ++s) {
+    float v = 97.0f + noise(0.1f);
+    uint32_t in = s % 3000;
+    if (in >= 1500 && in < 1530) v -= 8.0f * (float)(in - 1500) / 30.0f;
+    else if (in >= 1530 && in < 1590) v -= 8.0f * (float)(1590 - in) / 60.0f;
+    if (in == 1500) mark(out, s, s + 29);   // the fall; recovering isn't an alarm
+    out->rows.push_back(spo2_payload(v));
+  }
+  return "synthetic";
+}
+
+/* ---- Replay ---- */
+static void replay(const char *name, const char *source, const trace_t &tr, const rate_rule_t *rule,
+                   rate_metric_cb metric, bool first) {
+  const size_t n = tr.rows.size();
+  const double full_dt = 1.0 / rule->max_hz;
+
+  // Governed sampling: each sample scores the interval since the previous
+  // one; the rate the steps arrive at is applied at the next poll
+  const double poll = RATE_GOV_PERIOD_MS / 1000.0;
+  rate_state_t st;
+  memset(&st, 0, sizeof(st));
+  float hz = rule->max_hz, pending = hz;
+  double t = 0.0, next_poll = poll;
+  size_t prev = 0, taken = 1;
+  std::vector<size_t> at(1, 0);         // row of each governed sample
+  std::vector<bool> active(1, false);   // scored >= raise_above
+  for (;;) {
+    double next = t + 1.0 / hz;
+    for (; next_poll < next; next_poll += poll) {
+      if (pending == hz) continue;
+      hz = pending;
+      next = std::max(t + 1.0 / hz, next_poll);
+    }
+    t = next;
+    size_t row = (size_t)(t / full_dt + 0.5);
+    if (row >= n) break;
+    float m = metric(tr.rows[prev].data(), tr.rows[row].data(), tr.rows[row].size(), NULL);
+    at.push_back(row);
+    active.push_back(m >= rule->raise_above);
+    pending = rate_governor_step(rule, &st, m, pending);
+    prev = row;
+    taken++;
+  }
+
+  uint32_t missed = 0;
+  double delay_sum = 0.0;
+  size_t k = 1;
+  for (auto &ev : tr.events) {
+    // First governed sample whose interval (at[j-1], at[j]] reaches into the event
+    while (k < at.size() && at[k] < ev.first) k++;
+    size_t j = k;
+    while (j < at.size() && at[j - 1] < ev.second && !active[j]) j++;
+    if (j < at.size() && at[j - 1] < ev.second) delay_sum += (double)(at[j] - ev.first) * full_dt;
+    else missed++;
+  }
+  uint32_t detected = (uint32_t)tr.events.size() - missed;
+  printf("%s\n    {\"sensor\": \"%s\", \"trace\": \"%s\", \"hours\": %.2f, \"max_hz\": %.2f, "
+         "\"poll_ms\": %u, \"samples_full_rate\": %u, \"samples_governed\": %u, \"samples_saved_pct\": %.1f, "
+         "\"events\": %u, \"missed\": %u, \"delay_s_mean\": %.2f, \"raises\": %u, \"lowers\": %u}",
+         first ? "" : ",", name, source, n * full_dt / 3600.0, (double)rule->max_hz, (unsigned)RATE_GOV_PERIOD_MS,
+         (unsigned)n,
+         (unsigned)taken, n ? 100.0 * (double)(n - taken) / n : 0.0, (unsigned)tr.events.size(),
+         (unsigned)missed, detected ? delay_sum / detected : 0.0, (unsigned)st.raises, (unsigned)st.lowers);
+}
+
+void setup() {
+  const uint32_t secs = (uint32_t)knob("BENCH_HOURS", 8) * 3600u;
+  rng = (uint32_t)knob("BENCH_SEED", 1);
+  trace_t temp, imu, spo2;
+  // Serial is stdout on the host: keep host_trace's log out of the JSON
+  fflush(stdout);
+  int saved_fd = dup(STDOUT_FILENO);
+  dup2(open("/dev/null", O_WRONLY), STDOUT_FILENO);
+  const char *temp_src = temp_trace(&temp, secs);
+  const char *imu_src = imu_trace(&imu, secs);
+  const char *spo2_src = spo2_trace(&spo2, secs);
+  fflush(stdout);
+  dup2(saved_fd, STDOUT_FILENO);
+
+  printf("{\n  \"bench\": \"governor\",\n  \"results\": [");
+  replay("temp", temp_src, temp, &rate_rule_temp, rate_metric_temp, true);
+  replay("imu", imu_src, imu, &rate_rule_imu, rate_metric_imu, false);
+  replay("spo2", spo2_src, spo2, &rate_rule_spo2, rate_metric_spo2_drop, false);
+  printf("\n  ]\n}\n");
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
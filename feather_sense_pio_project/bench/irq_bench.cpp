@@ -0,0 +1,160 @@
+// bench/irq_bench.cpp
+// Polling vs data-ready interrupts on the dispatcher, printed as one JSON
+// object. A fake sensor makes a new sample every 1/BENCH_DATA_HZ on its own
+// clock (a little off the tick grid, as a real part's oscillator is) and,
+// in event mode, raises its INT pin through host_irq_fire(). Its read()
+// returns false when there is nothing new, like getSensorEvent(). Modes:
+//   poll_1x    polled at the data rate
+//   poll_4x    polled at four times the data rate
+//   event      SENSOR_FLAG_EVENT + sensor_attach_irq(), 1 Hz fallback poll
+// Per mode: read() wakeups/s, fresh samples/s, wakeups that found nothing,
+// samples overwritten before anyone read them, and the latency from data
+// ready to read(). Each mode runs in a fresh process (this program again,
+// with BENCH_PHASE set) as the manager is set up once per boot.
+//   pio run -e native_irq_bench && .pio/build/native_irq_bench/program > bench.json
+// Knobs: BENCH_MS run time per mode (4000), BENCH_DATA_HZ sample rate (50).
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <time.h>
+#include <errno.h>
+#include "sensor_manager.h"
+
+#define INT_PIN   5
+#define DRIFT     1.0037   // the part's clock vs ours
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+static void emit(const char *fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  printf("BENCH_JSON %s\n", buf);
+}
+
+/* ---- Fake part: a one-sample data register and an INT line ---- */
+static volatile uint32_t made;        // samples produced
+static volatile uint32_t made_us;     // when the latest became ready
+static volatile bool running = true;
+static bool use_irq;
+static uint32_t data_period_us;
+
+static void part_task(void *arg) {
+  (void)arg;
+  struct timespec next;
+  clock_gettime(CLOCK_MONOTONIC, &next);
+  while (running) {
+    uint64_t ns = (uint64_t)next.tv_nsec + (uint64_t)data_period_us * 1000u;
+    next.tv_sec += (time_t)(ns / 1000000000u);
+    next.tv_nsec = (long)(ns % 1000000000u);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {}
+    made_us = micros();
+    __atomic_store_n(&made, made + 1, __ATOMIC_RELEASE);
+    if (use_irq) host_irq_fire(INT_PIN);
+  }
+  vTaskSuspend(NULL);
+}
+
+/* ---- Driver side ---- */
+static uint32_t wakeups, fresh, missed, seen;
+static uint64_t lat_sum_us;
+static uint32_t lat_max_us;
+static volatile bool measuring;   // keep the start-up sample out of lat_max_us
+
+static bool read_part(void *ctx, sensor_data_t *out) {
+  (void)ctx;
+  wakeups++;
+  uint32_t n = __atomic_load_n(&made, __ATOMIC_ACQUIRE);
+  if (n == seen) return false;   // nothing new in the data register
+  uint32_t lat = micros() - made_us;
+  missed += n - seen - 1;
+  seen = n;
+  fresh++;
+  lat_sum_us += lat;
+  if (measuring && lat > lat_max_us) lat_max_us = lat;
+  memcpy(out->bytes, &n, 4);
+  out->len = 4;
+  return true;
+}
+
+static void mode_phase(const char *mode) {
+  const uint32_t ms = (uint32_t)knob("BENCH_MS", 4000);
+  const uint32_t data_hz = (uint32_t)knob("BENCH_DATA_HZ", 50);
+  data_period_us = (uint32_t)(1000000.0 * DRIFT / data_hz);
+  use_irq = !strcmp(mode, "event");
+  float poll_hz = use_irq ? 1.0f : (float)data_hz * (strcmp(mode, "poll_4x") ? 1 : 4);
+
+  sensor_manager_init_mode(SENSOR_SCHED_DISPATCHER);
+  int idx = sensor_register_ex("part", NULL, read_part, NULL, NULL, poll_hz, true, 4,
+                               use_irq ? SENSOR_FLAG_EVENT : 0);
+  if (use_irq) sensor_attach_irq(idx, INT_PIN, FALLING);
+  xTaskCreate(part_task, "part", 1024, NULL, 2, NULL);
+  delay(200);
+  // Counters belong to the sampler: take deltas rather than resetting them
+  measuring = true;
+  uint32_t w0 = wakeups, f0 = fresh, m0 = missed;
+  uint64_t l0 = lat_sum_us;
+  delay(ms);
+  uint32_t w = wakeups - w0, f = fresh - f0, m = missed - m0, lmax = lat_max_us;
+  uint64_t lsum = lat_sum_us - l0;
+  running = false;
+  double secs = ms / 1000.0;
+  emit("{\"mode\": \"%s\", \"data_hz\": %u, \"poll_hz\": %.0f, \"wakeups_per_s\": %.1f, "
+       "\"samples_per_s\": %.1f, \"empty_wakeups\": %u, \"missed\": %u, "
+       "\"latency_us_mean\": %.0f, \"latency_us_max\": %u}",
+       mode, (unsigned)data_hz, (double)poll_hz, w / secs, f / secs, (unsigned)(w - f), (unsigned)m,
+       f ? (double)lsum / f : 0.0, (unsigned)lmax);
+}
+
+/* ---- driver ---- */
+static char self_path[256];
+
+static int run_phase(const char *phase, bool first) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "BENCH_PHASE=%s '%s' 2>&1", phase, self_path);
+  FILE *p = popen(cmd, "r");
+  if (!p) return -1;
+  char line[1024];
+  int n = 0;
+  while (fgets(line, sizeof(line), p)) {
+    if (strncmp(line, "BENCH_JSON ", 11) != 0) continue;
+    line[strcspn(line, "\n")] = 0;
+    printf("%s\n    %s", (first && n == 0) ? "" : ",", line + 11);
+    n++;
+  }
+  pclose(p);
+  return n;
+}
+
+void setup() {
+  if (getenv("BENCH_PHASE")) {
+    mode_phase(getenv("BENCH_PHASE"));
+    // Tasks are still running; skip static destructors under their feet
+    fflush(stdout);
+    _exit(0);
+  }
+
+  ssize_t n = readlink("/proc/self/exe", self_path, sizeof(self_path) - 1);
+  if (n <= 0) {
+    printf("can't find this program's path\n");
+    exit(1);
+  }
+  self_path[n] = 0;
+
+  printf("{\n  \"bench\": \"irq\",\n  \"results\": [");
+  run_phase("poll_1x", true);
+  run_phase("poll_4x", false);
+  run_phase("event", false);
+  printf("\n  ]\n}\n");
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
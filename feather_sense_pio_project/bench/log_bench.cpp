@@ -0,0 +1,649 @@
+// bench/log_bench.cpp
+// Flash log robustness on a file-backed host flash image, printed as one
+// JSON object:
+//   powercut  BENCH_CUTS rounds of: a writer appending numbered records
+//             and flushing until HOST_FLASH_CUT_AFTER tears a random
+//             program or erase and kills it, then a boot that recovers the
+//             log and walks it. Per round the walk decodes every retained
+//             record straight off the image; a bad round is one where the
+//             boot failed, sector seqs aren't contiguous, a committed batch
+//             fails its CRC or doesn't decode to its end, or the record
+//             numbers don't strictly increase. Also the boot's time and
+//             flash bytes read. The rounds share one image, so it wraps.
+//   wear      one boot writing numbered records (a flush every 40) until
+//             the ring has turned BENCH_WRAPS times: sector erase counts
+//             (min/max/total), the slowest flush, the records the walk
+//             still finds against those written; then erase_all and a
+//             reboot, and the counts again, which must survive both
+//   resume    an upload interrupted after an ack: a log of about 200
+//             batches uploaded in full ('N' over the host link model), the
+//             batch halfway acked ('A'), then a fresh boot and 'N' again.
+//             The cursor must survive the reboot, and the second upload
+//             must be exactly the batches after the acked one, none at or
+//             before it
+//   overload  four sensors appending 64-byte numbered records for BENCH_MS
+//             at BENCH_KBS offered (200 and 30 KB/s by default), the last
+//             one STORAGE_DROP_EARLY: append time, each sensor's drops, what
+//             reached flash, and a walk of the log that must find only
+//             whole records in order
+//   preerase  once the ring has wrapped, BENCH_FLUSHES flushes of about
+//             1.4 KB each BENCH_IDLE_MS apart, as the flush timer paces
+//             them: storage_flush_now() time p50/p90/p99/max, sectors
+//             opened and how many of those the flush had to erase itself.
+//             native_log_bench_nopreerase builds the same with
+//             STORAGE_PREERASE_SECTORS 0 for the inline-erase baseline
+// Every writer and boot is a fresh process (this program again, with
+// BENCH_PHASE set), as the real thing reboots.
+//   pio run -e native_log_bench && .pio/build/native_log_bench/program > bench.json
+// Knobs: BENCH_DIR for the image (/tmp), BENCH_CUTS (20), BENCH_WRAPS (3),
+// BENCH_MS overload run time (3000), BENCH_KBS one overload rate instead of
+// both, BENCH_FLUSHES (150), BENCH_IDLE_MS (100), BENCH_SEED (1).
+// Flash model defaults as storage_bench: HOST_FLASH_PAGE_US 700,
+// HOST_FLASH_ERASE_US 45000.
+#include <Arduino.h>
+#include <bluefruit.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "storage.h"
+#include "record_codec.h"
+#include "flash_layout.h"
+#include "ble_manager.h"
+
+// On-flash format (storage.cpp)
+#define LOG_SECTOR       4096u
+#define LOG_SECTORS      (FLASH_LOG_MAX_BYTES / LOG_SECTOR)
+#define LOG_MAGIC        0x534C4F47u
+#define LOG_VERSION      4
+#define LOG_HDR_COMMIT   0xA55Au
+#define LOG_SECTOR_HDR   24u
+#define LOG_BATCH_HDR    12u
+#define LOG_BATCH_COMMIT 0xA5
+
+#define REC_BYTES        8      // number, then its complement
+#define OVERLOAD_BYTES   64
+#define OVERLOAD_SENSORS 4
+#define FLUSH_EVERY      40     // records per flush in the writer
+#define RESUME_RECORDS   8000   // about 200 batches to upload
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+template <typename T> static T pct(std::vector<T> &v, int p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(v.size() - 1) * (size_t)p / 100];
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void emit(const char *fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  printf("BENCH_JSON %s\n", buf);
+}
+
+static inline uint32_t be32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* ---- Walking the image ---- */
+typedef struct {
+  uint32_t sectors;
+  uint32_t seq_gaps;         // missing seqs between the oldest and newest sector
+  uint32_t batches;
+  uint32_t misframed;        // committed batches that don't decode to their end
+  uint32_t records;
+  uint32_t bad_records;      // complement or filler doesn't match
+  uint32_t out_of_order;     // numbers that don't strictly increase
+  uint32_t first, last;      // record numbers, oldest and newest retained
+} walk_t;
+
+static void walk_log(walk_t *w) {
+  static uint8_t sec[LOG_SECTOR];
+  memset(w, 0, sizeof(*w));
+  std::vector<std::pair<uint32_t, uint32_t> > order;   // seq, sector
+  for (uint32_t i = 0; i < LOG_SECTORS; ++i) {
+    uint8_t h[LOG_SECTOR_HDR];
+    flash_read(FLASH_LOG_BASE + i * LOG_SECTOR, h, sizeof(h));
+    uint32_t magic, seq;
+    uint16_t version, commit;
+    memcpy(&magic, h, 4);
+    memcpy(&seq, h + 4, 4);
+    memcpy(&version, h + 16, 2);
+    memcpy(&commit, h + 18, 2);
+    if (magic == LOG_MAGIC && version == LOG_VERSION && commit == LOG_HDR_COMMIT) order.push_back(std::make_pair(seq, i));
+  }
+  std::sort(order.begin(), order.end());
+  w->sectors = (uint32_t)order.size();
+  bool have = false;
+  for (size_t k = 0; k < order.size(); ++k) {
+    if (k && order[k].first != order[k - 1].first + 1) w->seq_gaps += order[k].first - order[k - 1].first - 1;
+    flash_read(FLASH_LOG_BASE + order[k].second * LOG_SECTOR, sec, LOG_SECTOR);
+    for (uint32_t off = LOG_SECTOR_HDR; off + LOG_BATCH_HDR <= LOG_SECTOR; ) {
+      uint32_t len = ((uint32_t)sec[off] << 8) | sec[off + 1];
+      if (sec[off + 2] != LOG_BATCH_COMMIT || len == 0 || off + LOG_BATCH_HDR + len > LOG_SECTOR) break;
+      w->batches++;
+      record_codec_block_t b;
+      record_codec_block_begin(&b, be32(sec + off + 4));
+      const uint8_t *body = sec + off + LOG_BATCH_HDR;
+      for (size_t at = 0; at < len; ) {
+        uint8_t idx, p[RECORD_CODEC_SHORT_MAX + 1], plen;
+        uint32_t ts;
+        size_t n = record_codec_decode(&b, body + at, len - at, &idx, &ts, p, &plen);
+        if (!n) {
+          w->misframed++;
+          break;
+        }
+        at += n;
+        uint32_t num, inv;
+        memcpy(&num, p, 4);
+        memcpy(&inv, p + 4, 4);
+        w->records++;
+        bool whole = plen >= REC_BYTES && inv == ~num;
+        for (uint8_t k = REC_BYTES; whole && k < plen; ++k) whole = p[k] == (uint8_t)(num + k);
+        if (!whole) {
+          w->bad_records++;
+          continue;
+        }
+        if (have && num <= w->last) w->out_of_order++;
+        if (!have) w->first = num;
+        w->last = num;
+        have = true;
+      }
+      off += LOG_BATCH_HDR + len;
+    }
+  }
+}
+
+// Record i: its number, the complement, then filler bytes i + k up to d->len
+static void fill_numbered(uint32_t i, sensor_data_t *d) {
+  uint32_t inv = ~i;
+  memcpy(d->bytes, &i, 4);
+  memcpy(d->bytes + 4, &inv, 4);
+  for (uint8_t k = REC_BYTES; k < d->len; ++k) d->bytes[k] = (uint8_t)(i + k);
+  d->timestamp = millis();
+}
+
+static void append_numbered(uint32_t i) {
+  static sensor_data_t d;
+  d.len = REC_BYTES;
+  fill_numbered(i, &d);
+  storage_append_record(0, &d);
+  if (i % FLUSH_EVERY == FLUSH_EVERY - 1) storage_flush_now();
+}
+
+/* ---- powercut ---- */
+// Append numbered records from BENCH_FROM until the flash cut kills us
+static void phase_writer(void) {
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  uint32_t from = (uint32_t)atol(getenv("BENCH_FROM") ? getenv("BENCH_FROM") : "0");
+  for (uint32_t i = from; i < from + 200000u; ++i) append_numbered(i);
+  emit("{\"error\": \"writer was never cut\"}");
+}
+
+static void phase_recover(void) {
+  flash_init();   // loading the host image isn't part of a boot
+  uint32_t read0 = flash.host_stats()->bytes_read;
+  uint64_t t0 = now_ns();
+  bool ok = storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  uint32_t us = (uint32_t)((now_ns() - t0) / 1000u);
+  uint32_t bytes_read = flash.host_stats()->bytes_read - read0;
+  storage_scan_t scan;
+  memset(&scan, 0, sizeof(scan));
+  storage_scan_log(&scan);
+  walk_t w;
+  walk_log(&w);
+  emit("{\"boot_ok\": %d, \"boot_us\": %u, \"boot_bytes_read\": %u, \"sectors\": %u, \"seq_gaps\": %u, "
+       "\"batches\": %u, \"batches_corrupt\": %u, \"sectors_torn\": %u, \"misframed\": %u, "
+       "\"records\": %u, \"bad_records\": %u, \"out_of_order\": %u, \"first\": %u, \"last\": %u}",
+       ok ? 1 : 0, (unsigned)us, (unsigned)bytes_read, (unsigned)w.sectors, (unsigned)w.seq_gaps,
+       (unsigned)w.batches, (unsigned)scan.batches_corrupt, (unsigned)scan.sectors_torn,
+       (unsigned)w.misframed, (unsigned)w.records, (unsigned)w.bad_records, (unsigned)w.out_of_order,
+       (unsigned)w.first, (unsigned)w.last);
+}
+
+/* ---- wear ---- */
+static void phase_wear(void) {
+  const uint32_t wraps = (uint32_t)knob("BENCH_WRAPS", 3);
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  storage_log_stats_t st;
+  uint32_t i = 0;
+  do {
+    for (uint32_t k = 0; k < FLUSH_EVERY * 10; ++k) append_numbered(i++);
+    storage_get_log_stats(&st);
+  } while (st.erase_total < wraps * LOG_SECTORS);
+  storage_flush_now();
+  flash_sync();
+  storage_get_log_stats(&st);
+  walk_t w;
+  walk_log(&w);
+  emit("{\"records_written\": %u, \"records_retained\": %u, \"oldest_retained\": %u, "
+       "\"sectors_used\": %u, \"erase_min\": %u, \"erase_max\": %u, \"erase_total\": %u, "
+       "\"erase_on_demand\": %u, \"flush_us_max\": %u}",
+       (unsigned)i, (unsigned)w.records, (unsigned)w.first, (unsigned)st.sectors_used,
+       (unsigned)st.erase_min, (unsigned)st.erase_max, (unsigned)st.erase_total,
+       (unsigned)st.erase_on_demand, (unsigned)st.flush_us_max);
+  storage_erase_all_logs();
+  flash_sync();
+}
+
+static void phase_wear_boot(void) {
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  storage_log_stats_t st;
+  storage_get_log_stats(&st);
+  emit("{\"after_erase_all\": {\"sectors_used\": %u, \"erase_min\": %u, \"erase_max\": %u, "
+       "\"erase_total\": %u}}",
+       (unsigned)st.sectors_used, (unsigned)st.erase_min, (unsigned)st.erase_max, (unsigned)st.erase_total);
+}
+
+/* ---- overload ---- */
+static void phase_overload(void) {
+  const uint32_t ms = (uint32_t)knob("BENCH_MS", 3000);
+  const uint32_t kbs = (uint32_t)knob("BENCH_KBS", 200);
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  storage_set_drop_policy(OVERLOAD_SENSORS - 1, STORAGE_DROP_EARLY);
+  // Offered bytes count the 7-byte RAM record header, as the batches do
+  uint64_t period = 1000000000ull * (7 + OVERLOAD_BYTES) / (kbs * 1024ull);
+  static sensor_data_t d;
+  d.len = OVERLOAD_BYTES;
+  uint64_t sum_ns = 0, max_ns = 0;
+  uint64_t t_end = now_ns() + (uint64_t)ms * 1000000u, next = now_ns();
+  uint32_t i = 0;
+  for (; now_ns() < t_end; ++i) {
+    while (now_ns() < next) {}
+    next += period;
+    fill_numbered(i, &d);
+    uint64_t t0 = now_ns();
+    storage_append_record((uint8_t)(i % OVERLOAD_SENSORS), &d);
+    uint64_t ns = now_ns() - t0;
+    sum_ns += ns;
+    if (ns > max_ns) max_ns = ns;
+  }
+  storage_flush_now();
+  flash_sync();
+  for (uint8_t s = 0; s < OVERLOAD_SENSORS; ++s) {
+    storage_sensor_stats_t st;
+    storage_get_sensor_stats(s, &st);
+    emit("{\"kind\": \"sensor\", \"offered_kb_s\": %u, \"sensor\": %u, \"policy\": \"%s\", "
+         "\"records\": %u, \"drops\": %u, \"drop_pct\": %.1f}",
+         (unsigned)kbs, (unsigned)s, s == OVERLOAD_SENSORS - 1 ? "early" : "when_full",
+         (unsigned)st.records, (unsigned)st.drops,
+         st.records + st.drops ? 100.0 * st.drops / (st.records + st.drops) : 0.0);
+  }
+  walk_t w;
+  walk_log(&w);
+  storage_log_stats_t ls;
+  storage_get_log_stats(&ls);
+  emit("{\"kind\": \"rate\", \"offered_kb_s\": %u, \"appended\": %u, \"append_ns_mean\": %.0f, "
+       "\"append_ns_max\": %u, \"flushed_kb_s\": %.1f, \"records_walked\": %u, \"bad_records\": %u, "
+       "\"misframed\": %u, \"out_of_order\": %u}",
+       (unsigned)kbs, (unsigned)i, i ? (double)sum_ns / i : 0.0, (unsigned)max_ns,
+       ls.bytes_in / 1024.0 / (ms / 1000.0), (unsigned)w.records, (unsigned)w.bad_records,
+       (unsigned)w.misframed, (unsigned)w.out_of_order);
+}
+
+/* ---- preerase ---- */
+static void phase_preerase(void) {
+  const uint32_t flushes = (uint32_t)knob("BENCH_FLUSHES", 150);
+  const uint32_t idle_ms = (uint32_t)knob("BENCH_IDLE_MS", 100);
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  // Wrap the ring first: past that every sector opened has to be erased
+  storage_log_stats_t st;
+  uint32_t i = 0;
+  do {
+    for (uint32_t k = 0; k < FLUSH_EVERY * 10; ++k) append_numbered(i++);
+    storage_get_log_stats(&st);
+  } while (st.erase_total < LOG_SECTORS + 8);
+  storage_flush_now();
+  flash_sync();
+  delay(idle_ms);
+  storage_log_stats_t s0;
+  storage_get_log_stats(&s0);
+
+  // Paced like the flush timer: about 1.4 KB a flush, then idle
+  static sensor_data_t d;
+  d.len = OVERLOAD_BYTES;
+  std::vector<uint32_t> us;
+  for (uint32_t f = 0; f < flushes; ++f) {
+    for (uint32_t k = 0; k < 1400 / (7 + OVERLOAD_BYTES); ++k) {
+      fill_numbered(i++, &d);
+      storage_append_record(0, &d);
+    }
+    uint64_t t0 = now_ns();
+    storage_flush_now();
+    us.push_back((uint32_t)((now_ns() - t0) / 1000u));
+    delay(idle_ms);
+  }
+  flash_sync();
+  storage_log_stats_t s1;
+  storage_get_log_stats(&s1);
+  walk_t w;
+  walk_log(&w);
+  emit("{\"preerase_sectors\": %u, \"flushes\": %u, \"idle_ms\": %u, \"flush_us_p50\": %u, "
+       "\"flush_us_p90\": %u, \"flush_us_p99\": %u, \"flush_us_max\": %u, \"sectors_opened\": %u, "
+       "\"erase_on_demand\": %u, \"preerased\": %u, \"bad_records\": %u, \"out_of_order\": %u}",
+       (unsigned)STORAGE_PREERASE_SECTORS, (unsigned)flushes, (unsigned)idle_ms, (unsigned)pct(us, 50),
+       (unsigned)pct(us, 90), (unsigned)pct(us, 99), (unsigned)pct(us, 100),
+       (unsigned)(s1.erase_total - s0.erase_total), (unsigned)(s1.erase_on_demand - s0.erase_on_demand),
+       (unsigned)s1.preerased, (unsigned)w.bad_records, (unsigned)w.out_of_order);
+}
+
+/* ---- resume ---- */
+typedef struct {
+  uint32_t seq, off;
+  std::vector<uint8_t> batch;   // as stored, header included
+} up_frame_t;
+
+// Split a captured upload stream into its 'K' frames; false unless it is
+// all 'K' frames ending in one 'N' 'E' frame
+static bool read_upload(const char *path, std::vector<up_frame_t> *frames, uint32_t *e_sent) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  std::vector<uint8_t> b;
+  uint8_t chunk[4096];
+  for (size_t n; (n = fread(chunk, 1, sizeof(chunk), f)) > 0; ) b.insert(b.end(), chunk, chunk + n);
+  fclose(f);
+  frames->clear();
+  for (size_t at = 0; at < b.size(); ) {
+    if (b[at] == 'E' && at + 12 == b.size() && b[at + 1] == 'N') {
+      *e_sent = be32(&b[at + 2]);
+      return true;
+    }
+    if (b[at] != 'K' || at + 7 + LOG_BATCH_HDR > b.size()) return false;
+    size_t total = LOG_BATCH_HDR + (((size_t)b[at + 7] << 8) | b[at + 8]);
+    if (at + 7 + total > b.size()) return false;
+    up_frame_t fr;
+    fr.seq = be32(&b[at + 1]);
+    fr.off = ((uint32_t)b[at + 5] << 8) | b[at + 6];
+    fr.batch.assign(b.begin() + at + 7, b.begin() + at + 7 + total);
+    frames->push_back(fr);
+    at += 7 + total;
+  }
+  return false;
+}
+
+// Connect, ask for everything after the cursor as a central does ('N'),
+// wait for the 'E' frame
+static void upload_all(void) {
+  const char *out = getenv("HOST_BLE_OUT");
+  while (!Bluefruit.connected()) delay(1);
+  storage_upload_rx((const uint8_t *)"N", 1);
+  for (;;) {
+    delay(5);
+    FILE *f = fopen(out, "rb");
+    if (!f) continue;
+    uint8_t tail[12];
+    bool done = fseek(f, -12, SEEK_END) == 0 && fread(tail, 1, 12, f) == 12 && tail[0] == 'E' && tail[1] == 'N';
+    fclose(f);
+    if (done) break;
+  }
+}
+
+static void phase_resume_fill(void) {
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  for (uint32_t i = 0; i < RESUME_RECORDS; ++i) append_numbered(i);
+  storage_flush_now();
+  flash_sync();
+  walk_t w;
+  walk_log(&w);
+  emit("{\"batches\": %u}", (unsigned)w.batches);
+}
+
+// Upload it all, ack the batch halfway through, and go (a disconnect
+// or power loss: nothing after the ack is taken as delivered)
+static void phase_resume_ack(void) {
+  ble_init();
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  upload_all();
+  std::vector<up_frame_t> frames;
+  uint32_t sent = 0;
+  if (!read_upload(getenv("HOST_BLE_OUT"), &frames, &sent) || frames.empty()) {
+    emit("{\"error\": \"bad upload stream\"}");
+    return;
+  }
+  size_t k = frames.size() / 2;
+  uint8_t ack[7] = { 'A' };
+  ack[1] = (uint8_t)(frames[k].seq >> 24);
+  ack[2] = (uint8_t)(frames[k].seq >> 16);
+  ack[3] = (uint8_t)(frames[k].seq >> 8);
+  ack[4] = (uint8_t)frames[k].seq;
+  ack[5] = (uint8_t)(frames[k].off >> 8);
+  ack[6] = (uint8_t)frames[k].off;
+  storage_upload_rx(ack, sizeof(ack));
+  uint32_t seq = 0, off = 0;
+  for (int i = 0; i < 2000 && !(storage_upload_cursor(&seq, &off) && seq == frames[k].seq && off == frames[k].off); ++i) {
+    delay(1);
+  }
+  flash_sync();
+  emit("{\"sent\": %u, \"frames\": %u, \"ack_index\": %u, \"ack_seq\": %u, \"ack_off\": %u, "
+       "\"cursor_seq\": %u, \"cursor_off\": %u}",
+       (unsigned)sent, (unsigned)frames.size(), (unsigned)k, (unsigned)frames[k].seq, (unsigned)frames[k].off,
+       (unsigned)seq, (unsigned)off);
+}
+
+static void phase_resume(void) {
+  ble_init();
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  uint32_t seq = 0, off = 0;
+  bool valid = storage_upload_cursor(&seq, &off);
+  upload_all();
+  emit("{\"cursor_valid\": %d, \"cursor_seq\": %u, \"cursor_off\": %u}", valid ? 1 : 0, (unsigned)seq,
+       (unsigned)off);
+}
+
+/* ---- driver ---- */
+static char self_path[256];
+
+// Run this program with BENCH_PHASE=phase; its first BENCH_JSON line
+// into out (empty if none)
+static int run_capture(const char *phase, char *out, size_t cap) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "BENCH_PHASE=%s '%s' 2>&1", phase, self_path);
+  out[0] = 0;
+  FILE *p = popen(cmd, "r");
+  if (!p) return -1;
+  char line[1024];
+  while (fgets(line, sizeof(line), p)) {
+    if (strncmp(line, "BENCH_JSON ", 11) != 0 || out[0]) continue;
+    line[strcspn(line, "\n")] = 0;
+    snprintf(out, cap, "%s", line + 11);
+  }
+  return pclose(p);
+}
+
+// Run this program with BENCH_PHASE=phase; print its BENCH_JSON lines as
+// a comma-separated list
+static int run_phase(const char *phase, bool first) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "BENCH_PHASE=%s '%s' 2>&1", phase, self_path);
+  FILE *p = popen(cmd, "r");
+  if (!p) return -1;
+  char line[1024];
+  int n = 0;
+  while (fgets(line, sizeof(line), p)) {
+    if (strncmp(line, "BENCH_JSON ", 11) != 0) continue;
+    line[strcspn(line, "\n")] = 0;
+    printf("%s\n    %s", (first && n == 0) ? "" : ",", line + 11);
+    n++;
+  }
+  pclose(p);
+  return n;
+}
+
+// A number field of a flat JSON object, 0 if absent
+static uint32_t field(const char *json, const char *key) {
+  char pat[64];
+  snprintf(pat, sizeof(pat), "\"%s\": ", key);
+  const char *at = strstr(json, pat);
+  return at ? (uint32_t)strtoul(at + strlen(pat), NULL, 10) : 0;
+}
+
+static void bench_powercut(const char *img) {
+  const uint32_t cuts = (uint32_t)knob("BENCH_CUTS", 20);
+  char line[1024], num[16];
+  uint32_t bad_rounds = 0, boot_fail = 0, seq_gaps = 0, corrupt = 0, misframed = 0, bad = 0, order = 0;
+  uint32_t torn = 0, records = 0, boot_us_max = 0, read_max = 0, wraps = 0, next = 0;
+  unlink(img);
+  for (uint32_t r = 0; r < cuts; ++r) {
+    // Early ops are the header, stamp and erase work; later ones batches
+    snprintf(num, sizeof(num), "%u", 20 + (unsigned)(rand() % 3000));
+    setenv("HOST_FLASH_CUT_AFTER", num, 1);
+    snprintf(num, sizeof(num), "%u", (unsigned)next);
+    setenv("BENCH_FROM", num, 1);
+    run_capture("writer", line, sizeof(line));
+    unsetenv("HOST_FLASH_CUT_AFTER");
+    run_capture("recover", line, sizeof(line));
+
+    bool ok = field(line, "boot_ok") == 1;
+    uint32_t g = field(line, "seq_gaps"), c = field(line, "batches_corrupt"), m = field(line, "misframed");
+    uint32_t b = field(line, "bad_records"), o = field(line, "out_of_order");
+    // The log keeps going from what survived: nothing older may reappear
+    uint32_t last = field(line, "last");
+    if (field(line, "records") && last + 1 < next) o++;
+    if (!ok || g || c || m || b || o) bad_rounds++;
+    boot_fail += ok ? 0 : 1;
+    seq_gaps += g;
+    corrupt += c;
+    misframed += m;
+    bad += b;
+    order += o;
+    torn += field(line, "sectors_torn");
+    records += field(line, "records");
+    if (field(line, "sectors") == LOG_SECTORS) wraps = 1;
+    boot_us_max = std::max(boot_us_max, field(line, "boot_us"));
+    read_max = std::max(read_max, field(line, "boot_bytes_read"));
+    next = std::max(next, last + 1);
+  }
+  unlink(img);
+  printf("  \"powercut\": {\"cuts\": %u, \"bad_rounds\": %u, \"boot_failed\": %u, \"seq_gaps\": %u, "
+         "\"batches_corrupt\": %u, \"misframed\": %u, \"bad_records\": %u, \"out_of_order\": %u, "
+         "\"sectors_torn\": %u, \"records_walked\": %u, \"log_filled\": %s, \"boot_us_max\": %u, "
+         "\"boot_bytes_read_max\": %u}",
+         (unsigned)cuts, (unsigned)bad_rounds, (unsigned)boot_fail, (unsigned)seq_gaps, (unsigned)corrupt,
+         (unsigned)misframed, (unsigned)bad, (unsigned)order, (unsigned)torn, (unsigned)records,
+         wraps ? "true" : "false", (unsigned)boot_us_max, (unsigned)read_max);
+}
+
+static void bench_resume(const char *img) {
+  char up1[256], up2[256], line[1024];
+  const char *dir = getenv("BENCH_DIR") ? getenv("BENCH_DIR") : "/tmp";
+  snprintf(up1, sizeof(up1), "%s/log_bench_up1.bin", dir);
+  snprintf(up2, sizeof(up2), "%s/log_bench_up2.bin", dir);
+  unlink(img);
+  run_capture("resume_fill", line, sizeof(line));
+  uint32_t logged = field(line, "batches");
+
+  setenv("HOST_BLE_CONNECT_MS", "0", 1);
+  setenv("HOST_BLE_OUT", up1, 1);
+  run_capture("resume_ack", line, sizeof(line));
+  uint32_t ack_index = field(line, "ack_index"), ack_seq = field(line, "ack_seq"), ack_off = field(line, "ack_off");
+  bool acked = line[0] && field(line, "cursor_seq") == ack_seq && field(line, "cursor_off") == ack_off;
+  setenv("HOST_BLE_OUT", up2, 1);
+  run_capture("resume", line, sizeof(line));
+  bool kept = field(line, "cursor_valid") == 1 && field(line, "cursor_seq") == ack_seq &&
+              field(line, "cursor_off") == ack_off;
+  unsetenv("HOST_BLE_OUT");
+  unsetenv("HOST_BLE_CONNECT_MS");
+
+  // The resumed upload must be exactly what followed the ack the first time
+  std::vector<up_frame_t> first, again;
+  uint32_t sent1 = 0, sent2 = 0;
+  bool ok1 = read_upload(up1, &first, &sent1), ok2 = read_upload(up2, &again, &sent2);
+  uint32_t expected = ok1 && first.size() > ack_index ? (uint32_t)(first.size() - ack_index - 1) : 0;
+  uint32_t resent_acked = 0, differ = 0;
+  for (size_t i = 0; i < again.size(); ++i) {
+    if (!(again[i].seq > ack_seq || (again[i].seq == ack_seq && again[i].off > ack_off))) resent_acked++;
+    size_t j = ack_index + 1 + i;
+    if (j >= first.size() || again[i].seq != first[j].seq || again[i].off != first[j].off ||
+        again[i].batch != first[j].batch)
+      differ++;
+  }
+  unlink(up1);
+  unlink(up2);
+  unlink(img);
+  printf(",\n  \"resume\": {\"batches_logged\": %u, \"first_sent\": %u, \"ack_seq\": %u, \"ack_off\": %u, "
+         "\"acked\": %s, \"cursor_kept\": %s, \"streams_ok\": %s, \"resent\": %u, \"expected\": %u, "
+         "\"resent_acked\": %u, \"differ\": %u, \"first_resent_seq\": %u, \"first_resent_off\": %u}",
+         (unsigned)logged, (unsigned)sent1, (unsigned)ack_seq, (unsigned)ack_off, acked ? "true" : "false",
+         kept ? "true" : "false", ok1 && ok2 && sent1 == first.size() && sent2 == again.size() ? "true" : "false",
+         (unsigned)again.size(), (unsigned)expected, (unsigned)resent_acked, (unsigned)differ,
+         again.empty() ? 0u : (unsigned)again[0].seq, again.empty() ? 0u : (unsigned)again[0].off);
+}
+
+void setup() {
+  setenv("HOST_FLASH_PAGE_US", "700", 0);
+  setenv("HOST_FLASH_ERASE_US", "45000", 0);
+  const char *phase = getenv("BENCH_PHASE");
+  if (phase) {
+    if (!strcmp(phase, "writer")) phase_writer();
+    else if (!strcmp(phase, "recover")) phase_recover();
+    else if (!strcmp(phase, "wear")) phase_wear();
+    else if (!strcmp(phase, "wear_boot")) phase_wear_boot();
+    else if (!strcmp(phase, "overload")) phase_overload();
+    else if (!strcmp(phase, "preerase")) phase_preerase();
+    else if (!strcmp(phase, "resume_fill")) phase_resume_fill();
+    else if (!strcmp(phase, "resume_ack")) phase_resume_ack();
+    else if (!strcmp(phase, "resume")) phase_resume();
+    // Tasks are still running; skip static destructors under their feet
+    fflush(stdout);
+    _exit(0);
+  }
+
+  ssize_t n = readlink("/proc/self/exe", self_path, sizeof(self_path) - 1);
+  if (n <= 0) {
+    printf("can't find this program's path\n");
+    exit(1);
+  }
+  self_path[n] = 0;
+  srand((unsigned)knob("BENCH_SEED", 1));
+
+  char img[256];
+  snprintf(img, sizeof(img), "%s/log_bench_flash.bin", getenv("BENCH_DIR") ? getenv("BENCH_DIR") : "/tmp");
+  setenv("HOST_FLASH_FILE", img, 1);
+  printf("{\n  \"bench\": \"log\",\n");
+  bench_powercut(img);
+
+  unlink(img);
+  char line[1024];
+  run_capture("wear", line, sizeof(line));
+  printf(",\n  \"wear\": %s", line[0] ? line : "null");
+  run_capture("wear_boot", line, sizeof(line));
+  printf(",\n  \"wear_reboot\": %s", line[0] ? line : "null");
+  unlink(img);
+  bench_resume(img);
+
+  // RAM-backed flash from here: nothing needs the image between runs
+  unsetenv("HOST_FLASH_FILE");
+  printf(",\n  \"overload\": [");
+  if (getenv("BENCH_KBS")) {
+    run_phase("overload", true);
+  } else {
+    setenv("BENCH_KBS", "200", 1);
+    run_phase("overload", true);
+    setenv("BENCH_KBS", "30", 1);
+    run_phase("overload", false);
+  }
+  printf("\n  ]");
+  unsetenv("BENCH_KBS");
+  run_capture("preerase", line, sizeof(line));
+  printf(",\n  \"preerase\": %s", line[0] ? line : "null");
+  printf("\n}\n");
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
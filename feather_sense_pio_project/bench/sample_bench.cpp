@@ -0,0 +1,169 @@
+// bench/sample_bench.cpp
+// Cost of one sample through the sensor manager, printed as one JSON object:
+//   before  the original sampler, kept here as a model: a full
+//           sensor_data_t on the stack, memset, read, then copied into the
+//           sensor's inline last_data under a critical section;
+//           sensor_get_last() copied the whole struct the same way
+//   after   sensor_sample() and sensor_get_last() as they are: the read
+//           goes straight into a pool block sized for the payload, and
+//           readers copy the header plus len bytes, lock-free
+// for battery (1 byte), temp (2), imu (12) and mic (1024) payloads, as CPU
+// ns per call and host TSC cycles where there is one, plus the RAM the
+// sample records take either way with host struct sizes. This file builds
+// sensor_manager.cpp itself to call the static sampler directly, with
+// SENSOR_INSTRUMENT off like the original code. native_sample_bench_instr
+// builds it with the instrumentation on: its "after" sample figures minus
+// these are what SENSOR_INSTRUMENT costs per sample (on the host each
+// timestamp is a clock_gettime(), on the target a DWT register read, so
+// the host figure is the upper bound).
+//   pio run -e native_sample_bench && .pio/build/native_sample_bench/program > bench.json
+//   pio run -e native_sample_bench_instr && .pio/build/native_sample_bench_instr/program > bench_instr.json
+// Knobs: BENCH_ITERS calls per run (100000), BENCH_REPS runs per figure,
+// best one kept (5).
+#include "../src/sensor_manager.cpp"
+#include "sample_pool.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t tsc(void) { return __rdtsc(); }
+#define HAVE_TSC 1
+#else
+static inline uint64_t tsc(void) { return 0; }
+#define HAVE_TSC 0
+#endif
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+static uint64_t cpu_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* ---- Workload: payloads as the real adapters fill them ---- */
+typedef struct {
+  const char *name;
+  size_t payload;
+  uint32_t n;
+} load_t;
+
+static load_t loads[] = {
+  { "battery", 1, 0 },
+  { "temp", 2, 0 },
+  { "imu", 12, 0 },
+  { "mic", 1024, 0 },
+};
+#define LOADS (sizeof(loads) / sizeof(loads[0]))
+
+static bool read_load(void *ctx, sensor_data_t *out) {
+  load_t *l = (load_t *)ctx;
+  l->n++;
+  for (size_t i = 0; i < l->payload; ++i) out->bytes[i] = (uint8_t)(l->n + i);
+  out->len = l->payload;
+  return true;
+}
+
+/* ---- The original sampler, as it was in sensor_task() ---- */
+static sensor_data_t old_last[LOADS];   // sensor_t::last_data
+
+static void old_sample(size_t i) {
+  if (sensor_bus_lock(SENSOR_BUS_WIRE, 100)) {
+    sensor_data_t tmp;
+    memset(&tmp, 0, sizeof(tmp));
+    bool ok = read_load(&loads[i], &tmp);
+    taskENTER_CRITICAL();
+    if (ok) old_last[i] = tmp;
+    else old_last[i].len = 0;
+    old_last[i].timestamp = millis();
+    taskEXIT_CRITICAL();
+    sensor_bus_unlock(SENSOR_BUS_WIRE);
+  }
+}
+
+static bool old_get_last(size_t i, sensor_data_t *out) {
+  taskENTER_CRITICAL();
+  memcpy(out, &old_last[i], sizeof(sensor_data_t));
+  taskEXIT_CRITICAL();
+  return out->len > 0;
+}
+
+/* ---- Measurement ---- */
+typedef struct {
+  double ns;
+  double cycles;
+} cost_t;
+
+// Best of reps runs: the host's noise only ever adds
+#define TIME(cost, iters, body) do {                                   \
+    (cost).ns = (cost).cycles = 1e18;                                  \
+    for (uint32_t r = 0; r < reps; ++r) {                              \
+      uint64_t c0 = tsc(), t0 = cpu_ns();                              \
+      for (uint32_t k = 0; k < (iters); ++k) { body; }                 \
+      double ns = (double)(cpu_ns() - t0) / (iters);                   \
+      double cyc = (double)(tsc() - c0) / (iters);                     \
+      if (ns < (cost).ns) (cost).ns = ns;                              \
+      if (cyc < (cost).cycles) (cost).cycles = cyc;                    \
+    }                                                                  \
+  } while (0)
+
+static void print_cost(const char *path, const char *op, const load_t *l, const cost_t *c, bool first) {
+  printf("%s\n    {\"path\": \"%s\", \"op\": \"%s\", \"sensor\": \"%s\", \"payload\": %u, \"ns\": %.1f",
+         first ? "" : ",", path, op, l->name, (unsigned)l->payload, c->ns);
+  if (HAVE_TSC) printf(", \"tsc_cycles\": %.0f", c->cycles);
+  printf("}");
+}
+
+void setup() {
+  const uint32_t iters = (uint32_t)knob("BENCH_ITERS", 100000);
+  const uint32_t reps = (uint32_t)knob("BENCH_REPS", 5);
+  static sensor_data_t out;   // full size, as sensor_get_last() wants
+
+  // Serial is stdout on the host: keep the registration log out of the JSON
+  fflush(stdout);
+  int saved_fd = dup(STDOUT_FILENO);
+  dup2(open("/dev/null", O_WRONLY), STDOUT_FILENO);
+  // Dispatcher mode with no rate: registered, never scheduled, so only
+  // this thread samples them
+  sensor_manager_init_mode(SENSOR_SCHED_DISPATCHER);
+  int idx[LOADS];
+  for (size_t i = 0; i < LOADS; ++i) {
+    idx[i] = sensor_register_ex(loads[i].name, NULL, read_load, NULL, &loads[i], 0, true,
+                                loads[i].payload, SENSOR_FLAG_BUS(SENSOR_BUS_WIRE));
+  }
+  fflush(stdout);
+  dup2(saved_fd, STDOUT_FILENO);
+
+  printf("{\n  \"bench\": \"sample\",\n  \"instrument\": %d,\n  \"iters\": %u,\n  \"results\": [",
+         SENSOR_INSTRUMENT, (unsigned)iters);
+  bool first = true;
+  for (size_t i = 0; i < LOADS; ++i) {
+    sensor_t *s = &sensors[idx[i]];
+    cost_t c;
+    TIME(c, iters, old_sample(i));
+    print_cost("before", "sample", &loads[i], &c, first);
+    first = false;
+    TIME(c, iters, sensor_sample(s, 0));
+    print_cost("after", "sample", &loads[i], &c, false);
+    TIME(c, iters, old_get_last(i, &out));
+    print_cost("before", "get_last", &loads[i], &c, false);
+    TIME(c, iters, sensor_get_last(idx[i], &out));
+    print_cost("after", "get_last", &loads[i], &c, false);
+  }
+
+  // Records only: the original sensor_t held one inline sensor_data_t each
+  size_t before = MAX_SENSORS * sizeof(sensor_data_t);
+  size_t after = MAX_SENSORS * 2 * sizeof(sensor_data_t *) + sample_pool_arena_bytes();
+  printf("\n  ],\n  \"ram\": {\"max_sensors\": %u, \"record_bytes_before\": %u, \"record_bytes_after\": %u}\n}\n",
+         (unsigned)MAX_SENSORS, (unsigned)before, (unsigned)after);
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
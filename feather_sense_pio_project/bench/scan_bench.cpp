@@ -0,0 +1,188 @@
+// bench/scan_bench.cpp
+// Log integrity: storage_scan_log() throughput over a full log, then fuzzed
+// corruption. Each round clears one programmed bit of a retained batch (all
+// NOR flash can do short of an erase), rescans, and restores the sector.
+// A miss is a round the scan reports clean. A last pass flips bits in
+// coded record blocks and counts how often the per-record check byte (or
+// the codec's own framing) rejects the block.
+//   pio run -e native_scan_bench && .pio/build/native_scan_bench/program
+// Knobs: BENCH_ROUNDS fuzz rounds (500), BENCH_SEED (1).
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "storage.h"
+#include "record_codec.h"
+
+#define LOG_SECTOR     4096u
+#define LOG_SECTOR_HDR 24u     // log_sector_hdr_t
+#define LOG_BATCH_HDR  12u
+#define LOG_MAGIC      0x534C4F47u
+#define LOG_REGION     FLASH_LOG_MAX_BYTES
+
+static uint8_t sector[LOG_SECTOR];
+
+static void fill_log(void) {
+  static sensor_data_t d;
+  storage_set_codec(0, RECORD_CODEC_F32LE_XOR);
+  storage_set_codec(1, RECORD_CODEC_I16BE_DELTA);
+  storage_set_codec(2, RECORD_CODEC_U8_DELTA);
+  uint32_t bytes = LOG_REGION * 2;   // raw input; coded it about fills the log
+  for (uint32_t i = 0, in = 0; in < bytes; ++i) {
+    float v[3] = { (float)(i % 360), 1.5f, -0.25f * (float)(i % 7) };
+    int16_t t = (int16_t)(2400 + (i % 50));
+    uint8_t pct = (uint8_t)(100 - i / 1000 % 100);
+    uint8_t s = (uint8_t)(i % 3);
+    d.timestamp = i * 20;
+    if (s == 0) { memcpy(d.bytes, v, sizeof(v)); d.len = sizeof(v); }
+    else if (s == 1) { d.bytes[0] = (uint8_t)(t >> 8); d.bytes[1] = (uint8_t)t; d.len = 2; }
+    else { d.bytes[0] = pct; d.len = 1; }
+    storage_append_record(s, &d);
+    in += 6 + d.len;
+    if (i % 200 == 199) storage_flush_now();
+  }
+  storage_flush_now();
+  flash_sync();
+  delay(500);   // let the pre-erase task evict what it needs before timing
+}
+
+// Batch header offsets in a copy of a sector, at most max
+static int batches_of(const uint8_t *sec, uint32_t *offs, int max) {
+  uint32_t magic;
+  memcpy(&magic, sec, 4);
+  if (magic != LOG_MAGIC) return 0;
+  int n = 0;
+  for (uint32_t off = LOG_SECTOR_HDR; off + LOG_BATCH_HDR <= LOG_SECTOR && n < max; ) {
+    uint32_t len = ((uint32_t)sec[off] << 8) | sec[off + 1];
+    if (sec[off + 2] != 0xA5 || len == 0 || off + LOG_BATCH_HDR + len > LOG_SECTOR) break;
+    offs[n++] = off;
+    off += LOG_BATCH_HDR + len;
+  }
+  return n;
+}
+
+static void restore(uint32_t i) {
+  flash_erase_sector(i);
+  flash_write(i * LOG_SECTOR, sector, LOG_SECTOR);
+}
+
+static void fuzz_log(uint32_t rounds, const storage_scan_t *clean) {
+  uint32_t detected = 0, missed = 0, tried = 0;
+  uint32_t offs[64];
+  while (tried < rounds) {
+    uint32_t i = (uint32_t)rand() % (LOG_REGION / LOG_SECTOR);
+    flash_read(i * LOG_SECTOR, sector, LOG_SECTOR);
+    int n = batches_of(sector, offs, 64);
+    if (!n) continue;
+    uint32_t off = offs[rand() % n];
+    uint32_t len = ((uint32_t)sector[off] << 8) | sector[off + 1];
+    uint32_t at = off + (uint32_t)rand() % (LOG_BATCH_HDR + len);
+    if (at == off + 3) continue;          // flags byte: reserved, not covered
+    uint8_t b = sector[at];
+    if (!b) continue;                     // nothing left to clear
+    int bit;
+    do bit = rand() % 8; while (!(b & (1u << bit)));
+    uint8_t bad = (uint8_t)(b & ~(1u << bit));
+    flash_write(i * LOG_SECTOR + at, &bad, 1);
+
+    storage_scan_t s;
+    storage_scan_log(&s);
+    if (s.batches_corrupt > clean->batches_corrupt || s.sectors_torn > clean->sectors_torn) detected++;
+    else {
+      missed++;
+      Serial.printf("  missed: sector %u batch +%u byte +%u bit %d\n", (unsigned)i, (unsigned)off,
+                    (unsigned)(at - off), bit);
+    }
+    restore(i);
+    tried++;
+  }
+  storage_scan_t s;
+  storage_scan_log(&s);
+  Serial.printf("log fuzz: %u rounds, %u detected, %u missed (restored: %u ok, %u corrupt)\n",
+                (unsigned)tried, (unsigned)detected, (unsigned)missed,
+                (unsigned)s.batches_ok, (unsigned)s.batches_corrupt);
+}
+
+static void fuzz_codec(uint32_t rounds) {
+  static uint8_t block[2048], copy[2048];
+  record_codec_block_t enc, dec;
+  uint32_t rejected = 0, decoded_wrong = 0, same = 0;
+  for (uint32_t r = 0; r < rounds; ++r) {
+    uint32_t ts = (uint32_t)rand();
+    record_codec_block_begin(&enc, ts);
+    size_t n = 0;
+    uint32_t count = 0;
+    while (n + RECORD_CODEC_MAX_BYTES(12) <= sizeof(block) && count < 64) {
+      float v[3] = { (float)(rand() % 360), 1.5f, (float)(rand() % 7) };
+      ts += 20;
+      n += record_codec_encode(&enc, RECORD_CODEC_F32LE_XOR, (uint8_t)(count % 3), ts,
+                               (const uint8_t *)v, sizeof(v), block + n, sizeof(block) - n);
+      count++;
+    }
+    memcpy(copy, block, n);
+    copy[rand() % n] ^= (uint8_t)(1u << (rand() % 8));
+
+    // Decode both; a flip is caught if the damaged block stops decoding
+    record_codec_block_t ref;
+    record_codec_block_begin(&ref, ts - 20 * count);
+    record_codec_block_begin(&dec, ts - 20 * count);
+    size_t a = 0, b = 0;
+    bool diverged = false, failed = false;
+    while (a < n) {
+      uint8_t idx_a, idx_b;
+      uint32_t ts_a, ts_b;
+      uint8_t pa[255], pb[255], la, lb;
+      size_t ua = record_codec_decode(&ref, block + a, n - a, &idx_a, &ts_a, pa, &la);
+      size_t ub = b < n ? record_codec_decode(&dec, copy + b, n - b, &idx_b, &ts_b, pb, &lb) : 0;
+      if (!ub) {
+        failed = true;
+        break;
+      }
+      if (ua != ub || idx_a != idx_b || ts_a != ts_b || la != lb || memcmp(pa, pb, la)) diverged = true;
+      a += ua;
+      b += ub;
+    }
+    if (failed) rejected++;
+    else if (diverged) decoded_wrong++;
+    else same++;
+  }
+  Serial.printf("codec fuzz: %u blocks, %u rejected, %u decoded wrong, %u unchanged\n",
+                (unsigned)rounds, (unsigned)rejected, (unsigned)decoded_wrong, (unsigned)same);
+}
+
+void setup() {
+  Serial.begin(115200);
+  if (!storage_init(3600 * 1000, 4096)) {
+    Serial.println("storage_init failed");
+    exit(1);
+  }
+  uint32_t rounds = (uint32_t)atol(getenv("BENCH_ROUNDS") ? getenv("BENCH_ROUNDS") : "500");
+  srand((unsigned)atol(getenv("BENCH_SEED") ? getenv("BENCH_SEED") : "1"));
+
+  fill_log();
+  storage_scan_t clean;
+  uint32_t t0 = micros();
+  storage_scan_log(&clean);
+  uint32_t us = micros() - t0;
+  for (int k = 0; k < 4; ++k) {         // best of five, the first warms caches
+    storage_scan_t s;
+    t0 = micros();
+    storage_scan_log(&s);
+    uint32_t t = micros() - t0;
+    if (t < us) us = t;
+  }
+  Serial.printf("scan: %u sectors, %u batches, %u bytes in %u us = %.1f MB/s\n",
+                (unsigned)clean.sectors, (unsigned)clean.batches_ok, (unsigned)clean.bytes_scanned,
+                (unsigned)us, us ? clean.bytes_scanned / (float)us : 0.0f);
+  if (clean.batches_corrupt || clean.sectors_torn) {
+    Serial.printf("scan: clean log reports %u corrupt, %u torn\n",
+                  (unsigned)clean.batches_corrupt, (unsigned)clean.sectors_torn);
+  }
+
+  fuzz_log(rounds, &clean);
+  fuzz_codec(rounds * 20);
+  // Tasks are still running; skip static destructors under their feet
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
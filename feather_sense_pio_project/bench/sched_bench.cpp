@@ -0,0 +1,207 @@
+// bench/sched_bench.cpp
+// Sensor scheduling: one task per sensor vs the dispatcher, on main.cpp's
+// seven sensors, printed as one JSON object:
+//   per_task, dispatcher  every sensor's sample interval jitter (|interval -
+//                         period| in us, mean and max), the manager's own
+//                         max_jitter_ticks and missed periods, plus the tasks
+//                         the mode creates and the stack/TCB RAM they take
+//                         on the target
+//   retime                dispatcher sensor_set_freq() 20 ms after a sample:
+//                         how long until the next one, vs last + new period
+// Rates are main.cpp's raised so a few seconds give every sensor enough
+// samples; each read spins for what its bus transfer costs on the target.
+// Every mode runs in a fresh process (this program again, with BENCH_PHASE
+// set) as the manager is set up once per boot.
+//   pio run -e native_sched_bench && .pio/build/native_sched_bench/program > bench.json
+// Knobs: BENCH_MS run time per mode (5000), BENCH_RETIMES set_freq calls (6).
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include "sensor_manager.h"
+
+#define TCB_BYTES 100   // about sizeof(TCB_t) with the nRF52 port's config
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+static void emit(const char *fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  printf("BENCH_JSON %s\n", buf);
+}
+
+/* ---- Synthetic workload ---- */
+typedef struct {
+  const char *name;
+  float hz;
+  uint32_t read_us;     // bus transfer the read stands for
+  size_t payload;
+  uint32_t flags;
+  // filled in by the read callback, each sensor's own task only
+  volatile uint32_t reads;
+  volatile uint32_t last_us;
+  uint64_t dev_sum_us;
+  uint32_t dev_max_us;
+  uint32_t intervals;
+} load_t;
+
+static load_t loads[] = {
+  { "temp",        10,  300, 2,    SENSOR_FLAG_BUS(SENSOR_BUS_WIRE) },
+  { "spo2",        25,  5,   20,   0 },
+  { "spo2_2",      25,  5,   20,   0 },
+  { "spo2_fusion", 10,  10,  8,    0 },
+  { "imu",         100, 500, 12,   SENSOR_FLAG_BUS(SENSOR_BUS_WIRE) },
+  { "mic",         20,  1000, 1024, SENSOR_FLAG_BUS(SENSOR_BUS_PDM) },
+  { "battery",     1,   50,  1,    SENSOR_FLAG_BUS(SENSOR_BUS_ADC) },
+};
+#define LOADS (sizeof(loads) / sizeof(loads[0]))
+
+static bool read_load(void *ctx, sensor_data_t *out) {
+  load_t *l = (load_t *)ctx;
+  uint32_t now = micros();
+  if (l->reads) {
+    uint32_t period_us = (uint32_t)(1000000.0f / l->hz);
+    uint32_t interval = now - l->last_us;
+    uint32_t dev = interval > period_us ? interval - period_us : period_us - interval;
+    l->dev_sum_us += dev;
+    if (dev > l->dev_max_us) l->dev_max_us = dev;
+    l->intervals++;
+  }
+  l->last_us = now;
+  l->reads = l->reads + 1;
+  while (micros() - now < l->read_us) {}
+  memset(out->bytes, (int)l->reads, l->payload);
+  out->len = l->payload;
+  return true;
+}
+
+static void mode_phase(sensor_sched_mode_t mode, const char *label) {
+  const uint32_t ms = (uint32_t)knob("BENCH_MS", 5000);
+  uint32_t tasks0, stack0, tasks1, stack1;
+
+  host_task_totals(&tasks0, &stack0);
+  sensor_manager_init_mode(mode);
+  int idx[LOADS];
+  for (size_t i = 0; i < LOADS; ++i) {
+    idx[i] = sensor_register_ex(loads[i].name, NULL, read_load, NULL, &loads[i], loads[i].hz, true,
+                                loads[i].payload, loads[i].flags);
+  }
+  host_task_totals(&tasks1, &stack1);
+  delay(200);   // settle: registration runs every sensor once
+  sensor_stats_reset(-1);
+  for (size_t i = 0; i < LOADS; ++i) {
+    loads[i].dev_sum_us = 0;
+    loads[i].dev_max_us = 0;
+    loads[i].intervals = 0;
+  }
+  delay(ms);
+
+  uint32_t tasks = tasks1 - tasks0, stack = stack1 - stack0;
+  uint64_t dev_sum = 0;
+  uint32_t dev_max = 0, intervals = 0, missed = 0;
+  for (size_t i = 0; i < LOADS; ++i) {
+    load_t *l = &loads[i];
+    sensor_stats_t st;
+    memset(&st, 0, sizeof(st));
+    sensor_stats_snapshot(idx[i], &st);
+    emit("{\"kind\": \"sensor\", \"mode\": \"%s\", \"sensor\": \"%s\", \"hz\": %.0f, \"samples\": %u, "
+         "\"jitter_us_mean\": %.1f, \"jitter_us_max\": %u, \"max_jitter_ticks\": %u, \"missed_periods\": %u}",
+         label, l->name, (double)l->hz, (unsigned)l->intervals,
+         l->intervals ? (double)l->dev_sum_us / l->intervals : 0.0, (unsigned)l->dev_max_us,
+         (unsigned)st.max_jitter_ticks, (unsigned)st.missed_periods);
+    dev_sum += l->dev_sum_us;
+    intervals += l->intervals;
+    if (l->dev_max_us > dev_max) dev_max = l->dev_max_us;
+    missed += st.missed_periods;
+  }
+  emit("{\"kind\": \"mode\", \"mode\": \"%s\", \"tasks\": %u, \"stack_bytes\": %u, \"ram_bytes\": %u, "
+       "\"jitter_us_mean\": %.1f, \"jitter_us_max\": %u, \"missed_periods\": %u}",
+       label, (unsigned)tasks, (unsigned)stack, (unsigned)(stack + tasks * TCB_BYTES),
+       intervals ? (double)dev_sum / intervals : 0.0, (unsigned)dev_max, (unsigned)missed);
+}
+
+// Alternate 10 and 5 Hz, each change 20 ms after a sample
+static void retime_phase(void) {
+  const uint32_t n = (uint32_t)knob("BENCH_RETIMES", 6);
+  load_t *l = &loads[0];
+  l->read_us = 0;
+  sensor_manager_init_mode(SENSOR_SCHED_DISPATCHER);
+  int idx = sensor_register_ex(l->name, NULL, read_load, NULL, l, 10, true, l->payload, 0);
+  double after_sum = 0, expect_sum = 0;
+  uint32_t forced = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    uint32_t seen = l->reads;
+    while (l->reads == seen) delay(1);
+    uint32_t sampled_us = l->last_us;
+    delay(20);
+    float hz = (i & 1) ? 10.0f : 5.0f;
+    seen = l->reads;
+    uint32_t set_us = micros();
+    sensor_set_freq(idx, hz);
+    while (l->reads == seen) delay(1);
+    uint32_t after_ms = (l->last_us - set_us) / 1000u;
+    double expect_ms = 1000.0 / hz - (set_us - sampled_us) / 1000.0;
+    after_sum += after_ms;
+    expect_sum += expect_ms;
+    if (after_ms < 5) forced++;
+  }
+  emit("{\"kind\": \"retime\", \"changes\": %u, \"next_sample_ms_mean\": %.1f, "
+       "\"expected_ms_mean\": %.1f, \"forced_samples\": %u}",
+       (unsigned)n, after_sum / n, expect_sum / n, (unsigned)forced);
+}
+
+/* ---- driver ---- */
+static char self_path[256];
+
+static int run_phase(const char *phase, bool first) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "BENCH_PHASE=%s '%s' 2>&1", phase, self_path);
+  FILE *p = popen(cmd, "r");
+  if (!p) return -1;
+  char line[1024];
+  int n = 0;
+  while (fgets(line, sizeof(line), p)) {
+    if (strncmp(line, "BENCH_JSON ", 11) != 0) continue;
+    line[strcspn(line, "\n")] = 0;
+    printf("%s\n    %s", (first && n == 0) ? "" : ",", line + 11);
+    n++;
+  }
+  pclose(p);
+  return n;
+}
+
+void setup() {
+  const char *phase = getenv("BENCH_PHASE");
+  if (phase) {
+    if (!strcmp(phase, "per_task")) mode_phase(SENSOR_SCHED_PER_TASK, phase);
+    else if (!strcmp(phase, "dispatcher")) mode_phase(SENSOR_SCHED_DISPATCHER, phase);
+    else if (!strcmp(phase, "retime")) retime_phase();
+    // Tasks are still running; skip static destructors under their feet
+    fflush(stdout);
+    _exit(0);
+  }
+
+  ssize_t n = readlink("/proc/self/exe", self_path, sizeof(self_path) - 1);
+  if (n <= 0) {
+    printf("can't find this program's path\n");
+    exit(1);
+  }
+  self_path[n] = 0;
+
+  printf("{\n  \"bench\": \"sched\",\n  \"results\": [");
+  run_phase("per_task", true);
+  run_phase("dispatcher", false);
+  run_phase("retime", false);
+  printf("\n  ]\n}\n");
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
@@ -0,0 +1,130 @@
+// bench/seqlock_bench.cpp
+// sensor_get_last() under load: one event sensor sampled as fast as a
+// notifier task can wake it, against several reader tasks copying its last
+// sample in a loop. Every sample is self-describing (its length and each
+// byte follow from a counter in the first four bytes), so a reader can tell
+// a torn copy: a length from one sample with bytes from another, or bytes
+// from two. Prints one JSON object and exits 1 if any copy was torn.
+//   pio run -e native_seqlock_bench && .pio/build/native_seqlock_bench/program
+// Knobs: BENCH_MS run time (3000), BENCH_READERS reader tasks (4),
+// BENCH_PAYLOAD largest sample in bytes (256).
+#include <Arduino.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "sensor_manager.h"
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+static uint32_t payload_max;
+static volatile bool running = true;
+static volatile uint32_t writes;
+static int idx;
+
+static size_t len_for(uint32_t n) {
+  return 4 + n % (payload_max - 3);
+}
+
+static uint8_t byte_for(uint32_t n, size_t i) {
+  return (uint8_t)(n * 31u + i);
+}
+
+// Writer: sample n is len_for(n) bytes, n itself first
+static bool read_pattern(void *ctx, sensor_data_t *out) {
+  (void)ctx;
+  uint32_t n = writes;
+  size_t len = len_for(n);
+  memcpy(out->bytes, &n, 4);
+  for (size_t i = 4; i < len; ++i) out->bytes[i] = byte_for(n, i);
+  out->len = len;
+  writes = n + 1;
+  return true;
+}
+
+static void notifier_task(void *arg) {
+  (void)arg;
+  while (running) {
+    sensor_notify(idx);
+    taskYIELD();
+  }
+  vTaskSuspend(NULL);
+}
+
+typedef struct {
+  uint32_t reads;
+  uint32_t torn;
+  uint32_t distinct;
+  volatile bool done;
+} reader_t;
+
+static void reader_task(void *arg) {
+  reader_t *r = (reader_t *)arg;
+  static thread_local sensor_data_t d;   // full size, as sensor_get_last() wants
+  uint32_t last = UINT32_MAX;
+  while (running) {
+    if (!sensor_get_last(idx, &d)) continue;
+    r->reads++;
+    uint32_t n;
+    memcpy(&n, d.bytes, 4);
+    bool ok = d.len == len_for(n);
+    for (size_t i = 4; ok && i < d.len; ++i) ok = d.bytes[i] == byte_for(n, i);
+    if (!ok) r->torn++;
+    if (n != last) r->distinct++;
+    last = n;
+  }
+  r->done = true;
+  vTaskSuspend(NULL);
+}
+
+void setup() {
+  const uint32_t ms = (uint32_t)knob("BENCH_MS", 3000);
+  const uint32_t n_readers = (uint32_t)knob("BENCH_READERS", 4);
+  payload_max = (uint32_t)knob("BENCH_PAYLOAD", 256);
+  if (payload_max < 8) payload_max = 8;
+  if (payload_max > SENSOR_DATA_BYTES) payload_max = SENSOR_DATA_BYTES;
+
+  // Serial is stdout on the host: keep the registration log out of the JSON
+  fflush(stdout);
+  int saved_fd = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+  sensor_manager_init();
+  idx = sensor_register_ex("pattern", NULL, read_pattern, NULL, NULL, 0, true, payload_max,
+                           SENSOR_FLAG_EVENT | SENSOR_FLAG_OWN_TASK);
+  reader_t *readers = (reader_t *)calloc(n_readers, sizeof(reader_t));
+  if (idx < 0 || !readers) {
+    printf("setup failed\n");
+    exit(1);
+  }
+  xTaskCreate(notifier_task, "notify", 1024, NULL, 1, NULL);
+  for (uint32_t i = 0; i < n_readers; ++i) xTaskCreate(reader_task, "reader", 1024, &readers[i], 1, NULL);
+
+  delay(ms);
+  running = false;
+  for (uint32_t i = 0; i < n_readers; ++i) {
+    while (!readers[i].done) delay(1);
+  }
+
+  fflush(stdout);
+  dup2(saved_fd, STDOUT_FILENO);
+
+  uint32_t reads = 0, torn = 0, distinct = 0;
+  for (uint32_t i = 0; i < n_readers; ++i) {
+    reads += readers[i].reads;
+    torn += readers[i].torn;
+    distinct += readers[i].distinct;
+  }
+  printf("{\n  \"bench\": \"seqlock\",\n  \"ms\": %u, \"readers\": %u, \"payload_max\": %u,\n"
+         "  \"writes\": %u, \"reads\": %u, \"distinct_samples_read\": %u, \"torn\": %u\n}\n",
+         (unsigned)ms, (unsigned)n_readers, (unsigned)payload_max,
+         (unsigned)writes, (unsigned)reads, (unsigned)distinct, (unsigned)torn);
+  // Tasks are still running; skip static destructors under their feet
+  fflush(stdout);
+  _exit(torn ? 1 : 0);
+}
+
+void loop() {}
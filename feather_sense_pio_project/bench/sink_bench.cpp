@@ -0,0 +1,175 @@
+// bench/sink_bench.cpp
+// Sensor-to-sink routing under load, printed as one JSON object: four
+// sensors with 12-byte (IMU-sized) samples routed to all three sinks
+// (flash, BLE, serial) on the dispatcher, at a total offered rate from
+// main.cpp's logging load up to the manager's rate limit. Per rate: each
+// sink's delivered and dropped samples per second, what the flash log
+// took (records into the RAM batches, record bytes flushed) and the
+// manager's missed periods, i.e. whether routing kept the sampler on time.
+// Storage runs on the QSPI timing model with main.cpp's batch settings, BLE
+// on the host link model with a full central (MTU 247, DLE 251, 2M) into
+// /dev/null, serial into /dev/null. Each rate runs in a fresh process
+// (this program again, with BENCH_PHASE set) as the manager is set up once
+// per boot.
+//   pio run -e native_sink_bench && .pio/build/native_sink_bench/program > bench.json
+// Knobs: BENCH_MS run time per rate (3000). Flash model defaults as
+// storage_bench: HOST_FLASH_PAGE_US 700, HOST_FLASH_ERASE_US 45000.
+#include <Arduino.h>
+#include <bluefruit.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include "sensor_manager.h"
+#include "sensor_sinks.h"
+#include "storage.h"
+#include "ble_manager.h"
+
+#define SENSORS   4
+#define PAYLOAD   12   // euler_t
+#define ALL_SINKS (SENSOR_FLAG_SINK(SENSOR_SINK_FLASH) | SENSOR_FLAG_SINK(SENSOR_SINK_BLE) | \
+                   SENSOR_FLAG_SINK(SENSOR_SINK_SERIAL))
+
+static const char *sink_names[SENSOR_SINK_COUNT] = { "flash", "ble", "serial" };
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+// Serial is stdout on the host and the serial sink writes there: results
+// go out on a copy of the real stdout
+static FILE *json_out;
+
+static void emit(const char *fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  fprintf(json_out, "BENCH_JSON %s\n", buf);
+  fflush(json_out);
+}
+
+static bool read_angles(void *ctx, sensor_data_t *out) {
+  uint32_t *n = (uint32_t *)ctx;
+  float v[3] = { (float)(*n % 3600) * 0.1f, 1.5f, -0.25f * (float)(*n % 7) };
+  (*n)++;
+  memcpy(out->bytes, v, sizeof(v));
+  out->len = PAYLOAD;
+  return true;
+}
+
+static void rate_phase(uint32_t total_hz) {
+  const uint32_t ms = (uint32_t)knob("BENCH_MS", 3000);
+  static uint32_t counters[SENSORS];
+
+  fflush(stdout);
+  json_out = fdopen(dup(STDOUT_FILENO), "w");
+  dup2(open("/dev/null", O_WRONLY), STDOUT_FILENO);
+
+  ble_init();
+  storage_init(60u * 1000u, STORAGE_BATCH_BYTES);
+  sensor_manager_init_mode(SENSOR_SCHED_DISPATCHER);
+  sensor_sinks_init(1, 1024);
+  while (!Bluefruit.connected()) delay(1);
+
+  int idx[SENSORS];
+  char name[SENSORS][8];
+  for (int i = 0; i < SENSORS; ++i) {
+    snprintf(name[i], sizeof(name[i]), "s%d", i);
+    idx[i] = sensor_register_ex(name[i], NULL, read_angles, NULL, &counters[i], (float)total_hz / SENSORS, true,
+                                PAYLOAD, ALL_SINKS);
+  }
+  delay(200);
+
+  // Counters belong to the sinks: take deltas rather than resetting them
+  sensor_sink_stats_t s0[SENSOR_SINK_COUNT], s1[SENSOR_SINK_COUNT];
+  for (int k = 0; k < SENSOR_SINK_COUNT; ++k) sensor_sinks_get_stats((sensor_sink_t)k, &s0[k]);
+  storage_log_stats_t l0, l1;
+  storage_get_log_stats(&l0);
+  sensor_stats_reset(-1);
+  delay(ms);
+  for (int k = 0; k < SENSOR_SINK_COUNT; ++k) sensor_sinks_get_stats((sensor_sink_t)k, &s1[k]);
+  uint32_t missed = 0;
+  for (int i = 0; i < SENSORS; ++i) {
+    sensor_stats_t st;
+    memset(&st, 0, sizeof(st));
+    sensor_stats_snapshot(idx[i], &st);
+    missed += st.missed_periods;
+  }
+  // Whatever the last timed window left in RAM goes to flash too
+  storage_flush_now();
+  flash_sync();
+  storage_get_log_stats(&l1);
+
+  double secs = ms / 1000.0;
+  for (int k = 0; k < SENSOR_SINK_COUNT; ++k) {
+    uint32_t rec = s1[k].records - s0[k].records, drops = s1[k].drops - s0[k].drops;
+    emit("{\"kind\": \"sink\", \"offered_hz\": %u, \"sink\": \"%s\", \"records_per_s\": %.1f, "
+         "\"drops_per_s\": %.1f, \"drop_pct\": %.1f}",
+         (unsigned)total_hz, sink_names[k], rec / secs, drops / secs,
+         rec + drops ? 100.0 * drops / (rec + drops) : 0.0);
+  }
+  uint32_t flash_rec = s1[SENSOR_SINK_FLASH].records - s0[SENSOR_SINK_FLASH].records;
+  emit("{\"kind\": \"rate\", \"offered_hz\": %u, \"samples\": %u, \"missed_periods\": %u, "
+       "\"flash_records\": %u, \"flash_bytes_in\": %u, \"flash_bytes_coded\": %u, \"flushes\": %u}",
+       (unsigned)total_hz, (unsigned)(s1[SENSOR_SINK_SERIAL].records + s1[SENSOR_SINK_SERIAL].drops -
+                                      s0[SENSOR_SINK_SERIAL].records - s0[SENSOR_SINK_SERIAL].drops),
+       (unsigned)missed, (unsigned)flash_rec, (unsigned)(l1.bytes_in - l0.bytes_in),
+       (unsigned)(l1.bytes_coded - l0.bytes_coded),
+       (unsigned)(l1.flushes_watermark + l1.flushes_full + l1.flushes_timer + l1.flushes_manual -
+                  l0.flushes_watermark - l0.flushes_full - l0.flushes_timer - l0.flushes_manual));
+}
+
+/* ---- driver ---- */
+static char self_path[256];
+
+static int run_phase(const char *phase, bool first) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "BENCH_PHASE=%s '%s' 2>&1", phase, self_path);
+  FILE *p = popen(cmd, "r");
+  if (!p) return -1;
+  char line[1024];
+  int n = 0;
+  while (fgets(line, sizeof(line), p)) {
+    if (strncmp(line, "BENCH_JSON ", 11) != 0) continue;
+    line[strcspn(line, "\n")] = 0;
+    printf("%s\n    %s", (first && n == 0) ? "" : ",", line + 11);
+    n++;
+  }
+  pclose(p);
+  return n;
+}
+
+void setup() {
+  setenv("HOST_FLASH_PAGE_US", "700", 0);
+  setenv("HOST_FLASH_ERASE_US", "45000", 0);
+  const char *phase = getenv("BENCH_PHASE");
+  if (phase) {
+    rate_phase((uint32_t)atol(phase));
+    // Tasks are still running; skip static destructors under their feet
+    _exit(0);
+  }
+
+  ssize_t n = readlink("/proc/self/exe", self_path, sizeof(self_path) - 1);
+  if (n <= 0) {
+    printf("can't find this program's path\n");
+    exit(1);
+  }
+  self_path[n] = 0;
+
+  unsetenv("HOST_FLASH_FILE");
+  setenv("HOST_BLE_OUT", "/dev/null", 1);
+  setenv("HOST_BLE_CONNECT_MS", "0", 1);
+  // 40 Hz is about main.cpp's logged load; 4000 Hz is 1 kHz per sensor
+  static const char *rates[] = { "40", "400", "4000" };
+  printf("{\n  \"bench\": \"sink\",\n  \"results\": [");
+  for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); ++i) run_phase(rates[i], i == 0);
+  printf("\n  ]\n}\n");
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
@@ -0,0 +1,510 @@
+// bench/storage_bench.cpp
+// Storage and codec benchmarks on the host QSPI timing model, printed as one
+// JSON object so runs can be diffed for regressions:
+//   codec   record_codec encode/decode MB/s and size ratio per codec, and
+//           records that didn't decode back to what was encoded
+//   codec_mixed  randomized mixed-sensor blocks round-tripped and checked
+//   append  storage_append_record() latency with the flush task running
+//   flush   storage_flush_now() time per RAM batch size: until it returns
+//           (writes queued) and until they are programmed (flash_sync)
+//   boot    storage_init() log recovery time and bytes read per fill level
+//   upload  storage_upload_over_ble() throughput into a file-backed central
+//           over the host link model, for a central that negotiates nothing
+//           (ATT MTU 23, 27-byte packets, 1M PHY) and one that takes MTU
+//           247, data length 251 and 2M
+// The storage phases each run in a fresh process (this program again, with
+// BENCH_PHASE set) so every one starts from cold statics and its own image.
+//   pio run -e native_storage_bench && .pio/build/native_storage_bench/program > bench.json
+// Flash model defaults, all overridable: HOST_FLASH_PAGE_US 700,
+// HOST_FLASH_ERASE_US 45000, HOST_FLASH_READ_CMD_NS 5000,
+// HOST_FLASH_READ_BYTE_NS 63. Knobs: BENCH_DIR for scratch files (/tmp),
+// BENCH_APPEND_HZ producer rate (5000), BENCH_RECORDS per codec (20000),
+// BENCH_BLOCKS and BENCH_SEED for codec_mixed (2000, 1),
+// HOST_BLE_CONN_INTERVAL_US for the upload (15000).
+#include <Arduino.h>
+#include <bluefruit.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include "storage.h"
+#include "record_codec.h"
+#include "ble_manager.h"
+
+#define LOG_SECTORS     (FLASH_LOG_MAX_BYTES / 4096u)
+#define IMU_BYTES       12      // euler_t, the commonest logged record
+#define REC_OVERHEAD    7       // storage RAM record header
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static const char *bench_dir(void) {
+  return getenv("BENCH_DIR") ? getenv("BENCH_DIR") : "/tmp";
+}
+
+static void scratch_path(char *out, size_t cap, const char *name) {
+  snprintf(out, cap, "%s/storage_bench_%s", bench_dir(), name);
+}
+
+// Slowly moving IMU angles, as the codecs see them in practice
+static void imu_sample(uint32_t i, sensor_data_t *d) {
+  float v[3] = { (float)(i % 3600) * 0.1f, 1.5f + (float)(i % 20) * 0.01f, -0.25f * (float)(i % 7) };
+  memcpy(d->bytes, v, sizeof(v));
+  d->len = sizeof(v);
+  d->timestamp = i * 10;   // 100 Hz
+}
+
+template <typename T> static T pct(std::vector<T> &v, int p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[(v.size() - 1) * (size_t)p / 100];
+}
+
+/* ---- codec (in this process) ---- */
+static void payload_for(record_codec_t c, uint32_t i, uint8_t *p, uint8_t *len) {
+  switch (c) {
+  case RECORD_CODEC_U8_DELTA:     // battery percent
+    p[0] = (uint8_t)(100 - i / 500 % 100);
+    *len = 1;
+    break;
+  case RECORD_CODEC_I16BE_DELTA: {   // temperature * 100
+    int16_t t = (int16_t)(3650 + (int)(i % 40) - 20);
+    p[0] = (uint8_t)(t >> 8);
+    p[1] = (uint8_t)t;
+    *len = 2;
+    break;
+  }
+  case RECORD_CODEC_F32BE_XOR: {     // SpO2 adapter: 5 big-endian floats
+    float v[5] = { 96.0f + (float)(i % 3), 72.0f, 0.02f, 0.03f, 97.0f };
+    for (int k = 0; k < 5; ++k) {
+      uint32_t u;
+      memcpy(&u, &v[k], 4);
+      p[4 * k] = (uint8_t)(u >> 24); p[4 * k + 1] = (uint8_t)(u >> 16);
+      p[4 * k + 2] = (uint8_t)(u >> 8); p[4 * k + 3] = (uint8_t)u;
+    }
+    *len = 20;
+    break;
+  }
+  default: {                         // IMU euler_t, also used for RAW
+    sensor_data_t d;
+    imu_sample(i, &d);
+    memcpy(p, d.bytes, IMU_BYTES);
+    *len = IMU_BYTES;
+    break;
+  }
+  }
+}
+
+static void bench_codec(void) {
+  static uint8_t blocks[1u << 20];
+  static const record_codec_t codecs[] = { RECORD_CODEC_RAW, RECORD_CODEC_U8_DELTA, RECORD_CODEC_I16BE_DELTA,
+                                           RECORD_CODEC_F32BE_XOR, RECORD_CODEC_F32LE_XOR };
+  static const char *names[] = { "raw", "u8_delta", "i16be_delta", "f32be_xor", "f32le_xor" };
+  const size_t block_cap = 4096 - 24 - 12;   // one batch per sector
+  uint32_t n = (uint32_t)atol(getenv("BENCH_RECORDS") ? getenv("BENCH_RECORDS") : "20000");
+  printf("  \"codec\": [");
+  for (size_t ci = 0; ci < sizeof(codecs) / sizeof(codecs[0]); ++ci) {
+    record_codec_t c = codecs[ci];
+    record_codec_block_t b;
+    std::vector<size_t> starts;   // block boundaries
+    std::vector<uint32_t> bases;  // and each block's base_ts
+    size_t used = 0, block_used = 0;
+    uint64_t raw = 0;
+    uint8_t p[32], len;
+
+    uint64_t t0 = now_ns();
+    record_codec_block_begin(&b, 0);
+    starts.push_back(0);
+    bases.push_back(0);
+    for (uint32_t i = 0; i < n && used + block_cap <= sizeof(blocks); ++i) {
+      payload_for(c, i, p, &len);
+      size_t k = record_codec_encode(&b, c, 1, i * 20, p, len, blocks + used, block_cap - block_used);
+      if (k == 0) {
+        starts.push_back(used);
+        bases.push_back(i * 20);
+        block_used = 0;
+        record_codec_block_begin(&b, i * 20);
+        k = record_codec_encode(&b, c, 1, i * 20, p, len, blocks + used, block_cap);
+      }
+      used += k;
+      block_used += k;
+      raw += len;
+    }
+    uint64_t enc_ns = now_ns() - t0;
+    starts.push_back(used);
+
+    uint32_t decoded = 0;
+    t0 = now_ns();
+    for (size_t s = 0; s + 1 < starts.size(); ++s) {
+      record_codec_block_begin(&b, bases[s]);
+      for (size_t at = starts[s]; at < starts[s + 1]; ) {
+        uint8_t idx, out[255], olen;
+        uint32_t ts;
+        size_t k = record_codec_decode(&b, blocks + at, starts[s + 1] - at, &idx, &ts, out, &olen);
+        if (!k) break;
+        at += k;
+        decoded++;
+      }
+    }
+    uint64_t dec_ns = now_ns() - t0;
+
+    // Untimed: every record back as it went in
+    uint32_t i = 0, mismatched = 0;
+    for (size_t s = 0; s + 1 < starts.size(); ++s) {
+      record_codec_block_begin(&b, bases[s]);
+      for (size_t at = starts[s]; at < starts[s + 1]; ++i) {
+        uint8_t idx, out[255], olen;
+        uint32_t ts;
+        size_t k = record_codec_decode(&b, blocks + at, starts[s + 1] - at, &idx, &ts, out, &olen);
+        if (!k) break;
+        at += k;
+        payload_for(c, i, p, &len);
+        if (idx != 1 || ts != i * 20 || olen != len || memcmp(out, p, len)) mismatched++;
+      }
+    }
+    printf("%s\n    {\"codec\": \"%s\", \"payload_bytes\": %u, \"records\": %u, \"decoded\": %u, "
+           "\"mismatched\": %u, \"coded_per_raw\": %.3f, \"encode_mb_s\": %.1f, \"decode_mb_s\": %.1f}",
+           ci ? "," : "", names[ci], (unsigned)len, (unsigned)n, (unsigned)decoded, (unsigned)mismatched,
+           (double)used / (double)(raw + (uint64_t)n * REC_OVERHEAD),
+           enc_ns ? raw * 1000.0 / enc_ns : 0.0, dec_ns ? raw * 1000.0 / dec_ns : 0.0);
+  }
+  printf("\n  ],\n");
+}
+
+/* Mixed blocks as the flush task builds them: six sensors on the five
+ * codecs, irregular timestamps, NaNs and the odd payload length a codec
+ * can't take (stored raw), each block decoded and checked record by record */
+static uint32_t rng = 1;
+static uint32_t rnd(uint32_t n) {
+  rng = rng * 1664525u + 1013904223u;
+  return (rng >> 8) % n;
+}
+
+static void put_f32(uint8_t *p, float f, bool be) {
+  uint32_t u;
+  memcpy(&u, &f, 4);
+  if (!be) {
+    memcpy(p, &u, 4);
+    return;
+  }
+  p[0] = (uint8_t)(u >> 24); p[1] = (uint8_t)(u >> 16); p[2] = (uint8_t)(u >> 8); p[3] = (uint8_t)u;
+}
+
+static void bench_codec_mixed(void) {
+  typedef struct { uint8_t idx, len; uint32_t ts; uint8_t p[255]; } rec_t;
+  static rec_t recs[1024];
+  static uint8_t block[4096];
+  const size_t block_cap = 4096 - 24 - 12;
+  const uint32_t blocks = (uint32_t)atol(getenv("BENCH_BLOCKS") ? getenv("BENCH_BLOCKS") : "2000");
+  rng = (uint32_t)atol(getenv("BENCH_SEED") ? getenv("BENCH_SEED") : "1");
+  uint64_t raw = 0, coded = 0;
+  uint32_t records = 0, mismatched = 0, bad_blocks = 0;
+
+  for (uint32_t blk = 0; blk < blocks; ++blk) {
+    record_codec_block_t b;
+    uint32_t ts = blk * 60000u;
+    size_t used = 0, n = 0;
+    record_codec_block_begin(&b, ts);
+    while (n < sizeof(recs) / sizeof(recs[0])) {
+      rec_t &r = recs[n];
+      r.idx = (uint8_t)rnd(6);
+      record_codec_t c = (record_codec_t)(r.idx % RECORD_CODEC_COUNT);
+      ts += rnd(300);
+      r.ts = ts;
+      switch (c) {
+      case RECORD_CODEC_U8_DELTA:
+        r.len = 1;
+        r.p[0] = (uint8_t)(80 + rnd(3));
+        break;
+      case RECORD_CODEC_I16BE_DELTA: {
+        int16_t t = (int16_t)(3640 + (int)rnd(20));
+        r.len = 2;
+        r.p[0] = (uint8_t)(t >> 8);
+        r.p[1] = (uint8_t)t;
+        break;
+      }
+      case RECORD_CODEC_F32BE_XOR:
+      case RECORD_CODEC_F32LE_XOR:
+        r.len = rnd(2) ? 12 : 20;
+        for (int k = 0; k < r.len / 4; ++k) {
+          float f = rnd(3) ? 97.0f + 0.1f * (float)rnd(5) : 72.0f;
+          if (rnd(10) == 0) f = NAN;
+          put_f32(r.p + 4 * k, f, c == RECORD_CODEC_F32BE_XOR);
+        }
+        break;
+      default:
+        r.len = (uint8_t)rnd(40);
+        for (int k = 0; k < r.len; ++k) r.p[k] = (uint8_t)rnd(256);
+        break;
+      }
+      if (rnd(50) == 0) r.len = 3;
+      size_t k = record_codec_encode(&b, c, r.idx, r.ts, r.p, r.len, block + used, block_cap - used);
+      if (!k) break;
+      used += k;
+      raw += r.len + REC_OVERHEAD;
+      n++;
+    }
+    coded += used;
+    records += (uint32_t)n;
+
+    record_codec_block_begin(&b, blk * 60000u);
+    size_t at = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint8_t idx, out[255], olen;
+      uint32_t t;
+      size_t k = record_codec_decode(&b, block + at, used - at, &idx, &t, out, &olen);
+      if (!k) {
+        mismatched += (uint32_t)(n - i);
+        break;
+      }
+      at += k;
+      if (idx != recs[i].idx || t != recs[i].ts || olen != recs[i].len || memcmp(out, recs[i].p, olen))
+        mismatched++;
+    }
+    if (at != used) bad_blocks++;
+  }
+  printf("  \"codec_mixed\": {\"blocks\": %u, \"records\": %u, \"mismatched\": %u, \"bad_blocks\": %u, "
+         "\"coded_per_raw\": %.3f},\n",
+         (unsigned)blocks, (unsigned)records, (unsigned)mismatched, (unsigned)bad_blocks,
+         raw ? (double)coded / (double)raw : 0.0);
+}
+
+/* ---- storage phases (child processes) ---- */
+static void emit(const char *fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  printf("BENCH_JSON %s\n", buf);
+}
+
+static void phase_append(void) {
+  storage_init(100, STORAGE_BATCH_BYTES);
+  long hz = atol(getenv("BENCH_APPEND_HZ") ? getenv("BENCH_APPEND_HZ") : "5000");
+  if (hz <= 0) hz = 5000;
+  uint64_t period = 1000000000u / (uint64_t)hz;
+  uint32_t n = (uint32_t)hz * 2;   // two seconds: ~20 flushes
+  std::vector<uint32_t> lat;
+  lat.reserve(n);
+  sensor_data_t d;
+  uint64_t next = now_ns();
+  for (uint32_t i = 0; i < n; ++i) {
+    while (now_ns() < next) {}
+    next += period;
+    imu_sample(i, &d);
+    uint64_t t0 = now_ns();
+    storage_append_record(0, &d);
+    lat.push_back((uint32_t)(now_ns() - t0));
+  }
+  storage_sensor_stats_t st;
+  storage_get_sensor_stats(0, &st);
+  emit("{\"rate_hz\": %ld, \"records\": %u, \"drops\": %u, \"p50_ns\": %u, \"p99_ns\": %u, \"max_ns\": %u}",
+       hz, (unsigned)n, (unsigned)st.drops, pct(lat, 50), pct(lat, 99), pct(lat, 100));
+}
+
+static void phase_flush(void) {
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);   // no timed flushes in the way
+  sensor_data_t d;
+  uint32_t i = 0;
+  static const uint32_t sizes[] = { 256, 512, 1024, 2048, 4096 };
+  for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+    std::vector<uint32_t> queued, durable;
+    for (int rep = 0; rep < 20; ++rep) {
+      for (uint32_t bytes = 0; bytes + REC_OVERHEAD + IMU_BYTES <= sizes[si]; bytes += REC_OVERHEAD + IMU_BYTES) {
+        imu_sample(i++, &d);
+        storage_append_record(0, &d);
+      }
+      uint64_t t0 = now_ns();
+      storage_flush_now();
+      uint64_t t1 = now_ns();
+      flash_sync();
+      uint64_t t2 = now_ns();
+      queued.push_back((uint32_t)((t1 - t0) / 1000u));
+      durable.push_back((uint32_t)((t2 - t0) / 1000u));
+    }
+    emit("{\"batch_bytes\": %u, \"queued_p50_us\": %u, \"queued_max_us\": %u, "
+         "\"durable_p50_us\": %u, \"durable_max_us\": %u}",
+         (unsigned)sizes[si], pct(queued, 50), pct(queued, 100), pct(durable, 50), pct(durable, 100));
+  }
+}
+
+// Fill the flash image to BENCH_FILL percent of the log (over 100 wraps)
+static void phase_fill(void) {
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  long fill = atol(getenv("BENCH_FILL") ? getenv("BENCH_FILL") : "50");
+  if (fill <= 0) return;
+  uint32_t target = (uint32_t)(LOG_SECTORS * (uint32_t)fill / 100u);
+  sensor_data_t d;
+  storage_log_stats_t st;
+  uint32_t coded_target = 0;
+  for (uint32_t i = 0; ; ++i) {
+    imu_sample(i, &d);
+    d.timestamp = i;
+    storage_append_record(0, &d);
+    if (i % 200 != 199) continue;
+    storage_flush_now();
+    storage_get_log_stats(&st);
+    if (fill <= 100 && st.sectors_used >= target) break;
+    if (fill > 100) {   // keep going past full by the extra percentage
+      if (!coded_target && st.sectors_used + STORAGE_PREERASE_SECTORS >= LOG_SECTORS) {
+        coded_target = st.bytes_coded + (uint32_t)(LOG_SECTORS * 4096ull * (uint64_t)(fill - 100) / 100u);
+      }
+      if (coded_target && st.bytes_coded >= coded_target) break;
+    }
+  }
+  flash_sync();
+}
+
+static void phase_boot(void) {
+  flash_init();   // loading the host image isn't part of a boot
+  uint32_t read0 = flash.host_stats()->bytes_read;
+  uint64_t t0 = now_ns();
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  uint64_t us = (now_ns() - t0) / 1000u;
+  storage_log_stats_t st;
+  storage_get_log_stats(&st);
+  emit("{\"fill_pct\": %s, \"sectors_used\": %u, \"boot_us\": %u, \"bytes_read\": %u}",
+       getenv("BENCH_FILL") ? getenv("BENCH_FILL") : "0", (unsigned)st.sectors_used, (unsigned)us,
+       (unsigned)(flash.host_stats()->bytes_read - read0));
+}
+
+// Upload the whole log to HOST_BLE_OUT; done when the 'E' frame lands
+static void phase_upload(void) {
+  ble_init();
+  storage_init(3600u * 1000u, STORAGE_BATCH_BYTES);
+  while (!Bluefruit.connected()) delay(1);
+  storage_log_stats_t st;
+  storage_get_log_stats(&st);
+  const char *out = getenv("HOST_BLE_OUT");
+  uint32_t read0 = flash.host_stats()->bytes_read;
+  uint64_t t0 = now_ns();
+  storage_upload_over_ble();
+  long size = 0;
+  for (;;) {
+    delay(5);
+    FILE *f = fopen(out, "rb");
+    if (!f) continue;
+    uint8_t tail[12];
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    bool done = size >= 12 && fseek(f, -12, SEEK_END) == 0 && fread(tail, 1, 12, f) == 12 &&
+                tail[0] == 'E' && tail[1] == 'N';
+    fclose(f);
+    if (done) break;
+  }
+  uint64_t us = (now_ns() - t0) / 1000u;
+  // The firmware's own figure lands once the last TX complete is in
+  ble_tx_stats_t tx;
+  ble_get_tx_stats(&tx);
+  for (int i = 0; i < 1000 && !tx.bulk_ms; ++i) {
+    delay(1);
+    ble_get_tx_stats(&tx);
+  }
+  emit("{\"sectors\": %u, \"mtu\": %u, \"data_len\": %u, \"phy\": %u, \"bytes_sent\": %ld, "
+       "\"notifications\": %u, \"upload_us\": %u, \"kb_s\": %.1f, \"bulk_kb_s\": %.1f, "
+       "\"flash_bytes_read\": %u}",
+       (unsigned)st.sectors_used, (unsigned)tx.mtu, (unsigned)tx.data_len, (unsigned)tx.phy, size,
+       (unsigned)tx.notifications, (unsigned)us, us ? size * 1000000.0 / 1024.0 / us : 0.0,
+       tx.bulk_ms ? tx.bulk_bytes * 1000.0 / 1024.0 / tx.bulk_ms : 0.0,
+       (unsigned)(flash.host_stats()->bytes_read - read0));
+}
+
+/* ---- driver ---- */
+// Run this program with BENCH_PHASE=phase; print its BENCH_JSON lines as
+// a comma-separated list
+static char self_path[256];
+
+static int run_phase(const char *phase, bool first) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "BENCH_PHASE=%s '%s' 2>&1", phase, self_path);
+  FILE *p = popen(cmd, "r");
+  if (!p) return -1;
+  char line[1024];
+  int n = 0;
+  while (fgets(line, sizeof(line), p)) {
+    if (strncmp(line, "BENCH_JSON ", 11) != 0) continue;
+    line[strcspn(line, "\n")] = 0;
+    printf("%s\n    %s", (first && n == 0) ? "" : ",", line + 11);
+    n++;
+  }
+  pclose(p);
+  return n;
+}
+
+void setup() {
+  setenv("HOST_FLASH_PAGE_US", "700", 0);
+  setenv("HOST_FLASH_ERASE_US", "45000", 0);
+  setenv("HOST_FLASH_READ_CMD_NS", "5000", 0);
+  setenv("HOST_FLASH_READ_BYTE_NS", "63", 0);
+  const char *phase = getenv("BENCH_PHASE");
+  if (phase) {
+    if (!strcmp(phase, "append")) phase_append();
+    else if (!strcmp(phase, "flush")) phase_flush();
+    else if (!strcmp(phase, "fill")) phase_fill();
+    else if (!strcmp(phase, "boot")) phase_boot();
+    else if (!strcmp(phase, "upload")) phase_upload();
+    // Tasks are still running; skip static destructors under their feet
+    fflush(stdout);
+    _exit(0);
+  }
+
+  ssize_t n = readlink("/proc/self/exe", self_path, sizeof(self_path) - 1);
+  if (n <= 0) {
+    printf("can't find this program's path\n");
+    exit(1);
+  }
+  self_path[n] = 0;
+
+  char img[256], ble[256];
+  scratch_path(img, sizeof(img), "flash.bin");
+  scratch_path(ble, sizeof(ble), "ble.bin");
+  printf("{\n  \"bench\": \"storage\",\n");
+  printf("  \"flash_model\": {\"page_us\": %s, \"erase_us\": %s, \"read_cmd_ns\": %s, \"read_byte_ns\": %s},\n",
+         getenv("HOST_FLASH_PAGE_US"), getenv("HOST_FLASH_ERASE_US"),
+         getenv("HOST_FLASH_READ_CMD_NS"), getenv("HOST_FLASH_READ_BYTE_NS"));
+  bench_codec();
+  bench_codec_mixed();
+
+  // RAM-backed flash for the phases that don't need an image between runs
+  unsetenv("HOST_FLASH_FILE");
+  printf("  \"append\": [");
+  run_phase("append", true);
+  printf("\n  ],\n  \"flush\": [");
+  run_phase("flush", true);
+
+  printf("\n  ],\n  \"boot\": [");
+  setenv("HOST_FLASH_FILE", img, 1);
+  static const char *fills[] = { "0", "25", "50", "75", "100", "150" };
+  for (size_t i = 0; i < sizeof(fills) / sizeof(fills[0]); ++i) {
+    unlink(img);
+    setenv("BENCH_FILL", fills[i], 1);
+    run_phase("fill", true);
+    run_phase("boot", i == 0);
+  }
+
+  // The last image (wrapped log) goes out over the fake BLE link
+  printf("\n  ],\n  \"upload\": [");
+  setenv("HOST_BLE_OUT", ble, 1);
+  setenv("HOST_BLE_CONNECT_MS", "0", 1);
+  static const char *centrals[][3] = { { "23", "27", "1" }, { "247", "251", "2" } };   // MTU, DLE, PHY
+  for (size_t i = 0; i < sizeof(centrals) / sizeof(centrals[0]); ++i) {
+    unlink(ble);
+    setenv("HOST_BLE_MTU", centrals[i][0], 1);
+    setenv("HOST_BLE_DLE", centrals[i][1], 1);
+    setenv("HOST_BLE_PHY", centrals[i][2], 1);
+    run_phase("upload", i == 0);
+  }
+  printf("\n  ]\n}\n");
+  unlink(img);
+  unlink(ble);
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
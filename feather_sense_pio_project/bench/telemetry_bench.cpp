@@ -0,0 +1,301 @@
+// bench/telemetry_bench.cpp
+// Live telemetry over the BLE UART, binary frames (telemetry.h) against the
+// text they replace, printed as one JSON object:
+//   snapshot  the 1 Hz printer tick: print_both() text (BLE_TEXT_LIVE) vs
+//             telemetry_send_snapshot(), for temp, spo2_fusion, imu and
+//             battery with their real print adapters
+//   live      the BLE sink at 100 Hz IMU + 10 Hz temp: one 'L' frame per
+//             sample (the old sink) vs samples packed per 100 ms hold
+// Per path: BLE bytes and notifications per sample and the sending thread's
+// CPU time. Text CPU is print_all_sensors() with text on minus with it off,
+// so the Serial copy both paths keep isn't counted. Each ATT MTU runs in a
+// fresh process (this program again, with BENCH_PHASE set) as the link is
+// negotiated once per connection; the central is legacy (MTU 23, 27-byte
+// packets, 1M) or full (247, 251, 2M).
+//   pio run -e native_telemetry_bench && .pio/build/native_telemetry_bench/program > bench.json
+// Knobs: BENCH_TICKS snapshot ticks (2000), BENCH_SAMPLES live samples
+// (20000), BENCH_DIR for the capture file (/tmp).
+#include <Arduino.h>
+#include <bluefruit.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <time.h>
+#include "sensor_manager.h"
+#include "ble_manager.h"
+#include "telemetry.h"
+#include "spo2_fusion.h"
+
+extern void temp_print_adapter(void *ctx, const sensor_data_t *d);
+extern void imu_print_adapter(void *ctx, const sensor_data_t *d);
+extern void battery_print_adapter(void *ctx, const sensor_data_t *d);
+
+#define LIVE_HDR_BYTES 8   // the old sink's 'L' idx ts(4) len(2)
+
+static uint64_t cpu_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static long knob(const char *name, long def) {
+  const char *v = getenv(name);
+  long n = v ? atol(v) : 0;
+  return n > 0 ? n : def;
+}
+
+/* ---- Synthetic sensors, payloads as the real adapters lay them out ---- */
+static uint32_t reads;
+
+static void put_f32be(uint8_t *p, float f) {
+  uint32_t x;
+  memcpy(&x, &f, sizeof(x));
+  p[0] = (uint8_t)(x >> 24); p[1] = (uint8_t)(x >> 16); p[2] = (uint8_t)(x >> 8); p[3] = (uint8_t)x;
+}
+
+static bool read_temp(void *ctx, sensor_data_t *out) {
+  (void)ctx;
+  int16_t t = (int16_t)(3650 + (int)(reads++ % 40) - 20);
+  out->bytes[0] = (uint8_t)(t >> 8);
+  out->bytes[1] = (uint8_t)t;
+  out->len = 2;
+  return true;
+}
+
+static bool read_fusion(void *ctx, sensor_data_t *out) {
+  (void)ctx;
+  put_f32be(out->bytes, 96.0f + (float)(reads++ % 4));
+  put_f32be(out->bytes + 4, 31.5f);
+  out->len = 8;
+  return true;
+}
+
+static void imu_at(uint32_t i, uint8_t *p) {
+  float v[3] = { (float)(i % 3600) * 0.1f, 1.5f + (float)(i % 20) * 0.01f, -45.0f + (float)(i % 90) };
+  memcpy(p, v, sizeof(v));   // euler_t, memcpy'd like imu_read_adapter
+}
+
+static bool read_imu(void *ctx, sensor_data_t *out) {
+  (void)ctx;
+  imu_at(reads++, out->bytes);
+  out->len = 12;
+  return true;
+}
+
+static bool read_battery(void *ctx, sensor_data_t *out) {
+  (void)ctx;
+  out->bytes[0] = 82;
+  out->len = 1;
+  return true;
+}
+
+/* ---- Measurement ---- */
+// Serial is stdout on the host: park it on /dev/null while timing
+static int quiet_fd = -1, saved_fd = -1;
+
+static void quiet(bool on) {
+  fflush(stdout);
+  if (on) {
+    if (quiet_fd < 0) quiet_fd = open("/dev/null", O_WRONLY);
+    saved_fd = dup(STDOUT_FILENO);
+    dup2(quiet_fd, STDOUT_FILENO);
+  } else {
+    dup2(saved_fd, STDOUT_FILENO);
+    close(saved_fd);
+  }
+}
+
+typedef struct {
+  uint64_t cpu_ns;
+  uint32_t bytes;
+  uint32_t notifications;
+} cost_t;
+
+static void cost_start(cost_t *c) {
+  ble_tx_stats_t tx;
+  ble_get_tx_stats(&tx);
+  c->bytes = tx.bytes;
+  c->notifications = tx.notifications;
+  c->cpu_ns = cpu_ns();
+}
+
+static void cost_end(cost_t *c) {
+  c->cpu_ns = cpu_ns() - c->cpu_ns;
+  ble_tx_stats_t tx;
+  ble_get_tx_stats(&tx);
+  c->bytes = tx.bytes - c->bytes;
+  c->notifications = tx.notifications - c->notifications;
+}
+
+static void emit(const char *fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  printf("BENCH_JSON %s\n", buf);
+}
+
+static void emit_cost(const char *kind, const char *path, const cost_t *c, uint32_t samples,
+                      uint32_t units, const char *unit, uint64_t cpu_ns_total) {
+  ble_tx_stats_t tx;
+  ble_get_tx_stats(&tx);
+  emit("{\"kind\": \"%s\", \"path\": \"%s\", \"mtu\": %u, \"samples\": %u, \"bytes_per_sample\": %.2f, "
+       "\"notifications_per_%s\": %.2f, \"cpu_us_per_%s\": %.2f}",
+       kind, path, (unsigned)tx.mtu, (unsigned)samples, samples ? (double)c->bytes / samples : 0.0,
+       unit, units ? (double)c->notifications / units : 0.0,
+       unit, units ? (double)cpu_ns_total / 1000.0 / units : 0.0);
+}
+
+// One printer tick per period, as sensor_printer_task does, CPU summed
+static void snapshot_phase(void) {
+  const uint32_t ticks = (uint32_t)knob("BENCH_TICKS", 2000);
+  const uint32_t samples = ticks * 4;   // temp, spo2_fusion, imu, battery
+  cost_t serial, text, bin;
+
+  quiet(true);
+  ble_set_text_live(false);
+  cost_start(&serial);
+  for (uint32_t i = 0; i < ticks; ++i) print_all_sensors();
+  cost_end(&serial);
+
+  ble_set_text_live(true);
+  cost_start(&text);
+  for (uint32_t i = 0; i < ticks; ++i) print_all_sensors();
+  cost_end(&text);
+  ble_set_text_live(false);
+
+  cost_start(&bin);
+  for (uint32_t i = 0; i < ticks; ++i) telemetry_send_snapshot();
+  cost_end(&bin);
+  quiet(false);
+
+  uint64_t text_ns = text.cpu_ns > serial.cpu_ns ? text.cpu_ns - serial.cpu_ns : 0;
+  emit_cost("snapshot", "text", &text, samples, ticks, "tick", text_ns);
+  emit_cost("snapshot", "binary", &bin, samples, ticks, "tick", bin.cpu_ns);
+  emit("{\"kind\": \"snapshot\", \"path\": \"serial_only\", \"cpu_us_per_tick\": %.2f}",
+       (double)serial.cpu_ns / 1000.0 / ticks);
+}
+
+// The BLE sink's traffic: every tenth sample a temp, the rest IMU at 10 ms
+static void live_phase(void) {
+  const uint32_t n = (uint32_t)knob("BENCH_SAMPLES", 20000);
+  uint8_t frame[LIVE_HDR_BYTES + 12];
+  cost_t old_path, packed;
+
+  cost_start(&old_path);
+  for (uint32_t i = 0; i < n; ++i) {
+    uint32_t ts = i * 10;
+    bool temp = i % 10 == 0;
+    size_t len = temp ? 2 : 12;
+    frame[0] = 'L';
+    frame[1] = temp ? 0 : 2;
+    frame[2] = (uint8_t)(ts >> 24); frame[3] = (uint8_t)(ts >> 16);
+    frame[4] = (uint8_t)(ts >> 8); frame[5] = (uint8_t)ts;
+    frame[6] = 0; frame[7] = (uint8_t)len;
+    if (temp) { frame[8] = 0x0E; frame[9] = 0x42; }
+    else imu_at(i, frame + LIVE_HDR_BYTES);
+    ble_write_bytes_chunked(frame, LIVE_HDR_BYTES + len);
+  }
+  cost_end(&old_path);
+
+  static telem_packer_t pk;
+  uint8_t payload[12];
+  cost_start(&packed);
+  for (uint32_t i = 0; i < n; ++i) {
+    uint32_t ts = i * 10;
+    if (i % 10 == 0) {
+      // SENSOR_SINK_BLE_HOLD_MS of samples: live_task sends what it has
+      telemetry_pack_flush(&pk);
+      payload[0] = 0x0E;
+      payload[1] = 0x42;
+      telemetry_pack(&pk, 0, ts, TELEM_LAYOUT_I16BE, payload, 2);
+    } else {
+      imu_at(i, payload);
+      telemetry_pack(&pk, 2, ts, TELEM_LAYOUT_F32LE, payload, 12);
+    }
+  }
+  telemetry_pack_flush(&pk);
+  cost_end(&packed);
+
+  uint32_t seconds = n / 100;   // 100 samples/s of sample time
+  emit_cost("live", "L_frames", &old_path, n, seconds, "s", old_path.cpu_ns);
+  emit_cost("live", "packed", &packed, n, seconds, "s", packed.cpu_ns);
+}
+
+static void phase_run(void) {
+  sensor_manager_init();
+  sensor_register_ex("temp", NULL, read_temp, temp_print_adapter, NULL, 10, true, 2, 0);
+  sensor_register_ex("spo2_fusion", NULL, read_fusion, spo2_print_fusion_adapter, NULL, 10, true, 8, 0);
+  sensor_register_ex("imu", NULL, read_imu, imu_print_adapter, NULL, 10, true, 12, 0);
+  sensor_register_ex("battery", NULL, read_battery, battery_print_adapter, NULL, 10, true, 1, 0);
+  telemetry_set_layout(0, TELEM_LAYOUT_I16BE);
+  telemetry_set_layout(1, TELEM_LAYOUT_F32BE);
+  telemetry_set_layout(2, TELEM_LAYOUT_F32LE);
+  telemetry_set_layout(3, TELEM_LAYOUT_U8);
+  ble_init();
+  while (!Bluefruit.connected()) delay(1);
+  delay(300);   // every sensor has a sample; the link is negotiated
+  telemetry_send_snapshot();   // the catalog goes out once, outside the timing
+  snapshot_phase();
+  live_phase();
+}
+
+/* ---- driver ---- */
+static char self_path[256];
+
+static int run_phase(bool first) {
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "BENCH_PHASE=run '%s' 2>&1", self_path);
+  FILE *p = popen(cmd, "r");
+  if (!p) return -1;
+  char line[1024];
+  int n = 0;
+  while (fgets(line, sizeof(line), p)) {
+    if (strncmp(line, "BENCH_JSON ", 11) != 0) continue;
+    line[strcspn(line, "\n")] = 0;
+    printf("%s\n    %s", (first && n == 0) ? "" : ",", line + 11);
+    n++;
+  }
+  pclose(p);
+  return n;
+}
+
+void setup() {
+  if (getenv("BENCH_PHASE")) {
+    phase_run();
+    // Tasks are still running; skip static destructors under their feet
+    fflush(stdout);
+    _exit(0);
+  }
+
+  ssize_t n = readlink("/proc/self/exe", self_path, sizeof(self_path) - 1);
+  if (n <= 0) {
+    printf("can't find this program's path\n");
+    exit(1);
+  }
+  self_path[n] = 0;
+
+  char ble[256];
+  snprintf(ble, sizeof(ble), "%s/telemetry_bench_ble.bin", getenv("BENCH_DIR") ? getenv("BENCH_DIR") : "/tmp");
+  // CPU and byte counts, not airtime: no link model, notifications go straight out
+  setenv("HOST_BLE_OUT", ble, 1);
+  setenv("HOST_BLE_CONNECT_MS", "0", 1);
+  setenv("HOST_BLE_CONN_INTERVAL_US", "0", 1);
+  printf("{\n  \"bench\": \"telemetry\",\n  \"results\": [");
+  static const char *centrals[][3] = { { "23", "27", "1" }, { "247", "251", "2" } };   // MTU, DLE, PHY
+  for (size_t i = 0; i < sizeof(centrals) / sizeof(centrals[0]); ++i) {
+    unlink(ble);
+    setenv("HOST_BLE_MTU", centrals[i][0], 1);
+    setenv("HOST_BLE_DLE", centrals[i][1], 1);
+    setenv("HOST_BLE_PHY", centrals[i][2], 1);
+    run_phase(i == 0);
+  }
+  printf("\n  ]\n}\n");
+  unlink(ble);
+  fflush(stdout);
+  _exit(0);
+}
+
+void loop() {}
@@ -0,0 +1,72 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Runtime configuration kept in flash.
+ * Every tunable keeps its compile-time value as the default; the store only
+ * holds overrides, so an empty store behaves like the old firmware. Values
+ * live in RAM after config_init() (one sector read), getters never touch
+ * flash and are cheap enough to call per sample. A set appends one 8-byte
+ * entry, programmed before its commit byte, so an update is all or
+ * nothing; see config_store.cpp for the format and wear figures.
+ *
+ * Rate keys: a sensor main.cpp hands to the rate governor (temp, SpO2,
+ * SpO2 #2, IMU) takes its key as the governor's max_hz, the rate it runs at
+ * on activity, with min_hz capped below it (rate_governor_set_bounds); a
+ * reset key restores the built-in rule. The other sensors take the key as
+ * their fixed rate.
+ *
+ * Key ids are stored on flash: append new keys, never renumber. */
+typedef enum {
+    CFG_TEMP_HZ        = 0,    // sensor rates (sensor_register_ex freq_hz), above
+    CFG_SPO2_HZ        = 1,
+    CFG_SPO2_2_HZ      = 2,
+    CFG_SPO2_FUSION_HZ = 3,
+    CFG_IMU_HZ         = 4,
+    CFG_MIC_HZ         = 5,
+    CFG_BATTERY_HZ     = 6,
+    CFG_SPO2_WINDOW    = 7,    // i32 samples per SpO2 window (Num)
+    CFG_SPO2_DC_IIR    = 8,    // DC IIR factor (frate)
+    CFG_SPO2_SMOOTH    = 9,    // SpO2 smoothing (FSpO2)
+    CFG_MIC_MIN_HZ     = 10,   // mic tone detector band and magnitude gate
+    CFG_MIC_MAX_HZ     = 11,
+    CFG_MIC_MIN_MAG    = 12,
+    CFG_MIC_MAX_MAG    = 13,
+    CFG_TEMP_OFFSET_C  = 14,   // added after scaling (TEMP_OFFSET_C)
+    CFG_FLUSH_WATERMARK = 15,  // i32 RAM batch bytes (STORAGE_FLUSH_WATERMARK)
+    CONFIG_KEY_COUNT
+} config_key_t;
+
+typedef enum {
+    CFG_NONE = 0,   // no override
+    CFG_I32  = 1,
+    CFG_F32  = 2
+} config_type_t;
+
+#define CONFIG_MAX_SUBSCRIBERS 12
+
+/* Load overrides from flash. False if flash is unavailable: getters then
+ * return their defaults and sets only last until reboot. */
+bool config_init(void);
+
+/* The override for key, or def if it has none (or holds the other type) */
+int32_t config_get_i32(config_key_t key, int32_t def);
+float config_get_f32(config_key_t key, float def);
+bool config_has(config_key_t key);
+
+/* Store an override and notify the key's subscribers. Setting the value
+ * a key already holds writes nothing. False for a value of the other type
+ * or outside the key's range (config_store.cpp), and then nothing changes. */
+bool config_set_i32(config_key_t key, int32_t value);
+bool config_set_f32(config_key_t key, float value);
+bool config_reset(config_key_t key);   // back to the default
+/* The set a type says: CFG_NONE resets, value holds the i32 or f32 bits */
+bool config_set_typed(config_key_t key, config_type_t type, uint32_t value);
+
+/* cb(ctx, key) runs in the setting task after each change of key */
+typedef void (*config_cb_t)(void *ctx, config_key_t key);
+bool config_subscribe(config_key_t key, config_cb_t cb, void *ctx);
+
+#endif /* CONFIG_STORE_H */
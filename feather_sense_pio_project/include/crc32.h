@@ -0,0 +1,13 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* CRC-32 (IEEE 802.3, as zlib/Python's zlib.crc32): start with crc = 0 and
+ * feed the data in any number of pieces. Table-driven, one byte per step:
+ * the nRF52840 has no CRC unit for arbitrary data (the radio's only covers
+ * its own packets) and the Cortex-M4 has no CRC instructions. */
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len);
+
+#endif /* CRC32_H */
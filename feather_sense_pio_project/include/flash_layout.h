@@ -0,0 +1,37 @@
+#ifndef FLASH_LAYOUT_H
+#define FLASH_LAYOUT_H
+
+/* QSPI flash map, in whole 4 KB sectors, each region right after the last:
+ *   log      FLASH_LOG_BASE      512 KB sector ring (storage.cpp)
+ *   meta     FLASH_META_BASE     upload ack cursor (storage.cpp)
+ *   config   FLASH_CONFIG_BASE   runtime config store (config_store.cpp)
+ *   summary  FLASH_SUMMARY_BASE  per-minute summary ring (storage.cpp)
+ * Addresses are on flash: moving a region orphans what is already there. */
+
+#define FLASH_CHIP_BYTES        (2u * 1024u * 1024u)   // Feather Sense QSPI part
+#define FLASH_LAYOUT_SECTOR     4096u                  // FLASH_SECTOR_SIZE
+
+#define FLASH_LOG_BASE          0u
+#define FLASH_LOG_MAX_BYTES     (512u * 1024u)
+
+#define FLASH_META_BASE         (FLASH_LOG_BASE + FLASH_LOG_MAX_BYTES)
+#define FLASH_META_SECTORS      2u
+
+#define FLASH_CONFIG_BASE       (FLASH_META_BASE + FLASH_META_SECTORS * FLASH_LAYOUT_SECTOR)
+#define FLASH_CONFIG_SECTORS    2u
+
+#ifndef STORAGE_SUMMARY_SECTORS
+#define STORAGE_SUMMARY_SECTORS 128   // 512 KB
+#endif
+#define FLASH_SUMMARY_BASE      (FLASH_CONFIG_BASE + FLASH_CONFIG_SECTORS * FLASH_LAYOUT_SECTOR)
+#define FLASH_SUMMARY_BYTES     (STORAGE_SUMMARY_SECTORS * FLASH_LAYOUT_SECTOR)
+
+static_assert(FLASH_LOG_MAX_BYTES % FLASH_LAYOUT_SECTOR == 0, "log region must be whole sectors");
+static_assert(FLASH_LOG_BASE + FLASH_LOG_MAX_BYTES <= FLASH_META_BASE, "log overlaps the cursor");
+static_assert(FLASH_META_BASE + FLASH_META_SECTORS * FLASH_LAYOUT_SECTOR <= FLASH_CONFIG_BASE,
+              "cursor overlaps the config store");
+static_assert(FLASH_CONFIG_BASE + FLASH_CONFIG_SECTORS * FLASH_LAYOUT_SECTOR <= FLASH_SUMMARY_BASE,
+              "config store overlaps the summaries");
+static_assert(FLASH_SUMMARY_BASE + FLASH_SUMMARY_BYTES <= FLASH_CHIP_BYTES, "summaries run off the chip");
+
+#endif /* FLASH_LAYOUT_H */
@@ -39,4 +39,7 @@ extern float a1, a2;
 
 float process_two_stage(float in);
 
+// Sensor-manager index to notify from the PDM callback (-1 = none)
+void mic_set_notify_sensor(int idx);
+
 void do_fft_on_shorts_inplace(const int16_t *pcm_shorts);
\ No newline at end of file
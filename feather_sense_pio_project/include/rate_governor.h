@@ -0,0 +1,75 @@
+#ifndef RATE_GOVERNOR_H
+#define RATE_GOVERNOR_H
+
+#include "sensor_manager.h"
+
+/* Adaptive sampling rates.
+ * A low-priority task polls each governed sensor every RATE_GOV_PERIOD_MS,
+ * drains the samples it took since the last poll (its own cursor on the
+ * sensor's queue, see sensor_attach_queue), scores each against the one
+ * before it and steps the rule once per sample. The resulting rate is set
+ * with sensor_set_freq() at the end of the poll:
+ *   metric >= raise_above            -> jump straight to max_hz
+ *   metric <= lower_below, calm_evals
+ *   times in a row                   -> rate *= step_down (not below min_hz)
+ * Fast attack / slow release, so a burst of activity is caught at full rate
+ * and a still night decays to the floor. */
+
+#define RATE_GOV_MAX        8
+#define RATE_GOV_PREV_BYTES 32   // governed sensors' payload limit
+#define RATE_GOV_PERIOD_MS  250  // default poll period
+
+/* Change score between two consecutive samples (same sensor, same len) */
+typedef float (*rate_metric_cb)(const uint8_t *prev, const uint8_t *cur, size_t len, void *ctx);
+
+typedef struct {
+    float min_hz;
+    float max_hz;
+    float raise_above;     // metric that counts as activity
+    float lower_below;     // metric that counts as calm
+    float step_down;       // 0 < step_down < 1
+    uint16_t calm_evals;   // consecutive calm samples before each step down
+} rate_rule_t;
+
+/* Decision state for one sensor, kept apart from the task so the same
+ * step function can be replayed over recorded traces */
+typedef struct {
+    uint16_t calm;
+    uint32_t raises;
+    uint32_t lowers;
+} rate_state_t;
+
+/* New rate for a sensor currently at cur_hz given one metric value */
+float rate_governor_step(const rate_rule_t *r, rate_state_t *st, float metric, float cur_hz);
+
+/* Govern sensor idx. Payload must be <= RATE_GOV_PREV_BYTES. Its queue is
+ * attached (deep enough for a poll at max_hz) on the task's first poll; if
+ * the sample pool can't spare it, only the latest sample per poll is seen.
+ * Returns false if the table is full or the arguments are bad. */
+bool rate_governor_add(int sensor_idx, rate_metric_cb metric, void *ctx, const rate_rule_t *rule);
+
+/* Move a governed sensor's min_hz/max_hz live (e.g. from its config rate
+ * key); 0 for either means the value rate_governor_add() was given, and
+ * min_hz is capped at max_hz. A sensor at the old max_hz moves to the new
+ * one, otherwise its rate is clamped into range. Its queue was sized for the
+ * first max_hz: raised much past that, a poll may skip samples (counted as
+ * queue overruns). False if sensor_idx isn't governed or a bound is < 0. */
+bool rate_governor_set_bounds(int sensor_idx, float min_hz, float max_hz);
+
+/* Start the governor task; it polls every sensor each period_ms
+ * (0: RATE_GOV_PERIOD_MS) */
+BaseType_t rate_governor_start(UBaseType_t priority, uint16_t stack_words, TickType_t period_ms);
+
+bool rate_governor_get_state(int sensor_idx, rate_state_t *out);
+
+/* Rules for this project's sensors (main.cpp, bench/governor_bench.cpp) */
+extern const rate_rule_t rate_rule_temp;   // C per sample
+extern const rate_rule_t rate_rule_imu;    // degrees per sample
+extern const rate_rule_t rate_rule_spo2;   // % SpO2 drop per sample
+
+/* Metrics for the payloads in this project */
+float rate_metric_temp(const uint8_t *prev, const uint8_t *cur, size_t len, void *ctx);       // |delta| in C
+float rate_metric_imu(const uint8_t *prev, const uint8_t *cur, size_t len, void *ctx);        // max |delta| angle in degrees
+float rate_metric_spo2_drop(const uint8_t *prev, const uint8_t *cur, size_t len, void *ctx);  // ESpO2 fall in %, 0 when rising
+
+#endif /* RATE_GOVERNOR_H */
@@ -0,0 +1,118 @@
+#ifndef RECORD_CODEC_H
+#define RECORD_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Compact record codec for the flash log.
+ * Records are coded in blocks (one flash batch each). A block starts from a
+ * base timestamp and empty per-sensor state, so every block decodes on its
+ * own. Each record is:
+ *   tag  u8       codec << 5 | sensor_idx
+ *   dt   varint   zigzag ms since the previous record in the block
+ *                 (the first one: since the block base timestamp)
+ *   len  u8       raw payload bytes
+ *   body          per codec, below
+ *   chk  u8       low byte of the CRC-32 of tag..body, so a decoder can
+ *                 tell where a damaged block stops making sense
+ * Codecs work on the payload as up to RECORD_CODEC_MAX_VALUES fixed-width
+ * values. Each value is coded against the same value in the sensor's
+ * previous record in the block (0 for the first one):
+ *   RAW        len bytes as-is
+ *   U8_DELTA   zigzag varint of each byte's delta
+ *   I16BE_DELTA zigzag varint of each big-endian int16's delta
+ *   F32BE_XOR / F32LE_XOR  Gorilla XOR of each float, bit-packed MSB first
+ *              and padded to a byte at the end of the record:
+ *              '0' same value; '10' + bits inside the previous window;
+ *              '11' + lead(5) + sig-1(5) + sig bits, which opens a new window
+ * Payloads that don't split into whole values, or have too many, are coded
+ * RAW whatever codec the sensor asked for.
+ *
+ * Payloads over RECORD_CODEC_SHORT_MAX bytes (mic buffers, PPG windows, IMU
+ * bursts) go in long records, raw, split into parts when a block runs out
+ * of room; each part sits in its own block, in order:
+ *   tag   u8      RECORD_CODEC_TAG_LONG << 5 | sensor_idx
+ *   dt    varint  as above; a part that opens a block has the record's ts
+ *                 as the block base, so every part carries the same ts
+ *   total varint  whole payload bytes
+ *   off   varint  where this part starts in the payload
+ *   n     varint  bytes in this part
+ *   chk   u8      low byte of the CRC-32 of tag..n, header only, so a
+ *                 reader can step over the body unread; the batch CRC
+ *                 covers the body
+ *   body          n payload bytes */
+
+#define RECORD_CODEC_MAX_SENSORS  32   // sensor_idx must fit the 5-bit tag
+#define RECORD_CODEC_MAX_VALUES   8
+/* Worst case coded size of a record with len payload bytes */
+#define RECORD_CODEC_MAX_BYTES(len)  (8 + 2 * (size_t)(len))
+#define RECORD_CODEC_SHORT_MAX    255  // longest payload of a coded record
+#define RECORD_CODEC_TAG_LONG     7    // tag codec field of a long record part
+/* Long record part header, worst case: tag, dt, 3 x 16-bit varint, chk */
+#define RECORD_CODEC_LONG_HDR_MAX 16
+
+typedef enum {
+    RECORD_CODEC_RAW = 0,
+    RECORD_CODEC_U8_DELTA,
+    RECORD_CODEC_I16BE_DELTA,
+    RECORD_CODEC_F32BE_XOR,
+    RECORD_CODEC_F32LE_XOR,
+    RECORD_CODEC_COUNT
+} record_codec_t;
+
+typedef struct {
+    uint32_t prev[RECORD_CODEC_MAX_VALUES];
+    uint8_t lead[RECORD_CODEC_MAX_VALUES];    // XOR window; 0xFF = none yet
+    uint8_t trail[RECORD_CODEC_MAX_VALUES];
+} record_codec_slot_t;
+
+/* Per-block coder state; the same struct drives the encoder and decoder */
+typedef struct {
+    uint32_t last_ts;
+    uint32_t live;                            // bit per sensor with slot state
+    record_codec_slot_t slot[RECORD_CODEC_MAX_SENSORS];
+} record_codec_block_t;
+
+void record_codec_block_begin(record_codec_block_t *b, uint32_t base_ts);
+
+/* Code one record into out[0..cap). Returns bytes written, or 0 if it
+ * doesn't fit or sensor_idx is out of range; the block state is then
+ * unchanged, so the caller can start a new block and retry. */
+size_t record_codec_encode(record_codec_block_t *b, record_codec_t codec, uint8_t sensor_idx,
+                           uint32_t ts, const uint8_t *payload, uint8_t len,
+                           uint8_t *out, size_t cap);
+
+/* Decode one record from in[0..avail) into payload (at least 255 bytes).
+ * Returns bytes consumed, 0 if the record is malformed, truncated or fails
+ * its check byte. Long record parts (record_codec_is_long) return 0 here;
+ * they go to record_codec_decode_part. */
+size_t record_codec_decode(record_codec_block_t *b, const uint8_t *in, size_t avail,
+                           uint8_t *sensor_idx, uint32_t *ts, uint8_t *payload, uint8_t *len);
+
+/* One part of a long record; body points into the decoded block */
+typedef struct {
+    uint8_t sensor_idx;
+    uint32_t ts;
+    uint16_t total;
+    uint16_t off;
+    uint16_t len;
+    const uint8_t *body;
+} record_codec_part_t;
+
+static inline bool record_codec_is_long(uint8_t tag) {
+    return (tag >> 5) == RECORD_CODEC_TAG_LONG;
+}
+
+/* Code payload[off..off+len) of a total-byte payload as one long record
+ * part. Returns bytes written, or 0 as record_codec_encode. */
+size_t record_codec_encode_part(record_codec_block_t *b, uint8_t sensor_idx, uint32_t ts,
+                                const uint8_t *payload, uint16_t total, uint16_t off, uint16_t len,
+                                uint8_t *out, size_t cap);
+
+/* Decode a long record part's header from in[0..avail). Returns the part's
+ * bytes, body included, without reading the body; 0 if in[0] is not a long
+ * record or the header is malformed or fails its check byte. */
+size_t record_codec_decode_part(record_codec_block_t *b, const uint8_t *in, size_t avail,
+                                record_codec_part_t *out);
+
+#endif /* RECORD_CODEC_H */
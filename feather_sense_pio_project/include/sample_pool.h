@@ -0,0 +1,40 @@
+#ifndef SAMPLE_POOL_H
+#define SAMPLE_POOL_H
+
+#include "sensor_manager.h"
+
+/* Fixed-block pool for sample records.
+ * A record is a sensor_data_t header followed by only as many payload bytes
+ * as the sensor declared, so a 2-byte temperature sample costs a small block
+ * instead of a full SENSOR_DATA_BYTES struct. Requests are served from the
+ * smallest size class that fits; alloc/free only touch a free list. */
+
+#define SAMPLE_POOL_SMALL_PAYLOAD    32
+#define SAMPLE_POOL_SMALL_COUNT      32
+#define SAMPLE_POOL_MEDIUM_PAYLOAD   128
+#define SAMPLE_POOL_MEDIUM_COUNT     8
+#define SAMPLE_POOL_LARGE_PAYLOAD    SENSOR_DATA_BYTES
+#define SAMPLE_POOL_LARGE_COUNT      4
+
+#define SAMPLE_POOL_CLASSES          3
+
+typedef struct {
+    uint16_t payload;     // largest payload a block of this class holds
+    uint16_t count;       // blocks in the class
+    uint16_t in_use;
+    uint16_t high_water;
+    uint32_t failures;    // allocations that found the class empty
+} sample_pool_class_stats_t;
+
+void sample_pool_init(void);
+
+/* Allocate a record able to hold max_payload bytes (cap = max_payload, len = 0).
+ * Returns NULL if max_payload is too large or the class is exhausted. */
+sensor_data_t *sample_pool_alloc(size_t max_payload);
+void sample_pool_free(sensor_data_t *rec);
+
+/* Total bytes reserved for the pool arena */
+size_t sample_pool_arena_bytes(void);
+bool sample_pool_class_stats(int cls, sample_pool_class_stats_t *out);
+
+#endif /* SAMPLE_POOL_H */
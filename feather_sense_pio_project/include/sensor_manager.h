@@ -11,21 +11,84 @@
 #include <Adafruit_TinyUSB.h>
 
 
+/* Hot-path instrumentation (read/bus-wait latency, deadline misses).
+ * Build with -DSENSOR_INSTRUMENT=0 to compile it out of the sampling path;
+ * the query functions below then report nothing. */
+#ifndef SENSOR_INSTRUMENT
+#define SENSOR_INSTRUMENT 1
+#endif
+
 #define SENSOR_NAME_MAX    24
 #define SENSOR_DATA_BYTES  1024 //Used to be 64 (1024 to accomdate max mic buffer)
 
+/* Sample record. Records handed to read/print callbacks live in pool blocks
+ * sized for the sensor's declared payload, so only bytes[0..cap) exist:
+ * never memset/copy sizeof(sensor_data_t) through a callback pointer.
+ * Callers of sensor_get_last() still pass a full-size sensor_data_t. */
 typedef struct {
-    uint8_t bytes[SENSOR_DATA_BYTES];
     size_t len;
     TickType_t timestamp;
+    uint16_t cap;                      // usable payload bytes in this record
+    uint8_t bytes[SENSOR_DATA_BYTES];
 } sensor_data_t;
 
+/* Bytes needed for a record carrying n payload bytes */
+#define SENSOR_RECORD_BYTES(n)  (offsetof(sensor_data_t, bytes) + (n))
+
 /* sensor callbacks expected by manager */
 typedef bool (*sensor_init_cb)(void *ctx);
 typedef bool (*sensor_read_cb)(void *ctx, sensor_data_t *out);
 typedef void (*sensor_print_cb)(void *ctx, const sensor_data_t *d);
 
-/* Register a sensor. Returns index or -1 on error. */
+/* Scheduling modes.
+ * SENSOR_SCHED_PER_TASK:   every sensor gets its own task (original behaviour).
+ * SENSOR_SCHED_DISPATCHER: one dispatcher task runs all sensors from a
+ *                          deadline-ordered timer queue; only sensors registered
+ *                          with SENSOR_FLAG_OWN_TASK get a dedicated task. */
+typedef enum {
+    SENSOR_SCHED_PER_TASK = 0,
+    SENSOR_SCHED_DISPATCHER
+} sensor_sched_mode_t;
+
+/* Hardware buses. Each bus has its own lock, so sensors on different buses
+ * never wait on each other. */
+typedef enum {
+    SENSOR_BUS_WIRE = 0,   // Wire: temp, IMU, MAX30105 #1
+    SENSOR_BUS_WIRE1,      // Wire1 (pins 12/13): MAX30105 #2
+    SENSOR_BUS_PDM,        // PDM microphone
+    SENSOR_BUS_ADC,        // SAADC (battery)
+    SENSOR_BUS_COUNT
+} sensor_bus_t;
+
+/* Registration flags */
+#define SENSOR_FLAG_OWN_TASK   (1u << 0)  /* always run in a dedicated task */
+/* Sample when notified (sensor_notify*, sensor_attach_irq). The period from
+ * freq_hz is only a fallback timeout; freq 0 means events only. */
+#define SENSOR_FLAG_EVENT      (1u << 1)
+/* Buses read() touches; the manager holds their locks around read().
+ * Sensors that only snapshot module globals declare none. */
+#define SENSOR_FLAG_BUS(b)     (1u << (8 + (b)))
+#define SENSOR_FLAG_BUS_MASK   (0xFFu << 8)
+
+/* Sinks: where each successful sample is routed, chosen per sensor with
+ * SENSOR_FLAG_SINK() at registration or sensor_set_sinks() later. A sensor
+ * with no sink bits pays one mask test per sample. */
+typedef enum {
+    SENSOR_SINK_FLASH = 0,   // storage RAM batch -> flash log
+    SENSOR_SINK_BLE,         // live stream over the BLE UART
+    SENSOR_SINK_SERIAL,      // live stream over USB serial
+    SENSOR_SINK_COUNT
+} sensor_sink_t;
+
+#define SENSOR_FLAG_SINK(k)    (1u << (16 + (k)))
+#define SENSOR_FLAG_SINK_MASK  (0xFFu << 16)
+
+/* Sink handler. Runs in the sampling task right after the sample is
+ * published (bus already released), so it must not block: copy and defer. */
+typedef void (*sensor_sink_cb)(void *ctx, int idx, const sensor_data_t *d);
+
+/* Register a sensor. Returns index or -1 on error.
+ * The sensor is assumed to use the Wire bus. */
 int sensor_register(const char *name,
                     sensor_init_cb init_cb,
                     sensor_read_cb read_cb,
@@ -34,31 +97,117 @@ int sensor_register(const char *name,
                     float initial_freq_hz,
                     bool start_enabled);
 
-/* Control */
+/* Same as sensor_register() with the largest payload the read callback will
+ * produce (<= SENSOR_DATA_BYTES) and SENSOR_FLAG_* options.
+ * sensor_register() reserves SENSOR_DATA_BYTES. */
+int sensor_register_ex(const char *name,
+                       sensor_init_cb init_cb,
+                       sensor_read_cb read_cb,
+                       sensor_print_cb print_cb,
+                       void *ctx,
+                       float initial_freq_hz,
+                       bool start_enabled,
+                       size_t max_payload,
+                       uint32_t flags);
+
+/* Control. Periods are whole ticks: rates above SENSOR_FREQ_MAX_HZ run at
+ * one tick, below SENSOR_FREQ_MIN_HZ the period would overflow. */
+#define SENSOR_FREQ_MIN_HZ 0.001f
+#define SENSOR_FREQ_MAX_HZ 1000.0f
 void sensor_enable(int idx);
 void sensor_disable(int idx);
-void sensor_set_freq(int idx, float freq_hz);
+void sensor_set_freq(int idx, float freq_hz);   // next sample at the last one + the new period
+float sensor_get_freq(int idx);   // 0 if idx is bad or the sensor is event-only
+const char *sensor_get_name(int idx);   // NULL if idx is bad
+
+/* Sink routing */
+bool sensor_sink_register(sensor_sink_t sink, sensor_sink_cb cb, void *ctx);
+bool sensor_set_sinks(int idx, uint32_t sink_flags);   // SENSOR_FLAG_SINK() bits
+uint32_t sensor_get_sinks(int idx);
+
+/* Event-driven acquisition (SENSOR_FLAG_EVENT sensors; ignored otherwise) */
+void sensor_notify(int idx);
+void sensor_notify_from_isr(int idx, BaseType_t *higher_prio_woken);
+/* Route a GPIO interrupt (e.g. MAX30105/BNO08x INT, active low -> FALLING)
+ * to sensor_notify_from_isr(idx). Up to SENSOR_IRQ_MAX pins. */
+#define SENSOR_IRQ_MAX 4
+bool sensor_attach_irq(int idx, int pin, int mode);
 
 /* Query / print */
 void print_all_sensors(void);
 bool sensor_get_last(int idx, sensor_data_t *out);
 
-/* Initialization */
+/* Multi-sample access: attach a ring of depth samples to a sensor so
+ * consumers see every successful sample, not just the latest.
+ * See sensor_queue.h for the consumer API. */
+struct sensor_queue_s;
+bool sensor_attach_queue(int idx, uint16_t depth);
+struct sensor_queue_s *sensor_get_queue(int idx);
+
+/* Initialization. sensor_manager_init() keeps the one-task-per-sensor mode. */
 bool sensor_manager_init(void);
+bool sensor_manager_init_mode(sensor_sched_mode_t mode);
 
 /* Create a periodic printer task (optional convenience) */
 BaseType_t create_sensor_printer_task(UBaseType_t priority, uint16_t stack_words, TickType_t period_ms);
 
+typedef struct {
+    uint32_t locks;             // successful acquisitions
+    uint32_t contended;         // acquisitions that found the bus busy
+    uint32_t timeouts;          // gave up waiting
+    uint32_t wait_ticks_total;  // ticks spent waiting (contended only)
+    uint32_t wait_ticks_max;
+} sensor_bus_stats_t;
+
+/* Per-sensor instrumentation. Latencies are in cycles of the DWT cycle
+ * counter (wall clock, so preemption counts), see sensor_stats_cycles_per_us().
+ * Histogram bucket b counts latencies in [2^b, 2^(b+1)) cycles; bucket 0
+ * also holds 0 and the last bucket everything above. Counts saturate. */
+#define SENSOR_HIST_BUCKETS 24
+
+typedef struct {
+    uint32_t samples;           // reads attempted with the bus held
+    uint32_t missed_periods;    // whole periods a timed sample ran late by
+    uint32_t max_jitter_ticks;  // worst lateness vs deadline (or vs notify, for events)
+    uint32_t read_cycles_max;
+    uint32_t bus_wait_cycles_max;
+    uint16_t read_hist[SENSOR_HIST_BUCKETS];
+    uint16_t bus_wait_hist[SENSOR_HIST_BUCKETS];
+} sensor_stats_t;
+
+/* Consistent copy of one sensor's counters. False if idx is bad or
+ * instrumentation is compiled out. */
+bool sensor_stats_snapshot(int idx, sensor_stats_t *out);
+/* Clear one sensor's counters, or every sensor's with idx < 0 */
+void sensor_stats_reset(int idx);
+uint32_t sensor_stats_cycles_per_us(void);
+
+/* Compact little-endian dump of every sensor's counters:
+ *   header: 'S' 'I' version(1) sensor_count(u8) cycles_per_us(u16) tick_hz(u16)
+ *   per sensor: idx(u8) samples missed_periods max_jitter_ticks
+ *               read_cycles_max bus_wait_cycles_max (u32 each)
+ *               read bucket bitmap(u32) + u16 count per set bit,
+ *               bus-wait bucket bitmap(u32) + u16 count per set bit
+ * Sensors that don't fit in cap are left out (sensor_count says how many
+ * follow). Returns bytes written, 0 if even the header doesn't fit. */
+#define SENSOR_STATS_DUMP_VERSION 1
+size_t sensor_stats_dump(uint8_t *buf, size_t cap);
+/* Stream the same dump to Serial and/or the BLE UART */
+void sensor_stats_send(bool to_serial, bool to_ble);
+
 // sensor_manager.h
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Acquire the I2C/sensor bus mutex (timeout in ms). Returns true if acquired.
-bool sensor_bus_lock(TickType_t timeout_ms);
+// Acquire one bus's mutex (timeout in ms). Returns true if acquired.
+bool sensor_bus_lock(sensor_bus_t bus, uint32_t timeout_ms);
+
+// Release one bus's mutex.
+void sensor_bus_unlock(sensor_bus_t bus);
 
-// Release the I2C/sensor bus mutex.
-void sensor_bus_unlock(void);
+// Copy the lock-wait counters for one bus.
+bool sensor_bus_get_stats(sensor_bus_t bus, sensor_bus_stats_t *out);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,42 @@
+#ifndef SENSOR_QUEUE_H
+#define SENSOR_QUEUE_H
+
+#include "sensor_manager.h"
+
+/* Single-producer / multi-consumer sample ring.
+ * The sensor's sampler pushes every sample; each consumer (storage, BLE,
+ * fusion...) owns a read cursor and drains at its own rate. A consumer that
+ * falls more than depth-1 samples behind skips the oldest ones and has them
+ * counted as overruns. Neither side disables interrupts or blocks the other;
+ * a consumer only retries a copy if the producer lapped it meanwhile.
+ * Slots are pool blocks sized for the sensor's max payload. */
+
+#define SENSOR_QUEUE_MAX          8    // queues in the system
+#define SENSOR_QUEUE_MAX_DEPTH    16   // samples per queue
+#define SENSOR_QUEUE_MAX_CONSUMERS 4   // cursors per queue
+
+typedef struct sensor_queue_s sensor_queue_t;
+
+/* Create a queue holding depth records of up to max_payload bytes.
+ * Returns NULL if the pool or queue table is exhausted. */
+sensor_queue_t *sensor_queue_create(uint16_t depth, size_t max_payload);
+
+/* Producer side. Must only be called from one task per queue. */
+void sensor_queue_push(sensor_queue_t *q, const sensor_data_t *d);
+
+/* Register a consumer; it sees samples pushed from now on.
+ * Returns a consumer id or -1 if all cursors are taken. */
+int sensor_queue_subscribe(sensor_queue_t *q);
+
+/* Copy the next sample for this consumer into out (a full-size
+ * sensor_data_t). Returns false if nothing new is available. */
+bool sensor_queue_pop(sensor_queue_t *q, int consumer, sensor_data_t *out);
+
+/* Like sensor_queue_pop() but blocks until a sample arrives or timeout. */
+bool sensor_queue_wait(sensor_queue_t *q, int consumer, sensor_data_t *out, uint32_t timeout_ms);
+
+/* Samples waiting for / dropped for this consumer */
+uint32_t sensor_queue_pending(sensor_queue_t *q, int consumer);
+uint32_t sensor_queue_overruns(sensor_queue_t *q, int consumer);
+
+#endif /* SENSOR_QUEUE_H */
@@ -0,0 +1,31 @@
+#ifndef SENSOR_SINKS_H
+#define SENSOR_SINKS_H
+
+#include "sensor_manager.h"
+
+/* Standard sink handlers for the sensor manager.
+ *   SENSOR_SINK_FLASH:  storage_append_record() into the storage RAM batch.
+ *   SENSOR_SINK_BLE:    telemetry frames (telemetry.h), each sample in its
+ *                       sensor's layout, sent only while a central is connected.
+ *                       Samples share a frame until it fills a notification
+ *                       or the first one has waited SENSOR_SINK_BLE_HOLD_MS.
+ *   SENSOR_SINK_SERIAL: one text line per sample, "S,idx,ts,hex".
+ * The live sinks copy each record into a ring and a low-priority task does
+ * the slow writes, so the sampling task never waits on BLE or USB. Records
+ * that don't fit are dropped whole and counted. */
+
+#define SENSOR_SINK_RING_BYTES 2048   // per live sink
+#define SENSOR_SINK_BLE_HOLD_MS 100
+
+typedef struct {
+    uint32_t records;   // handed to the sink
+    uint32_t drops;     // flash: storage refused it (batches full, drop policy);
+                        // live sinks: ring full, or nobody connected to send to
+} sensor_sink_stats_t;
+
+/* Register all three handlers and start the live-sink task */
+bool sensor_sinks_init(UBaseType_t priority, uint16_t stack_words);
+
+bool sensor_sinks_get_stats(sensor_sink_t sink, sensor_sink_stats_t *out);
+
+#endif /* SENSOR_SINKS_H */
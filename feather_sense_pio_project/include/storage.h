@@ -3,6 +3,8 @@
 
 #include <Adafruit_SPIFlash.h>
 #include "sensor_manager.h" 
+#include "record_codec.h"
+#include "flash_layout.h"
 
 // Declare global variables (not define)
 extern Adafruit_FlashTransport_QSPI flashTransport;
@@ -16,12 +18,136 @@ bool flash_read(uint32_t addr, uint8_t *buf, size_t len);
 bool flash_write(uint32_t addr, const uint8_t *buf, size_t len);
 uint32_t flash_sector_size();
 
+/* Asynchronous programming through the "flash-wr" task: requests run in
+ * order as 256-byte page programs, and the CPU is free while the chip is
+ * busy. buf must stay valid until cb(ctx, ok) runs, from the writer task
+ * (which must not call the flash_* functions). Returns a ticket for
+ * flash_wait, 0 on bad arguments. The synchronous calls above wait for
+ * everything queued first. */
+typedef void (*flash_write_cb_t)(void *ctx, bool ok);
+uint32_t flash_write_async(uint32_t addr, const uint8_t *buf, size_t len,
+                           flash_write_cb_t cb, void *ctx);
+void flash_wait(uint32_t ticket);
+void flash_sync(void);
+
 
 // Public API from storage.cpp
+/* flush_interval is the most a record waits in RAM; flushes normally come
+ * earlier, from the watermark below */
 bool storage_init(uint32_t flush_interval, size_t ram_buf_size);
-void storage_append_record(uint8_t sensor_idx, const sensor_data_t *d);
+/* Logged with d->timestamp, the millis() it was sampled at. False if the
+ * record was refused or dropped (bad arguments, storage not started, both
+ * RAM batches full, the sensor's drop policy) */
+bool storage_append_record(uint8_t sensor_idx, const sensor_data_t *d);
 void storage_flush_now(void);
-void storage_upload_over_ble(void);
+
+/* The flush task is woken once the filling RAM batch holds this many bytes
+ * (records with their 7-byte headers). 0 or over the batch size: only when
+ * a record doesn't fit. With nothing in RAM it sleeps until a record comes. */
+#ifndef STORAGE_FLUSH_WATERMARK
+#define STORAGE_FLUSH_WATERMARK 3072
+#endif
+void storage_set_flush_watermark(size_t bytes);
 void storage_erase_all_logs(void);
 
+/* Incremental BLE upload (protocol in storage.cpp). The central acks
+ * batches; the ack cursor is kept in flash, so only unacked data is sent
+ * again, also after a disconnect or reboot. The same UART commands set
+ * runtime config keys. */
+void storage_upload_over_ble(void);                         // queue everything after the cursor; non-blocking
+void storage_upload_rx(const uint8_t *data, size_t len);    // bytes the central wrote to the UART
+bool storage_upload_cursor(uint32_t *seq, uint32_t *off);   // false if nothing was acked yet
+
+/* Sectors kept erased ahead of the log head by a low-priority task, so
+ * flushes only program. Costs that much of the oldest data once full. */
+#ifndef STORAGE_PREERASE_SECTORS
+#define STORAGE_PREERASE_SECTORS 2
+#endif
+
+/* Flash log occupancy and wear. bytes_retained is an upper bound: sealed
+ * sectors count as full. Erase counts come from the sector headers, so
+ * they persist across reboots. Flush times cover coding and queuing the
+ * writes; the programs themselves finish in the background. */
+typedef struct {
+    uint32_t sectors_total;
+    uint32_t sectors_used;
+    uint32_t oldest_seq;
+    uint32_t newest_seq;
+    uint32_t bytes_retained;
+    uint32_t erase_min;
+    uint32_t erase_max;
+    uint32_t erase_total;
+    uint32_t bytes_in;        // raw record bytes flushed (7-byte header + payload)
+    uint32_t bytes_coded;     // the same records as coded on flash
+    uint32_t preerased;       // sectors ahead of the head ready to program
+    uint32_t erase_on_demand; // sectors the flush path had to erase itself
+    uint32_t batches_corrupt; // committed batches failing their CRC (boot walk, scans)
+    uint32_t flush_us_last;
+    uint32_t flush_us_max;
+    uint32_t flushes_watermark;    // flushes by reason: batch crossed the watermark,
+    uint32_t flushes_full;         //   a record didn't fit,
+    uint32_t flushes_timer;        //   oldest record hit flush_interval,
+    uint32_t flushes_manual;       //   storage_flush_now() (uploads, callers)
+    uint32_t flush_bytes_last;     // RAM bytes written per flush
+    uint32_t flush_bytes_max;
+    uint32_t flush_bytes_total;
+    uint32_t summary_sectors;      // summary ring sectors in use
+    uint32_t sectors_summarized;   // log sectors compacted before eviction
+    uint32_t sectors_unsummarized; // evicted or erased without a summary
+} storage_log_stats_t;
+
+bool storage_get_log_stats(storage_log_stats_t *out);
+
+/* Integrity scan: re-reads every retained batch and checks its CRC,
+ * holding the log one sector at a time. Corrupt batches are the ones the
+ * BLE upload skips; a torn sector's batch chain ends in a bad header. */
+typedef struct {
+    uint32_t sectors;
+    uint32_t batches_ok;
+    uint32_t batches_corrupt;
+    uint32_t sectors_torn;
+    uint32_t bytes_scanned;   // batch bytes, headers included
+} storage_scan_t;
+
+bool storage_scan_log(storage_scan_t *out);
+
+/* Records are batched in two static RAM buffers of STORAGE_BATCH_BYTES:
+ * one fills while the flush task writes the other. When both are full a
+ * record is dropped whole and counted against its sensor. */
+#define STORAGE_BATCH_BYTES 4096
+#define STORAGE_MAX_SENSORS 20   // stats/policy slots, matches the sensor manager
+
+typedef enum {
+    STORAGE_DROP_WHEN_FULL = 0,  // drop only when both batches are full (default)
+    STORAGE_DROP_EARLY,          // while a flush is in progress, stop at 3/4 of the
+                                 // filling batch and leave the rest to other sensors
+} storage_drop_policy_t;
+
+typedef struct {
+    uint32_t records;   // appended to a RAM batch
+    uint32_t drops;     // dropped whole
+} storage_sensor_stats_t;
+
+void storage_set_drop_policy(uint8_t sensor_idx, storage_drop_policy_t policy);
+/* How a sensor's payload is coded on flash (record_codec.h); default RAW.
+ * sensor_idx must be below RECORD_CODEC_MAX_SENSORS to be logged at all. */
+void storage_set_codec(uint8_t sensor_idx, record_codec_t codec);
+bool storage_get_sensor_stats(uint8_t sensor_idx, storage_sensor_stats_t *out);
+
+/* Tiered retention: log sectors about to be reclaimed are compacted in the
+ * background into per-minute summaries per sensor (record count, min/max/
+ * mean of chosen values, an optional histogram), kept in their own flash
+ * ring of STORAGE_SUMMARY_SECTORS after the config store (flash_layout.h).
+ * At this project's rates a summary sector stands for ~8 log sectors.
+ * Format and the 'S' upload in storage.cpp. */
+#define STORAGE_SUMMARY_MAX_BINS 8
+
+/* Histogram bin of one payload; bins or more leaves it out */
+typedef uint8_t (*storage_bin_cb)(const uint8_t *payload, size_t len, void *ctx);
+
+/* What sensor_idx's summaries hold: min/max/mean of the values in
+ * value_mask (bit i = value i as its codec splits the payload) and, with
+ * bin, a histogram of bins counts. Unset sensors summarize every value. */
+bool storage_set_summary(uint8_t sensor_idx, uint8_t value_mask, uint8_t bins, storage_bin_cb bin, void *ctx);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Binary live telemetry over the BLE UART, in place of print_both() text.
+ * Frames, big endian like the flash log:
+ *   'T' 'L' version(1) len(u16) base_ts(u32)  + len bytes of samples
+ *   'T' 'C' version(1) len(u16)               + len bytes of catalog
+ * Each sample is
+ *   tag  u8      type << 5 | sensor_idx
+ *   dt   varint  zigzag ticks since the previous sample in the frame (the
+ *                first one: since base_ts); snapshots aren't in time order
+ *   n    u8      values (RAW: payload bytes, up to 255)
+ *   body         n values of the type: U8, I16 (BE) or F16 (IEEE half,
+ *                BE); RAW bytes as the sensor produced them
+ * The catalog names the sensors, one entry per registered sensor:
+ *   idx(u8) type(u8) name_len(u8) name
+ * It goes out ahead of the first frame on every connection, so a client
+ * needs no copy of the firmware's registration order. A new version may
+ * add types and frame kinds; decoders skip frames they don't know by len.
+ * Decoders: BLEStuff/telemetry.py and website/telemetry.js. */
+
+#define TELEMETRY_VERSION     1
+#define TELEMETRY_HDR_BYTES   9     // 'T' 'L' header; 'T' 'C' uses the first 5
+#define TELEMETRY_MAX_SENSORS 32    // sensor_idx must fit the 5-bit tag
+/* Worst case bytes of one sample with len payload bytes */
+#define TELEMETRY_SAMPLE_MAX(len)  (1 + 5 + 1 + (size_t)(len))
+
+typedef enum {
+    TELEM_RAW = 0,
+    TELEM_U8,
+    TELEM_I16,
+    TELEM_F16,
+    TELEM_TYPE_COUNT
+} telem_type_t;
+
+/* Payload layouts as the read callbacks produce them, and the wire type
+ * each one goes out as. Floats are halved: 3 significant digits is plenty
+ * for a live view, and the flash log keeps the full values. */
+typedef enum {
+    TELEM_LAYOUT_NONE = 0,   // not in snapshots; the BLE sink sends it RAW
+    TELEM_LAYOUT_RAW,        // RAW
+    TELEM_LAYOUT_U8,         // U8
+    TELEM_LAYOUT_I16BE,      // I16
+    TELEM_LAYOUT_F32BE,      // F16
+    TELEM_LAYOUT_F32LE,      // F16 (structs memcpy'd on the device)
+    TELEM_LAYOUT_COUNT
+} telem_layout_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;          // header included
+    uint32_t base_ts;
+    uint32_t last_ts;
+    uint16_t samples;
+} telem_frame_t;
+
+telem_type_t telem_wire_type(telem_layout_t layout);
+uint16_t telem_f16(float f);   // round to nearest even
+
+/* Sample frame building. base_ts is usually the first sample's ts. */
+void telem_frame_begin(telem_frame_t *f, uint8_t *buf, size_t cap, uint32_t base_ts);
+/* Append one sample; false if it doesn't fit (or idx/layout are bad), the
+ * frame is then unchanged. Payloads that don't split into whole values,
+ * or into more than 255, go RAW; RAW payloads over 255 bytes don't go. */
+bool telem_frame_add(telem_frame_t *f, uint8_t idx, uint32_t ts, telem_layout_t layout,
+                     const uint8_t *payload, size_t len);
+/* Fill in the header; returns the frame bytes, 0 if it holds no samples */
+size_t telem_frame_end(telem_frame_t *f);
+
+/* ---- Device side: layouts per sensor and the BLE UART ---- */
+
+bool telemetry_set_layout(int idx, telem_layout_t layout);
+telem_layout_t telemetry_get_layout(int idx);
+
+/* Send a finished frame, the catalog first if this connection hasn't had
+ * it. Nothing goes out while no central has notifications on. */
+void telemetry_send(const uint8_t *frame, size_t len);
+
+/* Frame size for a buf_bytes buffer that ends on a notification boundary:
+ * the largest multiple of the link's payload that fits */
+size_t telemetry_frame_cap(size_t buf_bytes);
+
+/* Packs samples into frames of telemetry_frame_cap() and sends each one
+ * as it fills; one packer per sending task */
+typedef struct {
+    telem_frame_t f;
+    uint8_t buf[TELEMETRY_HDR_BYTES + TELEMETRY_SAMPLE_MAX(255)];
+    bool open;
+    uint32_t opened_ms;   // millis() at the frame's first sample
+} telem_packer_t;
+
+void telemetry_pack(telem_packer_t *p, uint8_t idx, uint32_t ts, telem_layout_t layout,
+                    const uint8_t *payload, size_t len);
+void telemetry_pack_flush(telem_packer_t *p);
+
+/* The latest sample of every sensor with a layout, packed into as few
+ * notifications as the link's MTU allows (periodic printer task). Sensors
+ * with a queue (sensor_attach_queue) send every sample since the last call
+ * instead, so a rate above the printer's loses nothing. */
+void telemetry_send_snapshot(void);
+
+#endif /* TELEMETRY_H */
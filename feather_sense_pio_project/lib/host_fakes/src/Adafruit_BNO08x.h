@@ -0,0 +1,61 @@
+#ifndef HOST_ADAFRUIT_BNO08X_H
+#define HOST_ADAFRUIT_BNO08X_H
+
+/* Host BNO08x. After enableReport() one rotation vector is available per
+ * report interval, from imu.csv (real,i,j,k), else a slow synthetic roll
+ * of +-60 degrees every two minutes, like turning over in bed. */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "host_trace.h"
+
+#define BNO08x_I2CADDR_DEFAULT 0x4A
+
+typedef uint8_t sh2_SensorId_t;
+#define SH2_ROTATION_VECTOR        0x05
+#define SH2_GAME_ROTATION_VECTOR   0x08
+#define SH2_ARVR_STABILIZED_RV     0x28
+#define SH2_ARVR_STABILIZED_GRV    0x29
+
+typedef struct {
+    float i, j, k, real;
+    float accuracy;
+} sh2_RotationVectorWAcc_t;
+
+typedef struct {
+    float i, j, k, real;
+} sh2_RotationVector_t;
+
+typedef struct {
+    uint8_t sensorId;
+    uint8_t sequence;
+    uint8_t status;
+    uint64_t timestamp;
+    uint32_t delay;
+    union {
+        sh2_RotationVectorWAcc_t rotationVector;
+        sh2_RotationVectorWAcc_t arvrStabilizedRV;
+        sh2_RotationVector_t gameRotationVector;
+        sh2_RotationVector_t arvrStabilizedGRV;
+    } un;
+} sh2_SensorValue_t;
+
+class Adafruit_BNO08x {
+public:
+    explicit Adafruit_BNO08x(int8_t reset_pin = -1) { (void)reset_pin; }
+
+    bool begin_I2C(uint8_t addr = BNO08x_I2CADDR_DEFAULT, TwoWire *wire = &Wire, int32_t sensor_id = 0);
+    bool enableReport(sh2_SensorId_t id, uint32_t interval_us = 10000);
+    bool getSensorEvent(sh2_SensorValue_t *value);
+    bool wasReset(void) { return false; }
+
+private:
+    sh2_SensorId_t report = 0;
+    uint32_t interval_ms = 10;
+    uint32_t next_ms = 0;
+    uint8_t seq = 0;
+    host_trace_t trace = {};
+    bool has_trace = false;
+};
+
+#endif /* HOST_ADAFRUIT_BNO08X_H */
@@ -0,0 +1,77 @@
+#ifndef HOST_ADAFRUIT_SPIFLASH_H
+#define HOST_ADAFRUIT_SPIFLASH_H
+
+/* Host QSPI NOR flash. NOR rules apply: erase sets a 4 KB sector to 0xFF
+ * and programming can only clear bits. Backed by RAM, or by the file named
+ * in $HOST_FLASH_FILE so a log survives between runs. $HOST_FLASH_BYTES
+ * overrides the 2 MB size of the Feather Sense part. $HOST_FLASH_CUT_AFTER=N
+ * tears the Nth program/erase in half and kills the process, to check
+ * recovery from a power cut on the next run. $HOST_FLASH_ERASE_US and
+ * $HOST_FLASH_PAGE_US keep the chip busy that long per sector erase /
+ * 256-byte page program (the GD25Q16 on the board: ~45 ms and ~0.7 ms
+ * typical). $HOST_FLASH_READ_CMD_NS and $HOST_FLASH_READ_BYTE_NS make each
+ * readBuffer take that long per command and per byte (QSPI at 32 MHz on the
+ * nRF52840: a few us of command overhead, ~16 MB/s, so ~5000 and ~63).
+ * Like the real library, a command returns once issued: the
+ * next one (or waitUntilReady) waits out the busy time and readStatus()
+ * reports it, so a writer can do other work meanwhile. A multi-page
+ * writeBuffer waits for all but its last page. */
+
+#include <Arduino.h>
+
+#define HOST_FLASH_SECTOR 4096u
+
+typedef struct {
+    uint32_t sector_erases;
+    uint32_t bytes_written;
+    uint32_t bytes_read;
+    uint32_t bad_programs;   // writes that tried to set a 0 bit back to 1
+} host_flash_stats_t;
+
+class Adafruit_FlashTransport_QSPI {
+public:
+    Adafruit_FlashTransport_QSPI(void) {}
+    Adafruit_FlashTransport_QSPI(int sck, int cs, int io0, int io1, int io2, int io3) {
+        (void)sck; (void)cs; (void)io0; (void)io1; (void)io2; (void)io3;
+    }
+};
+
+class Adafruit_SPIFlash {
+public:
+    explicit Adafruit_SPIFlash(Adafruit_FlashTransport_QSPI *transport) { (void)transport; }
+
+    bool begin(void);
+    uint32_t size(void) const { return bytes; }
+    uint32_t totalSize(void) const { return bytes; }
+    uint32_t pageSize(void) const { return 256; }
+    uint32_t readBuffer(uint32_t addr, uint8_t *buf, uint32_t len);
+    uint32_t writeBuffer(uint32_t addr, const uint8_t *buf, uint32_t len);
+    bool eraseSector(uint32_t sector);
+    bool eraseChip(void);
+    void waitUntilReady(void) { wait_busy(); }
+    uint8_t readStatus(void) { return busy_left_us() > 0 ? 0x01 : 0x00; }
+
+    const host_flash_stats_t *host_stats(void) const { return &stats; }
+
+private:
+    void persist(uint32_t addr, uint32_t len);
+    uint32_t cut_len(uint32_t len);
+    void cut_now(void);
+    long busy_left_us(void) const;
+    void wait_busy(void) const;
+    void set_busy(long us);
+
+    uint8_t *mem = NULL;
+    uint32_t bytes = 0;
+    int fd = -1;
+    long cut_after = 0;
+    long erase_us = 0;
+    long page_us = 0;
+    long read_cmd_ns = 0;
+    long read_byte_ns = 0;
+    long ops = 0;
+    uint64_t busy_until_us = 0;
+    host_flash_stats_t stats = {};
+};
+
+#endif /* HOST_ADAFRUIT_SPIFLASH_H */
@@ -0,0 +1,5 @@
+#ifndef HOST_ADAFRUIT_TINYUSB_H
+#define HOST_ADAFRUIT_TINYUSB_H
+// USB CDC is just stdout on the host; nothing to declare
+#include <Arduino.h>
+#endif
@@ -0,0 +1,94 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+/* Host stand-in for the Adafruit nRF52 Arduino core: Serial goes to stdout,
+ * time comes from the FreeRTOS shim, GPIO interrupts are fired by hand
+ * with host_irq_fire(). setup()/loop() are driven by host_arduino.cpp. */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PI          3.1415926535897932384626433832795
+#define DEG_TO_RAD  0.017453292519943295769236907684886
+#define RAD_TO_DEG  57.295779513082320876798154814105
+#define sq(x)       ((x) * (x))
+
+using std::min;
+using std::max;
+
+#define LOW     0
+#define HIGH    1
+#define INPUT         0x0
+#define OUTPUT        0x1
+#define INPUT_PULLUP  0x2
+#define CHANGE   1
+#define FALLING  2
+#define RISING   3
+
+#define A6      6
+#define LEDB    4
+#define LED_BUILTIN 3
+
+#define digitalPinToInterrupt(p) (p)
+
+uint32_t millis(void);
+uint32_t micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int val);
+int digitalRead(int pin);
+int analogRead(int pin);
+void attachInterrupt(int irq, void (*cb)(void), int mode);
+void detachInterrupt(int irq);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+/* Interrupt masking is the FreeRTOS shim's critical section */
+void noInterrupts(void);
+void interrupts(void);
+
+/* Run the ISR attached to pin, as if its edge arrived. True if one was attached. */
+bool host_irq_fire(int pin);
+
+class HostSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    operator bool() const { return true; }
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+
+    size_t write(uint8_t b) { return fwrite(&b, 1, 1, stdout); }
+    size_t write(const uint8_t *b, size_t n) { return fwrite(b, 1, n, stdout); }
+    size_t write(const char *s) { return fputs(s, stdout) < 0 ? 0 : strlen(s); }
+
+    size_t print(const char *s) { return write(s); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return printf("%d", v); }
+    size_t print(unsigned int v) { return printf("%u", v); }
+    size_t print(long v) { return printf("%ld", v); }
+    size_t print(unsigned long v) { return printf("%lu", v); }
+    size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+
+    size_t println(void) { return write("\r\n"); }
+    template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HostSerial Serial;
+
+#endif /* HOST_ARDUINO_H */
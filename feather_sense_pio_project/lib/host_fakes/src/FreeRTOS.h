@@ -0,0 +1,48 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+/* Host stand-in for the FreeRTOS API subset the firmware uses.
+ * Tasks are pthreads and the tick is CLOCK_MONOTONIC in ms since start, so
+ * timings are real time. Tasks run truly in parallel rather than by priority,
+ * and critical sections are one global recursive lock that fake interrupt
+ * sources (PDM, GPIO) also hold while their "ISR" runs. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t EventBits_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef struct host_task_s *TaskHandle_t;
+typedef struct host_sem_s *SemaphoreHandle_t;
+typedef struct host_evgroup_s *EventGroupHandle_t;
+
+#define pdTRUE   ((BaseType_t)1)
+#define pdFALSE  ((BaseType_t)0)
+#define pdPASS   pdTRUE
+#define pdFAIL   pdFALSE
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+// Waking a task from a fake ISR is immediate, nothing to yield to
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+#ifdef __cplusplus
+}
+#endif
+
+#define taskENTER_CRITICAL() vPortEnterCritical()
+#define taskEXIT_CRITICAL()  vPortExitCritical()
+
+#endif /* HOST_FREERTOS_H */
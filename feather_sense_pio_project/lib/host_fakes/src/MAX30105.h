@@ -0,0 +1,55 @@
+#ifndef HOST_MAX30105_H
+#define HOST_MAX30105_H
+
+/* Host MAX30105 pulse oximeter. Samples appear in a 32-deep FIFO at
+ * sampleRate / sampleAverage, taken from spo2_0.csv (Wire) or spo2_1.csv
+ * (Wire1), else a synthetic 65 bpm PPG. The INT pin is not modelled, so
+ * SPO2_INT_PIN builds run on their fallback timeout. */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "host_trace.h"
+
+#define MAX30105_ADDRESS     0x57
+#define I2C_SPEED_STANDARD   100000
+#define I2C_SPEED_FAST       400000
+#define HOST_MAX30105_FIFO   32
+
+class MAX30105 {
+public:
+    bool begin(TwoWire &wire = Wire, uint32_t i2c_speed = I2C_SPEED_STANDARD, uint8_t addr = MAX30105_ADDRESS);
+    void setup(byte power = 0x1F, byte sample_average = 4, byte led_mode = 3,
+               int sample_rate = 400, int pulse_width = 411, int adc_range = 4096);
+
+    void setPulseAmplitudeRed(uint8_t amp) { (void)amp; }
+    void setPulseAmplitudeIR(uint8_t amp) { (void)amp; }
+    void enableDIETEMPRDY(void) {}
+    void enableAFULL(void) {}
+    void setFIFOAlmostFull(uint8_t free_slots) { (void)free_slots; }
+    uint8_t getINT1(void) { return 0; }
+    uint8_t getINT2(void) { return 0; }
+
+    uint16_t check(void);
+    uint8_t available(void) { return (uint8_t)(head - tail); }
+    uint32_t getFIFORed(void) { return red[tail % HOST_MAX30105_FIFO]; }
+    uint32_t getFIFOIR(void) { return ir[tail % HOST_MAX30105_FIFO]; }
+    void nextSample(void) { if (head != tail) tail++; }
+    uint32_t getRed(void);
+    uint32_t getIR(void);
+
+private:
+    void synth(uint32_t *r, uint32_t *i);
+
+    int bus = 0;
+    float rate_hz = 50.0f;
+    uint32_t start_ms = 0;
+    uint32_t next_ms = 0;
+    uint32_t n = 0;               // samples produced since start_ms
+    uint32_t head = 0, tail = 0;
+    uint32_t red[HOST_MAX30105_FIFO] = {};
+    uint32_t ir[HOST_MAX30105_FIFO] = {};
+    host_trace_t trace = {};
+    bool has_trace = false;
+};
+
+#endif /* HOST_MAX30105_H */
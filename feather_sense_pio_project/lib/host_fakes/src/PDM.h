@@ -0,0 +1,36 @@
+#ifndef HOST_PDM_H
+#define HOST_PDM_H
+
+/* Host PDM microphone. After begin() a thread delivers one buffer of 16-bit
+ * PCM every buffer period and calls the onReceive() callback as the PDM ISR
+ * would. Audio comes from mic.raw, else low-level synthetic noise. */
+
+#include <Arduino.h>
+#include <pthread.h>
+
+class PDMClass {
+public:
+    void setPins(int din, int clk, int pwr) { (void)din; (void)clk; (void)pwr; }
+    void onReceive(void (*cb)(void)) { on_receive = cb; }
+    void setGain(int gain) { (void)gain; }
+    void setBufferSize(int bytes);
+    int begin(int channels, int sample_rate);
+    void end(void);
+    int available(void);
+    int read(void *buf, int n);
+
+    void host_run(void);   // delivery thread body
+
+private:
+    void (*on_receive)(void) = NULL;
+    int rate = 16000;
+    int buffer_bytes = 512;   // core default
+    bool running = false;
+    pthread_t thread;
+    int16_t pcm[1024];
+    int ready = 0;            // bytes waiting in pcm
+};
+
+extern PDMClass PDM;
+
+#endif /* HOST_PDM_H */
@@ -0,0 +1,58 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+/* Host I2C buses. Devices are register-read callbacks keyed by bus and
+ * address; anything else NACKs. Built in: the temp sensor (Wire 0x48, from
+ * temp.csv) plus ACK-only MAX30105 (both buses) and BNO08x addresses, whose
+ * drivers are faked directly. Bus 0 is Wire, bus 1 is Wire1. */
+
+#include <Arduino.h>
+
+#define HOST_I2C_MAX_DEVICES 8
+
+/* Fill out[0..n) with the device's reply to a read starting at reg.
+ * Returns bytes produced. */
+typedef size_t (*host_i2c_read_fn)(uint8_t reg, uint8_t *out, size_t n);
+
+// nRF TWIM instances the firmware names in its Wire1 constructor
+#define NRF_TWIM1  ((void *)1)
+#define NRF_TWIS1  ((void *)1)
+#define PWM1_IRQn  1
+
+class TwoWire {
+public:
+    TwoWire(int bus_id = 0) : bus(bus_id) {}
+    TwoWire(void *twim, void *twis, int irq, int sda, int scl) : bus(1) {
+        (void)twim; (void)twis; (void)irq; (void)sda; (void)scl;
+    }
+
+    void begin(void) {}
+    void begin(int sda, int scl) { (void)sda; (void)scl; }
+    void setPins(int sda, int scl) { (void)sda; (void)scl; }
+    void setClock(uint32_t hz) { (void)hz; }
+
+    void beginTransmission(uint8_t addr);
+    size_t write(uint8_t b);
+    size_t write(const uint8_t *b, size_t n);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t addr, uint8_t n, bool stop = true);
+    int available(void) { return (int)(rx_len - rx_pos); }
+    int read(void) { return rx_pos < rx_len ? rx[rx_pos++] : -1; }
+
+    int host_bus(void) const { return bus; }
+
+private:
+    int bus;
+    uint8_t tx_addr = 0;
+    uint8_t reg = 0;
+    size_t tx_len = 0;
+    uint8_t rx[32] = {};
+    size_t rx_len = 0, rx_pos = 0;
+};
+
+extern TwoWire Wire;
+
+/* Attach a device model (read may be NULL for an ACK-only device) */
+bool host_i2c_attach(int bus, uint8_t addr, host_i2c_read_fn read);
+
+#endif /* HOST_WIRE_H */
@@ -0,0 +1,4 @@
+#ifndef HOST_ARDUINOFFT_H
+#define HOST_ARDUINOFFT_H
+// mic.h includes this but the firmware's FFT goes through arm_math.h
+#endif
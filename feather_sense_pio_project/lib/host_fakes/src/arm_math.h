@@ -0,0 +1,36 @@
+#ifndef HOST_ARM_MATH_H
+#define HOST_ARM_MATH_H
+
+/* Portable subset of CMSIS-DSP used by the mic pipeline. Output layouts
+ * match CMSIS (rfft: re[0], re[N/2], then re/im pairs) so results compare
+ * with the target; speed does not. */
+
+#include <stdint.h>
+#include <math.h>
+
+typedef float float32_t;
+
+typedef enum {
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1,
+} arm_status;
+
+typedef struct {
+    uint16_t fftLenRFFT;
+} arm_rfft_fast_instance_f32;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+float32_t arm_cos_f32(float32_t x);
+float32_t arm_sin_f32(float32_t x);
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen);
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut, uint8_t ifftFlag);
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_ARM_MATH_H */
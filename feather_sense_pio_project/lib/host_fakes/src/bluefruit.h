@@ -0,0 +1,147 @@
+#ifndef HOST_BLUEFRUIT_H
+#define HOST_BLUEFRUIT_H
+
+/* Host Bluefruit stack. bleuart output goes to $HOST_BLE_OUT: a file path,
+ * or tcp:PORT to stream to a listener on 127.0.0.1. A central "connects"
+ * $HOST_BLE_CONNECT_MS after advertising starts (unset = never) and the
+ * connect callback runs from its own thread. $HOST_BLE_BYTES_PER_SEC throttles
+ * writes to model link throughput (0 = unlimited). With tcp:PORT, bytes the
+ * listener sends back are central writes: they land in the bleuart RX
+ * buffer and the RX callback runs from the socket reader thread.
+ *
+ * Link model: bleuart writes become notifications of at most ATT MTU - 3
+ * bytes that wait for a slot in the HVN TX queue, as on the SoftDevice.
+ * Every $HOST_BLE_CONN_INTERVAL_US (default 15000, 0 = no model, writes go
+ * straight out) a connection event sends what fits its event length in air
+ * time at the current PHY and LL data length, then reports them with one
+ * BLE_GATTS_EVT_HVN_TX_COMPLETE. configPrphBandwidth() sets the MTU limit,
+ * event length and queue size from the Adafruit core's table. The central
+ * accepts an ATT MTU up to $HOST_BLE_MTU (247), a data length up to
+ * $HOST_BLE_DLE (251) and the 2M PHY unless $HOST_BLE_PHY is 1. */
+
+#include <Arduino.h>
+
+#define BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE 0x06
+
+#define BANDWIDTH_AUTO   0
+#define BANDWIDTH_LOW    1
+#define BANDWIDTH_NORMAL 2
+#define BANDWIDTH_HIGH   3
+#define BANDWIDTH_MAX    4
+
+#define BLE_GATT_ATT_MTU_DEFAULT 23
+#define BLE_GAP_PHY_AUTO         0x00
+#define BLE_GAP_PHY_1MBPS        0x01
+#define BLE_GAP_PHY_2MBPS        0x02
+
+// SoftDevice events, just the ids and fields the firmware reads
+#define BLE_GAP_EVT_CONNECTED         0x10
+#define BLE_GAP_EVT_DISCONNECTED      0x11
+#define BLE_GATTS_EVT_HVN_TX_COMPLETE 0x57
+
+typedef struct {
+    struct {
+        uint16_t evt_id;
+        uint16_t evt_len;
+    } header;
+    union {
+        struct {
+            uint16_t conn_handle;
+        } gap_evt;
+        struct {
+            uint16_t conn_handle;
+            union {
+                struct {
+                    uint8_t count;
+                } hvn_tx_complete;
+            } params;
+        } gatts_evt;
+    } evt;
+} ble_evt_t;
+
+typedef struct {
+    uint16_t max_tx_octets;
+    uint16_t max_rx_octets;
+    uint16_t max_tx_time_us;
+    uint16_t max_rx_time_us;
+} ble_gap_data_length_params_t;
+
+typedef struct {
+    uint16_t tx_payload_limited_octets;
+    uint16_t rx_payload_limited_octets;
+    uint16_t tx_rx_time_limited_us;
+} ble_gap_data_length_limitation_t;
+
+class BLEService {};
+
+typedef void (*rx_callback_t)(uint16_t conn_hdl);
+
+class BLEUart : public BLEService {
+public:
+    void begin(void) {}
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t len);
+    int available(void);
+    int read(void);
+    int read(uint8_t *buf, size_t size);
+    bool notifyEnabled(void);
+    void setRxCallback(rx_callback_t fp, bool deferred = true);
+};
+
+typedef void (*ble_connect_cb_t)(uint16_t conn_handle);
+typedef void (*ble_disconnect_cb_t)(uint16_t conn_handle, uint8_t reason);
+
+// Requests settle at once, limited by the peripheral config and the central
+class BLEConnection {
+public:
+    bool requestPHY(uint8_t phy = BLE_GAP_PHY_AUTO);
+    bool requestDataLengthUpdate(ble_gap_data_length_params_t const *p_dl_params = NULL,
+                                 ble_gap_data_length_limitation_t *p_dl_limitation = NULL);
+    bool requestMtuExchange(uint16_t mtu);
+    uint16_t getMtu(void);
+    uint16_t getDataLength(void);
+    uint8_t getPHY(void);
+};
+
+class BLEPeriph {
+public:
+    void setConnectCallback(ble_connect_cb_t cb) { connect_cb = cb; }
+    void setDisconnectCallback(ble_disconnect_cb_t cb) { disconnect_cb = cb; }
+
+    ble_connect_cb_t connect_cb = NULL;
+    ble_disconnect_cb_t disconnect_cb = NULL;
+};
+
+class BLEAdvertising {
+public:
+    void stop(void) {}
+    void addFlags(uint8_t flags) { (void)flags; }
+    void addTxPower(void) {}
+    void addName(void) {}
+    void addService(BLEService &svc) { (void)svc; }
+    void restartOnDisconnect(bool on) { (void)on; }
+    void setInterval(uint16_t fast, uint16_t slow) { (void)fast; (void)slow; }
+    void setFastTimeout(uint16_t sec) { (void)sec; }
+    bool start(uint16_t timeout);
+};
+
+class AdafruitBluefruit {
+public:
+    BLEPeriph Periph;
+    BLEAdvertising Advertising;
+
+    void configPrphBandwidth(uint8_t bw);
+    bool begin(uint8_t prph_count = 1, uint8_t central_count = 0);
+    void setName(const char *name) { (void)name; }
+    void setTxPower(int8_t dbm) { (void)dbm; }
+    bool connected(void);
+    uint16_t connHandle(void) { return 0; }
+    BLEConnection *Connection(uint16_t conn_hdl);
+    void setEventCallback(void (*fp)(ble_evt_t *evt)) { event_cb = fp; }
+
+    void (*event_cb)(ble_evt_t *evt) = NULL;
+};
+
+extern AdafruitBluefruit Bluefruit;
+
+#endif /* HOST_BLUEFRUIT_H */
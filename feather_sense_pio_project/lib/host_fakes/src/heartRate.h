@@ -0,0 +1,14 @@
+#ifndef HOST_HEARTRATE_H
+#define HOST_HEARTRATE_H
+
+/* Beat detector with the SparkFun library's contract: feed every IR sample,
+ * true on the sample where a beat is detected. A simpler DC-tracking
+ * zero-crossing detector than the original PBA code, good enough to drive
+ * the HR pipeline on the host. Shared state across callers, as in the
+ * original. */
+
+#include <stdint.h>
+
+bool checkForBeat(int32_t sample);
+
+#endif /* HOST_HEARTRATE_H */
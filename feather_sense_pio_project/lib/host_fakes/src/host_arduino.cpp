@@ -0,0 +1,118 @@
+// lib/host_fakes/src/host_arduino.cpp
+#include <Arduino.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include "host_trace.h"
+
+HostSerial Serial;
+
+size_t HostSerial::printf(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vprintf(fmt, ap);
+    va_end(ap);
+    return n < 0 ? 0 : (size_t)n;
+}
+
+/* ---- Time ---- */
+
+uint32_t millis(void) {
+    return (uint32_t)xTaskGetTickCount() * (1000u / configTICK_RATE_HZ);
+}
+
+uint32_t micros(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+void delay(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+void delayMicroseconds(uint32_t us) {
+    struct timespec ts = { (time_t)(us / 1000000u), (long)(us % 1000000u) * 1000 };
+    while (nanosleep(&ts, &ts) == EINTR) {}
+}
+
+void yield(void) {}
+
+/* ---- GPIO / interrupts ---- */
+
+#define HOST_PINS 64
+static void (*irq_cb[HOST_PINS])(void);
+static uint8_t pin_level[HOST_PINS];
+
+void pinMode(int pin, int mode) {
+    if (pin >= 0 && pin < HOST_PINS && mode == INPUT_PULLUP) pin_level[pin] = HIGH;
+}
+
+void digitalWrite(int pin, int val) {
+    if (pin >= 0 && pin < HOST_PINS) pin_level[pin] = val ? HIGH : LOW;
+}
+
+int digitalRead(int pin) {
+    return (pin >= 0 && pin < HOST_PINS) ? pin_level[pin] : LOW;
+}
+
+void attachInterrupt(int irq, void (*cb)(void), int mode) {
+    (void)mode;
+    if (irq >= 0 && irq < HOST_PINS) irq_cb[irq] = cb;
+}
+
+void detachInterrupt(int irq) {
+    if (irq >= 0 && irq < HOST_PINS) irq_cb[irq] = NULL;
+}
+
+bool host_irq_fire(int pin) {
+    if (pin < 0 || pin >= HOST_PINS || !irq_cb[pin]) return false;
+    // ISRs run with "interrupts" masked, so they can't interleave with critical sections
+    noInterrupts();
+    irq_cb[pin]();
+    interrupts();
+    return true;
+}
+
+void noInterrupts(void) { taskENTER_CRITICAL(); }
+void interrupts(void) { taskEXIT_CRITICAL(); }
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+/* VBAT: battery.csv, else a LiPo at ~3.8 V (raw * 2 * 3.6 / 1024) */
+int analogRead(int pin) {
+    static host_trace_t vbat;
+    static bool opened = false;
+    if (pin != A6) return 0;
+    if (!opened) {
+        host_trace_open(&vbat, "battery.csv", 1);
+        opened = true;
+    }
+    float v;
+    if (host_trace_next(&vbat, &v)) return (int)v;
+    return 540;
+}
+
+/* ---- Entry point ---- */
+
+extern void setup(void);
+extern void loop(void);
+
+/* Runs setup() then loop() like the core's loop task. HOST_RUN_MS bounds the
+ * run (0 = until killed) so benchmarks can replay a trace and exit. */
+int main(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    signal(SIGPIPE, SIG_IGN);   // a closed BLE sink socket shouldn't kill the run
+    long run_ms = host_env_long("HOST_RUN_MS", 0);
+
+    setup();
+    for (;;) {
+        loop();
+        if (run_ms > 0 && millis() >= (uint32_t)run_ms) break;
+        delay(1);
+    }
+    fflush(stdout);
+    // Tasks are still running; skip static destructors under their feet
+    _exit(0);
+}
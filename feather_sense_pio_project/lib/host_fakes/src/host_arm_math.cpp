@@ -0,0 +1,77 @@
+// lib/host_fakes/src/host_arm_math.cpp
+#include "arm_math.h"
+#include <string.h>
+#include <stdlib.h>
+
+float32_t arm_cos_f32(float32_t x) { return cosf(x); }
+float32_t arm_sin_f32(float32_t x) { return sinf(x); }
+
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen) {
+    // CMSIS supports powers of two from 32 to 4096
+    if (!S || fftLen < 32 || fftLen > 4096 || (fftLen & (fftLen - 1))) return ARM_MATH_ARGUMENT_ERROR;
+    S->fftLenRFFT = fftLen;
+    return ARM_MATH_SUCCESS;
+}
+
+/* In-place iterative radix-2 complex FFT over n points (re/im interleaved) */
+static void cfft(float *x, uint32_t n, int sign) {
+    for (uint32_t i = 1, j = 0; i < n; ++i) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float tr = x[2 * i], ti = x[2 * i + 1];
+            x[2 * i] = x[2 * j]; x[2 * i + 1] = x[2 * j + 1];
+            x[2 * j] = tr; x[2 * j + 1] = ti;
+        }
+    }
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        double ang = sign * 2.0 * M_PI / (double)len;
+        for (uint32_t i = 0; i < n; i += len) {
+            for (uint32_t k = 0; k < len / 2; ++k) {
+                float wr = (float)cos(ang * k), wi = (float)sin(ang * k);
+                float *a = &x[2 * (i + k)], *b = &x[2 * (i + k + len / 2)];
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr; b[1] = a[1] - ti;
+                a[0] += tr; a[1] += ti;
+            }
+        }
+    }
+}
+
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut, uint8_t ifftFlag) {
+    uint32_t n = S->fftLenRFFT;
+    float *buf = (float *)malloc(2 * n * sizeof(float));
+    if (!buf) return;
+
+    if (!ifftFlag) {
+        for (uint32_t i = 0; i < n; ++i) { buf[2 * i] = p[i]; buf[2 * i + 1] = 0.0f; }
+        cfft(buf, n, -1);
+        pOut[0] = buf[0];        // DC
+        pOut[1] = buf[2 * (n / 2)];  // Nyquist (real)
+        for (uint32_t k = 1; k < n / 2; ++k) {
+            pOut[2 * k] = buf[2 * k];
+            pOut[2 * k + 1] = buf[2 * k + 1];
+        }
+    } else {
+        // Rebuild the Hermitian spectrum, inverse transform, scale by 1/n like CMSIS
+        buf[0] = p[0]; buf[1] = 0.0f;
+        buf[2 * (n / 2)] = p[1]; buf[2 * (n / 2) + 1] = 0.0f;
+        for (uint32_t k = 1; k < n / 2; ++k) {
+            buf[2 * k] = p[2 * k];
+            buf[2 * k + 1] = p[2 * k + 1];
+            buf[2 * (n - k)] = p[2 * k];
+            buf[2 * (n - k) + 1] = -p[2 * k + 1];
+        }
+        cfft(buf, n, +1);
+        for (uint32_t i = 0; i < n; ++i) pOut[i] = buf[2 * i] / (float)n;
+    }
+    free(buf);
+}
+
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples) {
+    for (uint32_t i = 0; i < numSamples; ++i) {
+        pDst[i] = sqrtf(pSrc[2 * i] * pSrc[2 * i] + pSrc[2 * i + 1] * pSrc[2 * i + 1]);
+    }
+}
@@ -0,0 +1,324 @@
+// lib/host_fakes/src/host_ble.cpp
+#include <bluefruit.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "host_trace.h"
+
+AdafruitBluefruit Bluefruit;
+
+static FILE *sink_file = NULL;
+static int sink_sock = -1;
+static volatile bool link_up = false;
+static long bytes_per_sec = 0;
+
+// Peripheral config from configPrphBandwidth(); the default is NORMAL
+static uint16_t cfg_mtu_max = BLE_GATT_ATT_MTU_DEFAULT;
+static uint32_t cfg_event_us = 3 * 1250;
+static uint8_t cfg_hvn_qsize = 2;
+
+// What the current connection negotiated, and what the central allows
+static uint16_t link_mtu = BLE_GATT_ATT_MTU_DEFAULT;
+static uint16_t link_dle = 27;
+static uint8_t link_phy = BLE_GAP_PHY_1MBPS;
+static long central_mtu = 247, central_dle = 251, central_phy = 2;
+static long conn_interval_us = 0;
+static BLEConnection conn0;
+
+// HVN TX queue: a notification holds its slot from write() until the TX
+// complete of the connection event that sent it
+#define HVN_SLOTS   8
+#define HVN_PAYLOAD 244
+typedef struct {
+    uint16_t len;
+    uint8_t data[HVN_PAYLOAD];
+} hvn_t;
+static pthread_mutex_t hvn_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t hvn_cond = PTHREAD_COND_INITIALIZER;
+static hvn_t hvn_q[HVN_SLOTS];
+static uint8_t hvn_head = 0, hvn_queued = 0, hvn_used = 0;
+
+// Central -> peripheral bytes from the tcp listener
+static pthread_mutex_t rx_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t rx_ring[256];
+static size_t rx_head = 0, rx_count = 0;
+static rx_callback_t rx_cb = NULL;
+
+static void sink_open(void) {
+    const char *out = host_env("HOST_BLE_OUT");
+    if (!out) return;
+    if (strncmp(out, "tcp:", 4) == 0) {
+        struct sockaddr_in a;
+        memset(&a, 0, sizeof(a));
+        a.sin_family = AF_INET;
+        a.sin_port = htons((uint16_t)atoi(out + 4));
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        sink_sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sink_sock >= 0 && connect(sink_sock, (struct sockaddr *)&a, sizeof(a)) != 0) {
+            close(sink_sock);
+            sink_sock = -1;
+        }
+        if (sink_sock < 0) printf("host: BLE sink %s not reachable\n", out);
+    } else {
+        sink_file = fopen(out, "wb");
+        if (!sink_file) printf("host: can't open BLE sink %s\n", out);
+    }
+}
+
+static void sink_put(const uint8_t *buf, size_t len) {
+    if (sink_file) {
+        fwrite(buf, 1, len, sink_file);
+        fflush(sink_file);
+    } else if (sink_sock >= 0) {
+        send(sink_sock, buf, len, 0);
+    }
+}
+
+static void post_event(uint16_t id, uint8_t count) {
+    if (!Bluefruit.event_cb) return;
+    ble_evt_t e;
+    memset(&e, 0, sizeof(e));
+    e.header.evt_id = id;
+    e.header.evt_len = sizeof(e.evt);
+    e.evt.gatts_evt.params.hvn_tx_complete.count = count;
+    Bluefruit.event_cb(&e);
+}
+
+// Air time of one LL data PDU with len payload bytes, its empty ack from
+// the central and the two inter-frame spaces (unencrypted link)
+static uint32_t pdu_us(uint32_t len) {
+    bool fast = link_phy == BLE_GAP_PHY_2MBPS;
+    uint32_t over = (fast ? 2 : 1) + 4 + 2 + 3;   // preamble, access address, header, CRC
+    return ((over + len) * 8 + over * 8) / (fast ? 2 : 1) + 2 * 150;
+}
+
+// A notification is len + 3 ATT + 4 L2CAP bytes in data-length fragments
+static uint32_t notification_us(uint32_t len) {
+    uint32_t us = 0;
+    for (uint32_t left = len + 7; left; ) {
+        uint32_t k = left < link_dle ? left : link_dle;
+        us += pdu_us(k);
+        left -= k;
+    }
+    return us;
+}
+
+// Connection events until the link goes down: send what fits the event
+// length, then free those queue slots with one TX complete
+static void run_link(long down_ms) {
+    uint32_t next = micros();
+    while (link_up) {
+        if (down_ms > 0 && millis() >= (uint32_t)down_ms) break;
+        uint32_t budget = cfg_event_us < (uint32_t)conn_interval_us ? cfg_event_us : (uint32_t)conn_interval_us;
+        uint32_t air = 0;
+        uint8_t sent = 0;
+        pthread_mutex_lock(&hvn_lock);
+        while (hvn_queued) {
+            hvn_t *h = &hvn_q[hvn_head];
+            uint32_t t = notification_us(h->len);
+            if (sent && air + t > budget) break;
+            sink_put(h->data, h->len);
+            air += t;
+            sent++;
+            hvn_head = (uint8_t)((hvn_head + 1) % HVN_SLOTS);
+            hvn_queued--;
+        }
+        pthread_mutex_unlock(&hvn_lock);
+        if (air) delayMicroseconds(air);
+        if (sent) {
+            pthread_mutex_lock(&hvn_lock);
+            hvn_used -= sent;
+            pthread_cond_broadcast(&hvn_cond);
+            pthread_mutex_unlock(&hvn_lock);
+            post_event(BLE_GATTS_EVT_HVN_TX_COMPLETE, sent);
+        }
+        next += (uint32_t)conn_interval_us;
+        uint32_t now = micros();
+        if ((int32_t)(next - now) > 0) delayMicroseconds(next - now);
+        else next = now;   // fell behind: no catching up with back-to-back events
+    }
+}
+
+static void *central_thread(void *p) {
+    (void)p;
+    delay((uint32_t)host_env_long("HOST_BLE_CONNECT_MS", 0));
+    link_mtu = BLE_GATT_ATT_MTU_DEFAULT;
+    link_dle = 27;
+    link_phy = BLE_GAP_PHY_1MBPS;
+    link_up = true;
+    post_event(BLE_GAP_EVT_CONNECTED, 0);
+    if (Bluefruit.Periph.connect_cb) Bluefruit.Periph.connect_cb(0);
+    // Writes that arrived before the link came up
+    pthread_mutex_lock(&rx_lock);
+    bool queued = rx_count > 0;
+    pthread_mutex_unlock(&rx_lock);
+    if (rx_cb && queued) rx_cb(0);
+
+    long down_ms = host_env_long("HOST_BLE_DISCONNECT_MS", 0);
+    if (conn_interval_us > 0) run_link(down_ms);
+    if (down_ms > 0) {
+        while (millis() < (uint32_t)down_ms) delay(10);
+        pthread_mutex_lock(&hvn_lock);
+        link_up = false;
+        hvn_queued = hvn_used = 0;   // queued notifications die with the link
+        pthread_cond_broadcast(&hvn_cond);
+        pthread_mutex_unlock(&hvn_lock);
+        post_event(BLE_GAP_EVT_DISCONNECTED, 0);
+        if (Bluefruit.Periph.disconnect_cb) Bluefruit.Periph.disconnect_cb(0, 0x13);
+    }
+    return NULL;
+}
+
+static void *rx_thread(void *p) {
+    (void)p;
+    uint8_t buf[64];
+    for (;;) {
+        ssize_t n = recv(sink_sock, buf, sizeof(buf), 0);
+        if (n <= 0) return NULL;
+        pthread_mutex_lock(&rx_lock);
+        for (ssize_t i = 0; i < n && rx_count < sizeof(rx_ring); ++i) {
+            rx_ring[(rx_head + rx_count++) % sizeof(rx_ring)] = buf[i];
+        }
+        pthread_mutex_unlock(&rx_lock);
+        if (link_up && rx_cb) rx_cb(0);
+    }
+}
+
+void AdafruitBluefruit::configPrphBandwidth(uint8_t bw) {
+    switch (bw) {
+    case BANDWIDTH_LOW:  cfg_mtu_max = BLE_GATT_ATT_MTU_DEFAULT; cfg_event_us = 2 * 1250; cfg_hvn_qsize = 1; break;
+    case BANDWIDTH_HIGH: cfg_mtu_max = 128; cfg_event_us = 6 * 1250; cfg_hvn_qsize = 2; break;
+    case BANDWIDTH_MAX:  cfg_mtu_max = 247; cfg_event_us = 6 * 1250; cfg_hvn_qsize = 3; break;
+    default:             cfg_mtu_max = BLE_GATT_ATT_MTU_DEFAULT; cfg_event_us = 3 * 1250; cfg_hvn_qsize = 2; break;
+    }
+}
+
+bool AdafruitBluefruit::begin(uint8_t prph_count, uint8_t central_count) {
+    (void)prph_count; (void)central_count;
+    sink_open();
+    bytes_per_sec = host_env_long("HOST_BLE_BYTES_PER_SEC", 0);
+    conn_interval_us = host_env_long("HOST_BLE_CONN_INTERVAL_US", 15000);
+    central_mtu = host_env_long("HOST_BLE_MTU", 247);
+    central_dle = host_env_long("HOST_BLE_DLE", 251);
+    central_phy = host_env_long("HOST_BLE_PHY", 2);
+    if (sink_sock >= 0) {
+        pthread_t t;
+        if (pthread_create(&t, NULL, rx_thread, NULL) == 0) pthread_detach(t);
+    }
+    return true;
+}
+
+// The central can only find us once we advertise
+bool BLEAdvertising::start(uint16_t timeout) {
+    (void)timeout;
+    static bool started = false;
+    if (!started && host_env("HOST_BLE_CONNECT_MS")) {
+        started = true;
+        pthread_t t;
+        if (pthread_create(&t, NULL, central_thread, NULL) == 0) pthread_detach(t);
+    }
+    return true;
+}
+
+bool AdafruitBluefruit::connected(void) {
+    return link_up;
+}
+
+BLEConnection *AdafruitBluefruit::Connection(uint16_t conn_hdl) {
+    return conn_hdl == 0 ? &conn0 : NULL;
+}
+
+bool BLEConnection::requestPHY(uint8_t phy) {
+    bool fast = (phy == BLE_GAP_PHY_AUTO || (phy & BLE_GAP_PHY_2MBPS)) && central_phy == 2;
+    link_phy = fast ? BLE_GAP_PHY_2MBPS : BLE_GAP_PHY_1MBPS;
+    return true;
+}
+
+bool BLEConnection::requestDataLengthUpdate(ble_gap_data_length_params_t const *p_dl_params,
+                                            ble_gap_data_length_limitation_t *p_dl_limitation) {
+    (void)p_dl_limitation;
+    long want = p_dl_params ? p_dl_params->max_tx_octets : 251;
+    link_dle = (uint16_t)(want < central_dle ? want : central_dle);
+    return true;
+}
+
+// Like sd_ble_gattc_exchange_mtu_request: more than the config allows fails
+bool BLEConnection::requestMtuExchange(uint16_t mtu) {
+    if (mtu > cfg_mtu_max) return false;
+    link_mtu = (uint16_t)(mtu < central_mtu ? mtu : central_mtu);
+    return true;
+}
+
+uint16_t BLEConnection::getMtu(void) { return link_mtu; }
+uint16_t BLEConnection::getDataLength(void) { return link_dle; }
+uint8_t BLEConnection::getPHY(void) { return link_phy; }
+
+bool BLEUart::notifyEnabled(void) {
+    return link_up;
+}
+
+// One notification: wait for a free HVN slot, as the core's notify() does
+static bool hvn_put(const uint8_t *buf, size_t len) {
+    pthread_mutex_lock(&hvn_lock);
+    while (link_up && hvn_used >= cfg_hvn_qsize) pthread_cond_wait(&hvn_cond, &hvn_lock);
+    bool ok = link_up;
+    if (ok) {
+        hvn_t *h = &hvn_q[(hvn_head + hvn_queued) % HVN_SLOTS];
+        h->len = (uint16_t)len;
+        memcpy(h->data, buf, len);
+        hvn_queued++;
+        hvn_used++;
+    }
+    pthread_mutex_unlock(&hvn_lock);
+    return ok;
+}
+
+size_t BLEUart::write(const uint8_t *buf, size_t len) {
+    // Like the real UART service: nothing goes out without a subscribed central
+    if (!link_up || !len) return 0;
+    size_t payload = (size_t)link_mtu - 3;
+    if (conn_interval_us > 0) {
+        size_t done = 0;
+        while (done < len) {
+            size_t n = len - done < payload ? len - done : payload;
+            if (!hvn_put(buf + done, n)) return done;
+            done += n;
+        }
+    } else {
+        sink_put(buf, len);
+        post_event(BLE_GATTS_EVT_HVN_TX_COMPLETE, (uint8_t)((len + payload - 1) / payload));
+    }
+    if (bytes_per_sec > 0) {
+        delayMicroseconds((uint32_t)((uint64_t)len * 1000000u / (uint64_t)bytes_per_sec));
+    }
+    return len;
+}
+
+void BLEUart::setRxCallback(rx_callback_t fp, bool deferred) {
+    (void)deferred;
+    rx_cb = fp;
+}
+
+int BLEUart::available(void) {
+    pthread_mutex_lock(&rx_lock);
+    int n = (int)rx_count;
+    pthread_mutex_unlock(&rx_lock);
+    return n;
+}
+
+int BLEUart::read(void) {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int BLEUart::read(uint8_t *buf, size_t size) {
+    pthread_mutex_lock(&rx_lock);
+    size_t n = size < rx_count ? size : rx_count;
+    for (size_t i = 0; i < n; ++i) buf[i] = rx_ring[(rx_head + i) % sizeof(rx_ring)];
+    rx_head = (rx_head + n) % sizeof(rx_ring);
+    rx_count -= n;
+    pthread_mutex_unlock(&rx_lock);
+    return (int)n;
+}
@@ -0,0 +1,47 @@
+// lib/host_fakes/src/host_bno08x.cpp
+#include <Adafruit_BNO08x.h>
+
+bool Adafruit_BNO08x::begin_I2C(uint8_t addr, TwoWire *wire, int32_t sensor_id) {
+    (void)sensor_id;
+    if (!wire) return false;
+    wire->beginTransmission(addr);
+    if (wire->endTransmission() != 0) return false;
+    has_trace = host_trace_open(&trace, "imu.csv", 4);
+    return true;
+}
+
+bool Adafruit_BNO08x::enableReport(sh2_SensorId_t id, uint32_t interval_us) {
+    report = id;
+    interval_ms = interval_us / 1000u;
+    if (interval_ms == 0) interval_ms = 1;
+    next_ms = millis();
+    return true;
+}
+
+bool Adafruit_BNO08x::getSensorEvent(sh2_SensorValue_t *value) {
+    if (!report || !value) return false;
+    uint32_t now = millis();
+    if ((int32_t)(now - next_ms) < 0) return false;
+    // Reports the sensor produced while nobody read are dropped, as on the SHTP link
+    next_ms = now + interval_ms;
+
+    float q[4];
+    if (!(has_trace && host_trace_next(&trace, q))) {
+        // Roll about the j axis (the firmware's remapped roll)
+        float roll = 60.0f * (float)DEG_TO_RAD * sinf(2.0f * (float)PI * (float)now / 120000.0f);
+        q[0] = cosf(roll / 2.0f);
+        q[1] = 0.0f;
+        q[2] = sinf(roll / 2.0f);
+        q[3] = 0.0f;
+    }
+
+    memset(value, 0, sizeof(*value));
+    value->sensorId = report;
+    value->sequence = seq++;
+    value->timestamp = (uint64_t)now * 1000u;
+    value->un.arvrStabilizedRV.real = q[0];
+    value->un.arvrStabilizedRV.i = q[1];
+    value->un.arvrStabilizedRV.j = q[2];
+    value->un.arvrStabilizedRV.k = q[3];
+    return true;
+}
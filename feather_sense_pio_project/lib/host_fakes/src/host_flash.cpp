@@ -0,0 +1,140 @@
+// lib/host_fakes/src/host_flash.cpp
+#include <Adafruit_SPIFlash.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "host_trace.h"
+
+bool Adafruit_SPIFlash::begin(void) {
+    if (mem) return true;
+    cut_after = host_env_long("HOST_FLASH_CUT_AFTER", 0);
+    erase_us = host_env_long("HOST_FLASH_ERASE_US", 0);
+    page_us = host_env_long("HOST_FLASH_PAGE_US", 0);
+    read_cmd_ns = host_env_long("HOST_FLASH_READ_CMD_NS", 0);
+    read_byte_ns = host_env_long("HOST_FLASH_READ_BYTE_NS", 0);
+    bytes = (uint32_t)host_env_long("HOST_FLASH_BYTES", 2L * 1024 * 1024);
+    bytes -= bytes % HOST_FLASH_SECTOR;
+    if (!bytes) return false;
+    mem = (uint8_t *)malloc(bytes);
+    if (!mem) return false;
+    memset(mem, 0xFF, bytes);
+
+    const char *path = host_env("HOST_FLASH_FILE");
+    if (path) {
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            printf("host: can't open flash file %s, using RAM\n", path);
+        } else {
+            // A new or short file reads as erased flash past its end
+            ssize_t got = pread(fd, mem, bytes, 0);
+            if (got < (ssize_t)bytes) persist(got > 0 ? (uint32_t)got : 0, bytes - (got > 0 ? (uint32_t)got : 0));
+        }
+    }
+    return true;
+}
+
+void Adafruit_SPIFlash::persist(uint32_t addr, uint32_t len) {
+    if (fd < 0 || !len) return;
+    if (pwrite(fd, mem + addr, len, addr) != (ssize_t)len) {
+        printf("host: flash file write failed at 0x%06X\n", (unsigned)addr);
+    }
+}
+
+/* Simulated power cut: the HOST_FLASH_CUT_AFTER'th program/erase only
+ * lands its first half in the file, then the process dies on the spot. */
+uint32_t Adafruit_SPIFlash::cut_len(uint32_t len) {
+    if (cut_after <= 0 || ++ops < cut_after) return len;
+    return len / 2;
+}
+
+void Adafruit_SPIFlash::cut_now(void) {
+    if (cut_after <= 0 || ops < cut_after) return;
+    printf("host: power cut after %ld flash ops\n", ops);
+    fflush(stdout);
+    _exit(3);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t now_us(void) {
+    return now_ns() / 1000u;
+}
+
+// Reads are short and the CPU waits on them: spin rather than sleep
+static void spin_ns(uint64_t ns) {
+    uint64_t end = now_ns() + ns;
+    while (now_ns() < end) {}
+}
+
+long Adafruit_SPIFlash::busy_left_us(void) const {
+    uint64_t now = now_us();
+    return busy_until_us > now ? (long)(busy_until_us - now) : 0;
+}
+
+void Adafruit_SPIFlash::wait_busy(void) const {
+    long left = busy_left_us();
+    if (left > 0) usleep((useconds_t)left);
+}
+
+void Adafruit_SPIFlash::set_busy(long us) {
+    if (us > 0) busy_until_us = now_us() + (uint64_t)us;
+}
+
+uint32_t Adafruit_SPIFlash::readBuffer(uint32_t addr, uint8_t *buf, uint32_t len) {
+    if (!mem || addr >= bytes) return 0;
+    if (len > bytes - addr) len = bytes - addr;
+    wait_busy();
+    memcpy(buf, mem + addr, len);
+    if (read_cmd_ns > 0 || read_byte_ns > 0) spin_ns((uint64_t)read_cmd_ns + (uint64_t)read_byte_ns * len);
+    stats.bytes_read += len;
+    return len;
+}
+
+uint32_t Adafruit_SPIFlash::writeBuffer(uint32_t addr, const uint8_t *buf, uint32_t len) {
+    if (!mem || addr >= bytes) return 0;
+    if (len > bytes - addr) len = bytes - addr;
+    wait_busy();
+    bool bad = false;
+    uint32_t lands = cut_len(len);
+    for (uint32_t i = 0; i < lands; ++i) {
+        if (buf[i] & ~mem[addr + i]) bad = true;
+        mem[addr + i] &= buf[i];   // NOR program: 1 -> 0 only
+    }
+    if (bad) stats.bad_programs++;
+    if (page_us > 0) {
+        // One program per 256-byte page touched; the last one runs on
+        uint32_t pages = (addr + len + 255) / 256 - addr / 256;
+        if (pages > 1) usleep((useconds_t)((pages - 1) * page_us));
+        set_busy(page_us);
+    }
+    stats.bytes_written += lands;
+    persist(addr, lands);
+    cut_now();
+    return len;
+}
+
+bool Adafruit_SPIFlash::eraseSector(uint32_t sector) {
+    uint32_t addr = sector * HOST_FLASH_SECTOR;
+    if (!mem || addr >= bytes) return false;
+    wait_busy();
+    uint32_t lands = cut_len(HOST_FLASH_SECTOR);
+    memset(mem + addr, 0xFF, lands);
+    stats.sector_erases++;
+    set_busy(erase_us);
+    persist(addr, lands);
+    cut_now();
+    return true;
+}
+
+bool Adafruit_SPIFlash::eraseChip(void) {
+    if (!mem) return false;
+    wait_busy();
+    memset(mem, 0xFF, bytes);
+    stats.sector_erases += bytes / HOST_FLASH_SECTOR;
+    persist(0, bytes);
+    return true;
+}
@@ -0,0 +1,94 @@
+// lib/host_fakes/src/host_max30105.cpp
+#include "MAX30105.h"
+#include "heartRate.h"
+
+bool MAX30105::begin(TwoWire &wire, uint32_t i2c_speed, uint8_t addr) {
+    (void)i2c_speed;
+    wire.beginTransmission(addr);
+    if (wire.endTransmission() != 0) return false;
+    bus = wire.host_bus();
+    has_trace = host_trace_open(&trace, bus == 0 ? "spo2_0.csv" : "spo2_1.csv", 2);
+    start_ms = next_ms = millis();
+    n = 0;
+    return true;
+}
+
+void MAX30105::setup(byte power, byte sample_average, byte led_mode,
+                     int sample_rate, int pulse_width, int adc_range) {
+    (void)power; (void)led_mode; (void)pulse_width; (void)adc_range;
+    rate_hz = (float)sample_rate / (float)(sample_average ? sample_average : 1);
+    if (rate_hz <= 0.0f) rate_hz = 50.0f;
+    start_ms = next_ms = millis();
+    n = 0;
+}
+
+/* 65 bpm PPG: systolic peak plus dicrotic notch. Perfusion is high enough to
+ * pass the module's AC/DC gate and red/IR gives R ~ 0.53, i.e. ~97 % SpO2. */
+void MAX30105::synth(uint32_t *r, uint32_t *i) {
+    float t = (float)n / rate_hz;
+    float ph = 2.0f * (float)PI * (65.0f / 60.0f) * t;
+    float wave = sinf(ph) + 0.3f * sinf(2.0f * ph + 0.5f);
+    *i = (uint32_t)(6000.0f + 350.0f * wave);
+    *r = (uint32_t)(5000.0f + 155.0f * wave);
+}
+
+// Move every sample due by now into the FIFO; the oldest are lost on overflow
+uint16_t MAX30105::check(void) {
+    uint32_t now = millis();
+    uint16_t added = 0;
+    while ((int32_t)(now - next_ms) >= 0) {
+        uint32_t r, i;
+        float row[2];
+        if (has_trace && host_trace_next(&trace, row)) {
+            r = (uint32_t)row[0];
+            i = (uint32_t)row[1];
+        } else {
+            synth(&r, &i);
+        }
+        red[head % HOST_MAX30105_FIFO] = r;
+        ir[head % HOST_MAX30105_FIFO] = i;
+        head++;
+        if (head - tail > HOST_MAX30105_FIFO) tail = head - HOST_MAX30105_FIFO;
+        n++;
+        added++;
+        next_ms = start_ms + (uint32_t)((float)n * 1000.0f / rate_hz);
+    }
+    return added;
+}
+
+uint32_t MAX30105::getRed(void) {
+    check();
+    return red[(head - 1) % HOST_MAX30105_FIFO];
+}
+
+uint32_t MAX30105::getIR(void) {
+    check();
+    return ir[(head - 1) % HOST_MAX30105_FIFO];
+}
+
+/* ---- Beat detection ---- */
+
+static float dc_est = 0.0f;
+static bool dc_init = false;
+static float ac_prev = 0.0f, ac_min = 0.0f, ac_max = 0.0f;
+
+bool checkForBeat(int32_t sample) {
+    if (!dc_init) {
+        dc_est = (float)sample;
+        dc_init = true;
+    }
+    dc_est += ((float)sample - dc_est) * 0.05f;
+    float ac = (float)sample - dc_est;
+
+    bool beat = false;
+    // Rising zero crossing after a full swing, same gate as the SparkFun code
+    if (ac_prev < 0.0f && ac >= 0.0f) {
+        float swing = ac_max - ac_min;
+        beat = swing > 20.0f && swing < 1000.0f;
+        ac_max = ac_min = 0.0f;
+    }
+    if (ac > ac_max) ac_max = ac;
+    if (ac < ac_min) ac_min = ac;
+    ac_prev = ac;
+    return beat;
+}
@@ -0,0 +1,72 @@
+// lib/host_fakes/src/host_pdm.cpp
+#include <PDM.h>
+#include <time.h>
+#include <errno.h>
+#include "host_trace.h"
+
+PDMClass PDM;
+
+static host_trace_t mic_trace;
+
+static void *pdm_thread(void *p) {
+    ((PDMClass *)p)->host_run();
+    return NULL;
+}
+
+void PDMClass::setBufferSize(int bytes) {
+    if (bytes > 0 && bytes <= (int)sizeof(pcm)) buffer_bytes = bytes & ~1;
+}
+
+int PDMClass::begin(int channels, int sample_rate) {
+    if (channels != 1 || sample_rate <= 0 || running) return 0;
+    rate = sample_rate;
+    host_trace_open_raw(&mic_trace, "mic.raw");
+    running = true;
+    if (pthread_create(&thread, NULL, pdm_thread, this) != 0) {
+        running = false;
+        return 0;
+    }
+    return 1;
+}
+
+void PDMClass::end(void) {
+    if (!running) return;
+    running = false;
+    pthread_join(thread, NULL);
+}
+
+int PDMClass::available(void) {
+    return ready;
+}
+
+int PDMClass::read(void *buf, int n) {
+    if (n > ready) n = ready;
+    memcpy(buf, pcm, (size_t)n);
+    ready = 0;
+    return n;
+}
+
+void PDMClass::host_run(void) {
+    const int samples = buffer_bytes / 2;
+    const long period_ns = (long)((int64_t)samples * 1000000000 / rate);
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    uint32_t lcg = 1;
+
+    while (running) {
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) { next.tv_nsec -= 1000000000L; next.tv_sec++; }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {}
+
+        // The callback is the ISR: deliver with "interrupts" masked
+        noInterrupts();
+        size_t got = host_trace_read_raw(&mic_trace, pcm, (size_t)buffer_bytes);
+        for (int i = (int)(got / 2); i < samples; ++i) {
+            lcg = lcg * 1664525u + 1013904223u;
+            pcm[i] = (int16_t)((int32_t)(lcg >> 16) % 64 - 32);
+        }
+        ready = buffer_bytes;
+        if (on_receive) on_receive();
+        interrupts();
+    }
+}
@@ -0,0 +1,366 @@
+// lib/host_fakes/src/host_rtos.cpp
+// FreeRTOS API on pthreads (see FreeRTOS.h for what differs from the target)
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "event_groups.h"
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+struct host_task_s {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    char name[16];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    bool suspended;
+};
+
+struct host_sem_s {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int count;
+};
+
+struct host_evgroup_s {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+static pthread_mutex_t critical_lock;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static struct timespec t_start;
+static thread_local host_task_s *current_task = NULL;
+
+static void rtos_init(void) {
+    pthread_mutexattr_t a;
+    pthread_mutexattr_init(&a);
+    pthread_mutexattr_settype(&a, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical_lock, &a);
+    pthread_mutexattr_destroy(&a);
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+}
+
+static inline void ensure_init(void) { pthread_once(&init_once, rtos_init); }
+
+/* ---- Time ---- */
+
+static uint64_t now_ms(void) {
+    ensure_init();
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // Whole ns first: splitting sec/nsec rounds a negative nsec difference
+    // up, and a tick that reads early makes a task wake "before" its deadline
+    int64_t ns = (int64_t)(ts.tv_sec - t_start.tv_sec) * 1000000000 + (ts.tv_nsec - t_start.tv_nsec);
+    return (uint64_t)ns / 1000000u;
+}
+
+/* Absolute CLOCK_MONOTONIC deadline `ticks` from now; NULL = forever */
+static const struct timespec *deadline_in(TickType_t ticks, struct timespec *out) {
+    if (ticks == portMAX_DELAY) return NULL;
+    clock_gettime(CLOCK_MONOTONIC, out);
+    uint64_t ns = (uint64_t)out->tv_nsec + (uint64_t)ticks * (1000000000u / configTICK_RATE_HZ);
+    out->tv_sec += (time_t)(ns / 1000000000u);
+    out->tv_nsec = (long)(ns % 1000000000u);
+    return out;
+}
+
+/* Wait on cond until woken or the deadline passes. False on timeout. */
+static bool cond_wait_until(pthread_cond_t *c, pthread_mutex_t *m, const struct timespec *dl) {
+    if (!dl) {
+        pthread_cond_wait(c, m);
+        return true;
+    }
+    return pthread_cond_timedwait(c, m, dl) != ETIMEDOUT;
+}
+
+static void init_cond(pthread_cond_t *c) {
+    pthread_condattr_t a;
+    pthread_condattr_init(&a);
+    pthread_condattr_setclock(&a, CLOCK_MONOTONIC);
+    pthread_cond_init(c, &a);
+    pthread_condattr_destroy(&a);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_ms() * configTICK_RATE_HZ / 1000);
+}
+
+TickType_t xTaskGetTickCountFromISR(void) {
+    return xTaskGetTickCount();
+}
+
+/* ---- Critical sections ---- */
+
+void vPortEnterCritical(void) {
+    ensure_init();
+    pthread_mutex_lock(&critical_lock);
+}
+
+void vPortExitCritical(void) {
+    pthread_mutex_unlock(&critical_lock);
+}
+
+/* ---- Tasks ---- */
+
+static host_task_s *task_alloc(const char *name) {
+    host_task_s *t = (host_task_s *)calloc(1, sizeof(*t));
+    if (!t) return NULL;
+    strncpy(t->name, name ? name : "", sizeof(t->name) - 1);
+    pthread_mutex_init(&t->lock, NULL);
+    init_cond(&t->cond);
+    return t;
+}
+
+/* Threads that weren't made by xTaskCreate (main/setup) get a handle on demand */
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (!current_task) {
+        current_task = task_alloc("main");
+        if (current_task) current_task->thread = pthread_self();
+    }
+    return current_task;
+}
+
+/* Park here while someone has suspended us. Caller holds t->lock. */
+static void honor_suspend_locked(host_task_s *t) {
+    while (t->suspended) pthread_cond_wait(&t->cond, &t->lock);
+}
+
+static void honor_suspend(host_task_s *t) {
+    pthread_mutex_lock(&t->lock);
+    honor_suspend_locked(t);
+    pthread_mutex_unlock(&t->lock);
+}
+
+static void *task_entry(void *p) {
+    host_task_s *t = (host_task_s *)p;
+    current_task = t;
+    honor_suspend(t);
+    t->fn(t->arg);
+    // FreeRTOS tasks must not return; treat it like vTaskDelete(NULL)
+    return NULL;
+}
+
+static uint32_t tasks_made, stack_bytes_asked;
+
+void host_task_totals(uint32_t *tasks, uint32_t *stack_bytes) {
+    if (tasks) *tasks = __atomic_load_n(&tasks_made, __ATOMIC_RELAXED);
+    if (stack_bytes) *stack_bytes = __atomic_load_n(&stack_bytes_asked, __ATOMIC_RELAXED);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_words,
+                       void *arg, UBaseType_t prio, TaskHandle_t *out) {
+    (void)prio;
+    ensure_init();
+    host_task_s *t = task_alloc(name);
+    if (!t) return pdFAIL;
+    t->fn = fn;
+    t->arg = arg;
+
+    pthread_attr_t a;
+    pthread_attr_init(&a);
+    pthread_attr_setdetachstate(&a, PTHREAD_CREATE_DETACHED);
+    // Host code needs more stack than the target (libc printf, no -Os); never go below 64 KB
+    size_t stack = (size_t)stack_words * 4u * 4u;
+    if (stack < 64u * 1024u) stack = 64u * 1024u;
+    pthread_attr_setstacksize(&a, stack);
+    if (out) *out = t;   // visible before the task runs, as on the target
+    int r = pthread_create(&t->thread, &a, task_entry, t);
+    pthread_attr_destroy(&a);
+    if (r != 0) {
+        if (out) *out = NULL;
+        free(t);
+        return pdFAIL;
+    }
+    __atomic_add_fetch(&tasks_made, 1u, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stack_bytes_asked, stack_words * 4u, __ATOMIC_RELAXED);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t t) {
+    if (!t || t == current_task) pthread_exit(NULL);
+    pthread_cancel(t->thread);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    host_task_s *self = xTaskGetCurrentTaskHandle();
+    if (ticks) {
+        struct timespec dl;
+        deadline_in(ticks, &dl);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &dl, NULL) == EINTR) {}
+    }
+    honor_suspend(self);
+}
+
+void vPortYield(void) {
+    sched_yield();
+    honor_suspend(xTaskGetCurrentTaskHandle());
+}
+
+void vTaskDelayUntil(TickType_t *prev_wake, TickType_t increment) {
+    *prev_wake += increment;
+    int32_t ahead = (int32_t)(*prev_wake - xTaskGetTickCount());
+    // Already late: return straight away, like the kernel does
+    vTaskDelay(ahead > 0 ? (TickType_t)ahead : 0);
+}
+
+void vTaskSuspend(TaskHandle_t t) {
+    host_task_s *self = xTaskGetCurrentTaskHandle();
+    if (!t) t = self;
+    pthread_mutex_lock(&t->lock);
+    t->suspended = true;
+    if (t == self) honor_suspend_locked(t);
+    pthread_mutex_unlock(&t->lock);
+}
+
+void vTaskResume(TaskHandle_t t) {
+    if (!t) return;
+    pthread_mutex_lock(&t->lock);
+    t->suspended = false;
+    pthread_cond_broadcast(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait) {
+    host_task_s *self = xTaskGetCurrentTaskHandle();
+    struct timespec ts;
+    const struct timespec *dl = deadline_in(wait, &ts);
+
+    pthread_mutex_lock(&self->lock);
+    for (;;) {
+        honor_suspend_locked(self);
+        if (self->notify || wait == 0) break;
+        if (!cond_wait_until(&self->cond, &self->lock, dl)) break;
+    }
+    uint32_t v = self->notify;
+    if (v) self->notify = clear_on_exit ? 0 : v - 1;
+    pthread_mutex_unlock(&self->lock);
+    return v;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t t) {
+    if (!t) return pdFAIL;
+    pthread_mutex_lock(&t->lock);
+    t->notify++;
+    pthread_cond_broadcast(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t *higher_prio_woken) {
+    xTaskNotifyGive(t);
+    if (higher_prio_woken) *higher_prio_woken = pdFALSE;
+}
+
+/* ---- Mutexes ---- */
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    host_sem_s *s = (host_sem_s *)calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    pthread_mutex_init(&s->lock, NULL);
+    init_cond(&s->cond);
+    s->count = 1;
+    return s;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t wait) {
+    if (!s) return pdFAIL;
+    struct timespec ts;
+    const struct timespec *dl = deadline_in(wait, &ts);
+    pthread_mutex_lock(&s->lock);
+    while (s->count == 0) {
+        if (wait == 0 || !cond_wait_until(&s->cond, &s->lock, dl)) break;
+    }
+    BaseType_t ok = pdFAIL;
+    if (s->count > 0) {
+        s->count--;
+        ok = pdPASS;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t s) {
+    if (!s) return pdFAIL;
+    pthread_mutex_lock(&s->lock);
+    BaseType_t ok = (s->count == 0) ? pdPASS : pdFAIL;
+    s->count = 1;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+    return ok;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t s) {
+    if (!s) return;
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+}
+
+/* ---- Event groups ---- */
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    host_evgroup_s *g = (host_evgroup_s *)calloc(1, sizeof(*g));
+    if (!g) return NULL;
+    pthread_mutex_init(&g->lock, NULL);
+    init_cond(&g->cond);
+    return g;
+}
+
+/* Nobody may be waiting on it, as on the target */
+void vEventGroupDelete(EventGroupHandle_t g) {
+    if (!g) return;
+    pthread_cond_destroy(&g->cond);
+    pthread_mutex_destroy(&g->lock);
+    free(g);
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits) {
+    pthread_mutex_lock(&g->lock);
+    g->bits |= bits;
+    EventBits_t v = g->bits;
+    pthread_cond_broadcast(&g->cond);
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t g, EventBits_t bits) {
+    pthread_mutex_lock(&g->lock);
+    EventBits_t v = g->bits;
+    g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t g) {
+    pthread_mutex_lock(&g->lock);
+    EventBits_t v = g->bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits,
+                                BaseType_t clear_on_exit, BaseType_t wait_all,
+                                TickType_t wait) {
+    struct timespec ts;
+    const struct timespec *dl = deadline_in(wait, &ts);
+    pthread_mutex_lock(&g->lock);
+    for (;;) {
+        EventBits_t hit = g->bits & bits;
+        if (wait_all ? hit == bits : hit != 0) break;
+        if (wait == 0 || !cond_wait_until(&g->cond, &g->lock, dl)) break;
+    }
+    EventBits_t v = g->bits;
+    EventBits_t hit = v & bits;
+    if (clear_on_exit && (wait_all ? hit == bits : hit != 0)) g->bits &= ~bits;
+    pthread_mutex_unlock(&g->lock);
+    return v;
+}
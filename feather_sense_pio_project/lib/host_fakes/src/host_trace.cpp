@@ -0,0 +1,79 @@
+// lib/host_fakes/src/host_trace.cpp
+#include "host_trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+const char *host_env(const char *name) {
+    const char *v = getenv(name);
+    return (v && *v) ? v : NULL;
+}
+
+long host_env_long(const char *name, long def) {
+    const char *v = host_env(name);
+    return v ? strtol(v, NULL, 0) : def;
+}
+
+static FILE *open_in_dir(const char *name, const char *mode) {
+    const char *dir = host_env("HOST_TRACE_DIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir ? dir : "traces", name);
+    return fopen(path, mode);
+}
+
+bool host_trace_open(host_trace_t *t, const char *name, int cols) {
+    t->f = open_in_dir(name, "r");
+    t->cols = cols > HOST_TRACE_MAX_COLS ? HOST_TRACE_MAX_COLS : cols;
+    t->binary = false;
+    if (t->f) printf("host: replaying traces/%s\n", name);
+    return t->f != NULL;
+}
+
+bool host_trace_open_raw(host_trace_t *t, const char *name) {
+    t->f = open_in_dir(name, "rb");
+    t->cols = 0;
+    t->binary = true;
+    if (t->f) printf("host: replaying traces/%s\n", name);
+    return t->f != NULL;
+}
+
+/* Parse one CSV line; false if it holds no numbers (comment/header) */
+static bool parse_row(const char *line, float *vals, int cols) {
+    const char *p = line;
+    int n = 0;
+    while (n < cols) {
+        while (*p == ' ' || *p == '\t' || *p == ',') ++p;
+        if (!*p || *p == '\n' || *p == '\r' || *p == '#') break;
+        char *end;
+        float v = strtof(p, &end);
+        if (end == p) return false;
+        vals[n++] = v;
+        p = end;
+    }
+    while (n < cols && n > 0) vals[n++] = 0.0f;
+    return n > 0;
+}
+
+bool host_trace_next(host_trace_t *t, float *vals) {
+    if (!t->f || t->binary) return false;
+    char line[256];
+    bool rewound = false;
+    for (;;) {
+        if (!fgets(line, sizeof(line), t->f)) {
+            if (rewound) return false;   // nothing usable in the whole file
+            rewind(t->f);
+            rewound = true;
+            continue;
+        }
+        if (parse_row(line, vals, t->cols)) return true;
+    }
+}
+
+size_t host_trace_read_raw(host_trace_t *t, void *buf, size_t n) {
+    if (!t->f || !t->binary) return 0;
+    size_t got = fread(buf, 1, n, t->f);
+    if (got < n) {
+        rewind(t->f);
+        got += fread((uint8_t *)buf + got, 1, n - got, t->f);
+    }
+    return got;
+}
@@ -0,0 +1,43 @@
+#ifndef HOST_TRACE_H
+#define HOST_TRACE_H
+
+/* Recorded sensor traces for the host fakes.
+ * Files live in $HOST_TRACE_DIR (default ./traces). Text traces are CSV,
+ * one sample per line; blank lines, '#' comments and a non-numeric header
+ * line are skipped. A trace is replayed in a loop.
+ *
+ *   temp.csv        raw                 TMP117-style register value, 1 per read
+ *   spo2_0.csv      red,ir              MAX30105 on Wire, 50 samples/s
+ *   spo2_1.csv      red,ir              MAX30105 on Wire1, 50 samples/s
+ *   imu.csv         real,i,j,k          BNO08x rotation vector, one per report
+ *   battery.csv     adc                 VBAT analogRead() value, 1 per read
+ *   mic.raw         int16 LE PCM        16 kHz mono
+ *
+ * Missing traces fall back to synthetic signals so the firmware still runs. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define HOST_TRACE_MAX_COLS 8
+
+typedef struct {
+    FILE *f;
+    int cols;
+    bool binary;
+} host_trace_t;
+
+/* Open trace `name`; false (and t->f NULL) if it doesn't exist */
+bool host_trace_open(host_trace_t *t, const char *name, int cols);
+bool host_trace_open_raw(host_trace_t *t, const char *name);
+
+/* Next row into vals[0..cols), rewinding at the end. False if closed/empty. */
+bool host_trace_next(host_trace_t *t, float *vals);
+/* Up to n bytes of a raw trace, rewinding at the end */
+size_t host_trace_read_raw(host_trace_t *t, void *buf, size_t n);
+
+/* Host-only env knobs: string (NULL if unset) and integer (def if unset) */
+const char *host_env(const char *name);
+long host_env_long(const char *name, long def);
+
+#endif /* HOST_TRACE_H */
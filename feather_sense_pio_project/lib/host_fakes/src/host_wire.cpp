@@ -0,0 +1,91 @@
+// lib/host_fakes/src/host_wire.cpp
+#include <Wire.h>
+#include "host_trace.h"
+
+TwoWire Wire(0);
+
+typedef struct {
+    int bus;
+    uint8_t addr;
+    host_i2c_read_fn read;
+} i2c_device_t;
+
+static size_t temp_read(uint8_t reg, uint8_t *out, size_t n);
+
+// Plain static tables, so lookups work before any C++ constructor has run
+static const i2c_device_t builtin_devices[] = {
+    { 0, 0x48, temp_read },   // temperature sensor
+    { 0, 0x57, NULL },        // MAX30105 #1 (driver faked in host_max30105.cpp)
+    { 1, 0x57, NULL },        // MAX30105 #2 on Wire1
+    { 0, 0x4A, NULL },        // BNO08x (driver faked in host_bno08x.cpp)
+};
+static i2c_device_t extra_devices[HOST_I2C_MAX_DEVICES];
+static int extra_count = 0;
+
+bool host_i2c_attach(int bus, uint8_t addr, host_i2c_read_fn read) {
+    if (extra_count >= HOST_I2C_MAX_DEVICES) return false;
+    extra_devices[extra_count].bus = bus;
+    extra_devices[extra_count].addr = addr;
+    extra_devices[extra_count].read = read;
+    extra_count++;
+    return true;
+}
+
+// Attached devices shadow the built-in ones
+static const i2c_device_t *find_device(int bus, uint8_t addr) {
+    for (int i = 0; i < extra_count; ++i) {
+        if (extra_devices[i].bus == bus && extra_devices[i].addr == addr) return &extra_devices[i];
+    }
+    for (size_t i = 0; i < sizeof(builtin_devices) / sizeof(builtin_devices[0]); ++i) {
+        if (builtin_devices[i].bus == bus && builtin_devices[i].addr == addr) return &builtin_devices[i];
+    }
+    return NULL;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+    tx_addr = addr;
+    tx_len = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+    // First byte written is the register pointer, like every device here
+    if (tx_len++ == 0) reg = b;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *b, size_t n) {
+    for (size_t i = 0; i < n; ++i) write(b[i]);
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+    (void)stop;
+    return find_device(bus, tx_addr) ? 0 : 2;   // 2 = address NACK
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t n, bool stop) {
+    (void)stop;
+    rx_len = rx_pos = 0;
+    const i2c_device_t *d = find_device(bus, addr);
+    if (!d || !d->read) return 0;
+    if (n > sizeof(rx)) n = sizeof(rx);
+    rx_len = d->read(reg, rx, n);
+    return (uint8_t)rx_len;
+}
+
+/* Register 0: 16-bit big-endian raw reading from temp.csv, else ~36.5 C
+ * after the adapter's (raw / 256) - 192 calibration */
+static size_t temp_read(uint8_t reg, uint8_t *out, size_t n) {
+    static host_trace_t trace;
+    static bool opened = false;
+    if (reg != 0x00 || n < 2) return 0;
+    if (!opened) {
+        host_trace_open(&trace, "temp.csv", 1);
+        opened = true;
+    }
+    float v;
+    uint16_t raw = host_trace_next(&trace, &v) ? (uint16_t)v : (uint16_t)((192.0f + 36.5f) * 256.0f);
+    out[0] = (uint8_t)(raw >> 8);
+    out[1] = (uint8_t)raw;
+    return 2;
+}
@@ -0,0 +1,40 @@
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_words,
+                       void *arg, UBaseType_t prio, TaskHandle_t *out);
+void vTaskDelete(TaskHandle_t t);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *prev_wake, TickType_t increment);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+/* Give up the CPU; on the host, to whichever thread the OS picks */
+void vPortYield(void);
+#define taskYIELD() vPortYield()
+
+/* Suspending another task takes effect the next time it blocks in this API
+ * (pthreads can't be stopped from outside); suspending yourself is immediate. */
+void vTaskSuspend(TaskHandle_t t);
+void vTaskResume(TaskHandle_t t);
+
+/* Host only: tasks made so far and the target stack bytes they asked for
+ * (stack_words * 4, as StackType_t is 32 bit on the nRF52) */
+void host_task_totals(uint32_t *tasks, uint32_t *stack_bytes);
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t wait);
+BaseType_t xTaskNotifyGive(TaskHandle_t t);
+void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t *higher_prio_woken);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TASK_H */
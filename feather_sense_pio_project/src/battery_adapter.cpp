@@ -20,7 +20,7 @@ bool battery_read_adapter(void *pv, sensor_data_t *out) {
     (void)pv;
 
     if (!out) return false;
-    memset(out, 0, sizeof(*out));
+    memset(out->bytes, 0, out->cap);
 
     // Read VBAT
     float measuredvbat = analogRead(VBATPIN);
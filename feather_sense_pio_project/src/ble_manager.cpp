@@ -1,24 +1,66 @@
 #pragma once
 #include <bluefruit.h>
 #include <stdarg.h>
+#include <semphr.h>
 #include "ble_manager.h"
 
 BLEUart bleuart;   // define this in ONE .cpp file only
 
+#define BLE_MAX_MTU     247
+#define BLE_MAX_PAYLOAD (BLE_MAX_MTU - 3)
+
+// Keeps each frame/line in one piece when several tasks write to bleuart
+static SemaphoreHandle_t tx_mutex = NULL;
+
+// Counters; the TX complete and connection ones are bumped from the BLE
+// event callback, so they are read and written in critical sections
+static ble_tx_stats_t tx_stats;
+static uint32_t link_gen = 0;      // bumped on every connect and disconnect
+static uint32_t tx_inflight = 0;   // notifications queued on this link, not yet sent
+
+// Held end of the bulk stream (under tx_mutex): less than one notification
+static uint8_t bulk_tail[BLE_MAX_PAYLOAD];
+static size_t bulk_tail_len = 0;
+static uint32_t bulk_gen = 0;   // link_gen the tail was written under
+static bool bulk_active = false;
+static uint32_t bulk_start_ms = 0;
+static uint32_t bulk_bytes = 0;
+static bool text_live = BLE_TEXT_LIVE;
+
+static void ble_event_cb(ble_evt_t *evt)
+{
+  taskENTER_CRITICAL();
+  if (evt->header.evt_id == BLE_GATTS_EVT_HVN_TX_COMPLETE) {
+    uint8_t n = evt->evt.gatts_evt.params.hvn_tx_complete.count;
+    tx_stats.tx_complete += n;
+    tx_inflight = tx_inflight > n ? tx_inflight - n : 0;
+  } else if (evt->header.evt_id == BLE_GAP_EVT_CONNECTED || evt->header.evt_id == BLE_GAP_EVT_DISCONNECTED) {
+    link_gen++;
+    tx_inflight = 0;   // a dropped link takes its queue with it
+  }
+  taskEXIT_CRITICAL();
+}
+
 void ble_init()
 {
   Serial.println("starting ble init");
 
+  // Largest MTU, event length and HVN queue; config*() must precede begin()
+  Bluefruit.configPrphBandwidth(BANDWIDTH_MAX);
+
   // Start BLE stack: 1 peripheral, 0 central
   Bluefruit.begin(1, 0);
   Bluefruit.setName("FeatherSense UART testing");
   Bluefruit.setTxPower(4);
 
   bleuart.begin();
+  if (!tx_mutex) tx_mutex = xSemaphoreCreateMutex();
   
   // Simple connect/disconnect logs (optional)
+  Bluefruit.setEventCallback(ble_event_cb);
   Bluefruit.Periph.setConnectCallback([](uint16_t connHandle) {
     Serial.println("[BLE] Connected");
+    ble_request_fast_link(connHandle);
   });
   Bluefruit.Periph.setDisconnectCallback([](uint16_t connHandle, uint8_t reason) {
     Serial.printf("[BLE] Disconnected, reason=%d\r\n", reason);
@@ -41,16 +83,162 @@ void ble_init()
   
 }
 
-// Writes data in safe BLE chunks
-void ble_write_bytes_chunked(const uint8_t *data, size_t len) {
-  const size_t CHUNK = 20; // safe default (MTU)
+void ble_request_fast_link(uint16_t conn_handle)
+{
+  BLEConnection *conn = Bluefruit.Connection(conn_handle);
+  if (!conn) return;
+  conn->requestPHY(BLE_GAP_PHY_2MBPS);
+  conn->requestDataLengthUpdate();
+  conn->requestMtuExchange(BLE_MAX_MTU);
+}
+
+size_t ble_tx_payload(void)
+{
+  BLEConnection *conn = Bluefruit.connected() ? Bluefruit.Connection(Bluefruit.connHandle()) : NULL;
+  size_t mtu = conn ? conn->getMtu() : BLE_GATT_ATT_MTU_DEFAULT;
+  if (mtu > BLE_MAX_MTU) mtu = BLE_MAX_MTU;
+  return mtu - 3;
+}
+
+// chunk-sized notifications, no pauses: the stack's notify() blocks until
+// the HVN TX queue has a slot, and slots free on TX complete events
+static void send_locked(const uint8_t *data, size_t len, size_t chunk)
+{
+  size_t payload = ble_tx_payload();
+  if (chunk == 0 || chunk > payload) chunk = payload;
   size_t offset = 0;
   while (offset < len) {
-    size_t to_write = ((len - offset) > CHUNK) ? CHUNK : (len - offset);
-    bleuart.write(data + offset, to_write);
-    offset = to_write;
-    delay(2); // small pause avoids BLE TX overflow
+    size_t to_write = ((len - offset) > chunk) ? chunk : (len - offset);
+    // Counted before the write: its TX complete may beat write() back
+    taskENTER_CRITICAL();
+    tx_inflight++;
+    taskEXIT_CRITICAL();
+    bool ok = bleuart.write(data + offset, to_write) == to_write;
+    taskENTER_CRITICAL();
+    if (ok) {
+      tx_stats.bytes += to_write;
+      tx_stats.notifications++;
+    } else if (tx_inflight) {
+      tx_inflight--;
+    }
+    taskEXIT_CRITICAL();
+    if (!ok) break;
+    offset += to_write;
+  }
+}
+
+// Sends the held end of the bulk stream, unless its link is gone
+static void bulk_tail_locked(void)
+{
+  taskENTER_CRITICAL();
+  bool same_link = bulk_gen == link_gen;
+  taskEXIT_CRITICAL();
+  if (bulk_tail_len && same_link) send_locked(bulk_tail, bulk_tail_len, bulk_tail_len);
+  bulk_tail_len = 0;
+}
+
+// Writes one frame in chunk-sized writes; other writers wait until it's out
+void ble_write_frame(const uint8_t *data, size_t len, size_t chunk) {
+  if (tx_mutex) xSemaphoreTake(tx_mutex, portMAX_DELAY);
+  bulk_tail_locked();
+  send_locked(data, len, chunk);
+  if (tx_mutex) xSemaphoreGive(tx_mutex);
+}
+
+// Writes data in whole notifications
+void ble_write_bytes_chunked(const uint8_t *data, size_t len) {
+  ble_write_frame(data, len, 0);
+}
+
+void ble_write_bulk(const uint8_t *data, size_t len)
+{
+  if (tx_mutex) xSemaphoreTake(tx_mutex, portMAX_DELAY);
+  size_t payload = ble_tx_payload();
+  taskENTER_CRITICAL();
+  uint32_t gen = link_gen;
+  taskEXIT_CRITICAL();
+  if (bulk_gen != gen || bulk_tail_len >= payload) bulk_tail_locked();
+  if (!bulk_active) {
+    bulk_active = true;
+    bulk_start_ms = millis();
+    bulk_bytes = 0;
   }
+  bulk_bytes += len;
+  bulk_gen = gen;
+
+  // Top the held notification up first
+  if (bulk_tail_len) {
+    size_t n = payload - bulk_tail_len;
+    if (n > len) n = len;
+    memcpy(bulk_tail + bulk_tail_len, data, n);
+    bulk_tail_len += n;
+    data += n;
+    len -= n;
+    if (bulk_tail_len == payload) bulk_tail_locked();
+  }
+  size_t whole = len - len % payload;
+  send_locked(data, whole, payload);
+  memcpy(bulk_tail + bulk_tail_len, data + whole, len - whole);
+  bulk_tail_len += len - whole;
+  if (tx_mutex) xSemaphoreGive(tx_mutex);
+}
+
+void ble_bulk_flush(void)
+{
+  if (tx_mutex) xSemaphoreTake(tx_mutex, portMAX_DELAY);
+  bulk_tail_locked();
+  bool was_active = bulk_active;
+  uint32_t bytes = bulk_bytes;
+  bulk_active = false;
+  if (tx_mutex) xSemaphoreGive(tx_mutex);
+  if (!was_active) return;
+
+  // Until the central has it all, or 1 s of no progress
+  uint32_t last = 0, since = millis();
+  while (Bluefruit.connected() && millis() - since < 1000) {
+    taskENTER_CRITICAL();
+    uint32_t left = tx_inflight;
+    taskEXIT_CRITICAL();
+    if (!left) break;
+    if (left != last) { last = left; since = millis(); }
+    delay(1);
+  }
+  uint32_t ms = millis() - bulk_start_ms;
+  taskENTER_CRITICAL();
+  tx_stats.bulk_bytes = bytes;
+  tx_stats.bulk_ms = ms;
+  taskEXIT_CRITICAL();
+
+  ble_tx_stats_t st;
+  ble_get_tx_stats(&st);
+  Serial.printf("[BLE] bulk: %lu bytes in %lu ms = %lu B/s (MTU %u, DLE %u, PHY %s)\r\n",
+                (unsigned long)bytes, (unsigned long)ms,
+                (unsigned long)(ms ? (uint64_t)bytes * 1000u / ms : 0),
+                (unsigned)st.mtu, (unsigned)st.data_len, st.phy == BLE_GAP_PHY_2MBPS ? "2M" : "1M");
+}
+
+uint32_t ble_link_generation(void)
+{
+  taskENTER_CRITICAL();
+  uint32_t gen = link_gen;
+  taskEXIT_CRITICAL();
+  return gen;
+}
+
+void ble_set_text_live(bool on)
+{
+  text_live = on;
+}
+
+void ble_get_tx_stats(ble_tx_stats_t *out)
+{
+  taskENTER_CRITICAL();
+  *out = tx_stats;
+  taskEXIT_CRITICAL();
+  BLEConnection *conn = Bluefruit.connected() ? Bluefruit.Connection(Bluefruit.connHandle()) : NULL;
+  out->mtu = conn ? conn->getMtu() : BLE_GATT_ATT_MTU_DEFAULT;
+  out->data_len = conn ? conn->getDataLength() : 27;
+  out->phy = conn ? conn->getPHY() : BLE_GAP_PHY_1MBPS;
 }
 
 // Prints to both Serial and BLE
@@ -63,6 +251,7 @@ void print_both(const char *fmt, ...) {
   if (n <= 0) return;
 
   Serial.print(buf); // debug console
+  if (!text_live) return;
 
   size_t len = (size_t)((n < (int)sizeof(buf)) ? n : (int)sizeof(buf - 1));
   ble_write_bytes_chunked((const uint8_t*)buf, len);
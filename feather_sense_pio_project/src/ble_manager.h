@@ -18,7 +18,45 @@ void my_disconnect_cb();
 
 void ble_init(void);
 void startAdv(void);
+void ble_write_frame(const uint8_t *data, size_t len, size_t chunk);
 void ble_write_bytes_chunked(const uint8_t *data, size_t len);
 void print_both(const char *fmt, ...);
 
+// print_both() text goes to the BLE UART too, the live format before
+// telemetry.h; off (the default), the UART carries binary frames only
+#ifndef BLE_TEXT_LIVE
+#define BLE_TEXT_LIVE 0
+#endif
+void ble_set_text_live(bool on);
+
+// Changes on every connect and disconnect
+uint32_t ble_link_generation(void);
+
+// Ask the central for the largest ATT MTU, LL data length and the 2M PHY.
+// Call from the connect callback; the central may settle for less.
+void ble_request_fast_link(uint16_t conn_handle);
+
+// Notification payload on the current link: ATT MTU - 3
+size_t ble_tx_payload(void);
+
+// Bulk stream (log upload): frames go out in full notifications, the
+// remainder waits for the next frame. Any other write or ble_bulk_flush()
+// sends it first; a disconnect drops it. The flush waits for the TX queue
+// to drain and logs the transfer rate.
+void ble_write_bulk(const uint8_t *data, size_t len);
+void ble_bulk_flush(void);
+
+typedef struct {
+  uint16_t mtu;             // ATT MTU (23 until exchanged)
+  uint16_t data_len;        // LL payload bytes per packet (27 without DLE)
+  uint8_t phy;              // BLE_GAP_PHY_1MBPS or BLE_GAP_PHY_2MBPS
+  uint32_t bytes;           // payload bytes handed to the stack
+  uint32_t notifications;   // handed to the stack
+  uint32_t tx_complete;     // reported sent by HVN TX complete events
+  uint32_t bulk_bytes;      // last bulk transfer, first write to drained
+  uint32_t bulk_ms;
+} ble_tx_stats_t;
+
+void ble_get_tx_stats(ble_tx_stats_t *out);
+
 #endif
\ No newline at end of file
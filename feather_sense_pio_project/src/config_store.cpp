@@ -0,0 +1,264 @@
+// src/config_store.cpp
+#include <Arduino.h>
+#include <semphr.h>
+#include "config_store.h"
+#include "storage.h"
+#include "sensor_manager.h"
+#include <float.h>
+
+/* ---- Flash format ----
+ * Two 4 KB sectors after the log's cursor (flash_layout.h), one active. Each
+ * is a list of 8-byte slots; slot 0 is the header, the rest are entries
+ * appended in order:
+ *   header [magic u32][gen u16][commit u16]
+ *   entry  [key u16][value u32][type u8][commit u8]
+ * Fields are programmed first and the commit last, so a torn write reads
+ * as a dead slot. Later entries win; type CFG_NONE drops the override.
+ * When the active sector fills, the live overrides are copied to the
+ * other one under gen + 1, and its header commit is the switch-over: a
+ * power cut before it leaves the old sector active. That is one erase per
+ * ~500 sets, alternating between the two sectors. Boot reads the two
+ * headers and then the active sector once. */
+#define CONFIG_BASE         FLASH_CONFIG_BASE
+#define CONFIG_SECTORS      FLASH_CONFIG_SECTORS
+#define CONFIG_SECTOR_BYTES 4096u
+#define CONFIG_SLOT_BYTES   8
+#define CONFIG_SLOTS        (CONFIG_SECTOR_BYTES / CONFIG_SLOT_BYTES)
+#define CONFIG_MAGIC        0x31474643u   // "CFG1"
+#define CONFIG_HDR_COMMIT   0xC0F1u
+#define CONFIG_ENTRY_COMMIT 0xC5
+
+typedef struct {
+  uint32_t value;
+  uint8_t type;   // config_type_t
+} config_val_t;
+
+/* What each key accepts, in key order; anything else fails to set */
+typedef struct {
+  uint8_t type;
+  double min, max;
+} config_spec_t;
+
+#define RATE_SPEC { CFG_F32, SENSOR_FREQ_MIN_HZ, SENSOR_FREQ_MAX_HZ }
+static const config_spec_t specs[] = {
+  RATE_SPEC,                          // CFG_TEMP_HZ
+  RATE_SPEC,                          // CFG_SPO2_HZ
+  RATE_SPEC,                          // CFG_SPO2_2_HZ
+  RATE_SPEC,                          // CFG_SPO2_FUSION_HZ
+  RATE_SPEC,                          // CFG_IMU_HZ
+  RATE_SPEC,                          // CFG_MIC_HZ
+  RATE_SPEC,                          // CFG_BATTERY_HZ
+  { CFG_I32, 1, 100000 },             // CFG_SPO2_WINDOW: samples, divides the RMS sums
+  { CFG_F32, 0.0, 1.0 },              // CFG_SPO2_DC_IIR
+  { CFG_F32, 0.0, 1.0 },              // CFG_SPO2_SMOOTH
+  { CFG_F32, 0.0, 8000.0 },           // CFG_MIC_MIN_HZ: below Nyquist
+  { CFG_F32, 0.0, 8000.0 },           // CFG_MIC_MAX_HZ
+  { CFG_F32, 0.0, FLT_MAX },          // CFG_MIC_MIN_MAG: any finite >= 0
+  { CFG_F32, 0.0, FLT_MAX },          // CFG_MIC_MAX_MAG
+  { CFG_F32, -300.0, 300.0 },         // CFG_TEMP_OFFSET_C
+  { CFG_I32, 0, STORAGE_BATCH_BYTES },  // CFG_FLUSH_WATERMARK
+};
+static_assert(sizeof(specs) / sizeof(specs[0]) == CONFIG_KEY_COUNT, "a spec per config key");
+
+static bool value_ok(config_key_t key, uint8_t type, uint32_t value) {
+  const config_spec_t *sp = &specs[key];
+  if (type == CFG_NONE) return true;
+  if (type != sp->type) return false;
+  double v;
+  if (type == CFG_I32) {
+    v = (int32_t)value;
+  } else {
+    float f;
+    memcpy(&f, &value, sizeof(f));
+    v = f;
+  }
+  return v >= sp->min && v <= sp->max;   // false for NaN
+}
+
+typedef struct {
+  config_key_t key;
+  config_cb_t cb;
+  void *ctx;
+} config_sub_t;
+
+// Getters read vals[] without the lock: one key's type never changes in
+// practice, and the 32-bit value is a single load
+static config_val_t vals[CONFIG_KEY_COUNT];
+static config_sub_t subs[CONFIG_MAX_SUBSCRIBERS];
+static uint8_t n_subs = 0;
+static SemaphoreHandle_t cfg_mutex = NULL;
+static bool flash_ok = false;
+static uint32_t active = 0;       // sector index, 0..CONFIG_SECTORS-1
+static uint16_t active_gen = 0;
+static uint32_t next_slot = 1;    // first free slot in the active sector
+
+static inline uint32_t slot_addr(uint32_t sector, uint32_t slot) {
+  return CONFIG_BASE + sector * CONFIG_SECTOR_BYTES + slot * CONFIG_SLOT_BYTES;
+}
+
+static bool read_hdr(uint32_t sector, uint16_t *gen) {
+  uint8_t h[CONFIG_SLOT_BYTES];
+  uint32_t magic;
+  uint16_t commit;
+  if (!flash_read(slot_addr(sector, 0), h, sizeof(h))) return false;
+  memcpy(&magic, h, 4);
+  memcpy(gen, h + 4, 2);
+  memcpy(&commit, h + 6, 2);
+  return magic == CONFIG_MAGIC && commit == CONFIG_HDR_COMMIT;
+}
+
+// Fields, then the commit byte
+static bool write_entry(uint32_t sector, uint32_t slot, uint16_t key, const config_val_t *v) {
+  uint8_t e[CONFIG_SLOT_BYTES - 1];
+  memcpy(e, &key, 2);
+  memcpy(e + 2, &v->value, 4);
+  e[6] = v->type;
+  uint8_t c = CONFIG_ENTRY_COMMIT;
+  uint32_t addr = slot_addr(sector, slot);
+  return flash_write(addr, e, sizeof(e)) && flash_write(addr + sizeof(e), &c, 1);
+}
+
+// New sector under gen with the live overrides; committed last
+static bool start_sector_locked(uint32_t sector, uint16_t gen) {
+  if (!flash_erase_sector((CONFIG_BASE + sector * CONFIG_SECTOR_BYTES) / FLASH_SECTOR_SIZE)) return false;
+  uint8_t h[6];
+  uint32_t magic = CONFIG_MAGIC;
+  memcpy(h, &magic, 4);
+  memcpy(h + 4, &gen, 2);
+  if (!flash_write(slot_addr(sector, 0), h, sizeof(h))) return false;
+  uint32_t slot = 1;
+  for (uint16_t k = 0; k < CONFIG_KEY_COUNT; ++k) {
+    if (vals[k].type == CFG_NONE) continue;
+    if (!write_entry(sector, slot++, k, &vals[k])) return false;
+  }
+  uint16_t commit = CONFIG_HDR_COMMIT;
+  if (!flash_write(slot_addr(sector, 0) + 6, (const uint8_t *)&commit, 2)) return false;
+  active = sector;
+  active_gen = gen;
+  next_slot = slot;
+  return true;
+}
+
+static void load_sector_locked(uint32_t sector) {
+  uint8_t buf[256];
+  next_slot = CONFIG_SLOTS;
+  for (uint32_t s = 0; s < CONFIG_SLOTS; s += sizeof(buf) / CONFIG_SLOT_BYTES) {
+    flash_read(slot_addr(sector, s), buf, sizeof(buf));
+    for (uint32_t k = 0; k < sizeof(buf) / CONFIG_SLOT_BYTES; ++k) {
+      if (s + k == 0) continue;   // header
+      const uint8_t *e = buf + k * CONFIG_SLOT_BYTES;
+      uint16_t key;
+      memcpy(&key, e, 2);
+      if (key == 0xFFFF && e[7] == 0xFF) {   // slots fill in order
+        next_slot = s + k;
+        return;
+      }
+      if (e[7] != CONFIG_ENTRY_COMMIT || key >= CONFIG_KEY_COUNT) continue;
+      memcpy(&vals[key].value, e + 2, 4);
+      vals[key].type = e[6] <= CFG_F32 ? e[6] : (uint8_t)CFG_NONE;
+    }
+  }
+}
+
+bool config_init(void) {
+  if (!cfg_mutex) cfg_mutex = xSemaphoreCreateMutex();
+  if (!cfg_mutex) return false;
+  xSemaphoreTake(cfg_mutex, portMAX_DELAY);
+  memset(vals, 0, sizeof(vals));
+  flash_ok = flash_init();
+  if (flash_ok) {
+    uint16_t gen[CONFIG_SECTORS];
+    bool ok[CONFIG_SECTORS];
+    int best = -1;
+    for (uint32_t s = 0; s < CONFIG_SECTORS; ++s) {
+      ok[s] = read_hdr(s, &gen[s]);
+      if (ok[s] && (best < 0 || (int16_t)(gen[s] - gen[best]) > 0)) best = (int)s;
+    }
+    if (best < 0) {
+      flash_ok = start_sector_locked(0, 1);   // first boot: empty store
+    } else {
+      active = (uint32_t)best;
+      active_gen = gen[best];
+      load_sector_locked(active);
+    }
+  }
+  xSemaphoreGive(cfg_mutex);
+  Serial.printf("[CFG] %s, sector %u gen %u, %u slots used\n", flash_ok ? "loaded" : "no flash, defaults",
+                (unsigned)active, (unsigned)active_gen, (unsigned)next_slot);
+  return flash_ok;
+}
+
+int32_t config_get_i32(config_key_t key, int32_t def) {
+  if ((unsigned)key >= CONFIG_KEY_COUNT || vals[key].type != CFG_I32) return def;
+  return (int32_t)vals[key].value;
+}
+
+float config_get_f32(config_key_t key, float def) {
+  if ((unsigned)key >= CONFIG_KEY_COUNT || vals[key].type != CFG_F32) return def;
+  float f;
+  uint32_t v = vals[key].value;
+  memcpy(&f, &v, sizeof(f));
+  return f;
+}
+
+bool config_has(config_key_t key) {
+  return (unsigned)key < CONFIG_KEY_COUNT && vals[key].type != CFG_NONE;
+}
+
+static bool config_put(config_key_t key, uint8_t type, uint32_t value) {
+  if ((unsigned)key >= CONFIG_KEY_COUNT || !cfg_mutex || !value_ok(key, type, value)) return false;
+  xSemaphoreTake(cfg_mutex, portMAX_DELAY);
+  config_val_t v = { type == CFG_NONE ? 0xFFFFFFFFu : value, type };
+  if (vals[key].type == v.type && (type == CFG_NONE || vals[key].value == v.value)) {
+    xSemaphoreGive(cfg_mutex);
+    return true;   // unchanged: no flash write, no callbacks
+  }
+  bool ok = true;
+  config_val_t old = vals[key];
+  vals[key] = v;
+  if (flash_ok) {
+    if (next_slot >= CONFIG_SLOTS) {
+      // Compaction writes vals[] as it is now, this change included
+      ok = start_sector_locked((active + 1) % CONFIG_SECTORS, (uint16_t)(active_gen + 1));
+    } else {
+      ok = write_entry(active, next_slot++, (uint16_t)key, &v);
+    }
+    if (!ok) vals[key] = old;
+  }
+  xSemaphoreGive(cfg_mutex);
+  if (!ok) return false;
+
+  for (uint8_t i = 0; i < n_subs; ++i) {
+    if (subs[i].key == key) subs[i].cb(subs[i].ctx, key);
+  }
+  return true;
+}
+
+bool config_set_i32(config_key_t key, int32_t value) {
+  return config_put(key, CFG_I32, (uint32_t)value);
+}
+
+bool config_set_f32(config_key_t key, float value) {
+  uint32_t v;
+  memcpy(&v, &value, sizeof(v));
+  return config_put(key, CFG_F32, v);
+}
+
+bool config_reset(config_key_t key) {
+  return config_put(key, CFG_NONE, 0);
+}
+
+bool config_set_typed(config_key_t key, config_type_t type, uint32_t value) {
+  if (type > CFG_F32) return false;
+  return config_put(key, (uint8_t)type, value);
+}
+
+// Subscribers are added during setup, before anything sets keys
+bool config_subscribe(config_key_t key, config_cb_t cb, void *ctx) {
+  if ((unsigned)key >= CONFIG_KEY_COUNT || !cb || n_subs >= CONFIG_MAX_SUBSCRIBERS) return false;
+  subs[n_subs].key = key;
+  subs[n_subs].cb = cb;
+  subs[n_subs].ctx = ctx;
+  n_subs++;
+  return true;
+}
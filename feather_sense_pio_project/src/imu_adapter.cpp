@@ -27,12 +27,26 @@ bool imu_read_adapter(void *ctx, sensor_data_t *out){
     }
 
     //Pack up ypr data (type euler_t{ float yaw, float pitch, float roll}) into sensor_data_t
-    memcpy(out, &ypr_in, sizeof(euler_t));
+    memcpy(out->bytes, &ypr_in, sizeof(euler_t));
 
-    out->len = 12; //len of data??? Should be 12 (3 floats)
+    out->len = sizeof(euler_t); // 3 floats
     return true;
 }
 
+// Sleeping position from roll: 0 extreme right .. 4 extreme left
+uint8_t imu_position_bin(const uint8_t *payload, size_t len, void *ctx)
+{
+    (void)ctx;
+    if (len < sizeof(euler_t)) return 0xFF;
+    euler_t e;
+    memcpy(&e, payload, sizeof(euler_t));
+    if (e.roll <= -90.f) return 0;
+    if (e.roll <= -30.f) return 1;
+    if (e.roll <= 30.f) return 2;
+    if (e.roll < 90.f) return 3;
+    return 4;
+}
+
 bool imu_print_adapter(void *ctx, const sensor_data_t *d)
 {
     (void)ctx;
@@ -43,7 +57,7 @@ bool imu_print_adapter(void *ctx, const sensor_data_t *d)
     }
 
     euler_t ypr_out;
-    memcpy(&ypr_out, d, sizeof(euler_t));   // keep your original behavior
+    memcpy(&ypr_out, d->bytes, sizeof(euler_t));
 
     // Prints everything on one line (tab-delimited)
     //print_both("status: %d\t", sensorValue.status);   // optional
@@ -57,7 +57,7 @@ void imu_sensor_init(void) {
   Wire.setClock(100000UL);
 
   // Try to acquire the shared I2C bus for a short time to probe the IMU.
-  if (!sensor_bus_lock(pdMS_TO_TICKS(100))) {
+  if (!sensor_bus_lock(SENSOR_BUS_WIRE, 100)) {
     Serial.println("imu_sensor_init: failed to lock I2C for init - skipping probe");
     return;
   }
@@ -69,7 +69,7 @@ void imu_sensor_init(void) {
   }
 
   // Release the bus ASAP
-  sensor_bus_unlock();
+  sensor_bus_unlock(SENSOR_BUS_WIRE);
 
   if (!found) {
     Serial.println("imu_sensor_init: Failed to find BNO08x chip (probe attempt). Continuing without IMU.");
@@ -79,9 +79,9 @@ void imu_sensor_init(void) {
   Serial.println("imu_sensor_init: BNO08x Found!");
 
   // Configure reports — wrap in bus lock because it likely uses I2C internally.
-  if (sensor_bus_lock(pdMS_TO_TICKS(200))) {
+  if (sensor_bus_lock(SENSOR_BUS_WIRE, 200)) {
     setReports(reportType, reportIntervalUs);
-    sensor_bus_unlock();
+    sensor_bus_unlock(SENSOR_BUS_WIRE);
   } else {
     Serial.println("imu_sensor_init: could not lock bus to call setReports(); try will occur later in reads.");
   }
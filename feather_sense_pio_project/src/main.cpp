@@ -4,6 +4,10 @@
 #include <bluefruit.h>
 #include "storage.h"
 #include "spo2_fusion.h"
+#include "rate_governor.h"
+#include "sensor_sinks.h"
+#include "config_store.h"
+#include "telemetry.h"
 
 // Forward declarations of your adapter functions (must be defined elsewhere in the project)
 extern BaseType_t create_battery_monitor_task(UBaseType_t, uint16_t, TickType_t);
@@ -23,10 +27,12 @@ extern void spo2_print_adapter_2(void *ctx, const sensor_data_t *d);
 extern bool imu_init_adapter(void *ctx);
 extern bool imu_read_adapter(void *ctx, sensor_data_t *out);
 extern void imu_print_adapter(void *ctx, const sensor_data_t *d);
+extern uint8_t imu_position_bin(const uint8_t *payload, size_t len, void *ctx);
 
 extern bool mic_init_adapter(void *ctx);
 extern bool mic_read_adapter(void *ctx, sensor_data_t *out);
 extern void mic_print_adapter(void *ctx, const sensor_data_t *d);
+extern void mic_set_notify_sensor(int idx);
 extern bool spo2_init_fusion_adapter(void *ctx);
 extern bool spo2_read_fusion_adapter(void *ctx, sensor_data_t *out);
 extern void spo2_print_fusion_adapter(void *ctx, const sensor_data_t *d);
@@ -35,16 +41,32 @@ extern bool battery_init_adapter(void *ctx);
 extern bool battery_read_adapter(void *ctx, sensor_data_t *out);
 extern void battery_print_adapter(void *ctx, const sensor_data_t *d);
 
+// Event-driven acquisition: GPIO wired to the BNO08x INT line (-1 = poll at the
+// registered rate). MIC_EVENT_DRIVEN samples every PDM buffer instead of 2 Hz.
+#define IMU_INT_PIN       -1
+#define MIC_EVENT_DRIVEN  0
+
+// Samples logged to flash. Raw mic audio (~2 KB/s) would fill the log in
+// minutes, so it stays off; add SENSOR_SINK_BLE/SERIAL for live streaming.
+#define LOG_SINKS  SENSOR_FLAG_SINK(SENSOR_SINK_FLASH)
+
 // Called on BLE central connect
 void my_connect_cb(uint16_t conn_handle) {
+  Serial.println("BLE connected -> resuming storage upload");
+  ble_request_fast_link(conn_handle);
+  // Only queues the request; the storage upload task does the sending
+  storage_upload_over_ble();
+}
+
+// Central wrote to the UART: upload requests and acks
+void my_rx_cb(uint16_t conn_handle) {
   (void)conn_handle;
-  Serial.println("BLE connected -> starting storage upload task");
-  // Kick upload in a short task to avoid blocking the BLE callback
-  xTaskCreate([](void *pv) {
-      (void)pv;
-      storage_upload_over_ble();
-      vTaskDelete(NULL);
-  }, "stor-up", 8192, NULL, 2, NULL);
+  uint8_t buf[32];
+  while (bleuart.available()) {
+    int n = bleuart.read(buf, sizeof(buf));
+    if (n <= 0) break;
+    storage_upload_rx(buf, (size_t)n);
+  }
 }
 
 void my_disconnect_cb(uint16_t conn_handle, uint8_t reason) {
@@ -52,6 +74,28 @@ void my_disconnect_cb(uint16_t conn_handle, uint8_t reason) {
   Serial.println("BLE disconnected");
 }
 
+// A rate key changed: for a governed sensor it is the governor's max_hz
+// (a reset key goes back to the rule's), otherwise the rate itself (a reset
+// key keeps the current rate until the next boot)
+static void rate_changed(void *ctx, config_key_t key) {
+  int idx = (int)(intptr_t)ctx;
+  if (rate_governor_set_bounds(idx, 0.0f, config_get_f32(key, 0.0f))) return;
+  if (config_has(key)) sensor_set_freq(idx, config_get_f32(key, sensor_get_freq(idx)));
+}
+
+// Stored overrides apply now too: the governed sensors' bounds weren't
+// known when they registered
+static void watch_rate(config_key_t key, int idx) {
+  if (idx < 0) return;
+  config_subscribe(key, rate_changed, (void *)(intptr_t)idx);
+  if (config_has(key)) rate_changed((void *)(intptr_t)idx, key);
+}
+
+static void watermark_changed(void *ctx, config_key_t key) {
+  (void)ctx;
+  storage_set_flush_watermark((size_t)config_get_i32(key, STORAGE_FLUSH_WATERMARK));
+}
+
 void setup() {
   Serial.begin(115200);
 
@@ -73,8 +117,9 @@ void setup() {
     // BLE callbacks
     Bluefruit.Periph.setConnectCallback(my_connect_cb);
     Bluefruit.Periph.setDisconnectCallback(my_disconnect_cb);
+    bleuart.setRxCallback(my_rx_cb);
 
-    // Initialize storage (flush every 60s, 4KB RAM buffer)
+    // Initialize storage (records wait in RAM at most 60s, 4KB RAM buffer)
     if (!storage_init(60*1000, 4*1024)) {
         Serial.println("storage_init failed!");
         // non-fatal for demo: continue but no persistent logs will be saved
@@ -82,95 +127,167 @@ void setup() {
         Serial.println("storage_init OK");
     }
 
+    // Runtime tunables (rates, SpO2/mic/temp parameters) from flash
+    if (!config_init()) {
+        Serial.println("config_init failed, using built-in defaults");
+    }
+    storage_set_flush_watermark((size_t)config_get_i32(CFG_FLUSH_WATERMARK, STORAGE_FLUSH_WATERMARK));
+    config_subscribe(CFG_FLUSH_WATERMARK, watermark_changed, NULL);
+
     //Initialize the sensor manager
     Serial.println("Initializing sensor manager...");
-    if (!sensor_manager_init()) {
+    // One dispatcher task drives all sensors instead of a 2048-word stack per sensor
+    if (!sensor_manager_init_mode(SENSOR_SCHED_DISPATCHER)) {
         Serial.println("sensor_manager_init failed!");
         while (1) delay(1000);
     }
     Serial.println("sensor_manager_init OK");
 
+    if (!sensor_sinks_init(1, 1024)) {
+        Serial.println("sensor_sinks_init failed, live sinks disabled");
+    }
+
 //    Register temperature sensor (uses temp_adapter/temp_sensor_module)
-    int temp_idx = sensor_register(
+    int temp_idx = sensor_register_ex(
         "temp",
         temp_init_adapter,
         temp_read_adapter,
         temp_print_adapter,
         NULL,
-        1,  // frequency in Hz
-        true   // start enabled
+        config_get_f32(CFG_TEMP_HZ, 1),  // frequency in Hz
+        true,  // start enabled
+        2,     // max payload: int16 (temp_c * 100)
+        SENSOR_FLAG_BUS(SENSOR_BUS_WIRE) | LOG_SINKS
     );
     Serial.printf("registered sensor temp_idx=%d\r\n", temp_idx);
 
     // Register SPO2 sensor (uses spo2_adapter/spo2_module)
-    int spo2_idx = sensor_register(
+    int spo2_idx = sensor_register_ex(
         "spo2",
         spo2_init_adapter,
         spo2_read_adapter,
         spo2_print_adapter,
         NULL,
-        0.2, // frequency in Hz
-        true   // start enabled
+        config_get_f32(CFG_SPO2_HZ, 0.2), // frequency in Hz
+        true,  // start enabled
+        20,    // max payload: 5 floats
+        LOG_SINKS  // reads module globals; spo2 task locks Wire itself
     );
     Serial.printf("registered sensor spo2_idx=%d\r\n", spo2_idx);
 
     // Register SPO2 sensor #2 (uses spo2_adapter_2/spo2_module_2)
-    int spo2_idx_2 = sensor_register(
+    int spo2_idx_2 = sensor_register_ex(
         "spo2_2",
         spo2_init_adapter_2,
         spo2_read_adapter_2,
         spo2_print_adapter_2,
         NULL,
-        0.2, // frequency in Hz
-        true   // start enabled
+        config_get_f32(CFG_SPO2_2_HZ, 0.2), // frequency in Hz
+        true,  // start enabled
+        20,    // max payload: 5 floats
+        LOG_SINKS  // reads module globals; spo2 task locks Wire1 itself
     );
     Serial.printf("registered sensor spo2_idx_2=%d\r\n", spo2_idx_2);
 
-    int spo2_fusion_idx = sensor_register(
+    int spo2_fusion_idx = sensor_register_ex(
         "spo2_fusion",
         spo2_init_fusion_adapter,
         spo2_read_fusion_adapter,
         spo2_print_fusion_adapter,
         NULL,
-        1, // frequency in Hz
-        true   // start enabled
+        config_get_f32(CFG_SPO2_FUSION_HZ, 1), // frequency in Hz
+        true,  // start enabled
+        8,     // max payload: 2 floats (SpO2, HR)
+        LOG_SINKS
     );
     Serial.printf("registered sensor spo2_fusion_idx=%d\r\n", spo2_fusion_idx);    
 
     // Register IMU sensor (uses imu_adapter/imu_module)
-    int imu_idx = sensor_register(
+    int imu_idx = sensor_register_ex(
         "imu",
         imu_init_adapter,
         imu_read_adapter,
         imu_print_adapter,
         NULL,
-        1, // frequency in Hz
-        true   // start enabled
+        config_get_f32(CFG_IMU_HZ, 1), // frequency in Hz
+        true,  // start enabled
+        12,    // max payload: euler_t (yaw/pitch/roll floats)
+        SENSOR_FLAG_BUS(SENSOR_BUS_WIRE) | (IMU_INT_PIN >= 0 ? SENSOR_FLAG_EVENT : 0) | LOG_SINKS
     );
     Serial.printf("registered sensor imu_idx=%d\r\n", imu_idx);
+    if (IMU_INT_PIN >= 0) sensor_attach_irq(imu_idx, IMU_INT_PIN, FALLING);
+    // The governor runs the IMU up to 10 Hz; the 1 s printer tick sends
+    // every sample from this queue rather than the latest one
+    if (!sensor_attach_queue(imu_idx, 12)) Serial.println("imu queue failed, snapshots only");
 
     // Register MIC sensor
-    int mic_idx = sensor_register(
+    int mic_idx = sensor_register_ex(
         "mic",
         mic_init_adapter,
         mic_read_adapter,
         mic_print_adapter,
         NULL,
-        2, 
-        true
+        config_get_f32(CFG_MIC_HZ, 2),
+        true,
+        1024,  // max payload: mic_data (512 PCM samples)
+        SENSOR_FLAG_BUS(SENSOR_BUS_PDM) | (MIC_EVENT_DRIVEN ? SENSOR_FLAG_EVENT : 0)
     );
     Serial.printf("registered sensor mic_idx=%d\r\n", mic_idx);
+    mic_set_notify_sensor(mic_idx);
 
-    int battery_idx = sensor_register(
+    int battery_idx = sensor_register_ex(
         "battery",
         battery_init_adapter,
         battery_read_adapter,
         battery_print_adapter,
         NULL, 
-        1, 
-        true
+        config_get_f32(CFG_BATTERY_HZ, 1),
+        true,
+        1,     // max payload: percent
+        SENSOR_FLAG_BUS(SENSOR_BUS_ADC) | LOG_SINKS
     );
     Serial.printf("registered sensor battery_idx=%d\r\n", battery_idx);
+
+    // Flash record codecs, matching each adapter's payload layout
+    storage_set_codec(temp_idx, RECORD_CODEC_I16BE_DELTA);
+    storage_set_codec(spo2_idx, RECORD_CODEC_F32BE_XOR);
+    storage_set_codec(spo2_idx_2, RECORD_CODEC_F32BE_XOR);
+    storage_set_codec(spo2_fusion_idx, RECORD_CODEC_F32BE_XOR);
+    storage_set_codec(imu_idx, RECORD_CODEC_F32LE_XOR);   // euler_t memcpy'd
+    storage_set_codec(battery_idx, RECORD_CODEC_U8_DELTA);
+
+    // Live telemetry: the sensors the text view used to print, each in its
+    // payload's layout (see telemetry.h); the rest reach BLE only via sinks
+    telemetry_set_layout(temp_idx, TELEM_LAYOUT_I16BE);
+    telemetry_set_layout(spo2_fusion_idx, TELEM_LAYOUT_F32BE);
+    telemetry_set_layout(imu_idx, TELEM_LAYOUT_F32LE);
+    telemetry_set_layout(battery_idx, TELEM_LAYOUT_U8);
+
+    // Per-minute summaries once raw data ages out: ESpO2 (nadir) and HR for
+    // the SpO2 sensors, roll and a position histogram for the IMU; the rest
+    // keep every value
+    storage_set_summary(spo2_idx, (1 << 3) | (1 << 4), 0, NULL, NULL);
+    storage_set_summary(spo2_idx_2, (1 << 3) | (1 << 4), 0, NULL, NULL);
+    storage_set_summary(imu_idx, 1 << 2, 5, imu_position_bin, NULL);
+
+    // Adaptive rates: full rate on activity, decay towards the floor when
+    // still (rules in rate_governor.cpp, shared with governor_bench)
+    rate_governor_add(temp_idx, rate_metric_temp, NULL, &rate_rule_temp);
+    rate_governor_add(imu_idx, rate_metric_imu, NULL, &rate_rule_imu);
+    rate_governor_add(spo2_idx, rate_metric_spo2_drop, NULL, &rate_rule_spo2);
+    rate_governor_add(spo2_idx_2, rate_metric_spo2_drop, NULL, &rate_rule_spo2);
+    rate_governor_start(1, 1024, RATE_GOV_PERIOD_MS);
+
+    // Rate overrides set at runtime take effect immediately; after the
+    // governor so its sensors' keys move their bounds
+    watch_rate(CFG_TEMP_HZ, temp_idx);
+    watch_rate(CFG_SPO2_HZ, spo2_idx);
+    watch_rate(CFG_SPO2_2_HZ, spo2_idx_2);
+    watch_rate(CFG_SPO2_FUSION_HZ, spo2_fusion_idx);
+    watch_rate(CFG_IMU_HZ, imu_idx);
+    watch_rate(CFG_MIC_HZ, mic_idx);
+    watch_rate(CFG_BATTERY_HZ, battery_idx);
+
     // Create a periodic print task (every 1 second) for quick feedback
     create_sensor_printer_task(1, 4096, 1000);
     //create_battery_monitor_task(1, 4096, 500);
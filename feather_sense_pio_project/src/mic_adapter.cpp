@@ -1,4 +1,5 @@
 #include "mic.h"
+#include "config_store.h"
 
 extern bool mic_sensor_init(void);
 extern bool readMic(mic_data*);
@@ -55,10 +56,11 @@ void do_fft_on_shorts_inplace(const int16_t *pcm_shorts) {
     float invN = 1.0f / (float)N;
     for (uint32_t k = 0; k < N/2; ++k) mag[k] *= invN;
 
-    const float MIN_FREQ = 700.0f;
-    const float MAX_FREQ = 900.0f;
-    const float MIN_MAG  = 0.000008f;
-    const float MAX_MAG  = 0.00005f;
+    // Tunable live through the config store
+    const float MIN_FREQ = config_get_f32(CFG_MIC_MIN_HZ, 700.0f);
+    const float MAX_FREQ = config_get_f32(CFG_MIC_MAX_HZ, 900.0f);
+    const float MIN_MAG  = config_get_f32(CFG_MIC_MIN_MAG, 0.000008f);
+    const float MAX_MAG  = config_get_f32(CFG_MIC_MAX_MAG, 0.00005f);
 
     // Compute bin range (do once)
     uint32_t k_start = (uint32_t)ceilf((MIN_FREQ * N) / SAMPLE_RATE);
@@ -121,7 +123,7 @@ bool mic_read_adapter(void *ctx, sensor_data_t *out){
     memcpy(out->bytes, data_struct.buffer, sizeof(mic_data));
     //Serial.printf("OUT yaw: %f, pitch: %f, roll: %f \n", ypr_in.yaw, ypr_in.pitch, ypr_in.roll);
 
-    out->len = 12; //len of data??? Should be 12 (3 floats)
+    out->len = sizeof(mic_data);
     return true;
 }
 
@@ -136,7 +138,7 @@ bool mic_print_adapter(void *ctx, const sensor_data_t *d){
     // printf("IN PRINT ADAPTER\n");
     mic_data mic_out;
 
-    memcpy(&mic_out.buffer, d, sizeof(mic_data));
+    memcpy(&mic_out.buffer, d->bytes, sizeof(mic_data));
     
     if(buffer_full == 1){
         // int snore_val_count = 0;      
@@ -21,6 +21,13 @@ static volatile uint32_t tailSamples = 0; // next read index (in samples)
 
 bool buffer_full = 0;
 
+// Sensor to wake from the PDM callback when it is event driven
+static volatile int notify_sensor_idx = -1;
+
+void mic_set_notify_sensor(int idx) {
+  notify_sensor_idx = idx;
+}
+
 // Helper: convert byte indices to sample indices. We keep indices in bytes for generality.
 inline uint32_t byte_to_sample_index(uint32_t byteIndex) {
   return (byteIndex >> 1) & (BUFFER_SAMPLES - 1); // divide by 2, wrap to sample array length
@@ -96,6 +103,13 @@ void onPDMdata() {
     else{
       headSamples = 0;
     }
+
+    // A fresh buffer is ready: wake the mic sensor (no-op unless SENSOR_FLAG_EVENT)
+    if (notify_sensor_idx >= 0) {
+      BaseType_t woken = pdFALSE;
+      sensor_notify_from_isr(notify_sensor_idx, &woken);
+      portYIELD_FROM_ISR(woken);
+    }
 }
 
 bool mic_sensor_init(void) {
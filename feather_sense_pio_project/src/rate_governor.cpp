@@ -0,0 +1,250 @@
+// src/rate_governor.cpp
+#include "rate_governor.h"
+#include "sensor_queue.h"
+#include <string.h>
+#include <math.h>
+#include <Arduino.h>
+
+typedef struct {
+    int sensor_idx;
+    rate_metric_cb metric;
+    void *ctx;
+    rate_rule_t rule;
+    rate_rule_t base;        // as added; rate_governor_set_bounds() 0 restores it
+    rate_state_t state;
+
+    sensor_queue_t *queue;   // every sample, or NULL: the latest one per poll
+    int consumer;
+    bool attached;           // queue attach tried
+    TickType_t last_ts;
+    size_t prev_len;
+    bool have_prev;
+    uint8_t prev[RATE_GOV_PREV_BYTES];
+} rate_entry_t;
+
+static rate_entry_t entries[RATE_GOV_MAX];
+static volatile int entry_count = 0;
+static TickType_t gov_period = pdMS_TO_TICKS(RATE_GOV_PERIOD_MS);
+static TaskHandle_t gov_handle = NULL;
+
+// Only the governor task reads samples, so one full-size scratch record is enough
+static sensor_data_t scratch;
+
+float rate_governor_step(const rate_rule_t *r, rate_state_t *st, float metric, float cur_hz)
+{
+    float next = cur_hz;
+    if (metric >= r->raise_above) {
+        st->calm = 0;
+        next = r->max_hz;
+    } else if (metric <= r->lower_below) {
+        if (++st->calm >= r->calm_evals) {
+            st->calm = 0;
+            next = cur_hz * r->step_down;
+        }
+    } else {
+        st->calm = 0;
+    }
+
+    if (next > r->max_hz) next = r->max_hz;
+    if (next < r->min_hz) next = r->min_hz;
+    if (next > cur_hz) st->raises++;
+    else if (next < cur_hz) st->lowers++;
+    return next;
+}
+
+bool rate_governor_add(int sensor_idx, rate_metric_cb metric, void *ctx, const rate_rule_t *rule)
+{
+    if (!metric || !rule || sensor_idx < 0) return false;
+    if (rule->min_hz <= 0.0f || rule->max_hz < rule->min_hz) return false;
+    if (rule->step_down <= 0.0f || rule->step_down >= 1.0f) return false;
+    if (entry_count >= RATE_GOV_MAX) return false;
+
+    rate_entry_t *e = &entries[entry_count];
+    memset(e, 0, sizeof(*e));
+    e->sensor_idx = sensor_idx;
+    e->metric = metric;
+    e->ctx = ctx;
+    e->rule = *rule;
+    if (e->rule.calm_evals == 0) e->rule.calm_evals = 1;
+    e->base = e->rule;
+    // Entry is complete before the task can see it
+    __atomic_store_n(&entry_count, entry_count + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool rate_governor_get_state(int sensor_idx, rate_state_t *out)
+{
+    if (!out) return false;
+    int n = __atomic_load_n(&entry_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < n; ++i) {
+        if (entries[i].sensor_idx != sensor_idx) continue;
+        taskENTER_CRITICAL();
+        *out = entries[i].state;
+        taskEXIT_CRITICAL();
+        return true;
+    }
+    return false;
+}
+
+/* Samples a poll period may bring at the rule's max_hz, plus the slot the
+ * producer may be writing */
+static uint16_t queue_depth(const rate_rule_t *r)
+{
+    float per_poll = r->max_hz * (float)gov_period / (float)configTICK_RATE_HZ;
+    uint16_t depth = (uint16_t)ceilf(per_poll) + 1;
+    if (depth < 2) depth = 2;
+    return depth > SENSOR_QUEUE_MAX_DEPTH ? SENSOR_QUEUE_MAX_DEPTH : depth;
+}
+
+// The next sample since the last poll: from the queue, or the latest one
+// once if the queue couldn't be had (pool or cursors exhausted)
+static bool next_sample(rate_entry_t *e, sensor_data_t *out)
+{
+    if (e->queue) return sensor_queue_pop(e->queue, e->consumer, out);
+    if (!sensor_get_last(e->sensor_idx, out)) return false;
+    return !(e->have_prev && out->timestamp == e->last_ts);
+}
+
+bool rate_governor_set_bounds(int sensor_idx, float min_hz, float max_hz)
+{
+    if (min_hz < 0.0f || max_hz < 0.0f) return false;
+    int n = __atomic_load_n(&entry_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < n; ++i) {
+        rate_entry_t *e = &entries[i];
+        if (e->sensor_idx != sensor_idx) continue;
+        float hi = max_hz > 0.0f ? max_hz : e->base.max_hz;
+        float lo = min_hz > 0.0f ? min_hz : e->base.min_hz;
+        if (lo > hi) lo = hi;
+        // The step function reads the rule under the same critical section
+        taskENTER_CRITICAL();
+        float old_hi = e->rule.max_hz;
+        e->rule.min_hz = lo;
+        e->rule.max_hz = hi;
+        taskEXIT_CRITICAL();
+
+        // Running at full rate stays at full rate; anything else is clamped
+        float cur = sensor_get_freq(sensor_idx);
+        float next = (cur >= old_hi) ? hi : (cur > hi ? hi : (cur < lo ? lo : cur));
+        if (cur > 0.0f && next != cur) sensor_set_freq(sensor_idx, next);
+        return true;
+    }
+    return false;
+}
+
+static void govern(rate_entry_t *e)
+{
+    if (!e->attached) {
+        // First poll: subscribe to every sample (the IMU's queue is shared)
+        e->attached = true;
+        if (sensor_attach_queue(e->sensor_idx, queue_depth(&e->rule))) {
+            sensor_queue_t *q = sensor_get_queue(e->sensor_idx);
+            int c = sensor_queue_subscribe(q);
+            if (c >= 0) {
+                e->queue = q;
+                e->consumer = c;
+            }
+        }
+    }
+
+    // Every sample since the last poll is scored against the one before it;
+    // the rate they arrive at moves once, here
+    float cur_hz = sensor_get_freq(e->sensor_idx);
+    float next = cur_hz;
+    while (next_sample(e, &scratch)) {
+        if (scratch.len > RATE_GOV_PREV_BYTES) continue;
+        // 0 Hz: disabled or event-only on purpose, leave it alone
+        if (e->have_prev && scratch.len == e->prev_len && cur_hz > 0.0f) {
+            float m = e->metric(e->prev, scratch.bytes, scratch.len, e->ctx);
+            taskENTER_CRITICAL();
+            next = rate_governor_step(&e->rule, &e->state, m, next);
+            taskEXIT_CRITICAL();
+        }
+        memcpy(e->prev, scratch.bytes, scratch.len);
+        e->prev_len = scratch.len;
+        e->last_ts = scratch.timestamp;
+        e->have_prev = true;
+    }
+    if (cur_hz > 0.0f && fabsf(next - cur_hz) > 0.001f * cur_hz) {
+        sensor_set_freq(e->sensor_idx, next);
+    }
+}
+
+static void rate_governor_task(void *pv)
+{
+    (void)pv;
+    TickType_t last_wake = xTaskGetTickCount();
+    for (;;) {
+        int n = __atomic_load_n(&entry_count, __ATOMIC_ACQUIRE);
+        for (int i = 0; i < n; ++i) govern(&entries[i]);
+        vTaskDelayUntil(&last_wake, gov_period);
+    }
+}
+
+BaseType_t rate_governor_start(UBaseType_t priority, uint16_t stack_words, TickType_t period_ms)
+{
+    if (gov_handle) return pdPASS;
+    gov_period = pdMS_TO_TICKS(period_ms ? period_ms : RATE_GOV_PERIOD_MS);
+    return xTaskCreate(rate_governor_task, "rate-gov", stack_words ? stack_words : 1024, NULL, priority ? priority : 1, &gov_handle);
+}
+
+/* ---- This project's rules ---- */
+
+//                                    min_hz max_hz raise  lower  step  calm
+const rate_rule_t rate_rule_temp = { 0.05f, 1.0f,  0.20f, 0.05f, 0.5f, 5 };    // C per sample
+const rate_rule_t rate_rule_imu  = { 0.2f,  10.0f, 5.0f,  1.0f,  0.5f, 10 };   // degrees per sample
+const rate_rule_t rate_rule_spo2 = { 0.2f,  1.0f,  0.5f,  0.1f,  0.5f, 3 };    // % SpO2 drop per sample
+
+/* ---- Metrics ---- */
+
+// temp payload: int16 big-endian, C * 100
+float rate_metric_temp(const uint8_t *prev, const uint8_t *cur, size_t len, void *ctx)
+{
+    (void)ctx;
+    if (len < 2) return 0.0f;
+    int16_t a = (int16_t)((prev[0] << 8) | prev[1]);
+    int16_t b = (int16_t)((cur[0] << 8) | cur[1]);
+    return fabsf((float)(b - a)) / 100.0f;
+}
+
+static float angle_delta(float a, float b)
+{
+    float d = fmodf(b - a, 360.0f);
+    if (d > 180.0f) d -= 360.0f;
+    if (d < -180.0f) d += 360.0f;
+    return fabsf(d);
+}
+
+// imu payload: euler_t, native floats (yaw, pitch, roll)
+float rate_metric_imu(const uint8_t *prev, const uint8_t *cur, size_t len, void *ctx)
+{
+    (void)ctx;
+    if (len < 3 * sizeof(float)) return 0.0f;
+    float a[3], b[3];
+    memcpy(a, prev, sizeof(a));
+    memcpy(b, cur, sizeof(b));
+    float m = 0.0f;
+    for (int i = 0; i < 3; ++i) {
+        float d = angle_delta(a[i], b[i]);
+        if (d > m) m = d;
+    }
+    return m;
+}
+
+static float be_float(const uint8_t *p)
+{
+    union { float f; uint8_t b[4]; } u;
+    for (int i = 0; i < 4; ++i) u.b[3 - i] = p[i];
+    return u.f;
+}
+
+// spo2 payload: 5 big-endian floats, ESpO2 is the fourth
+float rate_metric_spo2_drop(const uint8_t *prev, const uint8_t *cur, size_t len, void *ctx)
+{
+    (void)ctx;
+    if (len < 16) return 0.0f;
+    float a = be_float(prev + 12);
+    float b = be_float(cur + 12);
+    // Module reports 0 until it has a reading
+    if (a <= 0.0f || b <= 0.0f) return 0.0f;
+    return (a > b) ? (a - b) : 0.0f;
+}
@@ -0,0 +1,314 @@
+// src/record_codec.cpp
+#include "record_codec.h"
+#include "crc32.h"
+#include <string.h>
+
+#define TAG_CODEC_SHIFT  5
+#define TAG_IDX_MASK     0x1F
+#define NO_WINDOW        0xFF
+
+static const uint8_t value_bytes[RECORD_CODEC_COUNT] = { 1, 1, 2, 4, 4 };
+
+/* ---- byte/bit cursors ---- */
+typedef struct {
+    uint8_t *p;
+    size_t cap;
+    size_t pos;      // bytes
+    uint8_t bit;     // bits used in p[pos], 0 = byte not started
+    bool overflow;
+} wcur_t;
+
+typedef struct {
+    const uint8_t *p;
+    size_t avail;
+    size_t pos;
+    uint8_t bit;
+    bool underflow;
+} rcur_t;
+
+static void put_byte(wcur_t *w, uint8_t v) {
+    if (w->pos >= w->cap) { w->overflow = true; return; }
+    w->p[w->pos++] = v;
+}
+
+static void put_varint(wcur_t *w, uint32_t v) {
+    while (v >= 0x80) {
+        put_byte(w, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    put_byte(w, (uint8_t)v);
+}
+
+static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+static void put_bits(wcur_t *w, uint32_t v, uint8_t n) {
+    while (n) {
+        if (w->bit == 0) {
+            if (w->pos >= w->cap) { w->overflow = true; return; }
+            w->p[w->pos] = 0;
+        }
+        uint8_t room = 8 - w->bit;
+        uint8_t take = n < room ? n : room;
+        uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+        w->p[w->pos] |= (uint8_t)(chunk << (room - take));
+        w->bit += take;
+        n -= take;
+        if (w->bit == 8) { w->bit = 0; w->pos++; }
+    }
+}
+
+static void end_bits(wcur_t *w) {
+    if (w->bit) { w->bit = 0; w->pos++; }
+}
+
+static uint8_t get_byte(rcur_t *r) {
+    if (r->pos >= r->avail) { r->underflow = true; return 0; }
+    return r->p[r->pos++];
+}
+
+static uint32_t get_varint(rcur_t *r) {
+    uint32_t v = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t b = get_byte(r);
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r->underflow = true;
+    return 0;
+}
+
+static uint32_t get_bits(rcur_t *r, uint8_t n) {
+    uint32_t v = 0;
+    while (n) {
+        if (r->pos >= r->avail) { r->underflow = true; return 0; }
+        uint8_t room = 8 - r->bit;
+        uint8_t take = n < room ? n : room;
+        uint8_t chunk = (uint8_t)((r->p[r->pos] >> (room - take)) & ((1u << take) - 1));
+        v = (v << take) | chunk;
+        r->bit += take;
+        n -= take;
+        if (r->bit == 8) { r->bit = 0; r->pos++; }
+    }
+    return v;
+}
+
+static void end_bits(rcur_t *r) {
+    if (r->bit) { r->bit = 0; r->pos++; }
+}
+
+/* ---- value access ---- */
+static uint32_t load_value(record_codec_t c, const uint8_t *p) {
+    switch (c) {
+    case RECORD_CODEC_I16BE_DELTA: return (uint32_t)(int32_t)(int16_t)((p[0] << 8) | p[1]);
+    case RECORD_CODEC_F32BE_XOR:   return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+    case RECORD_CODEC_F32LE_XOR:   return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+    default:                       return p[0];
+    }
+}
+
+static void store_value(record_codec_t c, uint8_t *p, uint32_t v) {
+    switch (c) {
+    case RECORD_CODEC_I16BE_DELTA: p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; break;
+    case RECORD_CODEC_F32BE_XOR:   p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v; break;
+    case RECORD_CODEC_F32LE_XOR:   p[3] = (uint8_t)(v >> 24); p[2] = (uint8_t)(v >> 16); p[1] = (uint8_t)(v >> 8); p[0] = (uint8_t)v; break;
+    default:                       p[0] = (uint8_t)v; break;
+    }
+}
+
+static inline bool is_xor(record_codec_t c) {
+    return c == RECORD_CODEC_F32BE_XOR || c == RECORD_CODEC_F32LE_XOR;
+}
+
+/* The codec actually used for a payload (see header: RAW fallback) */
+static record_codec_t effective_codec(record_codec_t c, uint8_t len) {
+    if (c <= RECORD_CODEC_RAW || c >= RECORD_CODEC_COUNT) return RECORD_CODEC_RAW;
+    uint8_t vb = value_bytes[c];
+    if (len % vb || len / vb > RECORD_CODEC_MAX_VALUES) return RECORD_CODEC_RAW;
+    return c;
+}
+
+static record_codec_slot_t *slot_for(record_codec_block_t *b, uint8_t idx, record_codec_slot_t *scratch) {
+    if (b->live & (1u << idx)) {
+        *scratch = b->slot[idx];
+    } else {
+        memset(scratch->prev, 0, sizeof(scratch->prev));
+        memset(scratch->lead, NO_WINDOW, sizeof(scratch->lead));
+        memset(scratch->trail, 0, sizeof(scratch->trail));
+    }
+    return scratch;
+}
+
+static inline uint8_t clz32(uint32_t x) { return (uint8_t)__builtin_clz(x); }
+static inline uint8_t ctz32(uint32_t x) { return (uint8_t)__builtin_ctz(x); }
+
+void record_codec_block_begin(record_codec_block_t *b, uint32_t base_ts) {
+    b->last_ts = base_ts;
+    b->live = 0;
+}
+
+size_t record_codec_encode(record_codec_block_t *b, record_codec_t codec, uint8_t sensor_idx,
+                           uint32_t ts, const uint8_t *payload, uint8_t len,
+                           uint8_t *out, size_t cap) {
+    if (sensor_idx >= RECORD_CODEC_MAX_SENSORS) return 0;
+    record_codec_t c = effective_codec(codec, len);
+    wcur_t w = { out, cap, 0, 0, false };
+
+    put_byte(&w, (uint8_t)((c << TAG_CODEC_SHIFT) | sensor_idx));
+    put_varint(&w, zigzag((int32_t)(ts - b->last_ts)));
+    put_byte(&w, len);
+
+    // Work on a copy so a record that doesn't fit leaves the block untouched
+    record_codec_slot_t s;
+    if (c == RECORD_CODEC_RAW) {
+        if (w.pos + len > cap) return 0;
+        memcpy(out + w.pos, payload, len);
+        w.pos += len;
+    } else {
+        slot_for(b, sensor_idx, &s);
+        uint8_t vb = value_bytes[c];
+        uint8_t n = len / vb;
+        for (uint8_t i = 0; i < n; ++i) {
+            uint32_t v = load_value(c, payload + i * vb);
+            if (!is_xor(c)) {
+                put_varint(&w, zigzag((int32_t)(v - s.prev[i])));
+            } else {
+                uint32_t x = v ^ s.prev[i];
+                if (x == 0) {
+                    put_bits(&w, 0, 1);
+                } else {
+                    uint8_t lz = clz32(x), tz = ctz32(x);
+                    if (s.lead[i] != NO_WINDOW && lz >= s.lead[i] && tz >= s.trail[i]) {
+                        uint8_t sig = 32 - s.lead[i] - s.trail[i];
+                        put_bits(&w, 0x2, 2);
+                        put_bits(&w, x >> s.trail[i], sig);
+                    } else {
+                        uint8_t sig = 32 - lz - tz;
+                        put_bits(&w, 0x3, 2);
+                        put_bits(&w, lz, 5);
+                        put_bits(&w, sig - 1u, 5);
+                        put_bits(&w, x >> tz, sig);
+                        s.lead[i] = lz;
+                        s.trail[i] = tz;
+                    }
+                }
+            }
+            s.prev[i] = v;
+        }
+        end_bits(&w);
+    }
+    if (w.overflow || w.pos >= cap) return 0;
+    out[w.pos] = (uint8_t)crc32_update(0, out, w.pos);
+    w.pos++;
+
+    if (c != RECORD_CODEC_RAW) {
+        b->slot[sensor_idx] = s;
+        b->live |= 1u << sensor_idx;
+    }
+    b->last_ts = ts;
+    return w.pos;
+}
+
+size_t record_codec_decode(record_codec_block_t *b, const uint8_t *in, size_t avail,
+                           uint8_t *sensor_idx, uint32_t *ts, uint8_t *payload, uint8_t *len) {
+    rcur_t r = { in, avail, 0, 0, false };
+    uint8_t tag = get_byte(&r);
+    uint32_t dt = get_varint(&r);
+    uint8_t n_bytes = get_byte(&r);
+    if (r.underflow) return 0;
+
+    record_codec_t c = (record_codec_t)(tag >> TAG_CODEC_SHIFT);
+    uint8_t idx = tag & TAG_IDX_MASK;
+    if (c >= RECORD_CODEC_COUNT || effective_codec(c, n_bytes) != c) return 0;
+
+    record_codec_slot_t s;
+    if (c == RECORD_CODEC_RAW) {
+        if (r.pos + n_bytes > avail) return 0;
+        memcpy(payload, in + r.pos, n_bytes);
+        r.pos += n_bytes;
+    } else {
+        slot_for(b, idx, &s);
+        uint8_t vb = value_bytes[c];
+        uint8_t n = n_bytes / vb;
+        for (uint8_t i = 0; i < n; ++i) {
+            uint32_t v;
+            if (!is_xor(c)) {
+                v = s.prev[i] + (uint32_t)unzigzag(get_varint(&r));
+                if (c == RECORD_CODEC_I16BE_DELTA) v = (uint32_t)(int32_t)(int16_t)v;
+                else v &= 0xFF;
+            } else if (get_bits(&r, 1) == 0) {
+                v = s.prev[i];
+            } else if (get_bits(&r, 1) == 0) {
+                if (s.lead[i] == NO_WINDOW) return 0;
+                uint8_t sig = 32 - s.lead[i] - s.trail[i];
+                v = s.prev[i] ^ (get_bits(&r, sig) << s.trail[i]);
+            } else {
+                uint8_t lz = (uint8_t)get_bits(&r, 5);
+                uint8_t sig = (uint8_t)(get_bits(&r, 5) + 1);
+                if (lz + sig > 32) return 0;
+                uint8_t tz = 32 - lz - sig;
+                v = s.prev[i] ^ (get_bits(&r, sig) << tz);
+                s.lead[i] = lz;
+                s.trail[i] = tz;
+            }
+            if (r.underflow) return 0;
+            store_value(c, payload + i * vb, v);
+            s.prev[i] = v;
+        }
+        end_bits(&r);
+    }
+    if (r.pos >= avail || in[r.pos] != (uint8_t)crc32_update(0, in, r.pos)) return 0;
+    r.pos++;
+    if (c != RECORD_CODEC_RAW) {
+        b->slot[idx] = s;
+        b->live |= 1u << idx;
+    }
+
+    b->last_ts += (uint32_t)unzigzag(dt);
+    *sensor_idx = idx;
+    *ts = b->last_ts;
+    *len = n_bytes;
+    return r.pos;
+}
+
+size_t record_codec_encode_part(record_codec_block_t *b, uint8_t sensor_idx, uint32_t ts,
+                                const uint8_t *payload, uint16_t total, uint16_t off, uint16_t len,
+                                uint8_t *out, size_t cap) {
+    if (sensor_idx >= RECORD_CODEC_MAX_SENSORS || len == 0 || off + len > total) return 0;
+    wcur_t w = { out, cap, 0, 0, false };
+    put_byte(&w, (uint8_t)((RECORD_CODEC_TAG_LONG << TAG_CODEC_SHIFT) | sensor_idx));
+    put_varint(&w, zigzag((int32_t)(ts - b->last_ts)));
+    put_varint(&w, total);
+    put_varint(&w, off);
+    put_varint(&w, len);
+    if (w.overflow || w.pos + 1 + len > cap) return 0;
+    out[w.pos] = (uint8_t)crc32_update(0, out, w.pos);
+    w.pos++;
+    memcpy(out + w.pos, payload + off, len);
+    b->last_ts = ts;
+    return w.pos + len;
+}
+
+size_t record_codec_decode_part(record_codec_block_t *b, const uint8_t *in, size_t avail,
+                                record_codec_part_t *out) {
+    rcur_t r = { in, avail, 0, 0, false };
+    uint8_t tag = get_byte(&r);
+    if (r.underflow || !record_codec_is_long(tag)) return 0;
+    uint32_t dt = get_varint(&r);
+    uint32_t total = get_varint(&r);
+    uint32_t off = get_varint(&r);
+    uint32_t len = get_varint(&r);
+    if (r.underflow || r.pos >= avail) return 0;
+    if (in[r.pos] != (uint8_t)crc32_update(0, in, r.pos)) return 0;
+    r.pos++;
+    if (total > 0xFFFF || len == 0 || off + len > total || r.pos + len > avail) return 0;
+
+    b->last_ts += (uint32_t)unzigzag(dt);
+    out->sensor_idx = tag & TAG_IDX_MASK;
+    out->ts = b->last_ts;
+    out->total = (uint16_t)total;
+    out->off = (uint16_t)off;
+    out->len = (uint16_t)len;
+    out->body = in + r.pos;
+    return r.pos + len;
+}
@@ -0,0 +1,120 @@
+// src/sample_pool.cpp
+#include "sample_pool.h"
+#include <string.h>
+
+#define BLOCK_ALIGN        alignof(sensor_data_t)
+#define ROUND_UP(n, a)     ((((n) + (a) - 1) / (a)) * (a))
+#define BLOCK_BYTES(pl)    ROUND_UP(SENSOR_RECORD_BYTES(pl), BLOCK_ALIGN)
+
+#define SMALL_BLOCK   BLOCK_BYTES(SAMPLE_POOL_SMALL_PAYLOAD)
+#define MEDIUM_BLOCK  BLOCK_BYTES(SAMPLE_POOL_MEDIUM_PAYLOAD)
+#define LARGE_BLOCK   BLOCK_BYTES(SAMPLE_POOL_LARGE_PAYLOAD)
+
+#define ARENA_BYTES   (SMALL_BLOCK * SAMPLE_POOL_SMALL_COUNT + \
+                       MEDIUM_BLOCK * SAMPLE_POOL_MEDIUM_COUNT + \
+                       LARGE_BLOCK * SAMPLE_POOL_LARGE_COUNT)
+
+typedef struct free_block_s {
+    struct free_block_s *next;
+} free_block_t;
+
+typedef struct {
+    uint16_t payload;
+    uint16_t count;
+    size_t block_size;
+    uint8_t *base;
+    free_block_t *free_list;
+    uint16_t in_use;
+    uint16_t high_water;
+    uint32_t failures;
+} pool_class_t;
+
+alignas(sensor_data_t) static uint8_t arena[ARENA_BYTES];
+
+static pool_class_t classes[SAMPLE_POOL_CLASSES] = {
+    { SAMPLE_POOL_SMALL_PAYLOAD,  SAMPLE_POOL_SMALL_COUNT,  SMALL_BLOCK,  NULL, NULL, 0, 0, 0 },
+    { SAMPLE_POOL_MEDIUM_PAYLOAD, SAMPLE_POOL_MEDIUM_COUNT, MEDIUM_BLOCK, NULL, NULL, 0, 0, 0 },
+    { SAMPLE_POOL_LARGE_PAYLOAD,  SAMPLE_POOL_LARGE_COUNT,  LARGE_BLOCK,  NULL, NULL, 0, 0, 0 },
+};
+
+void sample_pool_init(void)
+{
+    uint8_t *p = arena;
+    for (int c = 0; c < SAMPLE_POOL_CLASSES; ++c) {
+        pool_class_t *pc = &classes[c];
+        pc->base = p;
+        pc->free_list = NULL;
+        // Thread the free list so the lowest addresses are handed out first
+        for (int i = pc->count - 1; i >= 0; --i) {
+            free_block_t *b = (free_block_t *)(pc->base + (size_t)i * pc->block_size);
+            b->next = pc->free_list;
+            pc->free_list = b;
+        }
+        pc->in_use = 0;
+        pc->high_water = 0;
+        pc->failures = 0;
+        p += (size_t)pc->count * pc->block_size;
+    }
+}
+
+sensor_data_t *sample_pool_alloc(size_t max_payload)
+{
+    for (int c = 0; c < SAMPLE_POOL_CLASSES; ++c) {
+        pool_class_t *pc = &classes[c];
+        if (max_payload > pc->payload) continue;
+
+        taskENTER_CRITICAL();
+        free_block_t *b = pc->free_list;
+        if (b) {
+            pc->free_list = b->next;
+            if (++pc->in_use > pc->high_water) pc->high_water = pc->in_use;
+        } else {
+            pc->failures++;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!b) return NULL;
+        sensor_data_t *rec = (sensor_data_t *)b;
+        rec->len = 0;
+        rec->timestamp = 0;
+        rec->cap = (uint16_t)max_payload;
+        return rec;
+    }
+    return NULL;
+}
+
+void sample_pool_free(sensor_data_t *rec)
+{
+    if (!rec) return;
+    uint8_t *p = (uint8_t *)rec;
+    for (int c = 0; c < SAMPLE_POOL_CLASSES; ++c) {
+        pool_class_t *pc = &classes[c];
+        if (p < pc->base || p >= pc->base + (size_t)pc->count * pc->block_size) continue;
+        free_block_t *b = (free_block_t *)p;
+        taskENTER_CRITICAL();
+        b->next = pc->free_list;
+        pc->free_list = b;
+        pc->in_use--;
+        taskEXIT_CRITICAL();
+        return;
+    }
+}
+
+size_t sample_pool_arena_bytes(void)
+{
+    return sizeof(arena);
+}
+
+bool sample_pool_class_stats(int cls, sample_pool_class_stats_t *out)
+{
+    if (!out || cls < 0 || cls >= SAMPLE_POOL_CLASSES) return false;
+    const pool_class_t *pc = &classes[cls];
+    taskENTER_CRITICAL();
+    out->payload = pc->payload;
+    out->count = pc->count;
+    out->in_use = pc->in_use;
+    out->high_water = pc->high_water;
+    out->failures = pc->failures;
+    taskEXIT_CRITICAL();
+    return true;
+}
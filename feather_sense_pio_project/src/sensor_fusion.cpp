@@ -39,7 +39,7 @@ bool spo2_init_fusion_adapter(void *ctx) {
 bool spo2_read_fusion_adapter(void *ctx, sensor_data_t *out) {
   (void)ctx;
   if (!out) return false;
-  memset(out, 0, sizeof(*out));
+  memset(out->bytes, 0, out->cap);
 
   float spo2_1, hr_1, acdc_ir_1, acdc_red_1;
   float spo2_2, hr_2, acdc_ir_2, acdc_red_2;
@@ -4,13 +4,16 @@
 #include <Arduino.h>
 #include <Adafruit_TinyUSB.h>
 #include "ble_manager.h"
+#include "sample_pool.h"
+#include "sensor_queue.h"
+#include "telemetry.h"
 
 /* Config */
 #define MAX_SENSORS        20
 #define DEFAULT_STACK_SIZE 2048
 #define DEFAULT_TASK_PRIO  2
 
-typedef struct {
+typedef struct sensor_s {
     char name[SENSOR_NAME_MAX];
     sensor_init_cb init;
     sensor_read_cb read;
@@ -18,31 +21,263 @@ typedef struct {
     void *ctx;
     float freq_hz;
     bool enabled;
+    uint32_t flags;
+    uint16_t max_payload;
     TaskHandle_t task_handle;
-    sensor_data_t last_data;
+
+    /* Last sample, published seqlock-style: the sampler writes
+     * last[(seq + 1) & 1] and then bumps seq, so readers copy last[seq & 1]
+     * without disabling interrupts and retry only if seq moved meanwhile.
+     * Both records are pool blocks sized for max_payload. */
+    sensor_data_t *last[2];
+    volatile uint32_t seq;
+
+    sensor_queue_t *queue;   /* optional: every successful sample is pushed */
+
+    /* Dispatcher bookkeeping (unused for sensors with their own task) */
+    TickType_t period_ticks;
+    TickType_t deadline;
+    struct sensor_s *next_due;
+    bool queued;
+
+#if SENSOR_INSTRUMENT
+    sensor_stats_t stats;            /* written only by the sampling task */
+    volatile TickType_t notify_tick; /* first notify since the last event sample */
+    volatile bool notify_pending;
+#endif
 } sensor_t;
 
 static sensor_t sensors[MAX_SENSORS];
 static int sensor_count = 0;
-static SemaphoreHandle_t bus_mutex = NULL;
 
-/* Bus locking (for shared I2C/SPI resources) */
-static inline bool bus_lock(TickType_t timeout_ms) {
-    if (!bus_mutex) return true;
-    return (xSemaphoreTake(bus_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE);
+static sensor_sched_mode_t sched_mode = SENSOR_SCHED_PER_TASK;
+static TaskHandle_t dispatcher_handle = NULL;
+static sensor_t *due_head = NULL;   /* timer queue, earliest deadline first */
+static volatile uint32_t due_events = 0;  /* bit per dispatcher sensor notified by an event */
+
+/* Bus registry: one mutex and wait counters per hardware bus */
+typedef struct {
+    SemaphoreHandle_t mutex;
+    sensor_bus_stats_t stats;
+} sensor_bus_entry_t;
+
+static sensor_bus_entry_t buses[SENSOR_BUS_COUNT];
+
+/* Sink handlers, indexed by sensor_sink_t */
+static struct {
+    sensor_sink_cb cb;
+    void *ctx;
+} sinks[SENSOR_SINK_COUNT];
+
+static bool bus_lock(int bus, uint32_t timeout_ms) {
+    if (bus < 0 || bus >= SENSOR_BUS_COUNT) return false;
+    sensor_bus_entry_t *b = &buses[bus];
+    if (!b->mutex) return true;
+
+    // Uncontended fast path keeps the counters honest about real waits
+    if (xSemaphoreTake(b->mutex, 0) == pdTRUE) {
+        b->stats.locks++;
+        return true;
+    }
+
+    TickType_t t0 = xTaskGetTickCount();
+    bool ok = (xSemaphoreTake(b->mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE);
+    uint32_t waited = (uint32_t)(xTaskGetTickCount() - t0);
+
+    // Counters are only updated while holding the bus (or, for timeouts,
+    // under a short critical section), so they never race each other
+    if (ok) {
+        b->stats.locks++;
+        b->stats.contended++;
+        b->stats.wait_ticks_total += waited;
+        if (waited > b->stats.wait_ticks_max) b->stats.wait_ticks_max = waited;
+    } else {
+        taskENTER_CRITICAL();
+        b->stats.timeouts++;
+        taskEXIT_CRITICAL();
+    }
+    return ok;
+}
+static inline void bus_unlock(int bus) {
+    if (bus < 0 || bus >= SENSOR_BUS_COUNT) return;
+    if (buses[bus].mutex) xSemaphoreGive(buses[bus].mutex);
+}
+
+/* Lock every bus in mask, lowest index first so multi-bus sensors can't
+ * deadlock each other. All-or-nothing. */
+static bool bus_lock_mask(uint32_t mask, uint32_t timeout_ms) {
+    for (int b = 0; b < SENSOR_BUS_COUNT; ++b) {
+        if (!(mask & (1u << b))) continue;
+        if (!bus_lock(b, timeout_ms)) {
+            while (--b >= 0) {
+                if (mask & (1u << b)) bus_unlock(b);
+            }
+            return false;
+        }
+    }
+    return true;
 }
-static inline void bus_unlock(void) {
-    if (bus_mutex) xSemaphoreGive(bus_mutex);
+static void bus_unlock_mask(uint32_t mask) {
+    for (int b = SENSOR_BUS_COUNT - 1; b >= 0; --b) {
+        if (mask & (1u << b)) bus_unlock(b);
+    }
 }
 
-// Exported wrappers so other modules can use the same bus mutex
-bool sensor_bus_lock(TickType_t timeout_ms) {
-    // bus_lock is static inline above in this file; call it
-    return bus_lock(timeout_ms);
+// Exported wrappers so other modules share the per-bus mutexes
+bool sensor_bus_lock(sensor_bus_t bus, uint32_t timeout_ms) {
+    return bus_lock((int)bus, timeout_ms);
 }
 
-void sensor_bus_unlock(void) {
-    bus_unlock();
+void sensor_bus_unlock(sensor_bus_t bus) {
+    bus_unlock((int)bus);
+}
+
+bool sensor_bus_get_stats(sensor_bus_t bus, sensor_bus_stats_t *out) {
+    if (!out || bus < 0 || bus >= SENSOR_BUS_COUNT) return false;
+    taskENTER_CRITICAL();
+    *out = buses[bus].stats;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+/* ---- Instrumentation ---- */
+
+#if SENSOR_INSTRUMENT
+/* Lateness argument for sensor_sample(); dropped entirely when
+ * instrumentation is compiled out */
+#define SAMPLE_LATE(expr) ((TickType_t)(expr))
+
+#if defined(DWT) && defined(CoreDebug)
+static void cycles_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+static inline uint32_t cycles_now(void) { return DWT->CYCCNT; }
+static uint32_t cycles_per_us(void) { return SystemCoreClock / 1000000u; }
+#else
+// No DWT (host builds): fall back to microseconds, reported as 1 cycle/us
+static void cycles_init(void) {}
+static inline uint32_t cycles_now(void) { return (uint32_t)micros(); }
+static uint32_t cycles_per_us(void) { return 1; }
+#endif
+
+static inline int hist_bucket(uint32_t v) {
+    int b = v ? 31 - __builtin_clz(v) : 0;
+    return b < SENSOR_HIST_BUCKETS ? b : SENSOR_HIST_BUCKETS - 1;
+}
+
+/* Called by the sampling task after each read. The bus lock keeps out
+ * nothing here (bus-less sensors hold none, and readers take none), so the
+ * buckets and missed periods are worked out first and the record is
+ * updated in one short critical section, the same one snapshot and reset
+ * take: they never see it half-updated */
+static void stats_record(sensor_t *s, uint32_t bus_cycles, uint32_t read_cycles, TickType_t late)
+{
+    sensor_stats_t *st = &s->stats;
+    int bus_b = hist_bucket(bus_cycles), read_b = hist_bucket(read_cycles);
+    uint32_t missed = 0;
+    // Event sensors have no deadline to miss; their lateness is vs the notify
+    if (!(s->flags & SENSOR_FLAG_EVENT) && s->period_ticks != portMAX_DELAY &&
+        late >= s->period_ticks) {
+        missed = late / s->period_ticks;
+    }
+    taskENTER_CRITICAL();
+    st->samples++;
+    if (st->bus_wait_hist[bus_b] != 0xFFFF) st->bus_wait_hist[bus_b]++;
+    if (st->read_hist[read_b] != 0xFFFF) st->read_hist[read_b]++;
+    if (bus_cycles > st->bus_wait_cycles_max) st->bus_wait_cycles_max = bus_cycles;
+    if (read_cycles > st->read_cycles_max) st->read_cycles_max = read_cycles;
+    if (late > st->max_jitter_ticks) st->max_jitter_ticks = late;
+    st->missed_periods += missed;
+    taskEXIT_CRITICAL();
+}
+
+/* Lateness of an event sample: ticks since the first unserviced notify */
+static TickType_t event_late(sensor_t *s)
+{
+    if (!s->notify_pending) return 0;
+    s->notify_pending = false;
+    return xTaskGetTickCount() - s->notify_tick;
+}
+#else
+#define SAMPLE_LATE(expr) ((TickType_t)0)
+#endif
+
+static TickType_t period_for(float freq_hz) {
+    if (freq_hz <= 0.0f) return portMAX_DELAY;
+    TickType_t t = pdMS_TO_TICKS((int)(1000.0f / freq_hz));
+    return t ? t : 1;
+}
+
+static inline bool uses_dispatcher(const sensor_t *s) {
+    return sched_mode == SENSOR_SCHED_DISPATCHER && !(s->flags & SENSOR_FLAG_OWN_TASK);
+}
+
+/* Copy the latest published sample. Only retries if the sampler
+ * published again while we were copying. */
+static void last_read(const sensor_t *s, sensor_data_t *out)
+{
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        const sensor_data_t *src = s->last[seq & 1];
+        size_t len = src->len;
+        if (len > s->max_payload) len = s->max_payload;   // torn len, retried below
+        memcpy(out, src, SENSOR_RECORD_BYTES(len));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq) break;
+    }
+    out->cap = SENSOR_DATA_BYTES;
+}
+
+static void sink_route(const sensor_t *s, const sensor_data_t *d, uint32_t route)
+{
+    int idx = (int)(s - sensors);
+    for (int k = 0; route && k < SENSOR_SINK_COUNT; ++k, route >>= 1) {
+        if ((route & 1u) && sinks[k].cb) sinks[k].cb(sinks[k].ctx, idx, d);
+    }
+}
+
+/* Take one sample straight into the unpublished slot, then publish it.
+ * Only one task ever samples a given sensor, so seq has a single writer.
+ * late is how many ticks after its deadline (or notify) the sample started. */
+static void sensor_sample(sensor_t *s, TickType_t late)
+{
+    uint32_t bus_mask = (s->flags & SENSOR_FLAG_BUS_MASK) >> 8;
+#if SENSOR_INSTRUMENT
+    uint32_t t_lock = cycles_now();
+#else
+    (void)late;
+#endif
+    if (bus_lock_mask(bus_mask, 100)) {
+#if SENSOR_INSTRUMENT
+        uint32_t t_read = cycles_now();
+#endif
+        uint32_t seq = s->seq;
+        sensor_data_t *slot = s->last[(seq + 1) & 1];
+        // Keep the slot writes after the previous publish of seq
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        slot->len = 0;
+        bool ok = false;
+        if (s->read) ok = s->read(s->ctx, slot);
+#if SENSOR_INSTRUMENT
+        uint32_t t_done = cycles_now();
+#endif
+        if (!ok) slot->len = 0;
+        slot->timestamp = millis();
+        __atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELEASE);
+#if SENSOR_INSTRUMENT
+        stats_record(s, t_read - t_lock, t_done - t_read, late);
+#endif
+        bus_unlock_mask(bus_mask);
+
+        if (ok && slot->len > 0) {
+            if (s->queue) sensor_queue_push(s->queue, slot);
+            // slot stays intact until the sample after next, and only we write it
+            uint32_t route = __atomic_load_n(&s->flags, __ATOMIC_RELAXED) & SENSOR_FLAG_SINK_MASK;
+            if (route) sink_route(s, slot, route >> 16);
+        }
+    }
 }
 
 /* Per-sensor task */
@@ -50,51 +285,185 @@ static void sensor_task(void *pvParameters)
 {
     sensor_t *s = (sensor_t *)pvParameters;
     TickType_t last_wake = xTaskGetTickCount();
-    TickType_t period_ticks = (s->freq_hz > 0.0f) ? pdMS_TO_TICKS((int)(1000.0f / s->freq_hz)) : portMAX_DELAY;
 
     for (;;) {
-        if (!s->enabled || s->freq_hz <= 0.0f) {
+        bool event = (s->flags & SENSOR_FLAG_EVENT) != 0;
+        if (!s->enabled || (s->period_ticks == portMAX_DELAY && !event)) {
             vTaskSuspend(NULL);
             last_wake = xTaskGetTickCount();
-            period_ticks = (s->freq_hz > 0.0f) ? pdMS_TO_TICKS((int)(1000.0f / s->freq_hz)) : portMAX_DELAY;
             continue;
         }
 
-        if (bus_lock(100)) {
-            sensor_data_t tmp;
-            memset(&tmp, 0, sizeof(tmp));
-            bool ok = false;
-            if (s->read) ok = s->read(s->ctx, &tmp);
-            if (ok) {
-                taskENTER_CRITICAL();
-                s->last_data = tmp;
-                s->last_data.timestamp = millis();
-                taskEXIT_CRITICAL();
+        if (event) {
+            // Woken by the interrupt/callback, or by the period as a fallback
+            ulTaskNotifyTake(pdTRUE, s->period_ticks);
+            if (s->enabled) sensor_sample(s, SAMPLE_LATE(event_late(s)));
+            continue;
+        }
+
+        // last_wake is this period's deadline; vTaskDelayUntil returns late
+        // (without sleeping) once we've fallen behind
+        sensor_sample(s, SAMPLE_LATE(xTaskGetTickCount() - last_wake));
+
+        vTaskDelayUntil(&last_wake, s->period_ticks);
+    }
+}
+
+/* ---- Dispatcher: one task drives every sensor without its own task ---- */
+
+/* Insert in deadline order. Caller holds the critical section. */
+static void due_insert_locked(sensor_t *s)
+{
+    sensor_t **pp = &due_head;
+    while (*pp && (int32_t)((*pp)->deadline - s->deadline) <= 0) {
+        pp = &(*pp)->next_due;
+    }
+    s->next_due = *pp;
+    *pp = s;
+    s->queued = true;
+}
+
+/* Caller holds the critical section. */
+static void due_remove_locked(sensor_t *s)
+{
+    for (sensor_t **pp = &due_head; *pp; pp = &(*pp)->next_due) {
+        if (*pp == s) {
+            *pp = s->next_due;
+            break;
+        }
+    }
+    s->next_due = NULL;
+    s->queued = false;
+}
+
+/* (Re)arm a dispatcher sensor so it runs now, or drop it if idle */
+static void sched_rearm(sensor_t *s)
+{
+    taskENTER_CRITICAL();
+    if (s->queued) due_remove_locked(s);
+    if (s->enabled && s->period_ticks != portMAX_DELAY) {
+        s->deadline = xTaskGetTickCount();
+        due_insert_locked(s);
+    }
+    taskEXIT_CRITICAL();
+    if (dispatcher_handle) xTaskNotifyGive(dispatcher_handle);
+}
+
+/* Move a dispatcher sensor to a new period. Its next deadline becomes the
+ * last one plus the new period (now at the latest), so a rate change
+ * doesn't force an extra sample; only a sensor that had no period runs now. */
+static void sched_retime(sensor_t *s, TickType_t old_period)
+{
+    taskENTER_CRITICAL();
+    bool retimed = false;
+    if (s->queued && old_period != portMAX_DELAY && s->period_ticks != portMAX_DELAY) {
+        due_remove_locked(s);
+        TickType_t now = xTaskGetTickCount();
+        s->deadline = s->deadline - old_period + s->period_ticks;
+        if ((int32_t)(now - s->deadline) > 0) s->deadline = now;
+        due_insert_locked(s);
+        retimed = true;
+    } else if (!s->queued && s->enabled && old_period != portMAX_DELAY && s->period_ticks != portMAX_DELAY) {
+        // Being sampled right now: the dispatcher re-queues it with the new period
+        retimed = true;
+    }
+    taskEXIT_CRITICAL();
+    if (!retimed) sched_rearm(s);
+    else if (dispatcher_handle) xTaskNotifyGive(dispatcher_handle);
+}
+
+/* Sample a dispatcher sensor that was notified and restart its fallback timeout */
+static void dispatch_event(sensor_t *s)
+{
+    if (!s->enabled) return;
+    sensor_sample(s, SAMPLE_LATE(event_late(s)));
+
+    taskENTER_CRITICAL();
+    if (s->queued) due_remove_locked(s);
+    if (s->enabled && s->period_ticks != portMAX_DELAY) {
+        s->deadline = xTaskGetTickCount() + s->period_ticks;
+        due_insert_locked(s);
+    }
+    taskEXIT_CRITICAL();
+}
+
+static void sensor_dispatcher_task(void *pvParameters)
+{
+    (void)pvParameters;
+    for (;;) {
+        uint32_t events = __atomic_exchange_n(&due_events, 0, __ATOMIC_ACQUIRE);
+        for (int i = 0; events; ++i, events >>= 1) {
+            if (events & 1u) dispatch_event(&sensors[i]);
+        }
+
+        TickType_t wait = portMAX_DELAY;
+
+        taskENTER_CRITICAL();
+        sensor_t *s = due_head;
+        if (s) {
+            int32_t ahead = (int32_t)(s->deadline - xTaskGetTickCount());
+            if (ahead <= 0) {
+                due_head = s->next_due;
+                s->next_due = NULL;
+                s->queued = false;
             } else {
-                taskENTER_CRITICAL();
-                s->last_data.len = 0;
-                s->last_data.timestamp = millis();
-                taskEXIT_CRITICAL();
+                wait = (TickType_t)ahead;
+                s = NULL;
             }
-            bus_unlock();
         }
+        taskEXIT_CRITICAL();
 
-        if (period_ticks == portMAX_DELAY) {
-            vTaskDelay(pdMS_TO_TICKS(100));
-        } else {
-            vTaskDelayUntil(&last_wake, period_ticks);
+        if (!s) {
+            // Sleep until the earliest deadline or until enable/freq changes kick us
+            ulTaskNotifyTake(pdTRUE, wait);
+            continue;
+        }
+
+        sensor_sample(s, SAMPLE_LATE(xTaskGetTickCount() - s->deadline));
+
+        taskENTER_CRITICAL();
+        // Skip if sensor_enable/sensor_set_freq already re-armed it while sampling
+        if (!s->queued && s->enabled && s->period_ticks != portMAX_DELAY) {
+            TickType_t now = xTaskGetTickCount();
+            s->deadline += s->period_ticks;
+            // Fell a whole period behind: run again now rather than bursting to catch up
+            if ((int32_t)(now - s->deadline) > 0) s->deadline = now;
+            due_insert_locked(s);
         }
+        taskEXIT_CRITICAL();
     }
 }
 
 bool sensor_manager_init(void)
 {
-    if (bus_mutex == NULL) {
-        bus_mutex = xSemaphoreCreateMutex();
-        if (!bus_mutex) return false;
+    return sensor_manager_init_mode(SENSOR_SCHED_PER_TASK);
+}
+
+bool sensor_manager_init_mode(sensor_sched_mode_t mode)
+{
+    for (int b = 0; b < SENSOR_BUS_COUNT; ++b) {
+        if (buses[b].mutex == NULL) {
+            buses[b].mutex = xSemaphoreCreateMutex();
+            if (!buses[b].mutex) return false;
+        }
+        memset(&buses[b].stats, 0, sizeof(buses[b].stats));
     }
     sensor_count = 0;
     memset(sensors, 0, sizeof(sensors));
+    sample_pool_init();
+#if SENSOR_INSTRUMENT
+    cycles_init();
+#endif
+    due_head = NULL;
+    sched_mode = mode;
+
+    if (mode == SENSOR_SCHED_DISPATCHER && dispatcher_handle == NULL) {
+        BaseType_t r = xTaskCreate(sensor_dispatcher_task, "sens-disp", DEFAULT_STACK_SIZE, NULL, DEFAULT_TASK_PRIO, &dispatcher_handle);
+        if (r != pdPASS) {
+            dispatcher_handle = NULL;
+            return false;
+        }
+    }
     return true;
 }
 
@@ -105,25 +474,59 @@ int sensor_register(const char *name,
                     void *ctx,
                     float initial_freq_hz,
                     bool start_enabled)
+{
+    return sensor_register_ex(name, init_cb, read_cb, print_cb, ctx,
+                              initial_freq_hz, start_enabled, SENSOR_DATA_BYTES,
+                              SENSOR_FLAG_BUS(SENSOR_BUS_WIRE));
+}
+
+int sensor_register_ex(const char *name,
+                       sensor_init_cb init_cb,
+                       sensor_read_cb read_cb,
+                       sensor_print_cb print_cb,
+                       void *ctx,
+                       float initial_freq_hz,
+                       bool start_enabled,
+                       size_t max_payload,
+                       uint32_t flags)
 {
     if (sensor_count >= MAX_SENSORS) return -1;
-    int idx = sensor_count++;
+    if (max_payload == 0 || max_payload > SENSOR_DATA_BYTES) return -1;
+    int idx = sensor_count;
     sensor_t *s = &sensors[idx];
+    s->last[0] = sample_pool_alloc(max_payload);
+    s->last[1] = sample_pool_alloc(max_payload);
+    if (!s->last[0] || !s->last[1]) {
+        sample_pool_free(s->last[0]);
+        sample_pool_free(s->last[1]);
+        s->last[0] = s->last[1] = NULL;
+        Serial.printf("No pool block for %s (%u bytes)\r\n", name, (unsigned)max_payload);
+        return -1;
+    }
+    sensor_count++;
     strncpy(s->name, name, SENSOR_NAME_MAX-1);
     s->init = init_cb;
     s->read = read_cb;
     s->print = print_cb;
     s->ctx = ctx;
     s->freq_hz = initial_freq_hz;
+    s->period_ticks = period_for(initial_freq_hz);
     s->enabled = start_enabled;
+    s->flags = flags;
+    s->max_payload = (uint16_t)max_payload;
     s->task_handle = NULL;
-    s->last_data.len = 0;
-    s->last_data.timestamp = 0;
+    s->seq = 0;
 
     if (s->init) {
         s->init(s->ctx);
     }
 
+    if (uses_dispatcher(s)) {
+        sched_rearm(s);
+        Serial.printf("Scheduled %s idx=%d on dispatcher\r\n", s->name, idx);
+        return idx;
+    }
+
     char tname[16];
     snprintf(tname, sizeof(tname), "sens-%d", idx);
     BaseType_t r = xTaskCreate(sensor_task, tname, DEFAULT_STACK_SIZE, (void*)s, DEFAULT_TASK_PRIO, &s->task_handle);
@@ -139,7 +542,7 @@ int sensor_register(const char *name,
     if (!start_enabled && s->task_handle) {
         vTaskSuspend(s->task_handle);
     }
-    Serial.printf("sensor register done, idx = %d", idx);
+    Serial.printf("sensor register done, idx = %d\r\n", idx);
     return idx;
 }
 
@@ -148,7 +551,8 @@ void sensor_enable(int idx)
     if (idx < 0 || idx >= sensor_count) return;
     sensor_t *s = &sensors[idx];
     s->enabled = true;
-    if (s->task_handle) vTaskResume(s->task_handle);
+    if (uses_dispatcher(s)) sched_rearm(s);
+    else if (s->task_handle) vTaskResume(s->task_handle);
 }
 
 void sensor_disable(int idx)
@@ -156,15 +560,59 @@ void sensor_disable(int idx)
     if (idx < 0 || idx >= sensor_count) return;
     sensor_t *s = &sensors[idx];
     s->enabled = false;
-    if (s->task_handle) vTaskSuspend(s->task_handle);
+    if (uses_dispatcher(s)) sched_rearm(s);
+    else if (s->task_handle) vTaskSuspend(s->task_handle);
 }
 
 void sensor_set_freq(int idx, float freq_hz)
 {
     if (idx < 0 || idx >= sensor_count) return;
     sensor_t *s = &sensors[idx];
+    TickType_t old_period = s->period_ticks;
     s->freq_hz = freq_hz;
-    if (s->enabled && s->task_handle) vTaskResume(s->task_handle);
+    s->period_ticks = period_for(freq_hz);
+    if (uses_dispatcher(s)) sched_retime(s, old_period);
+    else if (s->enabled && s->task_handle) vTaskResume(s->task_handle);
+}
+
+float sensor_get_freq(int idx)
+{
+    if (idx < 0 || idx >= sensor_count) return 0.0f;
+    return sensors[idx].freq_hz;
+}
+
+const char *sensor_get_name(int idx)
+{
+    if (idx < 0 || idx >= sensor_count) return NULL;
+    return sensors[idx].name;
+}
+
+bool sensor_sink_register(sensor_sink_t sink, sensor_sink_cb cb, void *ctx)
+{
+    if (sink < 0 || sink >= SENSOR_SINK_COUNT) return false;
+    taskENTER_CRITICAL();
+    sinks[sink].cb = cb;
+    sinks[sink].ctx = ctx;
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+bool sensor_set_sinks(int idx, uint32_t sink_flags)
+{
+    if (idx < 0 || idx >= sensor_count) return false;
+    sensor_t *s = &sensors[idx];
+    // The sampler reads flags without a lock; publish the new word in one store
+    taskENTER_CRITICAL();
+    uint32_t f = (s->flags & ~SENSOR_FLAG_SINK_MASK) | (sink_flags & SENSOR_FLAG_SINK_MASK);
+    __atomic_store_n(&s->flags, f, __ATOMIC_RELAXED);
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+uint32_t sensor_get_sinks(int idx)
+{
+    if (idx < 0 || idx >= sensor_count) return 0;
+    return sensors[idx].flags & SENSOR_FLAG_SINK_MASK;
 }
 
 // 
@@ -173,6 +621,7 @@ void print_all_sensors(void)
 {
     char buf[256];
     int count;
+    sensor_data_t snap;
 
     //count = snprintf(buf, sizeof(buf), "SENSORS SNAPSHOT\r\n");
     //bleuart.write((uint8_t*)buf, count);
@@ -180,29 +629,30 @@ void print_all_sensors(void)
     
     for (int i = 0; i < sensor_count; ++i) {
         sensor_t *s = &sensors[i];
+        last_read(s, &snap);
         if(i == 0){
-            print_both("%lu, ", s->last_data.timestamp);
+            print_both("%lu, ", snap.timestamp);
         }
         count = snprintf(buf, sizeof(buf),
             "[%d] %s : enabled=%d freq=%.2fHz last_len=%u ts=%lu\r\n",
             i, s->name ? s->name : "(null)",
             s->enabled ? 1 : 0,
             s->freq_hz,
-            (unsigned)s->last_data.len,
-            (unsigned long)s->last_data.timestamp);
+            (unsigned)snap.len,
+            (unsigned long)snap.timestamp);
         //bleuart.write((uint8_t*)buf, count);
 
         if (s->print) {
             // if s->print prints via Serial, that output won't go to BLE
             // modify those to use bleuart.write() as well if needed
-            s->print(s->ctx, &s->last_data);
+            s->print(s->ctx, &snap);
         } else {
-            if (s->last_data.len > 0) {
+            if (snap.len > 0) {
                 count = snprintf(buf, sizeof(buf), "  data (hex): ");
                 //bleuart.write((uint8_t*)buf, count);
 
-                for (size_t b = 0; b < s->last_data.len && b < SENSOR_DATA_BYTES; ++b) {
-                    count = snprintf(buf, sizeof(buf), "%02X ", s->last_data.bytes[b]);
+                for (size_t b = 0; b < snap.len && b < SENSOR_DATA_BYTES; ++b) {
+                    count = snprintf(buf, sizeof(buf), "%02X ", snap.bytes[b]);
                     //bleuart.write((uint8_t*)buf, count);
                     delay(1); // small delay to avoid flooding BLE TX buffer
                 }
@@ -223,19 +673,241 @@ bool sensor_get_last(int idx, sensor_data_t *out)
 {
     if (!out) return false;
     if (idx < 0 || idx >= sensor_count) return false;
+    last_read(&sensors[idx], out);
+    return (out->len > 0);
+}
+
+/* ---- Event-driven acquisition ---- */
+
+void sensor_notify_from_isr(int idx, BaseType_t *higher_prio_woken)
+{
+    if (idx < 0 || idx >= sensor_count) return;
     sensor_t *s = &sensors[idx];
+    if (!(s->flags & SENSOR_FLAG_EVENT) || !s->enabled) return;
+#if SENSOR_INSTRUMENT
+    if (!s->notify_pending) {
+        s->notify_tick = xTaskGetTickCountFromISR();
+        s->notify_pending = true;
+    }
+#endif
+
+    if (uses_dispatcher(s)) {
+        __atomic_fetch_or(&due_events, 1u << idx, __ATOMIC_RELEASE);
+        if (dispatcher_handle) vTaskNotifyGiveFromISR(dispatcher_handle, higher_prio_woken);
+    } else if (s->task_handle) {
+        vTaskNotifyGiveFromISR(s->task_handle, higher_prio_woken);
+    }
+}
+
+void sensor_notify(int idx)
+{
+    if (idx < 0 || idx >= sensor_count) return;
+    sensor_t *s = &sensors[idx];
+    if (!(s->flags & SENSOR_FLAG_EVENT) || !s->enabled) return;
+#if SENSOR_INSTRUMENT
     taskENTER_CRITICAL();
-    memcpy(out, &s->last_data, sizeof(sensor_data_t));
+    if (!s->notify_pending) {
+        s->notify_tick = xTaskGetTickCount();
+        s->notify_pending = true;
+    }
     taskEXIT_CRITICAL();
-    return (out->len > 0);
+#endif
+
+    if (uses_dispatcher(s)) {
+        __atomic_fetch_or(&due_events, 1u << idx, __ATOMIC_RELEASE);
+        if (dispatcher_handle) xTaskNotifyGive(dispatcher_handle);
+    } else if (s->task_handle) {
+        xTaskNotifyGive(s->task_handle);
+    }
+}
+
+/* attachInterrupt() callbacks take no argument, so each IRQ slot gets its
+ * own trampoline that knows which sensor it serves */
+static volatile int irq_sensor[SENSOR_IRQ_MAX] = { -1, -1, -1, -1 };
+
+template <int N>
+static void irq_trampoline(void)
+{
+    BaseType_t woken = pdFALSE;
+    sensor_notify_from_isr(irq_sensor[N], &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void (*const irq_trampolines[SENSOR_IRQ_MAX])(void) = {
+    irq_trampoline<0>, irq_trampoline<1>, irq_trampoline<2>, irq_trampoline<3>,
+};
+
+bool sensor_attach_irq(int idx, int pin, int mode)
+{
+    if (idx < 0 || idx >= sensor_count || pin < 0) return false;
+    for (int i = 0; i < SENSOR_IRQ_MAX; ++i) {
+        if (irq_sensor[i] >= 0) continue;
+        irq_sensor[i] = idx;
+        pinMode(pin, INPUT_PULLUP);   // MAX30105/BNO08x INT lines are open-drain
+        attachInterrupt(digitalPinToInterrupt(pin), irq_trampolines[i], mode);
+        return true;
+    }
+    return false;
+}
+
+bool sensor_attach_queue(int idx, uint16_t depth)
+{
+    if (idx < 0 || idx >= sensor_count) return false;
+    sensor_t *s = &sensors[idx];
+    if (s->queue) return true;
+    sensor_queue_t *q = sensor_queue_create(depth, s->max_payload);
+    if (!q) return false;
+    __atomic_store_n(&s->queue, q, __ATOMIC_RELEASE);
+    return true;
+}
+
+sensor_queue_t *sensor_get_queue(int idx)
+{
+    if (idx < 0 || idx >= sensor_count) return NULL;
+    return sensors[idx].queue;
+}
+
+/* ---- Instrumentation queries ---- */
+
+bool sensor_stats_snapshot(int idx, sensor_stats_t *out)
+{
+#if SENSOR_INSTRUMENT
+    if (!out || idx < 0 || idx >= sensor_count) return false;
+    taskENTER_CRITICAL();
+    *out = sensors[idx].stats;
+    taskEXIT_CRITICAL();
+    return true;
+#else
+    (void)idx; (void)out;
+    return false;
+#endif
+}
+
+void sensor_stats_reset(int idx)
+{
+#if SENSOR_INSTRUMENT
+    int first = idx < 0 ? 0 : idx;
+    int last = idx < 0 ? sensor_count - 1 : idx;
+    if (last >= sensor_count) return;
+    for (int i = first; i <= last; ++i) {
+        taskENTER_CRITICAL();
+        memset(&sensors[i].stats, 0, sizeof(sensors[i].stats));
+        taskEXIT_CRITICAL();
+    }
+#else
+    (void)idx;
+#endif
+}
+
+uint32_t sensor_stats_cycles_per_us(void)
+{
+#if SENSOR_INSTRUMENT
+    return cycles_per_us();
+#else
+    return 0;
+#endif
+}
+
+#if SENSOR_INSTRUMENT
+#define STATS_HEADER_BYTES 8
+/* idx + 5 counters + two bitmaps + every bucket */
+#define STATS_ENTRY_MAX    (1 + 5 * 4 + 2 * (4 + 2 * SENSOR_HIST_BUCKETS))
+
+static uint8_t *put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static size_t stats_header(uint8_t *p, uint8_t count) {
+    p[0] = 'S'; p[1] = 'I';
+    p[2] = SENSOR_STATS_DUMP_VERSION;
+    p[3] = count;
+    put_u16(p + 4, (uint16_t)cycles_per_us());
+    put_u16(p + 6, (uint16_t)configTICK_RATE_HZ);
+    return STATS_HEADER_BYTES;
+}
+
+/* Only nonzero buckets are sent, flagged in a bitmap */
+static uint8_t *put_hist(uint8_t *p, const uint16_t *hist) {
+    uint32_t map = 0;
+    for (int b = 0; b < SENSOR_HIST_BUCKETS; ++b) {
+        if (hist[b]) map |= 1u << b;
+    }
+    p = put_u32(p, map);
+    for (int b = 0; b < SENSOR_HIST_BUCKETS; ++b) {
+        if (hist[b]) p = put_u16(p, hist[b]);
+    }
+    return p;
+}
+
+/* p must have STATS_ENTRY_MAX bytes */
+static size_t stats_entry(uint8_t *p, int idx) {
+    sensor_stats_t st;
+    sensor_stats_snapshot(idx, &st);
+    uint8_t *q = p;
+    *q++ = (uint8_t)idx;
+    q = put_u32(q, st.samples);
+    q = put_u32(q, st.missed_periods);
+    q = put_u32(q, st.max_jitter_ticks);
+    q = put_u32(q, st.read_cycles_max);
+    q = put_u32(q, st.bus_wait_cycles_max);
+    q = put_hist(q, st.read_hist);
+    q = put_hist(q, st.bus_wait_hist);
+    return (size_t)(q - p);
+}
+#endif
+
+size_t sensor_stats_dump(uint8_t *buf, size_t cap)
+{
+#if SENSOR_INSTRUMENT
+    if (!buf || cap < STATS_HEADER_BYTES) return 0;
+    size_t n = STATS_HEADER_BYTES;
+    int count = 0;
+    uint8_t entry[STATS_ENTRY_MAX];
+    for (int i = 0; i < sensor_count; ++i) {
+        size_t e = stats_entry(entry, i);
+        if (n + e > cap) break;
+        memcpy(buf + n, entry, e);
+        n += e;
+        count++;
+    }
+    stats_header(buf, (uint8_t)count);
+    return n;
+#else
+    (void)buf; (void)cap;
+    return 0;
+#endif
+}
+
+void sensor_stats_send(bool to_serial, bool to_ble)
+{
+#if SENSOR_INSTRUMENT
+    // One entry at a time so we don't need a buffer for the whole dump
+    uint8_t buf[STATS_ENTRY_MAX];
+    size_t n = stats_header(buf, (uint8_t)sensor_count);
+    for (int i = -1; i < sensor_count; ++i) {
+        if (i >= 0) n = stats_entry(buf, i);
+        if (to_serial) Serial.write(buf, n);
+        if (to_ble) ble_write_bytes_chunked(buf, n);
+    }
+#else
+    (void)to_serial; (void)to_ble;
+#endif
 }
 
-/* Convenience: create periodic printer task */
+/* Convenience: create periodic printer task. Text goes to Serial, the
+ * same snapshot to a BLE central as one telemetry frame. */
 static TickType_t g_print_period = pdMS_TO_TICKS(2000);
 static void sensor_printer_task(void *pv) {
     (void)pv;
     for (;;) {
         print_all_sensors();
+        telemetry_send_snapshot();
         vTaskDelay(g_print_period);
     }
 }
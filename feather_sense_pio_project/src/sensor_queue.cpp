@@ -0,0 +1,153 @@
+// src/sensor_queue.cpp
+#include "sensor_queue.h"
+#include "sample_pool.h"
+#include <event_groups.h>
+#include <string.h>
+
+struct sensor_queue_s {
+    sensor_data_t *slots[SENSOR_QUEUE_MAX_DEPTH];
+    uint16_t depth;
+    uint16_t max_payload;
+    volatile uint32_t head;                          // samples pushed so far
+    uint32_t cursor[SENSOR_QUEUE_MAX_CONSUMERS];     // next sample per consumer
+    uint32_t overruns[SENSOR_QUEUE_MAX_CONSUMERS];
+    volatile uint32_t consumers;                     // bit per subscribed consumer
+    EventGroupHandle_t ready;                        // same bits, set on push
+};
+
+static sensor_queue_t queues[SENSOR_QUEUE_MAX];
+static int queue_count = 0;
+
+sensor_queue_t *sensor_queue_create(uint16_t depth, size_t max_payload)
+{
+    if (depth < 2 || depth > SENSOR_QUEUE_MAX_DEPTH) return NULL;
+
+    // Allocate everything first: a table slot is only claimed for a whole queue
+    sensor_data_t *slots[SENSOR_QUEUE_MAX_DEPTH];
+    uint16_t got = 0;
+    while (got < depth && (slots[got] = sample_pool_alloc(max_payload)) != NULL) got++;
+    EventGroupHandle_t ready = (got == depth) ? xEventGroupCreate() : NULL;
+
+    int qi = -1;
+    if (ready) {
+        taskENTER_CRITICAL();
+        if (queue_count < SENSOR_QUEUE_MAX) qi = queue_count++;
+        taskEXIT_CRITICAL();
+    }
+    if (qi < 0) {
+        if (ready) vEventGroupDelete(ready);
+        while (got > 0) sample_pool_free(slots[--got]);
+        return NULL;
+    }
+
+    sensor_queue_t *q = &queues[qi];
+    memset(q, 0, sizeof(*q));
+    memcpy(q->slots, slots, depth * sizeof(slots[0]));
+    q->ready = ready;
+    q->depth = depth;
+    q->max_payload = (uint16_t)max_payload;
+    return q;
+}
+
+void sensor_queue_push(sensor_queue_t *q, const sensor_data_t *d)
+{
+    if (!q || !d) return;
+    uint32_t h = q->head;
+    sensor_data_t *slot = q->slots[h % q->depth];
+    size_t len = (d->len > q->max_payload) ? q->max_payload : d->len;
+
+    // Keep the slot writes after the previous publish of head
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->len = len;
+    slot->timestamp = d->timestamp;
+    memcpy(slot->bytes, d->bytes, len);
+    __atomic_store_n(&q->head, h + 1, __ATOMIC_RELEASE);
+
+    uint32_t waiting = q->consumers;
+    if (waiting) xEventGroupSetBits(q->ready, (EventBits_t)waiting);
+}
+
+int sensor_queue_subscribe(sensor_queue_t *q)
+{
+    if (!q) return -1;
+    for (int c = 0; c < SENSOR_QUEUE_MAX_CONSUMERS; ++c) {
+        taskENTER_CRITICAL();
+        bool free_slot = !(q->consumers & (1u << c));
+        if (free_slot) {
+            q->cursor[c] = q->head;
+            q->overruns[c] = 0;
+            q->consumers |= (1u << c);
+        }
+        taskEXIT_CRITICAL();
+        if (free_slot) return c;
+    }
+    return -1;
+}
+
+bool sensor_queue_pop(sensor_queue_t *q, int consumer, sensor_data_t *out)
+{
+    if (!q || !out || consumer < 0 || consumer >= SENSOR_QUEUE_MAX_CONSUMERS) return false;
+    uint32_t cur = q->cursor[consumer];
+
+    for (;;) {
+        uint32_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+        if (cur == head) break;
+
+        // Only depth-1 slots are safe: the producer may be rewriting slot head % depth
+        if (head - cur >= q->depth) {
+            uint32_t skip = head - cur - (q->depth - 1);
+            q->overruns[consumer] += skip;
+            cur += skip;
+        }
+
+        const sensor_data_t *src = q->slots[cur % q->depth];
+        size_t len = src->len;
+        if (len > q->max_payload) len = q->max_payload;   // torn len, retried below
+        memcpy(out, src, SENSOR_RECORD_BYTES(len));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        // Lapped while copying: count the overrun on the next pass
+        if (__atomic_load_n(&q->head, __ATOMIC_RELAXED) - cur >= q->depth) continue;
+
+        q->cursor[consumer] = cur + 1;
+        out->cap = SENSOR_DATA_BYTES;
+        return true;
+    }
+    q->cursor[consumer] = cur;
+    return false;
+}
+
+bool sensor_queue_wait(sensor_queue_t *q, int consumer, sensor_data_t *out, uint32_t timeout_ms)
+{
+    if (!q || consumer < 0 || consumer >= SENSOR_QUEUE_MAX_CONSUMERS) return false;
+    const EventBits_t bit = (EventBits_t)(1u << consumer);
+    TickType_t start = xTaskGetTickCount();
+    TickType_t limit = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+
+    for (;;) {
+        // The push sets our bit after publishing head, so a sample landing
+        // between this pop and the wait below still wakes us
+        if (sensor_queue_pop(q, consumer, out)) return true;
+
+        TickType_t wait = portMAX_DELAY;
+        if (limit != portMAX_DELAY) {
+            TickType_t spent = xTaskGetTickCount() - start;
+            if (spent >= limit) return false;
+            wait = limit - spent;
+        }
+        xEventGroupWaitBits(q->ready, bit, pdTRUE, pdFALSE, wait);
+    }
+}
+
+uint32_t sensor_queue_pending(sensor_queue_t *q, int consumer)
+{
+    if (!q || consumer < 0 || consumer >= SENSOR_QUEUE_MAX_CONSUMERS) return 0;
+    uint32_t n = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) - q->cursor[consumer];
+    return (n > (uint32_t)(q->depth - 1)) ? (uint32_t)(q->depth - 1) : n;
+}
+
+uint32_t sensor_queue_overruns(sensor_queue_t *q, int consumer)
+{
+    if (!q || consumer < 0 || consumer >= SENSOR_QUEUE_MAX_CONSUMERS) return 0;
+    return q->overruns[consumer];
+}
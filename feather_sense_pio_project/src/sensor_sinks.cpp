@@ -0,0 +1,173 @@
+// src/sensor_sinks.cpp
+#include "sensor_sinks.h"
+#include "storage.h"
+#include "ble_manager.h"
+#include "telemetry.h"
+#include <string.h>
+#include <Arduino.h>
+#include <bluefruit.h>
+
+#define LIVE_HDR_BYTES 8   // ring frames: 'L' idx ts(4) len(2)
+
+/* Byte ring of length-prefixed frames. Producers are sampling tasks
+ * (dispatcher + own-task sensors), the consumer is live_task. */
+typedef struct {
+    uint8_t buf[SENSOR_SINK_RING_BYTES];
+    uint32_t head;   // free-running byte counts
+    uint32_t tail;
+} live_ring_t;
+
+static live_ring_t ble_ring;
+static live_ring_t serial_ring;
+static sensor_sink_stats_t stats[SENSOR_SINK_COUNT];
+static TaskHandle_t live_handle = NULL;
+
+static void ring_copy_in(live_ring_t *r, uint32_t at, const uint8_t *src, size_t n) {
+    for (size_t i = 0; i < n; ++i) r->buf[(at + i) % SENSOR_SINK_RING_BYTES] = src[i];
+}
+
+static void ring_copy_out(const live_ring_t *r, uint32_t at, uint8_t *dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] = r->buf[(at + i) % SENSOR_SINK_RING_BYTES];
+}
+
+/* Queue one frame (2-byte length prefix + header + payload); all or nothing */
+static bool ring_push(live_ring_t *r, uint8_t idx, const sensor_data_t *d) {
+    uint8_t hdr[2 + LIVE_HDR_BYTES];
+    uint16_t frame = (uint16_t)(LIVE_HDR_BYTES + d->len);
+    uint32_t ts = (uint32_t)d->timestamp;
+    hdr[0] = (uint8_t)(frame >> 8);
+    hdr[1] = (uint8_t)frame;
+    hdr[2] = 'L';
+    hdr[3] = idx;
+    hdr[4] = (uint8_t)(ts >> 24);
+    hdr[5] = (uint8_t)(ts >> 16);
+    hdr[6] = (uint8_t)(ts >> 8);
+    hdr[7] = (uint8_t)ts;
+    hdr[8] = (uint8_t)(d->len >> 8);
+    hdr[9] = (uint8_t)d->len;
+
+    bool ok = false;
+    taskENTER_CRITICAL();
+    if (SENSOR_SINK_RING_BYTES - (r->head - r->tail) >= sizeof(hdr) + d->len) {
+        ring_copy_in(r, r->head, hdr, sizeof(hdr));
+        ring_copy_in(r, r->head + sizeof(hdr), d->bytes, d->len);
+        r->head += (uint32_t)(sizeof(hdr) + d->len);
+        ok = true;
+    }
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+/* Pop one frame into out (cap bytes). Returns its length, 0 if empty. */
+static size_t ring_pop(live_ring_t *r, uint8_t *out, size_t cap) {
+    size_t n = 0;
+    taskENTER_CRITICAL();
+    if (r->head != r->tail) {
+        uint8_t len[2];
+        ring_copy_out(r, r->tail, len, 2);
+        n = ((size_t)len[0] << 8) | len[1];
+        if (n <= cap) ring_copy_out(r, r->tail + 2, out, n);
+        else n = 0;   // can't happen: frames are capped by SENSOR_DATA_BYTES
+        r->tail += (uint32_t)(2 + (((size_t)len[0] << 8) | len[1]));
+    }
+    taskEXIT_CRITICAL();
+    return n;
+}
+
+static void count(sensor_sink_t sink, bool ok) {
+    taskENTER_CRITICAL();
+    if (ok) stats[sink].records++;
+    else stats[sink].drops++;
+    taskEXIT_CRITICAL();
+}
+
+/* ---- Handlers (sampling task context) ---- */
+
+static void flash_sink(void *ctx, int idx, const sensor_data_t *d) {
+    (void)ctx;
+    count(SENSOR_SINK_FLASH, storage_append_record((uint8_t)idx, d));
+}
+
+static void live_sink(void *ctx, int idx, const sensor_data_t *d) {
+    live_ring_t *r = (live_ring_t *)ctx;
+    sensor_sink_t sink = (r == &ble_ring) ? SENSOR_SINK_BLE : SENSOR_SINK_SERIAL;
+    // Live data is worthless later; don't queue it for a central that isn't there
+    if (sink == SENSOR_SINK_BLE && !Bluefruit.connected()) {
+        count(sink, false);
+        return;
+    }
+    bool ok = ring_push(r, (uint8_t)idx, d);
+    count(sink, ok);
+    if (ok && live_handle) xTaskNotifyGive(live_handle);
+}
+
+/* ---- Slow side ---- */
+
+static void serial_line(const uint8_t *frame, size_t n) {
+    uint32_t ts = ((uint32_t)frame[2] << 24) | ((uint32_t)frame[3] << 16) |
+                  ((uint32_t)frame[4] << 8) | frame[5];
+    Serial.printf("S,%u,%lu,", (unsigned)frame[1], (unsigned long)ts);
+    for (size_t i = LIVE_HDR_BYTES; i < n; ++i) Serial.printf("%02X", frame[i]);
+    Serial.print("\r\n");
+}
+
+// Into the frame being packed; sensors without a layout go RAW
+static void ble_pack(telem_packer_t *pk, const uint8_t *frame, size_t n) {
+    uint8_t idx = frame[1];
+    uint32_t ts = ((uint32_t)frame[2] << 24) | ((uint32_t)frame[3] << 16) |
+                  ((uint32_t)frame[4] << 8) | frame[5];
+    telem_layout_t layout = telemetry_get_layout(idx);
+    if (layout == TELEM_LAYOUT_NONE) layout = TELEM_LAYOUT_RAW;
+    telemetry_pack(pk, idx, ts, layout, frame + LIVE_HDR_BYTES, n - LIVE_HDR_BYTES);
+}
+
+static void live_task(void *pv) {
+    (void)pv;
+    static uint8_t frame[LIVE_HDR_BYTES + SENSOR_DATA_BYTES];
+    static telem_packer_t pk;
+    for (;;) {
+        // A part-full frame goes out once its first sample has waited
+        // SENSOR_SINK_BLE_HOLD_MS; until then more samples may join it
+        TickType_t wait = pdMS_TO_TICKS(100);
+        if (pk.open) {
+            uint32_t held = millis() - pk.opened_ms;
+            // + 1: a part tick left must still block, not spin
+            wait = held < SENSOR_SINK_BLE_HOLD_MS ? pdMS_TO_TICKS(SENSOR_SINK_BLE_HOLD_MS - held) + 1 : 0;
+        }
+        if (wait) ulTaskNotifyTake(pdTRUE, wait);
+        // One frame from each ring per pass: a BLE ring that refills as fast
+        // as it drains mustn't starve the serial one
+        for (bool more = true; more; ) {
+            size_t n = ring_pop(&ble_ring, frame, sizeof(frame));
+            more = n > 0;
+            if (n && Bluefruit.connected()) ble_pack(&pk, frame, n);
+            n = ring_pop(&serial_ring, frame, sizeof(frame));
+            if (n) {
+                serial_line(frame, n);
+                more = true;
+            }
+        }
+        if (pk.open && (!Bluefruit.connected() || millis() - pk.opened_ms >= SENSOR_SINK_BLE_HOLD_MS)) {
+            telemetry_pack_flush(&pk);
+        }
+    }
+}
+
+bool sensor_sinks_init(UBaseType_t priority, uint16_t stack_words)
+{
+    sensor_sink_register(SENSOR_SINK_FLASH, flash_sink, NULL);
+    sensor_sink_register(SENSOR_SINK_BLE, live_sink, &ble_ring);
+    sensor_sink_register(SENSOR_SINK_SERIAL, live_sink, &serial_ring);
+    if (live_handle) return true;
+    return xTaskCreate(live_task, "sink-live", stack_words ? stack_words : 1024, NULL,
+                       priority ? priority : 1, &live_handle) == pdPASS;
+}
+
+bool sensor_sinks_get_stats(sensor_sink_t sink, sensor_sink_stats_t *out)
+{
+    if (!out || sink < 0 || sink >= SENSOR_SINK_COUNT) return false;
+    taskENTER_CRITICAL();
+    *out = stats[sink];
+    taskEXIT_CRITICAL();
+    return true;
+}
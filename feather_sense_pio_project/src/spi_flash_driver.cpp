@@ -1,35 +1,184 @@
 #include <Adafruit_SPIFlash.h>
 #include <Adafruit_TinyUSB.h>
 #include "storage.h"
+#include <event_groups.h>
+#include <semphr.h>
 
 Adafruit_FlashTransport_QSPI flashTransport;
 Adafruit_SPIFlash flash(&flashTransport);
-const uint32_t FLASH_SECTOR_SIZE = 4096;
+const uint32_t FLASH_SECTOR_SIZE = FLASH_LAYOUT_SECTOR;
 
-// Helper wrappers (used by storage module)
+#define FLASH_PAGE_BYTES   256
+#define FLASH_ASYNC_DEPTH  4
+#define FLASH_STATUS_WIP   0x01
+#define DONE_BIT           (1u << 0)
+
+/* Async write queue: submitters fill reqs[queued % depth], the writer task
+ * runs reqs[done % depth]. Counters are free-running; tickets are queued
+ * values. */
+typedef struct {
+  uint32_t addr;
+  const uint8_t *buf;
+  size_t len;
+  flash_write_cb_t cb;
+  void *ctx;
+} flash_req_t;
+
+static flash_req_t reqs[FLASH_ASYNC_DEPTH];
+static volatile uint32_t queued = 0;
+static volatile uint32_t done = 0;
+static EventGroupHandle_t done_ev = NULL;   // DONE_BIT after each request
+static TaskHandle_t writer_handle = NULL;
+// The chip does one thing at a time: the writer holds this per request,
+// the synchronous calls per call. Storage and the config store share it.
+static SemaphoreHandle_t chip_mutex = NULL;
+static bool flash_began = false;
+
+static inline void chip_lock(void) {
+  if (chip_mutex) xSemaphoreTake(chip_mutex, portMAX_DELAY);
+}
+
+static inline void chip_unlock(void) {
+  if (chip_mutex) xSemaphoreGive(chip_mutex);
+}
+
+// Poll the chip's busy bit. A page program (~0.7 ms) is shorter than a
+// tick, and sleeping a whole tick on it would cap async writes near
+// 250 KB/s, so it is polled out yielding to ready tasks; only a busy time
+// that has already run past a tick (a slow or suspended program) sleeps
+// between polls and lets idle run
+static void wait_ready(void) {
+  TickType_t t0 = xTaskGetTickCount();
+  while (flash.readStatus() & FLASH_STATUS_WIP) {
+    if (xTaskGetTickCount() - t0 <= 1) taskYIELD();
+    else vTaskDelay(1);
+  }
+}
+
+// One page program at a time; each returns as soon as the chip has the data
+static bool program_pages(uint32_t addr, const uint8_t *buf, size_t len) {
+  bool ok = true;
+  while (len) {
+    size_t n = FLASH_PAGE_BYTES - (addr % FLASH_PAGE_BYTES);
+    if (n > len) n = len;
+    wait_ready();
+    if (flash.writeBuffer(addr, buf, (uint32_t)n) != n) ok = false;
+    addr += (uint32_t)n;
+    buf += n;
+    len -= n;
+  }
+  wait_ready();
+  return ok;
+}
+
+static void writer_task(void *pv) {
+  (void)pv;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    for (;;) {
+      taskENTER_CRITICAL();
+      bool empty = done == queued;
+      flash_req_t r = reqs[done % FLASH_ASYNC_DEPTH];
+      taskEXIT_CRITICAL();
+      if (empty) break;
+      chip_lock();
+      bool ok = program_pages(r.addr, r.buf, r.len);
+      chip_unlock();
+      if (r.cb) r.cb(r.ctx, ok);
+      taskENTER_CRITICAL();
+      done++;
+      taskEXIT_CRITICAL();
+      xEventGroupSetBits(done_ev, DONE_BIT);
+    }
+  }
+}
+
+static inline bool ticket_done(uint32_t ticket) {
+  return (int32_t)(done - ticket) >= 0;
+}
+
+// Helper wrappers (used by storage module and the config store); once is enough
 bool flash_init() {
+  if (flash_began) return true;
   if (!flash.begin()) {
     return false;
   }
+  flash_began = true;
+  if (!chip_mutex) chip_mutex = xSemaphoreCreateMutex();
+  // Without the writer task async writes just run synchronously
+  if (!done_ev) done_ev = xEventGroupCreate();
+  if (done_ev && !writer_handle) {
+    if (xTaskCreate(writer_task, "flash-wr", 512, NULL, 1, &writer_handle) != pdPASS) writer_handle = NULL;
+  }
   return true;
 }
 
+// Bounded waits: another waiter may have taken the bit meant for us
+void flash_wait(uint32_t ticket) {
+  while (!ticket_done(ticket)) {
+    xEventGroupWaitBits(done_ev, DONE_BIT, pdTRUE, pdFALSE, 1);
+  }
+}
+
+void flash_sync(void) {
+  flash_wait(queued);
+}
+
+uint32_t flash_write_async(uint32_t addr, const uint8_t *buf, size_t len,
+                           flash_write_cb_t cb, void *ctx) {
+  if (!buf || len == 0) return 0;
+  if (!writer_handle) {
+    bool ok = flash_write(addr, buf, len);
+    if (cb) cb(ctx, ok);
+    taskENTER_CRITICAL();
+    uint32_t t = ++queued;
+    done = queued;
+    taskEXIT_CRITICAL();
+    return t;
+  }
+  // Wait for a free slot
+  while (queued - done >= FLASH_ASYNC_DEPTH) {
+    xEventGroupWaitBits(done_ev, DONE_BIT, pdTRUE, pdFALSE, 1);
+  }
+  taskENTER_CRITICAL();
+  flash_req_t *r = &reqs[queued % FLASH_ASYNC_DEPTH];
+  r->addr = addr;
+  r->buf = buf;
+  r->len = len;
+  r->cb = cb;
+  r->ctx = ctx;
+  uint32_t t = ++queued;
+  taskEXIT_CRITICAL();
+  xTaskNotifyGive(writer_handle);
+  return t;
+}
+
+// The synchronous calls go after everything queued, so reads see it
 bool flash_erase_sector(uint32_t sector_index) {
+  flash_sync();
+  chip_lock();
   bool r = flash.eraseSector(sector_index);
   flash.waitUntilReady();
+  chip_unlock();
   return r;
 }
 
 bool flash_read(uint32_t addr, uint8_t *buf, size_t len) {
   if (!buf || len == 0) return false;
+  flash_sync();
+  chip_lock();
   flash.readBuffer(addr, buf, len);
+  chip_unlock();
   return true;
 }
 
 bool flash_write(uint32_t addr, const uint8_t *buf, size_t len) {
   if (!buf || len == 0) return false;
+  flash_sync();
+  chip_lock();
   flash.writeBuffer(addr, (uint8_t*)buf, len);
   flash.waitUntilReady();
+  chip_unlock();
   return true;
 }
 
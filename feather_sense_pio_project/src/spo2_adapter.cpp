@@ -34,7 +34,7 @@ bool probe_common_addrs_and_record2(void) {
 
   for (size_t i = 0; i < sizeof(probe_addrs); ++i) {
     uint8_t a = probe_addrs[i];
-    if (!sensor_bus_lock(pdMS_TO_TICKS(100))) {
+    if (!sensor_bus_lock(SENSOR_BUS_WIRE, 100)) {
       #if SPO2_DEBUG
       Serial.println("spo2_adapter: probe - failed to lock bus");
       #endif
@@ -45,7 +45,7 @@ bool probe_common_addrs_and_record2(void) {
     Wire.beginTransmission(a);
     uint8_t err = Wire.endTransmission();
 
-    sensor_bus_unlock();
+    sensor_bus_unlock(SENSOR_BUS_WIRE);
     
     #if SPO2_DEBUG
     Serial.printf("sp02_adapter: probe 0x%02X result=%u\r\n", a, err);
@@ -111,7 +111,7 @@ bool spo2_init_adapter(void *ctx) {
 bool spo2_read_adapter(void *ctx, sensor_data_t *out) {
   (void)ctx;
   if (!out) return false;
-  memset(out, 0, sizeof(*out));
+  memset(out->bytes, 0, out->cap);
   if (spo2_i2c_addr == 0) return false; // no known device
 
   // Snapshot the volatile globals under a critical section to avoid torn reads.
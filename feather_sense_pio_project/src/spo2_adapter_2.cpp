@@ -26,7 +26,7 @@ bool probe_common_addrs_and_record2_2(void) {
 
   for (size_t i = 0; i < sizeof(probe_addrs) / sizeof(probe_addrs[0]); ++i) {
     uint8_t a = probe_addrs[i];
-    if (!sensor_bus_lock(pdMS_TO_TICKS(100))) {
+    if (!sensor_bus_lock(SENSOR_BUS_WIRE1, 100)) {
       #if SPO2_DEBUG
       Serial.println("spo2_adapter_2: probe - failed to lock bus");
       #endif
@@ -37,7 +37,7 @@ bool probe_common_addrs_and_record2_2(void) {
     Wire1.beginTransmission(a);
     uint8_t err = Wire1.endTransmission();
 
-    sensor_bus_unlock();
+    sensor_bus_unlock(SENSOR_BUS_WIRE1);
 
     #if SPO2_DEBUG
     Serial.printf("spo2_adapter_2: probe 0x%02X result=%u\r\n", a, err);
@@ -89,7 +89,7 @@ bool spo2_init_adapter_2(void *ctx) {
 bool spo2_read_adapter_2(void *ctx, sensor_data_t *out) {
   (void)ctx;
   if (!out) return false;
-  memset(out, 0, sizeof(*out));
+  memset(out->bytes, 0, out->cap);
   if (spo2_i2c_addr_2 == 0) return false;
 
   float ir_acdc_local = 0.0f;
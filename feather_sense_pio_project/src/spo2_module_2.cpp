@@ -10,6 +10,7 @@
 #include "MAX30105.h"
 #include "heartRate.h"
 #include "sensor_manager.h"
+#include "config_store.h"
 
 // enable/disable verbose debug prints for SPO2
 #ifndef SPO2_DEBUG
@@ -27,10 +28,20 @@ volatile float heartRate_2 = 0.0f;
 MAX30105 particleSensor_2;
 TwoWire Wire1(NRF_TWIM1, NRF_TWIS1, PWM1_IRQn, 12, 13);  // SDA=12, SCL=13
 
+// MAX30105 INT line (open drain, active low). When wired, the task sleeps until
+// the FIFO almost-full interrupt instead of polling every 20 ms; -1 = poll.
+#ifndef SPO2_2_INT_PIN
+#define SPO2_2_INT_PIN -1
+#endif
+const unsigned long SPO2_POLL_MS = 20;       // polling period without INT
+const unsigned long SPO2_FALLBACK_MS = 400;  // INT mode timeout (FIFO holds 32 samples = 640 ms at 50 sps)
+const uint8_t SPO2_FIFO_A_FULL = 0x0F;       // interrupt with 15 free slots = 17 samples queued
+
 // ---------- TUNED PARAMETERS ----------
-const int Num = 100;                  // samples/window for SpO2
-const double frate = 0.95;            // DC IIR factor (keep running between windows)
-const double FSpO2 = 0.80;            // SpO2 smoothing (higher => more smoothing)
+// Defaults for CFG_SPO2_WINDOW / CFG_SPO2_DC_IIR / CFG_SPO2_SMOOTH, read each call
+const int DEFAULT_NUM = 100;          // samples/window for SpO2
+const double DEFAULT_FRATE = 0.95;    // DC IIR factor (keep running between windows)
+const double DEFAULT_FSPO2 = 0.80;    // SpO2 smoothing (higher => more smoothing)
 const unsigned long PRINT_INTERVAL_MS = 1000; // print every 1s
 
 // HR filtering/smoothing thresholds
@@ -113,11 +124,22 @@ void readSpo2_2(void);
 // ----------------- Task management -----------------
 static TaskHandle_t spo2TaskHandle = NULL;
 
+static void spo2_int_isr(void) {
+  BaseType_t woken = pdFALSE;
+  if (spo2TaskHandle) vTaskNotifyGiveFromISR(spo2TaskHandle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
 static void spo2_task_fn(void *pv) {
   (void)pv;
   for (;;) {
     readSpo2_2(); // drain FIFO and update volatile globals
-    vTaskDelay(pdMS_TO_TICKS(20)); // ~50 Hz; tune if needed
+    if (SPO2_2_INT_PIN >= 0) {
+      // Sleep until the FIFO almost-full interrupt; the timeout only covers a missed edge
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SPO2_FALLBACK_MS));
+    } else {
+      vTaskDelay(pdMS_TO_TICKS(SPO2_POLL_MS)); // ~50 Hz; tune if needed
+    }
   }
 }
 
@@ -152,6 +174,13 @@ void spo2_sensor_init_2() {
   particleSensor_2.setPulseAmplitudeRed(ledBrightness);
   particleSensor_2.setPulseAmplitudeIR(ledBrightness);
 
+  if (SPO2_2_INT_PIN >= 0) {
+    particleSensor_2.setFIFOAlmostFull(SPO2_FIFO_A_FULL);
+    particleSensor_2.enableAFULL();
+    pinMode(SPO2_2_INT_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(SPO2_2_INT_PIN), spo2_int_isr, FALLING);
+  }
+
   avered = aveir = 0.0;
   sumredrms = sumirrms = 0.0;
   sampleCounter = 0;
@@ -165,13 +194,16 @@ void spo2_sensor_init_2() {
 #include "sensor_manager.h" // add this at top of spo2_module.cpp if not already included
 
 void readSpo2_2() {
+  const int Num = config_get_i32(CFG_SPO2_WINDOW, DEFAULT_NUM);
+  const double frate = config_get_f32(CFG_SPO2_DC_IIR, (float)DEFAULT_FRATE);
+  const double FSpO2 = config_get_f32(CFG_SPO2_SMOOTH, (float)DEFAULT_FSPO2);
   #if SPO2_DEBUG
   Serial.println("DEBUG: readSpo2()_2 called");
   #endif
 
-  // Attempt to lock the shared I2C bus before reading FIFO.
+  // Attempt to lock the Wire1 bus before reading FIFO.
   // Use a modest timeout so we don't block forever (50 ms recommended).
-  if (!sensor_bus_lock(pdMS_TO_TICKS(50))) {
+  if (!sensor_bus_lock(SENSOR_BUS_WIRE1, 50)) {
     // Could not acquire bus; skip this cycle and try again next time.
     #if SPO2_DEBUG
     Serial.println("DEBUG: readSpo2()_2 - failed to lock bus, skipping this cycle");
@@ -234,8 +266,11 @@ void readSpo2_2() {
     particleSensor_2.nextSample();
   } // end FIFO loop
 
+  // Reading INT_STATUS_1 releases the INT line so the next almost-full edge fires
+  if (SPO2_2_INT_PIN >= 0) particleSensor_2.getINT1();
+
   // Release I2C bus so others can use it
-  sensor_bus_unlock();
+  sensor_bus_unlock(SENSOR_BUS_WIRE1);
 
   #if SPO2_DEBUG
   Serial.printf("DEBUG: processed %d samples this call, sampleCounter=%d, avered=%.1f aveir=%.1f\n",
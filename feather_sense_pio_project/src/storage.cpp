@@ -1,287 +1,1552 @@
 // src/storage.cpp
 #include "storage.h"
+#include "record_codec.h"
+#include "crc32.h"
 #include "ble_manager.h"
 #include <semphr.h>
 #include "sensor_manager.h"
+#include "config_store.h"
 #include <bluefruit.h>
+#include <math.h>
 
 // ---- Configurable constants ----
-static const uint32_t FLASH_LOG_BASE = 0x000000;         // base address to store logs
-static const uint32_t FLASH_LOG_MAX_BYTES = 512 * 1024;  // how many bytes reserved for logs (512KB)
-static const size_t DEFAULT_RAM_BUF = 4*1024;            // default in-RAM batch buffer
 static const uint32_t DEFAULT_FLUSH_MS = 60 * 1000;      // flush interval
 
-// Upload chunk sizes
-static const size_t CHUNK_UPLOAD_PAYLOAD = 180; // safe payload to fit typical ATT MTU
+typedef enum {
+  FLUSH_WATERMARK = 0,   // filling batch crossed ram_watermark
+  FLUSH_FULL,            // a record didn't fit the filling batch
+  FLUSH_TIMER,           // oldest record waited flush_interval_ms
+  FLUSH_MANUAL,          // storage_flush_now(): uploads, callers
+  FLUSH_REASONS
+} flush_reason_t;
 
 // ---- Internal state ----
-static uint8_t *ram_buf = NULL;
-static size_t ram_len = 0;
-static size_t ram_capacity = 0;
+// Ping-pong RAM batches: appenders fill ram_batch[fill_idx] while the
+// flusher writes the other one. A batch that isn't being filled is either
+// empty or pending (handed to the flusher, appenders keep out).
+static uint8_t ram_batch[2][STORAGE_BATCH_BYTES];
+static size_t ram_len[2] = {0, 0};
+static bool ram_pending[2] = {false, false};
+static uint8_t fill_idx = 0;
+static size_t ram_capacity = STORAGE_BATCH_BYTES;
+static size_t ram_watermark = STORAGE_BATCH_BYTES;   // flush once the filling batch holds this much
+static uint32_t ram_first_ms[2];   // millis() of each batch's first record
+// Why the flush task was woken (flush_reason_t bits), and whether it is
+// asleep with nothing to flush; guarded by ram_mutex
+static uint8_t flush_why = 0;
+static bool flush_idle = false;
+static uint32_t flush_count[FLUSH_REASONS];
 static SemaphoreHandle_t ram_mutex = NULL;
+static storage_sensor_stats_t rec_stats[STORAGE_MAX_SENSORS];
+static uint8_t drop_policy[STORAGE_MAX_SENSORS];   // storage_drop_policy_t
+static uint8_t rec_codec[STORAGE_MAX_SENSORS];     // record_codec_t
 static TaskHandle_t flush_task_handle = NULL;
+static TaskHandle_t preerase_task_handle = NULL;
 static uint32_t flush_interval_ms = DEFAULT_FLUSH_MS;
-
-// Tracks where next write should go in flash (absolute address)
-static uint32_t flash_write_ptr = FLASH_LOG_BASE;
 static bool flash_initialized = false;
 
-/* Helper: find current write pointer by scanning flash for first 0xFF byte */
-static uint32_t find_write_ptr() {
-  // Scan in chunks for first 0xFF byte (free space)
-  const size_t SCAN_CHUNK = 256;
-  uint8_t buf[SCAN_CHUNK];
-  uint32_t max_addr = FLASH_LOG_BASE + FLASH_LOG_MAX_BYTES;
-  uint32_t addr = FLASH_LOG_BASE;
-
-  while (addr < max_addr) {
-    uint32_t read_len = SCAN_CHUNK;
-    if (addr + read_len > max_addr) read_len = max_addr - addr;
-    flash_read(addr, buf, read_len);
-    // search for 0xFF byte in chunk
-    for (size_t i = 0; i < read_len; ++i) {
-      if (buf[i] == 0xFF) {
-        // return this byte address as first free location
-        return addr + (uint32_t)i;
+/* ---- Log-structured flash format ----
+ * The log region is a ring of 4 KB sectors. Each sector starts with a
+ * header (log_sector_hdr_t) followed by batches, one per flush:
+ *   [len u16 BE][commit u8][0xFF][base_ts u32 BE][crc u32 BE] + len bytes of records
+ * Each batch is one record_codec block starting at base_ts, so it decodes
+ * on its own; a sector never splits a batch or a short record. A long
+ * record (over 255 bytes) that doesn't fit a sector's tail continues as a
+ * part at the start of the next batch. crc is the CRC-32 of len, base_ts
+ * and the records: a committed batch that fails it was damaged after the
+ * fact and is skipped (counted in batches_corrupt).
+ * NOR can only clear bits, so every "marker" is a field left 0xFF at
+ * write time and programmed afterwards:
+ *   hdr_commit  set once magic/seq/base_ts are down (torn header = free sector)
+ *   batch commit set once the batch payload is down (torn batch = end of sector)
+ *   used         set when the sector is sealed, so closed sectors need no walk
+ * Boot recovery reads one header per sector to find the oldest (tail) and
+ * newest (head) sequence numbers, then walks only the head's batch headers.
+ * Wear: only the sector ahead of the head is ever erased, and each header
+ * carries that sector's erase count. erase_all leaves an uncommitted
+ * "stamp" (magic + erase_count) in every sector so the counts survive.
+ * Pre-erase: a low-priority task keeps the STORAGE_PREERASE_SECTORS
+ * sectors after the head erased and stamped ("ready"), evicting the oldest
+ * data early when the ring is full, so opening a sector only programs. */
+#define LOG_MAGIC          0x534C4F47u   // "SLOG"
+#define LOG_VERSION        4
+#define LOG_HDR_COMMIT     0xA55Au
+#define LOG_SEAL_COMMIT    0x5AA5u
+#define LOG_BATCH_COMMIT   0xA5
+#define LOG_BATCH_HDR      12
+#define LOG_SECTOR_BYTES   4096u
+#define LOG_SECTORS        (FLASH_LOG_MAX_BYTES / LOG_SECTOR_BYTES)
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;          // +1 for every sector opened; oldest data = lowest seq
+    uint32_t base_ts;      // millis() when the sector was opened
+    uint32_t erase_count;  // erases of this sector, including the one before this header
+    uint16_t version;
+    uint16_t hdr_commit;   // LOG_HDR_COMMIT
+    uint16_t used;         // batch bytes after the header, programmed on seal
+    uint16_t seal_commit;  // LOG_SEAL_COMMIT once used is valid
+} log_sector_hdr_t;
+
+#define LOG_HDR_BYTES      ((uint32_t)sizeof(log_sector_hdr_t))
+#define LOG_SECTOR_PAYLOAD (LOG_SECTOR_BYTES - LOG_HDR_BYTES)
+
+// Raw record framing in the RAM batches: [ts u32 BE][sensor_idx][len][payload]
+#define REC_HDR_BYTES      7
+#define REC_LEN(p)         (((size_t)(p)[5] << 8) | (p)[6])
+#define REC_BYTES(p)       (REC_HDR_BYTES + REC_LEN(p))
+#define LONG_PART_MIN      64   // don't start a long record part on less room
+#define REC_TS(p)          (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (p)[3])
+
+// Head/tail of the ring; guarded by log_mutex
+static SemaphoreHandle_t log_mutex = NULL;
+static uint32_t sectors_used = 0;  // sectors holding a valid header
+static uint32_t head_sector = 0;   // sector being appended to
+static uint32_t head_seq = 0;
+static uint32_t head_off = 0;      // next free byte in head sector
+static bool head_open = false;     // head has a header and isn't sealed
+static uint32_t tail_sector = 0;   // oldest sector
+static uint32_t tail_seq = 0;
+static uint32_t fresh_sector = 0;  // where the next sector opens when the log is empty
+static uint32_t erased_ahead = 0;  // ready sectors right after the head (or from fresh_sector)
+// As a typed constant: built with 0, "erased_ahead < 0" would trip -Wtype-limits
+static const uint32_t preerase_sectors = STORAGE_PREERASE_SECTORS;
+static uint32_t erase_on_demand = 0;
+static uint32_t erase_counts[LOG_SECTORS];
+static uint32_t flush_us_max = 0;
+static uint32_t flush_us_last = 0;
+static uint32_t flush_bytes_last = 0;
+static uint32_t flush_bytes_max = 0;
+static uint32_t flush_bytes_total = 0;
+static uint32_t bytes_in = 0;       // raw record bytes flushed
+static uint32_t bytes_coded = 0;    // what they took on flash
+static uint32_t batches_corrupt = 0; // CRC failures found by recovery and scans
+static record_codec_block_t enc_block;
+// Batches are coded (header first) into one buffer while the other may
+// still be programming; enc_ticket is the last async write from each
+static uint8_t enc_buf[2][LOG_BATCH_HDR + LOG_SECTOR_PAYLOAD];
+static uint32_t enc_ticket[2] = { 0, 0 };
+static uint8_t enc_cur = 0;
+static const uint8_t batch_commit = LOG_BATCH_COMMIT;
+static volatile bool write_failed = false;   // set from the flash writer task
+
+static inline uint32_t sector_addr(uint32_t i) {
+  return FLASH_LOG_BASE + i * LOG_SECTOR_BYTES;
+}
+
+static bool read_hdr(uint32_t i, log_sector_hdr_t *h) {
+  if (!flash_read(sector_addr(i), (uint8_t *)h, sizeof(*h))) return false;
+  return h->magic == LOG_MAGIC && h->hdr_commit == LOG_HDR_COMMIT && h->version == LOG_VERSION;
+}
+
+/* Erase count from a header or a free-sector stamp; 0 if never written */
+static inline uint32_t hdr_erase_count(const log_sector_hdr_t *h) {
+  if (h->magic != LOG_MAGIC || h->version != LOG_VERSION || h->erase_count == 0xFFFFFFFFu) return 0;
+  return h->erase_count;
+}
+
+static bool erase_log_sector(uint32_t i) {
+  erase_counts[i]++;
+  return flash_erase_sector(sector_addr(i) / FLASH_SECTOR_SIZE);
+}
+
+/* Leave magic + erase_count in a freshly erased sector, hdr_commit unset */
+static void stamp_sector(uint32_t i) {
+  log_sector_hdr_t h;
+  memset(&h, 0xFF, sizeof(h));
+  h.magic = LOG_MAGIC;
+  h.erase_count = erase_counts[i];
+  h.version = LOG_VERSION;
+  flash_write(sector_addr(i), (const uint8_t *)&h, offsetof(log_sector_hdr_t, hdr_commit));
+}
+
+/* True if sector i is erased, apart from at most a stamp, so a header can
+ * be programmed straight over it */
+static bool sector_ready(uint32_t i) {
+  log_sector_hdr_t h;
+  flash_read(sector_addr(i), (uint8_t *)&h, sizeof(h));
+  bool stamp = h.magic == LOG_MAGIC && h.version == LOG_VERSION;
+  bool blank = h.magic == 0xFFFFFFFFu && h.version == 0xFFFF && h.erase_count == 0xFFFFFFFFu;
+  if (!(stamp || blank) || h.seq != 0xFFFFFFFFu || h.base_ts != 0xFFFFFFFFu ||
+      h.hdr_commit != 0xFFFF || h.used != 0xFFFF || h.seal_commit != 0xFFFF) return false;
+  uint8_t buf[256];
+  for (uint32_t off = LOG_HDR_BYTES; off < LOG_SECTOR_BYTES; off += sizeof(buf)) {
+    uint32_t n = LOG_SECTOR_BYTES - off < sizeof(buf) ? LOG_SECTOR_BYTES - off : sizeof(buf);
+    flash_read(sector_addr(i) + off, buf, n);
+    for (uint32_t k = 0; k < n; ++k) if (buf[k] != 0xFF) return false;
+  }
+  return true;
+}
+
+/* Drop the oldest sector from the ring */
+static void evict_tail_locked(void) {
+  sectors_used--;
+  tail_sector = (tail_sector + 1) % LOG_SECTORS;
+  tail_seq++;
+}
+
+static inline bool hdr_sealed(const log_sector_hdr_t *h) {
+  return h->seal_commit == LOG_SEAL_COMMIT && h->used <= LOG_SECTOR_PAYLOAD;
+}
+
+/* Walk the committed batches of the sector at flash address sec. Returns
+ * the offset of the first free byte; *torn is set if a batch was started
+ * but never committed. */
+typedef enum { BATCH_OK = 0, BATCH_END, BATCH_TORN, BATCH_CORRUPT } batch_state_t;
+
+static inline uint32_t batch_crc_start(const uint8_t *bh) {
+  uint32_t crc = crc32_update(0, bh, 2);         // len
+  return crc32_update(crc, bh + 4, 4);           // base_ts
+}
+
+static inline uint32_t batch_crc_stored(const uint8_t *bh) {
+  return ((uint32_t)bh[8] << 24) | ((uint32_t)bh[9] << 16) | ((uint32_t)bh[10] << 8) | bh[11];
+}
+
+/* Check the batch at off in the sector at flash address sec (ending by
+ * end). If buf is given the whole batch is read into it, otherwise the body
+ * is streamed through the CRC. *total is the batch size when the header is
+ * sound (OK or CORRUPT), so a walk can step over a damaged body. */
+static batch_state_t check_batch(uint32_t sec, uint32_t off, uint32_t end, uint8_t *buf, uint32_t *total) {
+  uint8_t bh[LOG_BATCH_HDR];
+  if (off + LOG_BATCH_HDR > end) return BATCH_END;
+  flash_read(sec + off, bh, sizeof(bh));
+  uint16_t len = (uint16_t)((bh[0] << 8) | bh[1]);
+  if (len == 0xFFFF && bh[2] == 0xFF) return BATCH_END;   // erased: end of log
+  if (bh[2] != LOG_BATCH_COMMIT || len == 0 || off + LOG_BATCH_HDR + len > end) return BATCH_TORN;
+  *total = LOG_BATCH_HDR + len;
+
+  uint32_t crc = batch_crc_start(bh);
+  uint32_t body = sec + off + LOG_BATCH_HDR;
+  if (buf) {
+    flash_read(sec + off, buf, *total);
+    crc = crc32_update(crc, buf + LOG_BATCH_HDR, len);
+  } else {
+    uint8_t chunk[256];
+    for (uint32_t done = 0; done < len; ) {
+      uint32_t n = len - done > sizeof(chunk) ? sizeof(chunk) : len - done;
+      flash_read(body + done, chunk, n);
+      crc = crc32_update(crc, chunk, n);
+      done += n;
+    }
+  }
+  return crc == batch_crc_stored(bh) ? BATCH_OK : BATCH_CORRUPT;
+}
+
+static uint32_t walk_batches(uint32_t sec, bool *torn) {
+  uint32_t off = LOG_HDR_BYTES;
+  *torn = false;
+  for (;;) {
+    uint32_t total;
+    batch_state_t st = check_batch(sec, off, LOG_SECTOR_BYTES, NULL, &total);
+    if (st == BATCH_END) break;
+    if (st == BATCH_TORN) {
+      *torn = true;
+      break;
+    }
+    if (st == BATCH_CORRUPT) batches_corrupt++;
+    off += total;
+  }
+  return off;
+}
+
+/* Program the used/seal fields of the head sector; it takes no more batches */
+static void seal_head_locked(void) {
+  if (!head_open) return;
+  uint8_t seal[4];
+  uint16_t used = (uint16_t)(head_off - LOG_HDR_BYTES);
+  memcpy(seal, &used, 2);
+  uint16_t c = LOG_SEAL_COMMIT;
+  memcpy(seal + 2, &c, 2);
+  flash_write(sector_addr(head_sector) + offsetof(log_sector_hdr_t, used), seal, sizeof(seal));
+  head_open = false;
+}
+
+static void sum_catch_up_locked(void);
+
+/* Write the header of the sector after head. Uses a pre-erased sector if
+ * there is one; otherwise erases on demand, overwriting the oldest sector
+ * once the ring is full. */
+static bool open_next_sector_locked(void) {
+  seal_head_locked();
+  uint32_t next = sectors_used ? (head_sector + 1) % LOG_SECTORS : fresh_sector;
+  uint32_t seq = sectors_used ? head_seq + 1 : tail_seq;
+
+  if (erased_ahead > 0) {
+    erased_ahead--;
+    if (preerase_task_handle) xTaskNotifyGive(preerase_task_handle);
+  } else {
+    // Ring full: next is the tail (summarized first); the one after it becomes the oldest
+    if (sectors_used == LOG_SECTORS) {
+      sum_catch_up_locked();
+      evict_tail_locked();
+    }
+    // A never-used or erase_all-stamped sector takes the header as it is
+    if (!sector_ready(next)) {
+      erase_on_demand++;
+      if (!erase_log_sector(next)) return false;
+    }
+  }
+
+  log_sector_hdr_t h;
+  memset(&h, 0xFF, sizeof(h));
+  h.magic = LOG_MAGIC;
+  h.seq = seq;
+  h.base_ts = (uint32_t)millis();
+  h.erase_count = erase_counts[next];
+  h.version = LOG_VERSION;
+  // Header fields first, commit second: a cut in between leaves a free sector
+  if (!flash_write(sector_addr(next), (const uint8_t *)&h, offsetof(log_sector_hdr_t, hdr_commit))) return false;
+  uint16_t c = LOG_HDR_COMMIT;
+  if (!flash_write(sector_addr(next) + offsetof(log_sector_hdr_t, hdr_commit), (const uint8_t *)&c, 2)) return false;
+
+  if (sectors_used == 0) {
+    tail_sector = next;
+    tail_seq = seq;
+  }
+  sectors_used++;
+  head_sector = next;
+  head_seq = seq;
+  head_off = LOG_HDR_BYTES;
+  head_open = true;
+  return true;
+}
+
+/* ---- Upload ack cursor ----
+ * Kept in the META_SECTORS after the log region as 8-byte slots
+ * [seq u32][off u16][commit u16], appended in order; the highest committed
+ * slot wins at boot. Loaded before recovery so an empty log can number its
+ * sectors after the cursor. */
+#define META_BASE         FLASH_META_BASE
+#define META_SECTORS      FLASH_META_SECTORS
+#define META_SLOT_BYTES   8
+#define META_SLOTS        (LOG_SECTOR_BYTES / META_SLOT_BYTES)
+#define META_COMMIT       0xAC5Eu
+
+// Cursor and meta slots; guarded by log_mutex
+static bool cursor_valid = false;
+static uint32_t cursor_seq = 0;
+static uint32_t cursor_off = 0;
+static uint32_t meta_sector = 0;
+static uint32_t meta_slot = 0;     // next free slot in meta_sector
+
+static inline bool pos_after(uint32_t s1, uint32_t o1, uint32_t s2, uint32_t o2) {
+  return s1 > s2 || (s1 == s2 && o1 > o2);
+}
+
+static inline uint32_t be32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void put_be32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+/* Find the highest committed cursor slot and the next free slot */
+static void meta_load_locked(void) {
+  uint32_t used[META_SECTORS] = { 0, 0 };
+  uint8_t buf[256];
+  cursor_valid = false;
+  meta_sector = 0;
+  for (uint32_t m = 0; m < META_SECTORS; ++m) {
+    bool blank = false;
+    for (uint32_t i = 0; i < META_SLOTS && !blank; i += sizeof(buf) / META_SLOT_BYTES) {
+      flash_read(META_BASE + m * LOG_SECTOR_BYTES + i * META_SLOT_BYTES, buf, sizeof(buf));
+      for (uint32_t k = 0; k < sizeof(buf) / META_SLOT_BYTES; ++k) {
+        const uint8_t *sl = buf + k * META_SLOT_BYTES;
+        uint32_t seq, commit_off;
+        uint16_t off, commit;
+        memcpy(&seq, sl, 4);
+        memcpy(&off, sl + 4, 2);
+        memcpy(&commit, sl + 6, 2);
+        memcpy(&commit_off, sl + 4, 4);
+        if (seq == 0xFFFFFFFFu && commit_off == 0xFFFFFFFFu) { blank = true; break; }  // slots fill in order
+        used[m] = i + k + 1;
+        if (commit != META_COMMIT) continue;   // torn write
+        if (!cursor_valid || pos_after(seq, off, cursor_seq, cursor_off)) {
+          cursor_valid = true;
+          cursor_seq = seq;
+          cursor_off = off;
+          meta_sector = m;
+        }
       }
     }
-    addr += read_len;
   }
-  //Serial.printf("[STOR] find_write_ptr => 0x%08X\n", (unsigned)flash_write_ptr);
-  // full — wrap to base (we'll erase when writing)
-  return FLASH_LOG_BASE;
+  meta_slot = used[meta_sector];
+}
 
+/* Append a cursor slot; switches to (and erases) the other meta sector
+ * when this one is full. The old sector keeps the last cursor until the
+ * new slot is committed. */
+static bool meta_write_locked(uint32_t seq, uint32_t off) {
+  if (meta_slot >= META_SLOTS) {
+    uint32_t other = (meta_sector + 1) % META_SECTORS;
+    if (!flash_erase_sector((META_BASE + other * LOG_SECTOR_BYTES) / FLASH_SECTOR_SIZE)) return false;
+    meta_sector = other;
+    meta_slot = 0;
+  }
+  uint32_t addr = META_BASE + meta_sector * LOG_SECTOR_BYTES + meta_slot * META_SLOT_BYTES;
+  uint8_t sl[6];
+  uint16_t off16 = (uint16_t)off;
+  memcpy(sl, &seq, 4);
+  memcpy(sl + 4, &off16, 2);
+  meta_slot++;
+  if (!flash_write(addr, sl, sizeof(sl))) return false;
+  uint16_t c = META_COMMIT;
+  return flash_write(addr + 6, (const uint8_t *)&c, 2);
 }
 
-// Erase whole log region (simple; erases sectors from base to base+MAX)
-static bool erase_log_region() {
-  uint32_t sectors = (FLASH_LOG_MAX_BYTES + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE;
-  for (uint32_t i = 0; i < sectors; ++i) {
-    uint32_t sec_idx = (FLASH_LOG_BASE / FLASH_SECTOR_SIZE) + i;
-    if (!flash_erase_sector(sec_idx)) {
-      // try again? for demo just fail
-      return false;
+/* ---- Tiered retention ----
+ * Before the tail sector is reclaimed (by the pre-erase task, or a flush
+ * erasing on demand) its records are compacted into per-minute summaries,
+ * one entry per sensor and minute of device millis:
+ *   [sensor u8][codec u8][mask u8][bins u8][minute u32 BE][count u16 BE]
+ *   + min, max, mean of each value in mask, in the codec's value width and
+ *     byte order (RAW and long records have no values: count only)
+ *   + bins x u16 BE histogram counts (storage_set_summary)
+ * A sector's entries form one batch (more if they pass SUM_BATCH_BYTES) in
+ * a second ring of STORAGE_SUMMARY_SECTORS with the log's sector header
+ * (magic "SSUM", never sealed) and batch format. There base_ts holds the
+ * seq of the log sector summarized: in the batch header for its entries,
+ * in the sector header for the batch that opened it. A minute spanning two
+ * log sectors gets an entry from each; readers merge them. When the ring
+ * is full its oldest sector is erased.
+ * Compaction decodes one log batch per call, so a pre-erase tick costs at
+ * most one batch. Recovery resumes after the last summarized sector; a
+ * power cut mid-sector only repeats that sector's decode. */
+#define SUM_BASE          FLASH_SUMMARY_BASE
+#define SUM_SECTORS       STORAGE_SUMMARY_SECTORS
+#define SUM_MAGIC         0x5353554Du      // "SSUM"
+#define SUM_ENTRY_HDR     10
+#define SUM_BATCH_BYTES   1024
+#define SUM_MINUTE_MS     60000u
+
+typedef struct {
+  uint32_t minute;
+  uint16_t count;                        // records; 0 = nothing gathered
+  uint8_t codec;                         // of the minute's first record
+  uint8_t n_values;
+  uint16_t n[RECORD_CODEC_MAX_VALUES];   // finite samples per value
+  float lo[RECORD_CODEC_MAX_VALUES];
+  float hi[RECORD_CODEC_MAX_VALUES];
+  float sum[RECORD_CODEC_MAX_VALUES];
+  uint16_t bins[STORAGE_SUMMARY_MAX_BINS];
+} sum_acc_t;
+
+typedef struct {
+  bool set;             // else every value, no histogram
+  uint8_t mask;
+  uint8_t bins;
+  storage_bin_cb bin;
+  void *ctx;
+} sum_cfg_t;
+
+static const uint8_t value_width[RECORD_CODEC_COUNT] = { 1, 1, 2, 4, 4 };
+
+// Summary ring and compaction state; guarded by log_mutex
+static sum_cfg_t sum_cfg[STORAGE_MAX_SENSORS];
+static sum_acc_t sum_acc[STORAGE_MAX_SENSORS];
+static uint32_t sum_used = 0;       // summary sectors holding a header
+static uint32_t sum_head = 0;
+static uint32_t sum_head_seq = 0;
+static uint32_t sum_head_off = 0;
+static bool sum_open = false;       // head takes more batches
+static uint32_t sum_tail = 0;
+static uint32_t sum_tail_seq = 0;
+static uint32_t sum_fresh = 0;      // where the ring restarts when empty
+static uint32_t sum_src_seq = 0;    // log sector being summarized
+static uint32_t sum_src_off = 0;    // next batch in it, 0 = not started
+static uint32_t sum_summarized = 0;
+static uint32_t sum_skipped = 0;
+static record_codec_block_t sum_block;
+static uint8_t sum_in[LOG_BATCH_HDR + LOG_SECTOR_PAYLOAD];
+static uint8_t sum_out[LOG_BATCH_HDR + SUM_BATCH_BYTES];
+static size_t sum_out_len = 0;      // entry bytes after the batch header
+static uint8_t sum_payload[RECORD_CODEC_SHORT_MAX];
+
+static inline uint32_t sum_addr(uint32_t i) {
+  return SUM_BASE + i * LOG_SECTOR_BYTES;
+}
+
+static float get_value(record_codec_t c, const uint8_t *p) {
+  uint32_t u;
+  float f;
+  switch (c) {
+    case RECORD_CODEC_U8_DELTA:    return (float)p[0];
+    case RECORD_CODEC_I16BE_DELTA: return (float)(int16_t)((p[0] << 8) | p[1]);
+    case RECORD_CODEC_F32BE_XOR:   u = be32(p); memcpy(&f, &u, 4); return f;
+    default:                       memcpy(&f, p, 4); return f;
+  }
+}
+
+static void put_value(record_codec_t c, uint8_t *p, float v) {
+  uint32_t u;
+  switch (c) {
+    case RECORD_CODEC_U8_DELTA:
+      p[0] = (uint8_t)lroundf(v < 0 ? 0 : v > 255 ? 255 : v);
+      break;
+    case RECORD_CODEC_I16BE_DELTA: {
+      int16_t i = (int16_t)lroundf(v < -32768 ? -32768 : v > 32767 ? 32767 : v);
+      p[0] = (uint8_t)((uint16_t)i >> 8);
+      p[1] = (uint8_t)i;
+      break;
+    }
+    case RECORD_CODEC_F32BE_XOR:
+      memcpy(&u, &v, 4);
+      put_be32(p, u);
+      break;
+    default:
+      memcpy(p, &v, 4);
+      break;
+  }
+}
+
+/* Find head/tail of the summary ring and where compaction left off */
+static void sum_recover_locked(void) {
+  sum_used = 0;
+  sum_open = false;
+  sum_src_seq = 0;
+  uint32_t head_src = 0;
+  for (uint32_t i = 0; i < SUM_SECTORS; ++i) {
+    log_sector_hdr_t h;
+    flash_read(sum_addr(i), (uint8_t *)&h, sizeof(h));
+    if (h.magic != SUM_MAGIC || h.hdr_commit != LOG_HDR_COMMIT || h.version != LOG_VERSION) continue;
+    if (sum_used == 0 || h.seq > sum_head_seq) {
+      sum_head = i;
+      sum_head_seq = h.seq;
+      head_src = h.base_ts;
+    }
+    if (sum_used == 0 || h.seq < sum_tail_seq) {
+      sum_tail = i;
+      sum_tail_seq = h.seq;
+    }
+    sum_used++;
+  }
+  if (!sum_used) {
+    sum_fresh = 0;
+    sum_tail_seq = 0;
+    return;
+  }
+  // The last committed batch names the last sector summarized
+  uint32_t off = LOG_HDR_BYTES, total;
+  sum_src_seq = head_src;
+  for (;;) {
+    batch_state_t st = check_batch(sum_addr(sum_head), off, LOG_SECTOR_BYTES, NULL, &total);
+    if (st == BATCH_END || st == BATCH_TORN) {
+      sum_open = st == BATCH_END;
+      break;
     }
+    uint8_t bh[LOG_BATCH_HDR];
+    flash_read(sum_addr(sum_head) + off, bh, sizeof(bh));
+    sum_src_seq = be32(bh + 4) + 1;
+    off += total;
   }
+  sum_head_off = off;
+}
+
+/* Next summary sector, erasing the oldest once the ring is full. Its
+ * erase count carries over from the old header, best effort. */
+static bool sum_open_next_locked(uint32_t src) {
+  uint32_t next = sum_used ? (sum_head + 1) % SUM_SECTORS : sum_fresh;
+  uint32_t seq = sum_used ? sum_head_seq + 1 : sum_tail_seq;
+  if (sum_used == SUM_SECTORS) {
+    sum_used--;
+    sum_tail = (sum_tail + 1) % SUM_SECTORS;
+    sum_tail_seq++;
+  }
+  log_sector_hdr_t h;
+  flash_read(sum_addr(next), (uint8_t *)&h, sizeof(h));
+  uint32_t erases = (h.magic == SUM_MAGIC && h.erase_count != 0xFFFFFFFFu) ? h.erase_count + 1 : 1;
+  sum_open = false;
+  if (!flash_erase_sector(sum_addr(next) / FLASH_SECTOR_SIZE)) return false;
+
+  memset(&h, 0xFF, sizeof(h));
+  h.magic = SUM_MAGIC;
+  h.seq = seq;
+  h.base_ts = src;
+  h.erase_count = erases;
+  h.version = LOG_VERSION;
+  if (!flash_write(sum_addr(next), (const uint8_t *)&h, offsetof(log_sector_hdr_t, hdr_commit))) return false;
+  uint16_t c = LOG_HDR_COMMIT;
+  if (!flash_write(sum_addr(next) + offsetof(log_sector_hdr_t, hdr_commit), (const uint8_t *)&c, 2)) return false;
+
+  if (sum_used == 0) {
+    sum_tail = next;
+    sum_tail_seq = seq;
+  }
+  sum_used++;
+  sum_head = next;
+  sum_head_seq = seq;
+  sum_head_off = LOG_HDR_BYTES;
+  sum_open = true;
   return true;
 }
 
-// Append bytes to RAM buffer (internal, caller should hold mutex)
-static void ram_append_locked(const uint8_t *src, size_t len) {
-  if (!src || len == 0) return;
-  // If not enough space, drop oldest data to make room (simple policy)
-  if (ram_len + len > ram_capacity) {
-    size_t keep = ram_capacity - len;
-    if (keep > 0) {
-      memmove(ram_buf, ram_buf + (ram_len - keep), keep);
-      ram_len = keep;
-    } else {
-      // new len larger than capacity -- drop everything and only keep last portion
-      ram_len = 0;
+/* Write the gathered entries as one batch for log sector src */
+static void sum_write_locked(uint32_t src) {
+  if (!sum_out_len) return;
+  size_t n = sum_out_len;
+  sum_out_len = 0;
+  if (!sum_open || sum_head_off + LOG_BATCH_HDR + n > LOG_SECTOR_BYTES) {
+    if (!sum_open_next_locked(src)) return;
+  }
+  uint8_t *bh = sum_out;
+  bh[0] = (uint8_t)(n >> 8);
+  bh[1] = (uint8_t)n;
+  bh[2] = bh[3] = 0xFF;
+  put_be32(bh + 4, src);
+  uint32_t crc = crc32_update(batch_crc_start(bh), sum_out + LOG_BATCH_HDR, n);
+  put_be32(bh + 8, crc);
+  uint32_t at = sum_addr(sum_head) + sum_head_off;
+  if (!flash_write(at, sum_out, LOG_BATCH_HDR + n) || !flash_write(at + 2, &batch_commit, 1)) {
+    sum_open = false;   // like a torn batch: the next one opens a new sector
+    return;
+  }
+  sum_head_off += (uint32_t)(LOG_BATCH_HDR + n);
+}
+
+/* Turn sensor idx's gathered minute into an entry */
+static void sum_emit_locked(uint8_t idx, uint32_t src) {
+  sum_acc_t *a = &sum_acc[idx];
+  const sum_cfg_t *cfg = &sum_cfg[idx];
+  uint8_t mask = (cfg->set ? cfg->mask : 0xFF) & (uint8_t)((1u << a->n_values) - 1);
+  uint8_t bins = cfg->set && cfg->bin ? cfg->bins : 0;
+  uint8_t w = a->n_values ? value_width[a->codec] : 0;
+  size_t need = SUM_ENTRY_HDR + 2u * bins;
+  for (uint8_t i = 0; i < a->n_values; ++i) if (mask & (1u << i)) need += 3u * w;
+  if (sum_out_len + need > SUM_BATCH_BYTES) sum_write_locked(src);
+
+  uint8_t *e = sum_out + LOG_BATCH_HDR + sum_out_len;
+  e[0] = idx;
+  e[1] = a->codec;
+  e[2] = mask;
+  e[3] = bins;
+  put_be32(e + 4, a->minute);
+  e[8] = (uint8_t)(a->count >> 8);
+  e[9] = (uint8_t)a->count;
+  uint8_t *p = e + SUM_ENTRY_HDR;
+  for (uint8_t i = 0; i < a->n_values; ++i) {
+    if (!(mask & (1u << i))) continue;
+    record_codec_t c = (record_codec_t)a->codec;
+    float mean = a->n[i] ? a->sum[i] / a->n[i] : NAN;
+    put_value(c, p, a->n[i] ? a->lo[i] : NAN);
+    put_value(c, p + w, a->n[i] ? a->hi[i] : NAN);
+    put_value(c, p + 2 * w, mean);
+    p += 3 * w;
+  }
+  for (uint8_t b = 0; b < bins; ++b) {
+    p[0] = (uint8_t)(a->bins[b] >> 8);
+    p[1] = (uint8_t)a->bins[b];
+    p += 2;
+  }
+  sum_out_len += need;
+  a->count = 0;
+}
+
+/* Add one record (payload NULL for a long one) to its sensor's minute */
+static void sum_add_locked(uint8_t idx, uint8_t codec, uint32_t ts, const uint8_t *payload, uint8_t len,
+                           uint32_t src) {
+  if (idx >= STORAGE_MAX_SENSORS) return;
+  sum_acc_t *a = &sum_acc[idx];
+  uint8_t nv = 0;
+  if (payload && codec != RECORD_CODEC_RAW && codec < RECORD_CODEC_COUNT) nv = len / value_width[codec];
+  uint32_t minute = ts / SUM_MINUTE_MS;
+  if (a->count && (a->minute != minute || a->codec != codec || a->n_values != nv || a->count == 0xFFFF)) {
+    sum_emit_locked(idx, src);
+  }
+  if (!a->count) {
+    memset(a, 0, sizeof(*a));
+    a->minute = minute;
+    a->codec = codec;
+    a->n_values = nv;
+    for (uint8_t i = 0; i < nv; ++i) {
+      a->lo[i] = INFINITY;
+      a->hi[i] = -INFINITY;
     }
   }
-  memcpy(ram_buf + ram_len, src, len);
-  ram_len += len;
+  a->count++;
+  for (uint8_t i = 0; i < nv; ++i) {
+    float v = get_value((record_codec_t)codec, payload + i * value_width[codec]);
+    if (!isfinite(v)) continue;
+    if (v < a->lo[i]) a->lo[i] = v;
+    if (v > a->hi[i]) a->hi[i] = v;
+    a->sum[i] += v;
+    a->n[i]++;
+  }
+  const sum_cfg_t *cfg = &sum_cfg[idx];
+  if (payload && cfg->set && cfg->bin) {
+    uint8_t b = cfg->bin(payload, len, cfg->ctx);
+    if (b < cfg->bins && a->bins[b] < 0xFFFF) a->bins[b]++;
+  }
 }
 
-// Public API: append record [4-byte ts][1-byte sensor_idx][1-byte len][payload]
-void storage_append_record(uint8_t sensor_idx, const sensor_data_t *d) {
-  if (!d || d->len == 0) return;
-  if (!ram_mutex) return;
-  if (!flash_initialized) {
-    // try to initialize flash if not ready
-    flash_initialized = flash_init();
-    if (!flash_initialized) return;
-    flash_write_ptr = find_write_ptr();
+/* One step of compacting the oldest unsummarized log sector: decode its
+ * next batch into the per-sensor minutes, or, past its last batch, write
+ * its entries and move on. Never called on the head. */
+static void sum_step_locked(void) {
+  if (sum_src_seq < tail_seq) {
+    // Evicted before it could be summarized (erase_all, log from older firmware)
+    sum_skipped += tail_seq - sum_src_seq;
+    sum_src_seq = tail_seq;
+    sum_src_off = 0;
+  }
+  if (!sum_src_off) {
+    for (uint8_t i = 0; i < STORAGE_MAX_SENSORS; ++i) sum_acc[i].count = 0;
+    sum_out_len = 0;
+    sum_src_off = LOG_HDR_BYTES;
+  }
+  uint32_t sec = (tail_sector + (sum_src_seq - tail_seq)) % LOG_SECTORS;
+  uint32_t total;
+  batch_state_t st = check_batch(sector_addr(sec), sum_src_off, LOG_SECTOR_BYTES, sum_in, &total);
+  if (st == BATCH_OK || st == BATCH_CORRUPT) {
+    sum_src_off += total;
+    if (st == BATCH_CORRUPT) return;   // nothing in it can be trusted
+    const uint8_t *in = sum_in + LOG_BATCH_HDR;
+    size_t n = total - LOG_BATCH_HDR;
+    record_codec_block_begin(&sum_block, be32(sum_in + 4));
+    for (size_t pos = 0; pos < n; ) {
+      size_t k;
+      if (record_codec_is_long(in[pos])) {
+        record_codec_part_t part;
+        k = record_codec_decode_part(&sum_block, in + pos, n - pos, &part);
+        if (k && part.off == 0) sum_add_locked(part.sensor_idx, RECORD_CODEC_TAG_LONG, part.ts, NULL, 0, sum_src_seq);
+      } else {
+        uint8_t idx, len;
+        uint32_t ts;
+        k = record_codec_decode(&sum_block, in + pos, n - pos, &idx, &ts, sum_payload, &len);
+        if (k) sum_add_locked(idx, in[pos] >> 5, ts, sum_payload, len, sum_src_seq);
+      }
+      if (!k) break;
+      pos += k;
+    }
+    return;
   }
+  // Past the last batch: the sector's minutes go out as they are
+  for (uint8_t i = 0; i < STORAGE_MAX_SENSORS; ++i) {
+    if (sum_acc[i].count) sum_emit_locked(i, sum_src_seq);
+  }
+  sum_write_locked(sum_src_seq);
+  sum_summarized++;
+  sum_src_seq++;
+  sum_src_off = 0;
+}
 
-  xSemaphoreTake(ram_mutex, portMAX_DELAY);
+/* Summarize the tail now, before an on-demand eviction */
+static void sum_catch_up_locked(void) {
+  while (sectors_used > 1 && sum_src_seq <= tail_seq) sum_step_locked();
+}
 
-  uint8_t hdr[6];
-  uint32_t ts = (uint32_t)millis();
+/* Rebuild head/tail from the sector headers */
+static void log_recover_locked(void) {
+  sectors_used = 0;
+  head_open = false;
+  erased_ahead = 0;   // the pre-erase task re-checks what is ready
+  bool head_sealed = true;
+  uint32_t least_worn = 0;
+  for (uint32_t i = 0; i < LOG_SECTORS; ++i) {
+    log_sector_hdr_t h;
+    bool valid = read_hdr(i, &h);
+    erase_counts[i] = hdr_erase_count(&h);
+    if (erase_counts[i] < erase_counts[least_worn]) least_worn = i;
+    if (!valid) continue;
+    if (sectors_used == 0 || h.seq > head_seq) {
+      head_sector = i;
+      head_seq = h.seq;
+      head_sealed = hdr_sealed(&h);
+      head_off = LOG_HDR_BYTES + (head_sealed ? h.used : 0);
+    }
+    if (sectors_used == 0 || h.seq < tail_seq) {
+      tail_sector = i;
+      tail_seq = h.seq;
+    }
+    sectors_used++;
+  }
+  if (sectors_used == 0) {
+    // Keep sequence numbers past the upload cursor so new data counts as unsent
+    tail_seq = cursor_valid ? cursor_seq + 1 : 0;
+    fresh_sector = least_worn;
+    return;
+  }
+  if (!head_sealed) {
+    bool torn;
+    head_off = walk_batches(sector_addr(head_sector), &torn);
+    head_open = true;
+    // Power cut mid-batch: keep what was committed and move on
+    if (torn || head_off + LOG_BATCH_HDR + RECORD_CODEC_MAX_BYTES(0) > LOG_SECTOR_BYTES) seal_head_locked();
+  }
+}
+
+static void batch_written(void *ctx, bool ok) {
+  (void)ctx;
+  if (!ok) write_failed = true;
+}
+
+/* Coded bytes a record needs in the head sector before starting there:
+ * a short record whole, a long one a part header and its first bytes */
+static size_t rec_min_bytes(const uint8_t *rec, size_t part_off) {
+  size_t len = REC_LEN(rec);
+  if (len <= RECORD_CODEC_SHORT_MAX) return RECORD_CODEC_MAX_BYTES(len);
+  size_t left = len - part_off;
+  return RECORD_CODEC_LONG_HDR_MAX + (left < LONG_PART_MIN ? left : LONG_PART_MIN);
+}
+
+/* Code raw RAM records (concatenated) into batches, one per sector. The
+ * batches are queued as async writes (body, then the commit byte) and
+ * program in the background; any synchronous flash call waits for them.
+ * A long record that doesn't fit the rest of a sector is split, and its
+ * next part opens the next batch. */
+static bool log_append_locked(const uint8_t *data, size_t len) {
+  size_t pos = 0;
+  size_t part_off = 0;   // bytes of the long record at pos already coded
+  while (pos < len) {
+    const uint8_t *rec = data + pos;
+    if (!head_open || head_off + LOG_BATCH_HDR + rec_min_bytes(rec, part_off) > LOG_SECTOR_BYTES) {
+      if (!open_next_sector_locked()) return false;
+    }
+    // As many records as code into the head sector
+    size_t room = LOG_SECTOR_BYTES - head_off - LOG_BATCH_HDR;
+    uint32_t base_ts = REC_TS(rec);
+    uint8_t k = enc_cur;
+    enc_cur ^= 1;
+    flash_wait(enc_ticket[k]);   // its last batch is still programming
+    uint8_t *out = enc_buf[k];
+    record_codec_block_begin(&enc_block, base_ts);
+    size_t n = 0;
+    while (pos < len) {
+      rec = data + pos;
+      uint8_t idx = rec[4];
+      size_t rlen = REC_LEN(rec);
+      if (rlen > RECORD_CODEC_SHORT_MAX) {
+        size_t left = rlen - part_off;
+        size_t fit = room - n > RECORD_CODEC_LONG_HDR_MAX ? room - n - RECORD_CODEC_LONG_HDR_MAX : 0;
+        if (fit < left && fit < LONG_PART_MIN) break;
+        size_t part = left < fit ? left : fit;
+        size_t coded = record_codec_encode_part(&enc_block, idx, REC_TS(rec), rec + REC_HDR_BYTES,
+                                                (uint16_t)rlen, (uint16_t)part_off, (uint16_t)part,
+                                                out + LOG_BATCH_HDR + n, room - n);
+        if (coded == 0) break;
+        n += coded;
+        bytes_coded += (uint32_t)coded;
+        part_off += part;
+        if (part_off < rlen) break;   // the rest goes in the next sector
+        part_off = 0;
+        pos += REC_BYTES(rec);
+        bytes_in += (uint32_t)REC_BYTES(rec);
+        continue;
+      }
+      record_codec_t c = idx < STORAGE_MAX_SENSORS ? (record_codec_t)rec_codec[idx] : RECORD_CODEC_RAW;
+      size_t coded = record_codec_encode(&enc_block, c, idx, REC_TS(rec), rec + REC_HDR_BYTES, (uint8_t)rlen,
+                                         out + LOG_BATCH_HDR + n, room - n);
+      if (coded == 0) break;
+      n += coded;
+      pos += REC_BYTES(rec);
+      bytes_in += (uint32_t)REC_BYTES(rec);
+      bytes_coded += (uint32_t)coded;
+    }
+
+    uint32_t at = sector_addr(head_sector) + head_off;
+    uint8_t bh[LOG_BATCH_HDR] = { (uint8_t)(n >> 8), (uint8_t)n, 0xFF, 0xFF,
+                                  (uint8_t)(base_ts >> 24), (uint8_t)(base_ts >> 16),
+                                  (uint8_t)(base_ts >> 8), (uint8_t)base_ts };
+    uint32_t crc = crc32_update(batch_crc_start(bh), out + LOG_BATCH_HDR, n);
+    bh[8] = (uint8_t)(crc >> 24);
+    bh[9] = (uint8_t)(crc >> 16);
+    bh[10] = (uint8_t)(crc >> 8);
+    bh[11] = (uint8_t)crc;
+    memcpy(out, bh, sizeof(bh));
+    if (!flash_write_async(at, out, LOG_BATCH_HDR + n, batch_written, NULL)) return false;
+    enc_ticket[k] = flash_write_async(at + 2, &batch_commit, 1, batch_written, NULL);
+    if (!enc_ticket[k]) return false;
+
+    head_off += (uint32_t)(LOG_BATCH_HDR + n);
+  }
+  return true;
+}
+
+/* Erase the sectors holding data and stamp their erase counts back.
+ * Sectors that are already free are left alone. */
+static bool erase_log_region() {
+  for (uint32_t n = 0; n < sectors_used; ++n) {
+    uint32_t i = (tail_sector + n) % LOG_SECTORS;
+    if (!erase_log_sector(i)) return false;
+    stamp_sector(i);
+  }
+  return true;
+}
+
+/* Bring flash up on first use and recover the log */
+static bool log_ready(void) {
+  if (flash_initialized) return true;
+  if (!flash_init()) return false;
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  meta_load_locked();
+  log_recover_locked();
+  sum_recover_locked();
+  // Summaries from a log that is gone (or wiped) don't hold anything back
+  if (!sectors_used || sum_src_seq < tail_seq || sum_src_seq > head_seq + 1) sum_src_seq = tail_seq;
+  xSemaphoreGive(log_mutex);
+  flash_initialized = true;
+  return true;
+}
+
+// Append one whole record to the filling batch (caller holds ram_mutex).
+// Swaps batches when it doesn't fit; false means drop it, and *wake means
+// the flush task has something new to do: a batch was handed over, the
+// watermark was crossed, or an idle task has a first record to time.
+static bool ram_append_locked(uint8_t sensor_idx, const uint8_t *hdr, const uint8_t *payload,
+                              size_t plen, bool *wake) {
+  size_t len = REC_HDR_BYTES + plen;
+  if (len > ram_capacity) return false;   // never fits a batch
+  uint8_t f = fill_idx;
+  bool other_busy = ram_pending[f ^ 1];
+  if (ram_len[f] + len > ram_capacity) {
+    if (other_busy) return false;   // both full
+    ram_pending[f] = true;
+    fill_idx = f = f ^ 1;
+    flush_why |= 1u << FLUSH_FULL;
+    *wake = true;
+  } else if (other_busy && sensor_idx < STORAGE_MAX_SENSORS &&
+             drop_policy[sensor_idx] == STORAGE_DROP_EARLY &&
+             ram_len[f] + len > ram_capacity - ram_capacity / 4) {
+    return false;   // leave the last quarter to the other sensors
+  }
+  if (ram_len[f] == 0) {
+    ram_first_ms[f] = REC_TS(hdr);
+    if (flush_idle) *wake = true;   // start the max-latency clock
+  }
+  memcpy(ram_batch[f] + ram_len[f], hdr, REC_HDR_BYTES);
+  memcpy(ram_batch[f] + ram_len[f] + REC_HDR_BYTES, payload, plen);
+  size_t was = ram_len[f];
+  ram_len[f] += len;
+  if (was < ram_watermark && ram_len[f] >= ram_watermark) {
+    flush_why |= 1u << FLUSH_WATERMARK;
+    *wake = true;
+  }
+  return true;
+}
+
+// Public API: append record [4-byte ts][1-byte sensor_idx][2-byte len][payload]
+bool storage_append_record(uint8_t sensor_idx, const sensor_data_t *d) {
+  if (!d || d->len == 0 || d->len > SENSOR_DATA_BYTES) return false;
+  if (!ram_mutex || sensor_idx >= RECORD_CODEC_MAX_SENSORS) return false;
+
+  // Payloads over RECORD_CODEC_SHORT_MAX are logged as long records
+  size_t plen = d->len;
+  uint8_t hdr[REC_HDR_BYTES];
+  uint32_t ts = (uint32_t)d->timestamp;   // when it was sampled, not when a sink got to it
   hdr[0] = (uint8_t)((ts >> 24) & 0xFF);
   hdr[1] = (uint8_t)((ts >> 16) & 0xFF);
   hdr[2] = (uint8_t)((ts >> 8) & 0xFF);
   hdr[3] = (uint8_t)(ts & 0xFF);
   hdr[4] = sensor_idx;
-  hdr[5] = (uint8_t)(d->len & 0xFF);
-
-  ram_append_locked(hdr, sizeof(hdr));
-  ram_append_locked(d->bytes, d->len);
+  hdr[5] = (uint8_t)(plen >> 8);
+  hdr[6] = (uint8_t)plen;
 
+  bool wake = false;
+  xSemaphoreTake(ram_mutex, portMAX_DELAY);
+  bool ok = ram_append_locked(sensor_idx, hdr, d->bytes, plen, &wake);
+  if (sensor_idx < STORAGE_MAX_SENSORS) {
+    if (ok) rec_stats[sensor_idx].records++;
+    else rec_stats[sensor_idx].drops++;
+  }
   xSemaphoreGive(ram_mutex);
+  if (wake && flush_task_handle) xTaskNotifyGive(flush_task_handle);
 
-  // Serial.printf("[STOR] appended rec sensor=%u len=%u ram_len=%u\n",
-  //             (unsigned)sensor_idx, (unsigned)d->len, (unsigned)ram_len);
+  // Serial.printf("[STOR] appended rec sensor=%u len=%u ok=%d\n",
+  //             (unsigned)sensor_idx, (unsigned)d->len, (int)ok);
+  return ok;
 }
 
-// Flush RAM buffer to flash now
-void storage_flush_now(void) {
-  if (!flash_initialized) {
-    flash_initialized = flash_init();
-    if (!flash_initialized) {
-      // cannot access flash; drop RAM to avoid unbounded growth
-      if (ram_mutex) {
-        xSemaphoreTake(ram_mutex, portMAX_DELAY);
-        ram_len = 0;
-        xSemaphoreGive(ram_mutex);
-      }
-      return;
+// Flush RAM batches to flash now: the pending one, then whatever is filling
+static void flush_ram(flush_reason_t why) {
+  if (!ram_mutex) return;
+  if (!log_ready()) {
+    // cannot access flash; drop RAM to avoid unbounded growth
+    xSemaphoreTake(ram_mutex, portMAX_DELAY);
+    ram_len[0] = ram_len[1] = 0;
+    ram_pending[0] = ram_pending[1] = false;
+    xSemaphoreGive(ram_mutex);
+    return;
+  }
+
+  // log_mutex makes this the only flusher; appenders only need ram_mutex
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  uint32_t bytes = 0;
+  if (write_failed) {
+    // An earlier batch didn't program; leave its sector like a failed flush
+    flash_sync();
+    write_failed = false;
+    seal_head_locked();
+  }
+  for (int pass = 0; pass < 2; ++pass) {
+    xSemaphoreTake(ram_mutex, portMAX_DELAY);
+    int b = -1;
+    if (ram_pending[fill_idx ^ 1]) {
+      b = fill_idx ^ 1;
+    } else if (ram_len[fill_idx]) {
+      b = fill_idx;
+      ram_pending[b] = true;
+      fill_idx ^= 1;
+    }
+    xSemaphoreGive(ram_mutex);
+    if (b < 0) break;
+
+    // Pending batches are ours alone, so the write runs without ram_mutex
+    bytes += (uint32_t)ram_len[b];
+    uint32_t t0 = micros();
+    bool ok = log_append_locked(ram_batch[b], ram_len[b]);
+    if (!ok) {
+      // Don't append after a half-written batch; the next flush opens a fresh sector
+      seal_head_locked();
+      // Serial.println("[STOR] flash write failed!");
     }
+    flush_us_last = micros() - t0;
+    if (flush_us_last > flush_us_max) flush_us_max = flush_us_last;
+    // Serial.printf("[STOR] flushed %u bytes -> sector %u off %u\n",
+    //                 (unsigned)ram_len[b], (unsigned)head_sector, (unsigned)head_off);
+
+    xSemaphoreTake(ram_mutex, portMAX_DELAY);
+    ram_len[b] = 0;
+    ram_pending[b] = false;
+    xSemaphoreGive(ram_mutex);
   }
+  if (bytes) {
+    flush_count[why]++;
+    flush_bytes_last = bytes;
+    if (bytes > flush_bytes_max) flush_bytes_max = bytes;
+    flush_bytes_total += bytes;
+  }
+  xSemaphoreGive(log_mutex);
+}
 
-  // Quick copy RAM content under lock so we hold lock for minimal time
+void storage_flush_now(void) {
+  flush_ram(FLUSH_MANUAL);
+}
+
+void storage_set_flush_watermark(size_t bytes) {
   if (!ram_mutex) return;
   xSemaphoreTake(ram_mutex, portMAX_DELAY);
-  if (ram_len == 0) {
+  ram_watermark = (bytes == 0 || bytes > ram_capacity) ? ram_capacity : bytes;
+  bool over = ram_len[fill_idx] >= ram_watermark;
+  if (over) flush_why |= 1u << FLUSH_WATERMARK;
+  xSemaphoreGive(ram_mutex);
+  if (over && flush_task_handle) xTaskNotifyGive(flush_task_handle);
+}
+
+void storage_set_codec(uint8_t sensor_idx, record_codec_t codec) {
+  if (sensor_idx >= STORAGE_MAX_SENSORS || codec >= RECORD_CODEC_COUNT) return;
+  // Read by the flusher as each record is coded; a byte store is atomic
+  rec_codec[sensor_idx] = (uint8_t)codec;
+}
+
+void storage_set_drop_policy(uint8_t sensor_idx, storage_drop_policy_t policy) {
+  if (sensor_idx >= STORAGE_MAX_SENSORS) return;
+  drop_policy[sensor_idx] = (uint8_t)policy;
+}
+
+bool storage_set_summary(uint8_t sensor_idx, uint8_t value_mask, uint8_t bins, storage_bin_cb bin, void *ctx) {
+  if (sensor_idx >= STORAGE_MAX_SENSORS || bins > STORAGE_SUMMARY_MAX_BINS || !log_mutex) return false;
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  sum_cfg_t *c = &sum_cfg[sensor_idx];
+  c->set = true;
+  c->mask = value_mask;
+  c->bins = bin ? bins : 0;
+  c->bin = bin;
+  c->ctx = ctx;
+  xSemaphoreGive(log_mutex);
+  return true;
+}
+
+bool storage_get_sensor_stats(uint8_t sensor_idx, storage_sensor_stats_t *out) {
+  if (!out || sensor_idx >= STORAGE_MAX_SENSORS || !ram_mutex) return false;
+  xSemaphoreTake(ram_mutex, portMAX_DELAY);
+  *out = rec_stats[sensor_idx];
+  xSemaphoreGive(ram_mutex);
+  return true;
+}
+
+/* Flush task: as soon as the filling batch crosses the watermark (or a
+ * batch fills up), and at the latest flush_interval_ms after the oldest
+ * unflushed record. With nothing in RAM it sleeps until the first record
+ * arrives, so a quiet device doesn't wake up at all. */
+static void flush_task(void *pv) {
+  (void)pv;
+  for (;;) {
+    xSemaphoreTake(ram_mutex, portMAX_DELAY);
+    uint8_t f = fill_idx;
+    bool empty = ram_len[f] == 0 && !ram_pending[f ^ 1] && !flush_why;
+    uint32_t age = empty ? 0 : (uint32_t)millis() - ram_first_ms[f];
+    flush_idle = empty;
     xSemaphoreGive(ram_mutex);
-    return;
-  }
-  uint8_t *tmp = (uint8_t *)malloc(ram_len);
-  if (!tmp) {
-    // allocation failed; drop buffer
-    ram_len = 0;
+
+    if (empty) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } else if (age < flush_interval_ms) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(flush_interval_ms - age));
+    }
+
+    xSemaphoreTake(ram_mutex, portMAX_DELAY);
+    uint8_t why = flush_why;
+    flush_why = 0;
+    flush_idle = false;
+    bool due = ram_len[fill_idx] && (uint32_t)millis() - ram_first_ms[fill_idx] >= flush_interval_ms;
     xSemaphoreGive(ram_mutex);
-    return;
+
+    // Batch handed over or watermark crossed; otherwise the deadline, if due
+    if (why & (1u << FLUSH_FULL)) flush_ram(FLUSH_FULL);
+    else if (why & (1u << FLUSH_WATERMARK)) flush_ram(FLUSH_WATERMARK);
+    else if (due) flush_ram(FLUSH_TIMER);
   }
-  memcpy(tmp, ram_buf, ram_len);
-  size_t write_len = ram_len;
-  ram_len = 0;
-  xSemaphoreGive(ram_mutex);
+}
 
-  // Ensure there is space in our reserved log region
-  uint32_t max_addr = FLASH_LOG_BASE + FLASH_LOG_MAX_BYTES;
-  if (flash_write_ptr + (uint32_t)write_len > max_addr) {
-    // Not enough space -> erase region and start at base.
-    if (!erase_log_region()) {
-      // cannot erase -> drop the data
-      free(tmp);
-      return;
+/* Make the first not-yet-ready sector after the head ready. One erase (or
+ * one batch of tail compaction) per call with log_mutex held, so a flush
+ * waits at most that long for it. False once STORAGE_PREERASE_SECTORS are
+ * ready (or nothing to do). */
+static bool preerase_one(void) {
+  bool more = false;
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  if (flash_initialized && erased_ahead < preerase_sectors) {
+    uint32_t first = sectors_used ? (head_sector + 1) % LOG_SECTORS : fresh_sector;
+    uint32_t target = (first + erased_ahead) % LOG_SECTORS;
+    // Past the free sectors the next one is the tail; never evict the head
+    bool holds_data = sectors_used && sectors_used + erased_ahead >= LOG_SECTORS;
+    if (holds_data && sectors_used > 1 && sum_src_seq <= tail_seq) {
+      // The tail goes next: summarize it first, a batch per call
+      sum_step_locked();
+      more = true;
+    } else if (!holds_data || sectors_used > 1) {
+      if (holds_data) evict_tail_locked();
+      if (holds_data || !sector_ready(target)) {
+        if (erase_log_sector(target)) stamp_sector(target);
+      }
+      if (sector_ready(target)) {
+        erased_ahead++;
+        more = erased_ahead < preerase_sectors;
+      }
     }
-    flash_write_ptr = FLASH_LOG_BASE;
-  }
-
-  // Before writing, must ensure sectors containing the destination are erased.
-  // Our simple approach: erase every sector that overlaps write_ptr..write_ptr+write_len-1
-  uint32_t start_sector = flash_write_ptr / FLASH_SECTOR_SIZE;
-  uint32_t end_sector = (flash_write_ptr + write_len - 1) / FLASH_SECTOR_SIZE;
-  for (uint32_t s = start_sector; s <= end_sector; ++s) {
-    if (!flash_erase_sector(s)) {
-      // erase failed — abort and drop data to avoid repeated attempts
-      free(tmp);
-      return;
+  }
+  xSemaphoreGive(log_mutex);
+  return more;
+}
+
+// Pre-erase task: tops up the ready sectors after each sector opens
+static void preerase_task(void *pv) {
+  (void)pv;
+  for (;;) {
+    while (preerase_one()) vTaskDelay(1);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(flush_interval_ms));
+  }
+}
+
+/* ---- Incremental BLE upload ----
+ * Central -> device commands over the UART service (big endian):
+ *   'N'                          every batch after the ack cursor
+ *   'R' from_seq(4) to_seq(4)    batches of sectors from_seq..to_seq
+ *   'T' from_ts(4) to_ts(4)      batches whose base_ts (device millis) is in range
+ *   'S'                          every summary batch (tiered retention, above)
+ *   'A' seq(4) off(2)            ack every batch up to and including this one
+ *   'X'                          stop the current upload
+ *   'C' key(1) type(1) value(4)  set a config key (config_store.h): type
+ *                                0 resets it, 1 i32, 2 f32 bits
+ * Device -> central frames:
+ *   'K' seq(4) off(2) + the batch as stored (12-byte header + body);
+ *                                batches failing their CRC are skipped
+ *   'M' seq(4) off(2) + a summary batch, as 'K'; summaries are not acked
+ *   'E' op(1) sent(4) cursor_seq(4) cursor_off(2)    end of request op
+ *   'C' key(1) type(1) value(4) ok(1)    a 'C' command echoed, ok 1 if
+ *                                the store took it (0: bad key, type or range)
+ * A batch is named by its sector's seq and its offset in that sector; both
+ * only grow, so "after the cursor" is a plain compare. A new request (or
+ * a connect, which queues 'N') preempts the one in progress without an 'E',
+ * so a resume continues from the last ack. */
+typedef enum { UP_NONE = 0, UP_RESUME, UP_SEQ, UP_TIME, UP_SUMMARY } upload_kind_t;
+
+typedef struct {
+  uint8_t kind;   // upload_kind_t
+  uint32_t from;
+  uint32_t to;
+} upload_req_t;
+
+// Set by the RX path, taken by the upload task; guarded by critical sections
+static upload_req_t up_req = { UP_NONE, 0, 0 };
+static bool up_stop = false;
+static bool ack_pending = false;
+static uint32_t ack_seq = 0;
+static uint32_t ack_off = 0;
+
+static TaskHandle_t upload_task_handle = NULL;
+static uint8_t upload_frame[7 + LOG_SECTOR_BYTES];   // 'K' header + one batch
+static uint8_t *const upload_buf = upload_frame + 7;
+static uint8_t rx_buf[9];
+static size_t rx_len = 0;
+
+/* Persist the newest ack from the central if it moves the cursor forward */
+static void persist_ack(void) {
+  taskENTER_CRITICAL();
+  bool have = ack_pending;
+  uint32_t s = ack_seq, o = ack_off;
+  ack_pending = false;
+  taskEXIT_CRITICAL();
+  if (!have) return;
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  // Only batches that exist can be acked, and the cursor never moves back
+  bool ok = sectors_used && s <= head_seq && (!cursor_valid || pos_after(s, o, cursor_seq, cursor_off));
+  if (ok && meta_write_locked(s, o)) {
+    cursor_valid = true;
+    cursor_seq = s;
+    cursor_off = o;
+  }
+  xSemaphoreGive(log_mutex);
+}
+
+/* Read the first committed batch after (seq, off) into upload_buf and move
+ * (seq, off) to it, from the log or the summary ring. off 0 means from the
+ * start of sector seq. Returns the batch size (header included), 0 at the
+ * end. */
+static uint32_t read_next_batch_locked(bool summaries, uint32_t *seq, uint32_t *off) {
+  uint32_t used = summaries ? sum_used : sectors_used;
+  uint32_t t_seq = summaries ? sum_tail_seq : tail_seq;
+  uint32_t h_seq = summaries ? sum_head_seq : head_seq;
+  if (!used) return 0;
+  uint32_t s = *seq, o = *off;
+  if (s < t_seq) { s = t_seq; o = 0; }   // evicted before it was sent
+  for (; s <= h_seq; ++s, o = 0) {
+    uint32_t addr = summaries ? sum_addr((sum_tail + (s - t_seq)) % SUM_SECTORS)
+                              : sector_addr((tail_sector + (s - t_seq)) % LOG_SECTORS);
+    // Only the head is still growing; everything else is sealed or ends in
+    // an erased batch header
+    uint32_t end = LOG_SECTOR_BYTES;
+    if (s == h_seq && (summaries ? sum_open : head_open)) end = summaries ? sum_head_off : head_off;
+    uint32_t at = LOG_HDR_BYTES;
+    for (;;) {
+      uint32_t total;
+      // Only batches past the position are read whole and checked
+      batch_state_t st;
+      if (at > o) {
+        st = check_batch(addr, at, end, upload_buf, &total);
+      } else {
+        uint8_t bh[LOG_BATCH_HDR];
+        if (at + LOG_BATCH_HDR > end) break;
+        flash_read(addr + at, bh, sizeof(bh));
+        uint16_t len = (uint16_t)((bh[0] << 8) | bh[1]);
+        st = (bh[2] != LOG_BATCH_COMMIT || len == 0 || at + LOG_BATCH_HDR + len > end) ? BATCH_TORN : BATCH_OK;
+        total = LOG_BATCH_HDR + len;
+      }
+      if (st == BATCH_END || st == BATCH_TORN) break;
+      if (st == BATCH_OK && at > o) {
+        *seq = s;
+        *off = at;
+        return total;
+      }
+      at += total;   // corrupt batches are never sent
     }
   }
+  return 0;
+}
 
-  // Write the data
-  bool ok = flash_write(flash_write_ptr, tmp, write_len);
-  free(tmp);
-  if (!ok) {
-    // write failed: we give up for now
-    // Serial.println("[STOR] flash write failed!");
-    return;
+static void run_upload(const upload_req_t *req) {
+  if (!Bluefruit.connected() || !log_ready()) return;
+
+  // Flush RAM first so we include latest data
+  storage_flush_now();
+
+  uint32_t seq = 0, off = 0;
+  if (req->kind == UP_SEQ) {
+    seq = req->from;
+  } else if (req->kind == UP_RESUME) {
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    if (cursor_valid) { seq = cursor_seq; off = cursor_off; }
+    xSemaphoreGive(log_mutex);
+  }
+
+  uint32_t sent = 0;
+  for (;;) {
+    persist_ack();
+    taskENTER_CRITICAL();
+    bool superseded = up_req.kind != UP_NONE;
+    bool stop = up_stop;
+    taskEXIT_CRITICAL();
+    if (superseded) return;   // the new request reports instead
+    if (stop || !Bluefruit.connected()) break;
+
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    uint32_t n = read_next_batch_locked(req->kind == UP_SUMMARY, &seq, &off);
+    xSemaphoreGive(log_mutex);
+    if (n == 0) break;
+    if (req->kind == UP_SEQ && seq > req->to) break;
+    if (req->kind == UP_TIME) {
+      uint32_t base_ts = be32(upload_buf + 4);
+      if (base_ts < req->from || base_ts > req->to) continue;
+    }
+
+    upload_frame[0] = req->kind == UP_SUMMARY ? 'M' : 'K';
+    put_be32(upload_frame + 1, seq);
+    upload_frame[5] = (uint8_t)(off >> 8);
+    upload_frame[6] = (uint8_t)off;
+    // Frames are whole in the bulk stream, so live/text output can't land
+    // inside one; notifications run across frame boundaries
+    ble_write_bulk(upload_frame, 7 + n);
+    sent++;
   }
-  flash_write_ptr += (uint32_t)write_len;
-  // Serial.printf("[STOR] flushed %u bytes -> new flash_ptr=0x%08X\n",
-  //                 (unsigned)write_len, (unsigned)flash_write_ptr);
+
+  persist_ack();
+  static const char ops[] = { 0, 'N', 'R', 'T', 'S' };
+  uint8_t eh[12] = { 'E', (uint8_t)ops[req->kind] };
+  put_be32(eh + 2, sent);
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  put_be32(eh + 6, cursor_valid ? cursor_seq : 0);
+  eh[10] = (uint8_t)((cursor_valid ? cursor_off : 0) >> 8);
+  eh[11] = (uint8_t)(cursor_valid ? cursor_off : 0);
+  xSemaphoreGive(log_mutex);
+  ble_write_bulk(eh, sizeof(eh));
+  ble_bulk_flush();
 }
 
-// Periodic flush task
-static void flush_task(void *pv) {
+// Upload task: runs requests queued by the RX path and connects
+static void upload_task(void *pv) {
   (void)pv;
   for (;;) {
-    vTaskDelay(pdMS_TO_TICKS(flush_interval_ms));
-    storage_flush_now();
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    for (;;) {
+      taskENTER_CRITICAL();
+      upload_req_t req = up_req;
+      up_req.kind = UP_NONE;
+      up_stop = false;
+      taskEXIT_CRITICAL();
+      persist_ack();
+      if (req.kind == UP_NONE) break;
+      run_upload(&req);
+    }
   }
 }
 
-// Upload logs over BLE by streaming bytes in chunks
+static void queue_upload(uint8_t kind, uint32_t from, uint32_t to) {
+  taskENTER_CRITICAL();
+  up_req.kind = kind;
+  up_req.from = from;
+  up_req.to = to;
+  taskEXIT_CRITICAL();
+  if (upload_task_handle) xTaskNotifyGive(upload_task_handle);
+}
+
+// Queue an upload of everything after the ack cursor (e.g. on connect)
 void storage_upload_over_ble(void) {
-  if (!Bluefruit.connected()) return;
-  if (!flash_initialized) {
-    flash_initialized = flash_init();
-    if (!flash_initialized) return;
+  queue_upload(UP_RESUME, 0, 0);
+}
+
+// Feed bytes the central wrote to the UART; commands may arrive split
+void storage_upload_rx(const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    if (rx_len == 0 && !memchr("NRTAXSC", data[i], 7)) continue;   // resync on junk
+    rx_buf[rx_len++] = data[i];
+    char op = (char)rx_buf[0];
+    size_t need = (op == 'R' || op == 'T') ? 9 : (op == 'A' || op == 'C') ? 7 : 1;
+    if (rx_len < need) continue;
+    rx_len = 0;
+
+    if (op == 'N') {
+      queue_upload(UP_RESUME, 0, 0);
+    } else if (op == 'R') {
+      queue_upload(UP_SEQ, be32(rx_buf + 1), be32(rx_buf + 5));
+    } else if (op == 'T') {
+      queue_upload(UP_TIME, be32(rx_buf + 1), be32(rx_buf + 5));
+    } else if (op == 'A') {
+      taskENTER_CRITICAL();
+      uint32_t s = be32(rx_buf + 1), o = (uint32_t)((rx_buf[5] << 8) | rx_buf[6]);
+      // Acks may overtake each other in here; keep the furthest
+      if (!ack_pending || pos_after(s, o, ack_seq, ack_off)) {
+        ack_seq = s;
+        ack_off = o;
+        ack_pending = true;
+      }
+      taskEXIT_CRITICAL();
+      if (upload_task_handle) xTaskNotifyGive(upload_task_handle);
+    } else if (op == 'S') {
+      queue_upload(UP_SUMMARY, 0, 0);
+    } else if (op == 'X') {
+      taskENTER_CRITICAL();
+      up_stop = true;
+      taskEXIT_CRITICAL();
+    } else if (op == 'C') {
+      // Applied here: subscribers (rates, watermark) take effect before the reply
+      uint8_t reply[8];
+      memcpy(reply, rx_buf, 7);
+      reply[7] = config_set_typed((config_key_t)rx_buf[1], (config_type_t)rx_buf[2], be32(rx_buf + 3)) ? 1 : 0;
+      ble_write_frame(reply, sizeof(reply), 0);
+    }
   }
+}
 
-  // Flush RAM first so we include latest data
-  storage_flush_now();
+bool storage_upload_cursor(uint32_t *seq, uint32_t *off) {
+  if (!log_mutex || !flash_initialized) return false;
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  bool ok = cursor_valid;
+  if (seq) *seq = cursor_seq;
+  if (off) *off = cursor_off;
+  xSemaphoreGive(log_mutex);
+  return ok;
+}
+
+// Integrity scan, one sector per log_mutex hold so flushes keep going
+bool storage_scan_log(storage_scan_t *out) {
+  if (!out || !log_mutex || !log_ready()) return false;
+  memset(out, 0, sizeof(*out));
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  uint32_t s = tail_seq;
+  xSemaphoreGive(log_mutex);
+
+  for (;;) {
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    if (!sectors_used || s > head_seq) {
+      xSemaphoreGive(log_mutex);
+      break;
+    }
+    if (s < tail_seq) s = tail_seq;   // evicted meanwhile
+    uint32_t sec = (tail_sector + (s - tail_seq)) % LOG_SECTORS;
+    uint32_t end = LOG_SECTOR_BYTES;
+    log_sector_hdr_t h;
+    if (s == head_seq && head_open) end = head_off;
+    else if (read_hdr(sec, &h) && hdr_sealed(&h)) end = LOG_HDR_BYTES + h.used;
+    uint32_t at = LOG_HDR_BYTES;
+    for (;;) {
+      uint32_t total;
+      batch_state_t st = check_batch(sector_addr(sec), at, end, NULL, &total);
+      if (st == BATCH_END) break;
+      if (st == BATCH_TORN) {
+        out->sectors_torn++;
+        break;
+      }
+      if (st == BATCH_OK) out->batches_ok++;
+      else out->batches_corrupt++;
+      out->bytes_scanned += total;
+      at += total;
+    }
+    out->sectors++;
+    xSemaphoreGive(log_mutex);
+    s++;
+  }
 
-  // calculate how many bytes stored: find write_ptr by reading pointer (we already track flash_write_ptr)
-  uint32_t ptr = flash_write_ptr;
-  uint32_t read_addr = FLASH_LOG_BASE;
-
-  // Stream in CHUNK_UPLOAD_PAYLOAD sized blocks
-  uint8_t payload[CHUNK_UPLOAD_PAYLOAD];
-  uint32_t seq = 0;
-
-  while (read_addr < ptr) {
-    size_t to_read = CHUNK_UPLOAD_PAYLOAD;
-    if (read_addr + to_read > ptr) to_read = ptr - read_addr;
-    flash_read(read_addr, payload, to_read);
-    // Serial.printf("[STOR] upload chunk seq=%u addr=0x%08X len=%u\n", (unsigned)seq, (unsigned)read_addr, (unsigned)to_read);
-    // send small chunk header, then payload
-    uint8_t hdr[7];
-    hdr[0] = 'B';
-    hdr[1] = (uint8_t)((seq >> 24) & 0xFF);
-    hdr[2] = (uint8_t)((seq >> 16) & 0xFF);
-    hdr[3] = (uint8_t)((seq >> 8) & 0xFF);
-    hdr[4] = (uint8_t)(seq & 0xFF);
-    hdr[5] = (uint8_t)((to_read >> 8) & 0xFF);
-    hdr[6] = (uint8_t)(to_read & 0xFF);
-
-    // write header + payload to BLE UART (existing bleuart.write)
-    bleuart.write(hdr, sizeof(hdr));
-    // small delay to avoid overflowing BLE buffers — tune if your BLE stack supports bigger queues
-    vTaskDelay(pdMS_TO_TICKS(2));
-    bleuart.write(payload, to_read);
-    vTaskDelay(pdMS_TO_TICKS(2));
-
-    read_addr += to_read;
-    seq++;
-  }
-}
-
-// Erase all logs in the region (useful for app-requested cleanup)
+  // A full scan replaces the count rather than adding to it
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  batches_corrupt = out->batches_corrupt;
+  xSemaphoreGive(log_mutex);
+  return true;
+}
+
+// Erase all logs and their summaries (useful for app-requested cleanup)
 void storage_erase_all_logs(void) {
-  if (!flash_initialized) flash_initialized = flash_init();
+  if (!log_ready()) return;
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  head_open = false;
   erase_log_region();
-  flash_write_ptr = FLASH_LOG_BASE;
+  // Keep counting up so any stale header left by a failed erase stays older,
+  // and carry on after the old head so the ring keeps rotating
+  if (sectors_used) {
+    tail_seq = head_seq + 1;
+    fresh_sector = (head_sector + 1) % LOG_SECTORS;
+  }
+  sectors_used = 0;
+  erased_ahead = 0;
+  // Summaries go too; the ring restarts after its old head
+  for (uint32_t n = 0; n < sum_used; ++n) {
+    flash_erase_sector(sum_addr((sum_tail + n) % SUM_SECTORS) / FLASH_SECTOR_SIZE);
+  }
+  if (sum_used) {
+    sum_tail_seq = sum_head_seq + 1;
+    sum_fresh = (sum_head + 1) % SUM_SECTORS;
+  }
+  sum_used = 0;
+  sum_open = false;
+  sum_src_seq = tail_seq;
+  sum_src_off = 0;
+  xSemaphoreGive(log_mutex);
+  if (preerase_task_handle) xTaskNotifyGive(preerase_task_handle);
+}
+
+bool storage_get_log_stats(storage_log_stats_t *out) {
+  if (!out || !log_mutex || !flash_initialized) return false;
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  out->sectors_total = LOG_SECTORS;
+  out->sectors_used = sectors_used;
+  out->oldest_seq = tail_seq;
+  out->newest_seq = head_seq;
+  out->bytes_retained = 0;
+  if (sectors_used) {
+    uint32_t head_used = head_off - LOG_HDR_BYTES;
+    out->bytes_retained = (sectors_used - 1) * LOG_SECTOR_PAYLOAD + head_used;
+  }
+  out->erase_min = out->erase_max = erase_counts[0];
+  out->erase_total = 0;
+  for (uint32_t i = 0; i < LOG_SECTORS; ++i) {
+    if (erase_counts[i] < out->erase_min) out->erase_min = erase_counts[i];
+    if (erase_counts[i] > out->erase_max) out->erase_max = erase_counts[i];
+    out->erase_total += erase_counts[i];
+  }
+  out->bytes_in = bytes_in;
+  out->bytes_coded = bytes_coded;
+  out->preerased = erased_ahead;
+  out->erase_on_demand = erase_on_demand;
+  out->batches_corrupt = batches_corrupt;
+  out->flush_us_last = flush_us_last;
+  out->flush_us_max = flush_us_max;
+  out->flushes_watermark = flush_count[FLUSH_WATERMARK];
+  out->flushes_full = flush_count[FLUSH_FULL];
+  out->flushes_timer = flush_count[FLUSH_TIMER];
+  out->flushes_manual = flush_count[FLUSH_MANUAL];
+  out->flush_bytes_last = flush_bytes_last;
+  out->flush_bytes_max = flush_bytes_max;
+  out->flush_bytes_total = flush_bytes_total;
+  out->summary_sectors = sum_used;
+  out->sectors_summarized = sum_summarized;
+  out->sectors_unsummarized = sum_skipped;
+  xSemaphoreGive(log_mutex);
+  return true;
 }
 
 // Initialize storage
 bool storage_init(uint32_t flush_interval, size_t ram_buf_size) {
   flush_interval_ms = (flush_interval == 0) ? DEFAULT_FLUSH_MS : flush_interval;
-  ram_capacity = (ram_buf_size == 0) ? DEFAULT_RAM_BUF : ram_buf_size;
-
-  // allocate RAM buffer
-  ram_buf = (uint8_t *)malloc(ram_capacity);
-  if (!ram_buf) return false;
-  ram_len = 0;
+  // Each of the two static batches holds at most STORAGE_BATCH_BYTES
+  ram_capacity = (ram_buf_size == 0 || ram_buf_size > STORAGE_BATCH_BYTES) ? STORAGE_BATCH_BYTES : ram_buf_size;
+  ram_len[0] = ram_len[1] = 0;
+  ram_pending[0] = ram_pending[1] = false;
+  ram_watermark = STORAGE_FLUSH_WATERMARK < ram_capacity ? STORAGE_FLUSH_WATERMARK : ram_capacity;
 
   ram_mutex = xSemaphoreCreateMutex();
-  if (!ram_mutex) {
-    free(ram_buf);
-    ram_buf = NULL;
+  log_mutex = xSemaphoreCreateMutex();
+  if (!ram_mutex || !log_mutex) {
+    if (ram_mutex) vSemaphoreDelete(ram_mutex);
+    if (log_mutex) vSemaphoreDelete(log_mutex);
+    ram_mutex = log_mutex = NULL;
     return false;
   }
 
-  // Init flash and determine write pointer
-  flash_initialized = flash_init();
-  if (!flash_initialized) {
-    // still allow operation; we'll drop data or retry when flushing
-    flash_initialized = false;
-  } else {
-    flash_write_ptr = find_write_ptr();
+  // Init flash and recover the log; if this fails we retry when flushing
+  if (log_ready()) {
+    Serial.printf("[STOR] log: %u sectors, seq %u..%u, head off %u\n",
+                  (unsigned)sectors_used, (unsigned)tail_seq, (unsigned)head_seq, (unsigned)head_off);
   }
 
-  // Create flush task
+  // Create flush task, and the pre-erase task below it
   BaseType_t r = xTaskCreate(flush_task, "stor-flush", 4096, NULL, 1, &flush_task_handle);
+  if (r == pdPASS && xTaskCreate(upload_task, "stor-up", 1024, NULL, 1, &upload_task_handle) != pdPASS) {
+    vTaskDelete(flush_task_handle);
+    flush_task_handle = NULL;
+    r = pdFAIL;
+  }
+  if (r == pdPASS && STORAGE_PREERASE_SECTORS > 0) {
+    // Without it every new sector is erased on demand; not fatal
+    if (xTaskCreate(preerase_task, "stor-erase", 1024, NULL, 1, &preerase_task_handle) != pdPASS) {
+      preerase_task_handle = NULL;
+    }
+  }
   if (r != pdPASS) {
     // cleanup
     vSemaphoreDelete(ram_mutex);
-    ram_mutex = NULL;
-    free(ram_buf);
-    ram_buf = NULL;
+    vSemaphoreDelete(log_mutex);
+    ram_mutex = log_mutex = NULL;
     return false;
   }
   return true;
@@ -0,0 +1,244 @@
+// src/telemetry.cpp
+#include <Arduino.h>
+#include <bluefruit.h>
+#include <string.h>
+#include "telemetry.h"
+#include "ble_manager.h"
+#include "sensor_manager.h"
+#include "sensor_queue.h"
+
+#define TAG_TYPE_SHIFT 5
+
+static const uint8_t layout_type[TELEM_LAYOUT_COUNT] = {
+    TELEM_RAW, TELEM_RAW, TELEM_U8, TELEM_I16, TELEM_F16, TELEM_F16
+};
+static const uint8_t layout_width[TELEM_LAYOUT_COUNT] = { 1, 1, 1, 2, 4, 4 };
+static const uint8_t wire_width[TELEM_TYPE_COUNT] = { 1, 1, 2, 2 };
+
+telem_type_t telem_wire_type(telem_layout_t layout)
+{
+    return (unsigned)layout < TELEM_LAYOUT_COUNT ? (telem_type_t)layout_type[layout] : TELEM_RAW;
+}
+
+uint16_t telem_f16(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+    uint32_t exp = (x >> 23) & 0xFF;
+    uint32_t man = x & 0x7FFFFF;
+    if (exp == 0xFF) return (uint16_t)(sign | 0x7C00 | (man ? 0x200 : 0));   // inf, NaN
+    int e = (int)exp - 127 + 15;
+    if (e >= 31) return (uint16_t)(sign | 0x7C00);
+    if (e <= 0) {
+        // Subnormal half: shift the 24-bit significand down, round to even
+        if (e < -10) return sign;
+        man |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - e);
+        uint32_t h = man >> shift;
+        uint32_t rem = man & ((1u << shift) - 1), half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (h & 1))) h++;
+        return (uint16_t)(sign | h);
+    }
+    uint32_t h = ((uint32_t)e << 10) | (man >> 13);
+    uint32_t rem = man & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) h++;   // a carry into the exponent is still right
+    return (uint16_t)(sign | h);
+}
+
+static size_t varint_len(uint32_t v)
+{
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; n++; }
+    return n;
+}
+
+static void put_be16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+void telem_frame_begin(telem_frame_t *f, uint8_t *buf, size_t cap, uint32_t base_ts)
+{
+    f->buf = buf;
+    f->cap = cap;
+    f->len = TELEMETRY_HDR_BYTES;
+    f->base_ts = base_ts;
+    f->last_ts = base_ts;
+    f->samples = 0;
+}
+
+bool telem_frame_add(telem_frame_t *f, uint8_t idx, uint32_t ts, telem_layout_t layout,
+                     const uint8_t *payload, size_t len)
+{
+    if (idx >= TELEMETRY_MAX_SENSORS || layout == TELEM_LAYOUT_NONE || (unsigned)layout >= TELEM_LAYOUT_COUNT) {
+        return false;
+    }
+    size_t width = layout_width[layout];
+    if (len % width || len / width > 255) layout = TELEM_LAYOUT_RAW;
+    if (layout == TELEM_LAYOUT_RAW) {
+        if (len > 255) return false;
+        width = 1;
+    }
+    uint8_t type = layout_type[layout];
+    size_t n = len / width;
+    int32_t dt = (int32_t)(ts - f->last_ts);
+    uint32_t zz = ((uint32_t)dt << 1) ^ (uint32_t)(dt >> 31);
+    size_t need = 1 + varint_len(zz) + 1 + n * wire_width[type];
+    if (f->len + need > f->cap) return false;
+
+    uint8_t *p = f->buf + f->len;
+    *p++ = (uint8_t)(type << TAG_TYPE_SHIFT | idx);
+    while (zz >= 0x80) {
+        *p++ = (uint8_t)(zz | 0x80);
+        zz >>= 7;
+    }
+    *p++ = (uint8_t)zz;
+    *p++ = (uint8_t)n;
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t *v = payload + i * width;
+        if (layout == TELEM_LAYOUT_RAW || layout == TELEM_LAYOUT_U8) {
+            *p++ = v[0];
+        } else if (layout == TELEM_LAYOUT_I16BE) {
+            *p++ = v[0];
+            *p++ = v[1];
+        } else {
+            uint32_t bits = layout == TELEM_LAYOUT_F32BE
+                ? ((uint32_t)v[0] << 24) | ((uint32_t)v[1] << 16) | ((uint32_t)v[2] << 8) | v[3]
+                : ((uint32_t)v[3] << 24) | ((uint32_t)v[2] << 16) | ((uint32_t)v[1] << 8) | v[0];
+            float fv;
+            memcpy(&fv, &bits, sizeof(fv));
+            put_be16(p, telem_f16(fv));
+            p += 2;
+        }
+    }
+    f->len = (size_t)(p - f->buf);
+    f->last_ts = ts;
+    f->samples++;
+    return true;
+}
+
+size_t telem_frame_end(telem_frame_t *f)
+{
+    if (!f->samples) return 0;
+    uint8_t *h = f->buf;
+    h[0] = 'T';
+    h[1] = 'L';
+    h[2] = TELEMETRY_VERSION;
+    put_be16(h + 3, (uint16_t)(f->len - TELEMETRY_HDR_BYTES));
+    h[5] = (uint8_t)(f->base_ts >> 24);
+    h[6] = (uint8_t)(f->base_ts >> 16);
+    h[7] = (uint8_t)(f->base_ts >> 8);
+    h[8] = (uint8_t)f->base_ts;
+    return f->len;
+}
+
+/* ---- Device side ---- */
+
+static uint8_t layouts[TELEMETRY_MAX_SENSORS];   // telem_layout_t
+// Link generation the catalog last went out on; guarded by critical sections
+static bool catalog_sent = false;
+static uint32_t catalog_gen = 0;
+
+bool telemetry_set_layout(int idx, telem_layout_t layout)
+{
+    if (idx < 0 || idx >= TELEMETRY_MAX_SENSORS || (unsigned)layout >= TELEM_LAYOUT_COUNT) return false;
+    layouts[idx] = (uint8_t)layout;
+    return true;
+}
+
+telem_layout_t telemetry_get_layout(int idx)
+{
+    if (idx < 0 || idx >= TELEMETRY_MAX_SENSORS) return TELEM_LAYOUT_NONE;
+    return (telem_layout_t)layouts[idx];
+}
+
+// Every registered sensor, with the type its samples go out as
+static void send_catalog(void)
+{
+    static uint8_t buf[5 + TELEMETRY_MAX_SENSORS * (3 + SENSOR_NAME_MAX)];
+    size_t n = 5;
+    for (int i = 0; i < TELEMETRY_MAX_SENSORS; ++i) {
+        const char *name = sensor_get_name(i);
+        if (!name) break;
+        size_t len = strnlen(name, SENSOR_NAME_MAX);
+        telem_layout_t l = (telem_layout_t)layouts[i];
+        buf[n++] = (uint8_t)i;
+        buf[n++] = (uint8_t)telem_wire_type(l == TELEM_LAYOUT_NONE ? TELEM_LAYOUT_RAW : l);
+        buf[n++] = (uint8_t)len;
+        memcpy(buf + n, name, len);
+        n += len;
+    }
+    buf[0] = 'T';
+    buf[1] = 'C';
+    buf[2] = TELEMETRY_VERSION;
+    put_be16(buf + 3, (uint16_t)(n - 5));
+    ble_write_frame(buf, n, 0);
+}
+
+void telemetry_send(const uint8_t *frame, size_t len)
+{
+    if (!len || !Bluefruit.connected() || !bleuart.notifyEnabled()) return;
+    uint32_t gen = ble_link_generation();
+    taskENTER_CRITICAL();
+    bool due = !catalog_sent || catalog_gen != gen;
+    catalog_sent = true;
+    catalog_gen = gen;
+    taskEXIT_CRITICAL();
+    if (due) send_catalog();
+    ble_write_frame(frame, len, 0);
+}
+
+size_t telemetry_frame_cap(size_t buf_bytes)
+{
+    size_t payload = ble_tx_payload();
+    size_t k = buf_bytes / payload;
+    return k ? k * payload : buf_bytes;
+}
+
+void telemetry_pack(telem_packer_t *p, uint8_t idx, uint32_t ts, telem_layout_t layout,
+                    const uint8_t *payload, size_t len)
+{
+    if (p->open && telem_frame_add(&p->f, idx, ts, layout, payload, len)) return;
+    telemetry_pack_flush(p);
+    telem_frame_begin(&p->f, p->buf, telemetry_frame_cap(sizeof(p->buf)), ts);
+    p->open = true;
+    p->opened_ms = millis();
+    if (telem_frame_add(&p->f, idx, ts, layout, payload, len)) return;
+    // Bigger than a notification-sized frame: a frame of its own
+    telem_frame_begin(&p->f, p->buf, sizeof(p->buf), ts);
+    if (telem_frame_add(&p->f, idx, ts, layout, payload, len)) telemetry_pack_flush(p);
+    p->open = false;
+}
+
+void telemetry_pack_flush(telem_packer_t *p)
+{
+    if (!p->open) return;
+    p->open = false;
+    telemetry_send(p->buf, telem_frame_end(&p->f));
+}
+
+void telemetry_send_snapshot(void)
+{
+    if (!Bluefruit.connected() || !bleuart.notifyEnabled()) return;
+    static telem_packer_t pk;
+    static sensor_data_t snap;   // full-size record: keep it off the task stack
+    static int8_t consumer[TELEMETRY_MAX_SENSORS];   // queue cursor + 1, 0 = none yet
+    for (int i = 0; i < TELEMETRY_MAX_SENSORS; ++i) {
+        telem_layout_t l = (telem_layout_t)layouts[i];
+        if (l == TELEM_LAYOUT_NONE) continue;
+        sensor_queue_t *q = sensor_get_queue(i);
+        if (q && !consumer[i]) consumer[i] = (int8_t)(sensor_queue_subscribe(q) + 1);
+        if (q && consumer[i]) {
+            // Everything since the last tick, not just the latest
+            while (sensor_queue_pop(q, consumer[i] - 1, &snap)) {
+                telemetry_pack(&pk, (uint8_t)i, (uint32_t)snap.timestamp, l, snap.bytes, snap.len);
+            }
+            continue;
+        }
+        if (!sensor_get_last(i, &snap)) continue;
+        telemetry_pack(&pk, (uint8_t)i, (uint32_t)snap.timestamp, l, snap.bytes, snap.len);
+    }
+    telemetry_pack_flush(&pk);
+}
@@ -4,6 +4,7 @@
 #include <Wire.h>
 #include <Adafruit_TinyUSB.h>
 #include "ble_manager.h"
+#include "config_store.h"
 
 // These are implemented in temp_sensor_module.cpp
 extern void temp_sensor_init(void);
@@ -20,7 +21,7 @@ uint8_t temp_i2c_addr = 0;
 // Default values approximate the previous behavior; tweak as needed.
 static const float RAW_DIV = 256.0f;       // existing conversion used in adapter
 static const float TEMP_SCALE = 1.0f;      // scale factor (1.0 = no scale)
-static const float TEMP_OFFSET_C = -192.0f;   // offset in Celsius to add after scaling
+static const float TEMP_OFFSET_C = -192.0f;   // offset in Celsius to add after scaling (default for CFG_TEMP_OFFSET_C)
 
 // Probe a small set of likely addresses only (non-blocking, with recovery)
 bool probe_common_addrs_and_record(void) {
@@ -70,7 +71,7 @@ bool temp_init_adapter(void *ctx) {
 bool temp_read_adapter(void *ctx, sensor_data_t *out) {
   (void)ctx;
   if (!out) return false;
-  memset(out, 0, sizeof(*out));
+  memset(out->bytes, 0, out->cap);
   if (temp_i2c_addr == 0) return false; // no known device
 
   uint16_t raw = readTemp();
@@ -78,7 +79,7 @@ bool temp_read_adapter(void *ctx, sensor_data_t *out) {
 
   // Convert raw -> Celsius using configurable scale/offset:
   float temp_c = ((float)raw) / RAW_DIV;
-  temp_c = temp_c * TEMP_SCALE + TEMP_OFFSET_C;
+  temp_c = temp_c * TEMP_SCALE + config_get_f32(CFG_TEMP_OFFSET_C, TEMP_OFFSET_C);
 
   // Pack as int16_t scaled by 100 (same format temp_print_adapter expects)
   int16_t t_scaled = (int16_t)roundf(temp_c * 100.0f);
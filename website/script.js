@@ -9,8 +9,8 @@ let server = null;
 let txChar = null;
 let rxChar = null;
 
-// buffer for incoming messages
-let partial = "";
+// decodes the device's binary telemetry frames (telemetry.js)
+let telemetry = new Telemetry.Decoder();
 
 // Head Position Categories
 const HEAD_POSITIONS = [
@@ -356,25 +356,48 @@ function updateSubplotCharts(parsed) {
   }
 }
 
-function parseLine(data) {
-  try {
-    if (!data || typeof data !== "string") throw new Error("Invalid input");
-
-    const dataArray = data.split(",").map((p) => p.trim());
-
-    return {
-      time: dataArray[0] ?? "-",
-      temperature: dataArray[1] ?? "-",
-      heartRate: dataArray[2] ?? "-",
-      spo2: dataArray[3] ?? "-",
-      headPosition: dataArray[4] ?? "-",
-      snoring: dataArray[5] ?? "-",
-      battery: dataArray[6] ?? "-",
-    };
-  } catch (e) {
-    console.error("[ERR] Parsing error:", e);
-    return null;
+// Head position from the IMU roll, as the firmware's imu_print_adapter classifies it
+function positionOf(roll) {
+  if (roll <= -90) return "extreme right";
+  if (roll <= -30) return "medium right";
+  if (roll <= 30) return "relatively up";
+  if (roll < 90) return "medium left";
+  return "extreme left";
+}
+
+// One row from a telemetry frame's samples, in the fields of the old text
+// line: time, temp, hr, spo2, position, snoring, battery
+function parseSamples(list) {
+  const row = {
+    time: "-",
+    temperature: "-",
+    heartRate: "-",
+    spo2: "-",
+    headPosition: "-",
+    snoring: "-",
+    battery: "-",
+  };
+  let ts = null;
+  for (const s of list) {
+    const v = s.values;
+    if (s.name === "temp" && v.length >= 1) {
+      row.temperature = (v[0] / 100).toFixed(2);
+    } else if (s.name === "spo2_fusion" && v.length >= 2) {
+      row.spo2 = v[0].toFixed(2);
+      row.heartRate = v[1].toFixed(1);
+    } else if (s.name === "imu" && v.length >= 3) {
+      row.headPosition = positionOf(v[2]);
+      row.snoring = "1";
+    } else if (s.name === "battery" && v.length >= 1) {
+      row.battery = String(v[0]);
+    } else {
+      continue;
+    }
+    if (ts === null || s.ts > ts) ts = s.ts;
   }
+  if (ts === null) return null;
+  row.time = String(ts);
+  return row;
 }
 
 // bluetooth handlers
@@ -412,6 +435,7 @@ async function connect() {
     txChar = await service.getCharacteristic(NUS_TX_UUID);
     rxChar = await service.getCharacteristic(NUS_RX_UUID);
 
+    telemetry = new Telemetry.Decoder();
     await txChar.startNotifications();
     txChar.addEventListener("characteristicvaluechanged", onNotify);
 
@@ -432,26 +456,16 @@ async function disconnect() {
 
 function onNotify(event) {
   const value = event.target.value;
-  const chunk = new TextDecoder().decode(value);
-
-  partial += chunk;
-
-  let idx;
-  while ((idx = partial.indexOf("\n")) >= 0) {
-    const line = partial.slice(0, idx).trim();
-    partial = partial.slice(idx + 1);
+  const chunk = new Uint8Array(value.buffer, value.byteOffset, value.byteLength);
 
-    if (!line) continue;
+  const parsed = parseSamples(telemetry.feed(chunk));
+  if (!parsed) return;
 
-    logLine(line);
+  logLine(columns.map((col) => parsed[col]).join(", "));
 
-    const parsed = parseLine(line);
-    if (parsed) {
-      samples.push(parsed);
-      // addRow(parsed)
-      updateSubplotCharts(parsed);
-    }
-  }
+  samples.push(parsed);
+  // addRow(parsed)
+  updateSubplotCharts(parsed);
 }
 
 // button wiring
@@ -0,0 +1,142 @@
+// Decoder for the device's binary live telemetry (firmware include/telemetry.h).
+// Frames, big endian:
+//   'T' 'L' version len(u16) base_ts(u32) + samples
+//   'T' 'C' version len(u16) + catalog entries idx type name_len name
+// Sample: tag (type << 5 | sensor idx), zigzag varint dt, n, n values.
+// BLEStuff/telemetry.py is the same decoder for the host tools.
+const Telemetry = (function () {
+  const VERSION = 1;
+  const RAW = 0;
+  const U8 = 1;
+  const I16 = 2;
+  const F16 = 3;
+
+  function f16(h) {
+    const sign = h & 0x8000 ? -1 : 1;
+    const exp = (h >> 10) & 0x1f;
+    const man = h & 0x3ff;
+    if (exp === 0) return sign * man * Math.pow(2, -24);
+    if (exp === 31) return man ? NaN : sign * Infinity;
+    return sign * (1 + man / 1024) * Math.pow(2, exp - 15);
+  }
+
+  // [{ts, idx, type, values}] of a sample frame body; RAW values are bytes
+  function samplesIn(baseTs, body) {
+    const out = [];
+    const view = new DataView(body.buffer, body.byteOffset, body.byteLength);
+    let pos = 0;
+    let ts = baseTs;
+    while (pos < body.length) {
+      const tag = body[pos++];
+      const type = tag >> 5;
+      let zz = 0;
+      let shift = 0;
+      for (;;) {
+        if (pos >= body.length || shift >= 35) throw new Error("bad varint");
+        const b = body[pos++];
+        zz += (b & 0x7f) * Math.pow(2, shift);
+        if (!(b & 0x80)) break;
+        shift += 7;
+      }
+      const dt = zz % 2 ? -(zz + 1) / 2 : zz / 2;
+      ts = (ts + dt) >>> 0;
+      if (pos >= body.length || type > F16) throw new Error("bad sample");
+      const n = body[pos++];
+      const width = type === I16 || type === F16 ? 2 : 1;
+      if (pos + n * width > body.length) throw new Error("truncated sample");
+      let values;
+      if (type === RAW) {
+        values = body.slice(pos, pos + n);
+      } else {
+        values = [];
+        for (let i = 0; i < n; i++) {
+          const p = pos + i * width;
+          if (type === U8) values.push(body[p]);
+          else if (type === I16) values.push(view.getInt16(p));
+          else values.push(f16(view.getUint16(p)));
+        }
+      }
+      pos += n * width;
+      out.push({ ts, idx: tag & 0x1f, type, values });
+    }
+    return out;
+  }
+
+  // {idx: {type, name}} of a catalog frame body
+  function catalogIn(body) {
+    const out = {};
+    let pos = 0;
+    while (pos + 3 <= body.length) {
+      const n = body[pos + 2];
+      if (pos + 3 + n > body.length) break;
+      let name = "";
+      for (let i = 0; i < n; i++) name += String.fromCharCode(body[pos + 3 + i]);
+      out[body[pos]] = { type: body[pos + 1], name };
+      pos += 3 + n;
+    }
+    return out;
+  }
+
+  // Feed notification bytes in order; returns the samples they complete as
+  // [{ts, idx, name, values}]. Other traffic on the UART is skipped.
+  class Decoder {
+    constructor() {
+      this.buf = new Uint8Array(0);
+      this.catalog = {};
+    }
+
+    feed(data) {
+      const next = new Uint8Array(this.buf.length + data.length);
+      next.set(this.buf);
+      next.set(data, this.buf.length);
+      const buf = next;
+      const out = [];
+      let pos = 0;
+      while (pos < buf.length) {
+        if (buf[pos] !== 0x54) {
+          // 'T'
+          pos++;
+          continue;
+        }
+        if (pos + 5 > buf.length) break;
+        const kind = buf[pos + 1];
+        const hdr = kind === 0x4c ? 9 : kind === 0x43 ? 5 : 0; // 'L', 'C'
+        if (!hdr || buf[pos + 2] !== VERSION) {
+          pos++;
+          continue;
+        }
+        const n = (buf[pos + 3] << 8) | buf[pos + 4];
+        if (pos + hdr + n > buf.length) break;
+        const body = buf.subarray(pos + hdr, pos + hdr + n);
+        try {
+          if (kind === 0x43) {
+            this.catalog = catalogIn(body);
+          } else {
+            const baseTs =
+              ((buf[pos + 5] << 24) | (buf[pos + 6] << 16) | (buf[pos + 7] << 8) | buf[pos + 8]) >>> 0;
+            for (const s of samplesIn(baseTs, body)) {
+              const entry = this.catalog[s.idx];
+              out.push({
+                ts: s.ts,
+                idx: s.idx,
+                name: entry ? entry.name : "sensor" + s.idx,
+                values: s.values,
+              });
+            }
+          }
+        } catch (e) {
+          // Not a frame after all: a 'T' inside other traffic
+          pos++;
+          continue;
+        }
+        pos += hdr + n;
+      }
+      this.buf = buf.slice(pos);
+      return out;
+    }
+  }
+
+  return { VERSION, RAW, U8, I16, F16, f16, Decoder };
+})();
+
+if (typeof module !== "undefined") module.exports = Telemetry;